@@ -45,6 +45,9 @@
 #include "iio_adc_demo.h"
 #include "iio.h"
 
+/* Number of scans copied to the iio buffer at once by adc_submit_samples */
+#define ADC_DEMO_SCANS_PER_PUSH	32
+
 /**
  * @brief utility function for computing next upcoming channel
  * @param ch_mask - active channels .
@@ -145,35 +148,41 @@ int32_t adc_submit_samples(struct iio_device_data *dev_data)
 	struct adc_demo_desc *desc;
 	uint32_t k = 0;
 	uint32_t ch = -1;
-	uint16_t buff[TOTAL_ADC_CHANNELS];
+	uint16_t buff[ADC_DEMO_SCANS_PER_PUSH * TOTAL_ADC_CHANNELS];
 	uint32_t i;
+	uint32_t nb_scans;
+	uint32_t scans = 0;
 	uint16_t *ch_buf_ptr;
+	int offset_per_ch = NO_OS_ARRAY_SIZE(sine_lut) / TOTAL_ADC_CHANNELS;
 
 	if(!dev_data)
 		return -ENODEV;
 
 	desc = (struct adc_demo_desc *)dev_data->dev;
+	nb_scans = dev_data->buffer->size / dev_data->buffer->bytes_per_scan;
 
-	if(desc->ext_buff == NULL) {
-		int offset_per_ch = NO_OS_ARRAY_SIZE(sine_lut) / TOTAL_ADC_CHANNELS;
-		for(i = 0; i < dev_data->buffer->size / dev_data->buffer->bytes_per_scan; i++) {
-			while(get_next_ch_idx(desc->active_ch, ch, &ch))
-				buff[k++] = sine_lut[(i + ch * offset_per_ch ) % NO_OS_ARRAY_SIZE(sine_lut)];
+	/* Scans are pushed in chunks to update the buffer once per chunk */
+	for(i = 0; i < nb_scans; i++) {
+		while(get_next_ch_idx(desc->active_ch, ch, &ch)) {
+			if(desc->ext_buff == NULL) {
+				buff[k++] = sine_lut[(i + ch * offset_per_ch) %
+						     NO_OS_ARRAY_SIZE(sine_lut)];
+			} else {
+				ch_buf_ptr = (uint16_t*)desc->ext_buff +
+					     (ch * desc->ext_buff_len);
+				buff[k++] = ch_buf_ptr[i];
+			}
+		}
+		if (++scans == ADC_DEMO_SCANS_PER_PUSH) {
+			iio_buffer_push_scans(dev_data->buffer, buff, scans);
+			scans = 0;
 			k = 0;
-			iio_buffer_push_scan(dev_data->buffer, buff);
 		}
-		return dev_data->buffer->size / dev_data->buffer->bytes_per_scan;
 	}
+	if (scans)
+		iio_buffer_push_scans(dev_data->buffer, buff, scans);
 
-	for(i = 0; i < dev_data->buffer->size / dev_data->buffer->bytes_per_scan; i++) {
-		while(get_next_ch_idx(desc->active_ch, ch, &ch)) {
-			ch_buf_ptr = (uint16_t*)desc->ext_buff + (ch * desc->ext_buff_len);
-			buff[k++] = ch_buf_ptr[i];
-		}
-		k = 0;
-		iio_buffer_push_scan(dev_data->buffer, buff);
-	}
-	return dev_data->buffer->size / dev_data->buffer->bytes_per_scan;
+	return nb_scans;
 }
 
 
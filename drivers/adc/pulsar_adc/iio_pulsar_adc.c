@@ -145,13 +145,35 @@ static int32_t iio_pulsar_adc_submit_buffer(struct iio_device_data
 	if (ret)
 		return ret;
 
-	ret = pulsar_adc_read_data(dev, buff, buffer->samples);
+#if !defined(USE_STANDARD_SPI)
+	if (dev->stream_blocks)
+		ret = pulsar_adc_read_data_stream(dev, buff, buffer->samples,
+						  &iio_dev->block_info);
+	else
+#endif
+		ret = pulsar_adc_read_data(dev, buff, buffer->samples);
 	if (ret)
 		return ret;
 
 	return iio_buffer_block_done(buffer);
 }
 
+/**
+ * @brief Stop the continuous capture when the buffer is disabled
+ * @param dev - Pointer to IIO device instance
+ * @return 0 in case of success, negative error code otherwise
+ */
+static int32_t iio_pulsar_adc_post_disable(void *dev)
+{
+#if !defined(USE_STANDARD_SPI)
+	struct pulsar_adc_iio_dev *iio_dev = dev;
+
+	return pulsar_adc_stream_stop(iio_dev->pulsar_adc_dev);
+#else
+	return 0;
+#endif
+}
+
 static struct iio_attribute pulsar_adc_iio_ch_attributes[] = {
 	{ .name = "raw", .show = get_raw },
 	{ .name = "scale", .show = get_scale, },
@@ -174,6 +196,7 @@ static struct iio_device pulsar_adc_iio_device_template = {
 	.debug_reg_read = iio_pulsar_adc_debug_reg_read,
 	.debug_reg_write= iio_pulsar_adc_debug_reg_write,
 	.submit = iio_pulsar_adc_submit_buffer,
+	.post_disable = iio_pulsar_adc_post_disable,
 };
 
 /**
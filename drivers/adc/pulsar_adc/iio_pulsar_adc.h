@@ -65,6 +65,10 @@ struct pulsar_adc_iio_dev {
 	uint32_t ref_voltage_mv;
 	/* scan type */
 	struct scan_type scan_type;
+#if !defined(USE_STANDARD_SPI)
+	/* Sequence number, timestamp and overruns of the last block captured */
+	struct axi_dmac_block_info block_info;
+#endif
 };
 
 /**
@@ -176,6 +176,15 @@ int32_t pulsar_adc_spi_reg_write(struct pulsar_adc_dev *dev,
 }
 
 #if !defined(USE_STANDARD_SPI)
+/* Offload message reading one sample */
+static uint32_t pulsar_adc_offload_cmds[] = {
+	CS_LOW,
+	READ(2),
+	CS_HIGH
+};
+
+static uint32_t pulsar_adc_offload_data[] = {0xFF, 0xFF};
+
 /**
  * Read samples using spi offload engine
  * @param dev - The device structure.
@@ -188,13 +197,7 @@ static int32_t pulsar_adc_read_data_offload(struct pulsar_adc_dev *dev,
 		uint16_t samples)
 {
 	struct spi_engine_offload_message msg;
-	uint32_t commands_data[2] = {0xFF, 0xFF};
 	int ret;
-	uint32_t spi_eng_msg_cmds[3] = {
-		CS_LOW,
-		READ(2),
-		CS_HIGH
-	};
 
 	if (!dev)
 		return -EINVAL;
@@ -203,10 +206,10 @@ static int32_t pulsar_adc_read_data_offload(struct pulsar_adc_dev *dev,
 	if (ret)
 		return ret;
 
-	msg.commands = spi_eng_msg_cmds;
-	msg.no_commands = NO_OS_ARRAY_SIZE(spi_eng_msg_cmds);
+	msg.commands = pulsar_adc_offload_cmds;
+	msg.no_commands = NO_OS_ARRAY_SIZE(pulsar_adc_offload_cmds);
 	msg.rx_addr = buf;
-	msg.commands_data = commands_data;
+	msg.commands_data = pulsar_adc_offload_data;
 
 	ret = spi_engine_offload_transfer(dev->spi_desc, msg, samples);
 	if (ret)
@@ -217,6 +220,85 @@ static int32_t pulsar_adc_read_data_offload(struct pulsar_adc_dev *dev,
 
 	return ret;
 }
+
+/**
+ * Read a block of samples from the continuous offload capture. The capture
+ * is started on the first call and restarted when the number of samples
+ * changes, the blocks are then captured by the DMA without gaps between
+ * calls.
+ * @param dev - The device structure.
+ * @param buf - Buffer to hold the conversion results data
+ * @param samples - number of samples to read
+ * @param info - Sequence number, timestamp and overruns of the block, can be
+ *		 NULL.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t pulsar_adc_read_data_stream(struct pulsar_adc_dev *dev, uint32_t *buf,
+				    uint16_t samples,
+				    struct axi_dmac_block_info *info)
+{
+	struct spi_engine_offload_stream_param param;
+	struct spi_engine_offload_message msg;
+	int32_t ret;
+
+	if (!dev || !samples || !dev->offload_enable || dev->stream_blocks < 2)
+		return -EINVAL;
+
+	if (dev->stream_samples != samples) {
+		ret = pulsar_adc_stream_stop(dev);
+		if (ret)
+			return ret;
+
+		ret = spi_engine_offload_init(dev->spi_desc,
+					      dev->offload_init_param);
+		if (ret)
+			return ret;
+
+		msg.commands = pulsar_adc_offload_cmds;
+		msg.no_commands = NO_OS_ARRAY_SIZE(pulsar_adc_offload_cmds);
+		msg.rx_addr = 0;
+		msg.commands_data = pulsar_adc_offload_data;
+
+		param.msg = &msg;
+		param.samples_per_block = samples;
+		param.nb_blocks = dev->stream_blocks;
+		param.get_timestamp = dev->get_timestamp;
+		param.dcache_invalidate_range = dev->dcache_invalidate_range;
+
+		ret = spi_engine_offload_stream_start(dev->spi_desc, &param);
+		if (ret)
+			return ret;
+
+		dev->stream_samples = samples;
+	}
+
+	return spi_engine_offload_stream_read(dev->spi_desc, buf, info,
+					      PULSAR_ADC_STREAM_TIMEOUT_MS);
+}
+
+/**
+ * Stop the continuous offload capture.
+ * @param dev - The device structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t pulsar_adc_stream_stop(struct pulsar_adc_dev *dev)
+{
+	int32_t ret;
+
+	if (!dev)
+		return -EINVAL;
+
+	if (!dev->stream_samples)
+		return 0;
+
+	ret = spi_engine_offload_stream_stop(dev->spi_desc);
+	if (ret)
+		return ret;
+
+	dev->stream_samples = 0;
+
+	return 0;
+}
 #endif
 
 /**
@@ -324,6 +406,9 @@ int32_t pulsar_adc_init(struct pulsar_adc_dev **device,
 	dev->offload_init_param = init_param->offload_init_param;
 	dev->dcache_invalidate_range = init_param->dcache_invalidate_range;
 	dev->offload_enable =  init_param->offload_enable;
+	dev->stream_blocks = init_param->stream_blocks;
+	dev->stream_samples = 0;
+	dev->get_timestamp = init_param->get_timestamp;
 
 #if defined(USE_STANDARD_SPI)
 	ret = no_os_gpio_get(&dev->gpio_cnv, init_param->gpio_cnv);
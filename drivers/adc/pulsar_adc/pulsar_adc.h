@@ -57,6 +57,8 @@
 #define PULSAR_ADC_READ_COMMAND	0x54
 #define PULSAR_ADC_WRITE_COMMAND	0x14
 #define PULSAR_ADC_RESERVED_MSK	0xE0
+/* Time allowed for a block of the continuous offload capture */
+#define PULSAR_ADC_STREAM_TIMEOUT_MS	500
 
 #define PULSAR_ADC_TURBO_MODE(x)		(((x) & 0x1) << 1)
 #define PULSAR_ADC_HIGH_Z_MODE(x)		(((x) & 0x1) << 2)
@@ -120,6 +122,13 @@ struct pulsar_adc_dev {
 	void (*dcache_invalidate_range)(uint32_t address, uint32_t bytes_count);
 	/* enable offload */
 	bool offload_enable;
+	/** Number of blocks of the continuous offload capture, 0 to run one
+	 * offload transfer per read */
+	uint32_t stream_blocks;
+	/** Samples per block of the running continuous capture, 0 if stopped */
+	uint32_t stream_samples;
+	/** Time source for the continuous capture block timestamps */
+	uint64_t (*get_timestamp)(void);
 };
 
 struct pulsar_adc_init_param {
@@ -146,6 +155,12 @@ struct pulsar_adc_init_param {
 	/* buffer size */
 	uint32_t buffer_size;
 	bool offload_enable;
+	/** Number of blocks of the continuous offload capture (at least 2),
+	 * 0 to run one offload transfer per read. The offload RX DMAC must
+	 * be in IRQ_ENABLED mode, with spi_engine_offload_rx_isr() registered */
+	uint32_t stream_blocks;
+	/** Optional time source for the continuous capture block timestamps */
+	uint64_t (*get_timestamp)(void);
 	bool turbo_mode;
 	bool high_z_mode;
 	bool span_compression;
@@ -162,4 +177,12 @@ int32_t pulsar_adc_remove(struct pulsar_adc_dev *dev);
 /* read data samples */
 int32_t pulsar_adc_read_data(struct pulsar_adc_dev *dev, uint32_t *buf,
 			     uint16_t samples);
+#if !defined(USE_STANDARD_SPI)
+/* read a block of samples from the continuous offload capture */
+int32_t pulsar_adc_read_data_stream(struct pulsar_adc_dev *dev, uint32_t *buf,
+				    uint16_t samples,
+				    struct axi_dmac_block_info *info);
+/* stop the continuous offload capture */
+int32_t pulsar_adc_stream_stop(struct pulsar_adc_dev *dev);
+#endif
 #endif /* SRC_PULSAR_ADC_H_ */
@@ -201,6 +201,9 @@ int32_t no_os_spi_transfer(struct no_os_spi_desc *desc,
 	if (desc->platform_ops->transfer)
 		return desc->platform_ops->transfer(desc, msgs, len);
 
+	if (!desc->platform_ops->write_and_read)
+		return -ENOSYS;
+
 	no_os_mutex_lock(desc->bus->mutex);
 
 	for (i = 0; i < len; i++) {
@@ -208,8 +211,9 @@ int32_t no_os_spi_transfer(struct no_os_spi_desc *desc,
 			ret = -EINVAL;
 			goto out;
 		}
-		ret = no_os_spi_write_and_read(desc, msgs[i].rx_buff,
-					       msgs[i].bytes_number);
+		/* The bus lock is already held for the whole message list */
+		ret = desc->platform_ops->write_and_read(desc, msgs[i].rx_buff,
+				msgs[i].bytes_number);
 		if (NO_OS_IS_ERR_VALUE(ret)) {
 			goto out;
 		}
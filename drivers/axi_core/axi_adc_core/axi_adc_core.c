@@ -122,14 +122,12 @@ int32_t axi_adc_set_pnsel(struct axi_adc *adc,
 			  uint32_t chan,
 			  enum axi_adc_pn_sel sel)
 {
-	uint32_t reg_data;
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, adc->base, 1);
 
-	axi_adc_read(adc, AXI_ADC_REG_CHAN_CNTRL_3(chan), &reg_data);
-	reg_data &= ~AXI_ADC_ADC_PN_SEL(~0);
-	reg_data |= AXI_ADC_ADC_PN_SEL(sel);
-	axi_adc_write(adc, AXI_ADC_REG_CHAN_CNTRL_3(chan), reg_data);
+	no_os_axi_io_batch_update(&batch, AXI_ADC_REG_CHAN_CNTRL_3(chan),
+				  AXI_ADC_ADC_PN_SEL(~0), AXI_ADC_ADC_PN_SEL(sel));
 
-	return 0;
+	return no_os_axi_io_batch_exec(&batch);
 }
 
 /**
@@ -142,20 +140,28 @@ int32_t axi_adc_set_pnsel(struct axi_adc *adc,
 int32_t axi_adc_pn_mon(struct axi_adc *adc,
 		       enum axi_adc_pn_sel sel, uint32_t delay_ms)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, adc->base, 16);
 	uint8_t	ch;
 	uint32_t reg_data;
+	int32_t ret;
 
 	for (ch = 0; ch < adc->num_channels; ch++) {
-		axi_adc_read(adc, AXI_ADC_REG_CHAN_CNTRL(ch), &reg_data);
-		reg_data |= AXI_ADC_ENABLE;
-		axi_adc_write(adc, AXI_ADC_REG_CHAN_CNTRL(ch), reg_data);
-		axi_adc_set_pnsel(adc, ch, sel);
+		no_os_axi_io_batch_update(&batch, AXI_ADC_REG_CHAN_CNTRL(ch),
+					  AXI_ADC_ENABLE, AXI_ADC_ENABLE);
+		no_os_axi_io_batch_update(&batch, AXI_ADC_REG_CHAN_CNTRL_3(ch),
+					  AXI_ADC_ADC_PN_SEL(~0),
+					  AXI_ADC_ADC_PN_SEL(sel));
 	}
+	ret = no_os_axi_io_batch_exec(&batch);
+	if (ret)
+		return ret;
 	no_os_mdelay(1);
 
-	for (ch = 0; ch < adc->num_channels; ch++) {
-		axi_adc_write(adc, AXI_ADC_REG_CHAN_STATUS(ch), 0xff);
-	}
+	for (ch = 0; ch < adc->num_channels; ch++)
+		no_os_axi_io_batch_write(&batch, AXI_ADC_REG_CHAN_STATUS(ch), 0xff);
+	ret = no_os_axi_io_batch_exec(&batch);
+	if (ret)
+		return ret;
 	no_os_mdelay(delay_ms);
 
 	for (ch = 0; ch < adc->num_channels; ch++) {
@@ -178,11 +184,17 @@ int32_t axi_adc_get_sampling_freq(struct axi_adc *adc,
 				  uint32_t chan,
 				  uint64_t *sampling_freq)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, adc->base, 2);
 	uint32_t freq;
 	uint32_t ratio;
+	int32_t ret;
+
+	no_os_axi_io_batch_read(&batch, AXI_ADC_REG_CLK_FREQ, &freq);
+	no_os_axi_io_batch_read(&batch, AXI_ADC_REG_CLK_RATIO, &ratio);
+	ret = no_os_axi_io_batch_exec(&batch);
+	if (ret)
+		return ret;
 
-	axi_adc_read(adc, AXI_ADC_REG_CLK_FREQ, &freq);
-	axi_adc_read(adc, AXI_ADC_REG_CLK_RATIO, &ratio);
 	*sampling_freq = freq * ratio;
 	*sampling_freq = ((*sampling_freq) * 390625) >> 8;
 
@@ -617,18 +629,24 @@ int32_t axi_adc_init_begin(struct axi_adc **adc_core,
  */
 int32_t axi_adc_init_finish(struct axi_adc *adc)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, adc->base, 3);
 	uint32_t reg_data;
 	uint32_t freq;
 	uint32_t ratio;
+	int32_t ret;
+
+	no_os_axi_io_batch_read(&batch, AXI_ADC_REG_STATUS, &reg_data);
+	no_os_axi_io_batch_read(&batch, AXI_ADC_REG_CLK_FREQ, &freq);
+	no_os_axi_io_batch_read(&batch, AXI_ADC_REG_CLK_RATIO, &ratio);
+	ret = no_os_axi_io_batch_exec(&batch);
+	if (ret)
+		return ret;
 
-	axi_adc_read(adc, AXI_ADC_REG_STATUS, &reg_data);
 	if(reg_data == 0x0) {
 		printf("%s: Status errors\n", adc->name);
 		return -1;
 	}
 
-	axi_adc_read(adc, AXI_ADC_REG_CLK_FREQ, &freq);
-	axi_adc_read(adc, AXI_ADC_REG_CLK_RATIO, &ratio);
 	adc->clock_hz = freq * ratio;
 	adc->clock_hz = (adc->clock_hz * 390625) >> 8;
 
@@ -647,6 +665,7 @@ int32_t axi_adc_init_finish(struct axi_adc *adc)
 int32_t axi_adc_init(struct axi_adc **adc_core,
 		     const struct axi_adc_init *init)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, init->base, 16);
 	struct axi_adc *adc;
 	int32_t ret;
 	uint8_t ch;
@@ -655,14 +674,17 @@ int32_t axi_adc_init(struct axi_adc **adc_core,
 	if (ret)
 		return ret;
 
-	axi_adc_write(adc, AXI_ADC_REG_RSTN, 0);
-	axi_adc_write(adc, AXI_ADC_REG_RSTN,
-		      AXI_ADC_MMCM_RSTN | AXI_ADC_RSTN);
+	no_os_axi_io_batch_write(&batch, AXI_ADC_REG_RSTN, 0);
+	no_os_axi_io_batch_write(&batch, AXI_ADC_REG_RSTN,
+				 AXI_ADC_MMCM_RSTN | AXI_ADC_RSTN);
 
 	for (ch = 0; ch < adc->num_channels; ch++)
-		axi_adc_write(adc, AXI_ADC_REG_CHAN_CNTRL(ch),
-			      AXI_ADC_FORMAT_SIGNEXT | AXI_ADC_FORMAT_ENABLE |
-			      AXI_ADC_ENABLE);
+		no_os_axi_io_batch_write(&batch, AXI_ADC_REG_CHAN_CNTRL(ch),
+					 AXI_ADC_FORMAT_SIGNEXT | AXI_ADC_FORMAT_ENABLE |
+					 AXI_ADC_ENABLE);
+	ret = no_os_axi_io_batch_exec(&batch);
+	if (ret)
+		goto error;
 
 	no_os_mdelay(100);
 
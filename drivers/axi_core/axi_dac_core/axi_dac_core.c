@@ -380,17 +380,18 @@ int32_t axi_dac_set_datasel(struct axi_dac *dac,
 			    int32_t chan,
 			    enum axi_dac_data_sel sel)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, dac->base, 16);
 	int32_t i;
 
 	if (chan < 0)
 		for (i = 0; i < dac->num_channels; i++)
-			axi_dac_write(dac, AXI_DAC_REG_CHAN_CNTRL_7(i), sel);
+			no_os_axi_io_batch_write(&batch, AXI_DAC_REG_CHAN_CNTRL_7(i), sel);
 	else
-		axi_dac_write(dac, AXI_DAC_REG_CHAN_CNTRL_7(chan), sel);
+		no_os_axi_io_batch_write(&batch, AXI_DAC_REG_CHAN_CNTRL_7(chan), sel);
 
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
 
-	return 0;
+	return no_os_axi_io_batch_exec(&batch);
 }
 
 /**
@@ -403,18 +404,19 @@ int32_t axi_dac_set_datasel(struct axi_dac *dac,
 int32_t axi_dac_dds_set_frequency(struct axi_dac *dac,
 				  uint32_t chan, uint32_t freq_hz)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, dac->base, 3);
 	uint64_t val64;
-	uint32_t reg;
 
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, 0);
-	axi_dac_read(dac, AXI_DAC_REG_DDS_INIT_INCR(chan), &reg);
 	val64 = (uint64_t) freq_hz * 0xFFFFULL;
 	val64 = val64 / dac->clock_hz;
-	reg = (reg & ~AXI_DAC_DDS_INCR(~0)) | AXI_DAC_DDS_INCR(val64) | 1;
-	axi_dac_write(dac, AXI_DAC_REG_DDS_INIT_INCR(chan), reg);
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
 
-	return 0;
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_SYNC_CONTROL, 0);
+	no_os_axi_io_batch_update(&batch, AXI_DAC_REG_DDS_INIT_INCR(chan),
+				  AXI_DAC_DDS_INCR(~0),
+				  AXI_DAC_DDS_INCR(val64) | 1);
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
+
+	return no_os_axi_io_batch_exec(&batch);
 }
 
 /**
@@ -427,12 +429,18 @@ int32_t axi_dac_dds_set_frequency(struct axi_dac *dac,
 int32_t axi_dac_dds_get_frequency(struct axi_dac *dac,
 				  uint32_t chan, uint32_t *freq)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, dac->base, 3);
 	uint32_t reg;
 	uint64_t val64;
+	int32_t ret;
+
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_SYNC_CONTROL, 0);
+	no_os_axi_io_batch_read(&batch, AXI_DAC_REG_DDS_INIT_INCR(chan), &reg);
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
+	ret = no_os_axi_io_batch_exec(&batch);
+	if (ret)
+		return ret;
 
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, 0);
-	axi_dac_read(dac, AXI_DAC_REG_DDS_INIT_INCR(chan), &reg);
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
 	reg = (reg & AXI_DAC_DDS_INCR(~0));
 	val64 = (uint64_t) reg * dac->clock_hz;
 	no_os_do_div(&val64, 0xFFFF);
@@ -452,18 +460,18 @@ int32_t axi_dac_dds_get_frequency(struct axi_dac *dac,
 int32_t axi_dac_dds_set_phase(struct axi_dac *dac,
 			      uint32_t chan, uint32_t phase)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, dac->base, 3);
 	uint64_t val64;
-	uint32_t reg;
 
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, 0);
-	axi_dac_read(dac, AXI_DAC_REG_DDS_INIT_INCR(chan), &reg);
 	val64 = (uint64_t) phase * 0x10000ULL + (360000 / 2);
 	val64 = val64 / 360000;
-	reg = (reg & ~AXI_DAC_DDS_INIT(~0)) | AXI_DAC_DDS_INIT(val64);
-	axi_dac_write(dac, AXI_DAC_REG_DDS_INIT_INCR(chan), reg);
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
 
-	return 0;
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_SYNC_CONTROL, 0);
+	no_os_axi_io_batch_update(&batch, AXI_DAC_REG_DDS_INIT_INCR(chan),
+				  AXI_DAC_DDS_INIT(~0), AXI_DAC_DDS_INIT(val64));
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
+
+	return no_os_axi_io_batch_exec(&batch);
 }
 
 /**
@@ -477,12 +485,18 @@ int32_t axi_dac_dds_set_phase(struct axi_dac *dac,
 int32_t axi_dac_dds_get_phase(struct axi_dac *dac,
 			      uint32_t chan, uint32_t *phase)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, dac->base, 3);
 	uint64_t val64;
 	uint32_t reg;
+	int32_t ret;
+
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_SYNC_CONTROL, 0);
+	no_os_axi_io_batch_read(&batch, AXI_DAC_REG_DDS_INIT_INCR(chan), &reg);
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
+	ret = no_os_axi_io_batch_exec(&batch);
+	if (ret)
+		return ret;
 
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, 0);
-	axi_dac_read(dac, AXI_DAC_REG_DDS_INIT_INCR(chan), &reg);
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
 	reg = (reg & AXI_DAC_DDS_INIT(~0));
 	reg = AXI_DAC_TO_DDS_INIT(reg);
 	val64 = reg * 360000ULL + (0x10000 / 2);
@@ -504,6 +518,7 @@ int32_t axi_dac_dds_set_scale(struct axi_dac *dac,
 			      uint32_t chan,
 			      int32_t scale_micro_units)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, dac->base, 3);
 	uint32_t scale_reg;
 
 	scale_reg = scale_micro_units;
@@ -515,12 +530,12 @@ int32_t axi_dac_dds_set_scale(struct axi_dac *dac,
 	if (scale_micro_units < 0)
 		scale_reg = scale_reg | 0x8000;
 
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, 0);
-	axi_dac_write(dac, AXI_DAC_REG_DDS_SCALE(chan),
-		      AXI_DAC_DDS_SCALE(scale_reg));
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_SYNC_CONTROL, 0);
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_DDS_SCALE(chan),
+				 AXI_DAC_DDS_SCALE(scale_reg));
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
 
-	return 0;
+	return no_os_axi_io_batch_exec(&batch);
 }
 
 /**
@@ -535,13 +550,18 @@ int32_t axi_dac_dds_get_scale(struct axi_dac *dac,
 			      uint32_t chan,
 			      int32_t *scale_micro_units)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, dac->base, 3);
 	int32_t sign;
 	uint32_t scale_reg;
+	int32_t ret;
+
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_SYNC_CONTROL, 0);
+	no_os_axi_io_batch_read(&batch, AXI_DAC_REG_DDS_SCALE(chan), &scale_reg);
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
+	ret = no_os_axi_io_batch_exec(&batch);
+	if (ret)
+		return ret;
 
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, 0);
-	axi_dac_read(dac, AXI_DAC_REG_DDS_SCALE(chan),
-		     &scale_reg);
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
 	scale_reg = AXI_DAC_TO_DDS_SCALE(scale_reg);
 	sign = (scale_reg & 0x8000) ? -1 : 1;
 	scale_reg &= ~0x8000;
@@ -854,6 +874,7 @@ int32_t axi_dac_load_custom_data(struct axi_dac *dac,
 				 uint32_t custom_tx_count,
 				 uint32_t address)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, dac->base, 16);
 	uint32_t index, index_mem = 0;
 	uint8_t chan;
 	uint8_t num_tx_channels = dac->num_channels / 2;
@@ -870,12 +891,12 @@ int32_t axi_dac_load_custom_data(struct axi_dac *dac,
 	}
 
 	for (chan = 0; chan < dac->num_channels; chan++) {
-		axi_dac_write(dac, AXI_DAC_REG_DATA_SELECT((chan*2)+0), 0x2);
-		axi_dac_write(dac, AXI_DAC_REG_DATA_SELECT((chan*2)+1), 0x2);
+		no_os_axi_io_batch_write(&batch, AXI_DAC_REG_DATA_SELECT((chan*2)+0), 0x2);
+		no_os_axi_io_batch_write(&batch, AXI_DAC_REG_DATA_SELECT((chan*2)+1), 0x2);
 	}
-	axi_dac_write(dac, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_SYNC_CONTROL, AXI_DAC_SYNC);
 
-	return 0;
+	return no_os_axi_io_batch_exec(&batch);
 }
 
 /**
@@ -910,18 +931,24 @@ int32_t axi_dac_init_begin(struct axi_dac **dac_core,
  */
 int32_t axi_dac_init_finish(struct axi_dac *dac)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, dac->base, 3);
 	uint32_t reg_data;
 	uint32_t freq;
 	uint32_t ratio;
+	int32_t ret;
+
+	no_os_axi_io_batch_read(&batch, AXI_DAC_REG_STATUS, &reg_data);
+	no_os_axi_io_batch_read(&batch, AXI_DAC_REG_CLK_FREQ, &freq);
+	no_os_axi_io_batch_read(&batch, AXI_DAC_REG_CLK_RATIO, &ratio);
+	ret = no_os_axi_io_batch_exec(&batch);
+	if (ret)
+		return ret;
 
-	axi_dac_read(dac, AXI_DAC_REG_STATUS, &reg_data);
 	if(reg_data == 0x0) {
 		printf("%s: Status errors\n", dac->name);
 		return -1;
 	}
 
-	axi_dac_read(dac, AXI_DAC_REG_CLK_FREQ, &freq);
-	axi_dac_read(dac, AXI_DAC_REG_CLK_RATIO, &ratio);
 	dac->clock_hz = freq * ratio;
 	dac->clock_hz = (dac->clock_hz * 390625) >> 8;
 
@@ -940,6 +967,7 @@ int32_t axi_dac_init_finish(struct axi_dac *dac)
 int32_t axi_dac_init(struct axi_dac **dac_core,
 		     const struct axi_dac_init *init)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, init->base, 3);
 	struct axi_dac *dac;
 	int32_t ret;
 
@@ -947,11 +975,14 @@ int32_t axi_dac_init(struct axi_dac **dac_core,
 	if (ret)
 		return ret;
 
-	axi_dac_write(dac, AXI_DAC_REG_RSTN, 0);
-	axi_dac_write(dac, AXI_DAC_REG_RSTN,
-		      AXI_DAC_MMCM_RSTN | AXI_DAC_RSTN);
-
-	axi_dac_write(dac, AXI_DAC_REG_RATECNTRL, AXI_DAC_RATE(init->rate));
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_RSTN, 0);
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_RSTN,
+				 AXI_DAC_MMCM_RSTN | AXI_DAC_RSTN);
+	no_os_axi_io_batch_write(&batch, AXI_DAC_REG_RATECNTRL,
+				 AXI_DAC_RATE(init->rate));
+	ret = no_os_axi_io_batch_exec(&batch);
+	if (ret)
+		goto error;
 
 	no_os_mdelay(100);
 
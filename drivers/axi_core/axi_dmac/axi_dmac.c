@@ -44,123 +44,202 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include "no_os_axi_io.h"
 #include "no_os_error.h"
 #include "no_os_delay.h"
 #include "no_os_alloc.h"
+#include "no_os_semaphore.h"
 #include "axi_dmac.h"
 
 /*******************************************************************************
- * @brief ISR for dev to mem DMA transfer. It computes the next transfer params,
- *			if any, and sets the transfer structure fields accordingly.
+ * @brief Queue transfers from the descriptor chain until the hardware queue
+ *			is full or the chain is exhausted.
  *
- * @param instance - the instance that triggered the ISR.
+ * @param dmac - DMAC instance.
  *
- * @return None.
+ * @return 0 for success, negative error code otherwise.
 *******************************************************************************/
-void axi_dmac_dev_to_mem_isr(void *instance)
+static int32_t axi_dmac_queue_desc(struct axi_dmac *dmac)
 {
-	struct axi_dmac *dmac = (struct axi_dmac *)instance;
-	uint32_t burst_size;
-	uint32_t reg_val;
-
-	/* Get interrupt sources and clear interrupts. */
-	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
-	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
-
-	if (reg_val & AXI_DMAC_IRQ_SOT) {
-		if (dmac->remaining_size) {
-			/* See if remaining size is bigger than max transfer size and
-			 * set burst size. */
-			if (dmac->remaining_size > dmac->max_length) {
-				burst_size = dmac->max_length;
-			} else {
-				burst_size = dmac->remaining_size - 1;
-			}
-
-			/* The current transfer was started; set up the new one. */
-			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_ADDRESS, dmac->next_dest_addr);
-			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_STRIDE, 0x0);
-			axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, burst_size);
-			axi_dmac_write(dmac, AXI_DMAC_REG_Y_LENGTH, 0x0);
-
-			/* Compute size of the next transfer. */
-			dmac->remaining_size = dmac->remaining_size - (burst_size + 1);
-			/* Address must advance with +1 since the DMAC writes X_LENGTH+1. */
-			dmac->next_dest_addr = dmac->next_dest_addr + (burst_size + 1);
-
-			/* Trigger the next transfer. */
-			axi_dmac_write(dmac, AXI_DMAC_REG_TRANSFER_SUBMIT, AXI_DMAC_TRANSFER_SUBMIT);
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, dmac->base, 12);
+	struct axi_dma_desc *desc;
+	uint32_t x_len, y_len;
+	uint32_t busy, id;
+	uint64_t src, dest;
+	int32_t ret;
+
+	while (dmac->desc_idx < dmac->nb_desc) {
+		ret = axi_dmac_read(dmac, AXI_DMAC_REG_TRANSFER_SUBMIT, &busy);
+		if (ret)
+			return ret;
+		if (busy & AXI_DMAC_QUEUE_FULL)
+			break;
+
+		desc = &dmac->desc[dmac->desc_idx];
+		src = desc->src_addr;
+		dest = desc->dest_addr;
+		if (desc->y_len > 1) {
+			x_len = desc->x_len;
+			y_len = desc->y_len;
+		} else {
+			/* Split 1D descriptors in bursts of at most max_length + 1 */
+			x_len = no_os_min(desc->x_len - dmac->desc_offset,
+					  dmac->max_length + 1);
+			y_len = 1;
+			src += dmac->desc_offset;
+			dest += dmac->desc_offset;
 		}
-	}
-	if (reg_val & AXI_DMAC_IRQ_EOT) {
-		if (!dmac->remaining_size) {
-			dmac->transfer.transfer_done = true;
-			dmac->next_dest_addr = 0;
+
+		if (dmac->direction != DMA_MEM_TO_DEV) {
+			no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_DEST_ADDRESS,
+						 (uint32_t)dest);
+			if (dmac->hw_addr64)
+				no_os_axi_io_batch_write(&batch,
+							 AXI_DMAC_REG_DEST_ADDRESS_HIGH,
+							 (uint32_t)(dest >> 32));
+			no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_DEST_STRIDE,
+						 desc->dest_stride);
+		}
+		if (dmac->direction != DMA_DEV_TO_MEM) {
+			no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_SRC_ADDRESS,
+						 (uint32_t)src);
+			if (dmac->hw_addr64)
+				no_os_axi_io_batch_write(&batch,
+							 AXI_DMAC_REG_SRC_ADDRESS_HIGH,
+							 (uint32_t)(src >> 32));
+			no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_SRC_STRIDE,
+						 desc->src_stride);
 		}
+		no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_X_LENGTH, x_len - 1);
+		no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_Y_LENGTH, y_len - 1);
+		no_os_axi_io_batch_read(&batch, AXI_DMAC_REG_TRANSFER_ID, &id);
+		ret = no_os_axi_io_batch_exec(&batch);
+		if (ret)
+			return ret;
+
+		/*
+		 * Account the transfer before submitting it, so that its
+		 * completion is never seen before the transfer itself.
+		 */
+		id %= AXI_DMAC_MAX_TRANSFER_ID;
+		dmac->id_desc[id] = AXI_DMAC_NO_DESC;
+
+		if (y_len > 1 || dmac->desc_offset + x_len >= desc->x_len) {
+			dmac->id_desc[id] = dmac->desc_idx;
+			dmac->desc_offset = 0;
+			dmac->desc_idx++;
+			/* Software cyclic transfers restart the chain. */
+			if (dmac->desc_idx == dmac->nb_desc &&
+			    dmac->transfer.cyclic == CYCLIC &&
+			    !dmac->hw_cyclic_active)
+				dmac->desc_idx = 0;
+		} else {
+			dmac->desc_offset += x_len;
+		}
+		dmac->active_ids |= (uint32_t)1 << id;
+
+		ret = axi_dmac_write(dmac, AXI_DMAC_REG_TRANSFER_SUBMIT,
+				     AXI_DMAC_TRANSFER_SUBMIT);
+		if (ret)
+			return ret;
 	}
+
+	return 0;
 }
 
 /*******************************************************************************
- * @brief ISR for mem DMA to dev transfer. It computes the next transfer params,
- *			if any, and sets the transfer structure fields accordingly.
+ * @brief Handle the DMAC interrupt sources: retire the completed transfers,
+ *			refill the hardware queue and flag the end of the chain.
  *
- * @param instance - the instance that triggered the ISR.
+ * @param dmac - DMAC instance.
  *
  * @return None.
 *******************************************************************************/
-void axi_dmac_mem_to_dev_isr(void *instance)
+static void axi_dmac_handle_irq(struct axi_dmac *dmac)
 {
-	struct axi_dmac *dmac = (struct axi_dmac *)instance;
-	uint32_t burst_size;
-	uint32_t reg_val;
-
-	/* Get interrupt sources and clear interrupts. */
-	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
-	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
-
-	if (reg_val & AXI_DMAC_IRQ_SOT) {
-		if ((dmac->transfer.cyclic == CYCLIC) &&
-		    (dmac->next_src_addr >= (dmac->init_addr + dmac->transfer.size - 1))) {
-			dmac->remaining_size = dmac->transfer.size;
-			dmac->next_src_addr = dmac->init_addr;
-		}
-
-		if (dmac->remaining_size) {
-			/** See if remaining size is bigger than max transfer size and
-			 * set burst size. */
-			if (dmac->remaining_size > dmac->max_length) {
-				burst_size = dmac->max_length;
-			} else {
-				burst_size = dmac->remaining_size - 1;
-			}
-
-			/* The current transfer was started; set up the new one. */
-			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_ADDRESS, dmac->next_src_addr);
-			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_STRIDE, 0x0);
-			axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, burst_size);
-			axi_dmac_write(dmac, AXI_DMAC_REG_Y_LENGTH, 0x0);
-
-			/* Compute parameters for the next transfer. */
-			dmac->remaining_size = dmac->remaining_size - (burst_size + 1);
-			/* Address must advance with +1 since the DMAC writes X_LENGTH+1. */
-			dmac->next_src_addr = dmac->next_src_addr + (burst_size + 1);
-
-			/* Trigger the current transfer */
-			axi_dmac_write(dmac, AXI_DMAC_REG_TRANSFER_SUBMIT, AXI_DMAC_TRANSFER_SUBMIT);
-		}
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, dmac->base, 3);
+	uint32_t pending = 0;
+	uint32_t done = 0;
+	uint32_t id;
+
+	/*
+	 * Get interrupt sources and clear them by writing back the value
+	 * read, in the same access, so that sources raised meanwhile stay
+	 * pending for the next interrupt.
+	 */
+	no_os_axi_io_batch_add(&batch, NO_OS_AXI_IO_OP_UPDATE,
+			       AXI_DMAC_REG_IRQ_PENDING, 0, 0, &pending);
+	no_os_axi_io_batch_read(&batch, AXI_DMAC_REG_TRANSFER_DONE, &done);
+	if (no_os_axi_io_batch_exec(&batch))
+		return;
+
+	if (pending & AXI_DMAC_IRQ_EOT) {
+		done &= dmac->active_ids;
+		dmac->active_ids &= ~done;
+		/* A software cyclic transfer always has a transfer queued
+		 * behind the one completing, unless the ISR was late and the
+		 * DMA ran dry, dropping the data received meanwhile. */
+		if (done && !dmac->active_ids &&
+		    dmac->transfer.cyclic == CYCLIC && !dmac->hw_cyclic_active)
+			dmac->stalls++;
+		for (id = 0; done && dmac->desc_done; id++, done >>= 1)
+			if ((done & 1) && dmac->id_desc[id] != AXI_DMAC_NO_DESC)
+				dmac->desc_done(dmac->desc_done_ctx, dmac->id_desc[id]);
 	}
-	if (reg_val & AXI_DMAC_IRQ_EOT) {
-		if ((!dmac->remaining_size) && (dmac->transfer.cyclic != CYCLIC)) {
-			dmac->transfer.transfer_done = true;
-			dmac->next_src_addr = 0;
-		}
+
+	/* A started transfer frees a slot in the hardware queue. */
+	if (pending & (AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT))
+		axi_dmac_queue_desc(dmac);
+
+	if (!dmac->transfer.transfer_done && !dmac->active_ids &&
+	    dmac->desc_idx == dmac->nb_desc && dmac->transfer.cyclic != CYCLIC) {
+		dmac->transfer.transfer_done = true;
+		/* done_sem only exists with IRQ_ENABLED, in the ISR here */
+		if (dmac->done_sem)
+			no_os_semaphore_give_from_isr(dmac->done_sem);
 	}
 }
 
 /*******************************************************************************
- * @brief ISR for mem DMA to mem DMA transfer. It computes the next transfer
- *			params, if any, and sets the transfer structure fields accordingly.
+ * @brief DMAC interrupt service routine. Keeps the hardware transfer queue
+ *			filled from the descriptor chain.
+ *
+ * @param instance - the instance that triggered the ISR.
+ *
+ * @return None.
+*******************************************************************************/
+void axi_dmac_isr(void *instance)
+{
+	axi_dmac_handle_irq((struct axi_dmac *)instance);
+}
+
+/*******************************************************************************
+ * @brief ISR for dev to mem DMA transfer. Same as axi_dmac_isr().
+ *
+ * @param instance - the instance that triggered the ISR.
+ *
+ * @return None.
+*******************************************************************************/
+void axi_dmac_dev_to_mem_isr(void *instance)
+{
+	axi_dmac_handle_irq((struct axi_dmac *)instance);
+}
+
+/*******************************************************************************
+ * @brief ISR for mem DMA to dev transfer. Same as axi_dmac_isr().
+ *
+ * @param instance - the instance that triggered the ISR.
+ *
+ * @return None.
+*******************************************************************************/
+void axi_dmac_mem_to_dev_isr(void *instance)
+{
+	axi_dmac_handle_irq((struct axi_dmac *)instance);
+}
+
+/*******************************************************************************
+ * @brief ISR for mem DMA to mem DMA transfer. Same as axi_dmac_isr().
  *
  * @param instance - the instance that triggered the ISR.
  *
@@ -168,56 +247,7 @@ void axi_dmac_mem_to_dev_isr(void *instance)
 *******************************************************************************/
 void axi_dmac_mem_to_mem_isr(void *instance)
 {
-	struct axi_dmac *dmac = (struct axi_dmac *)instance;
-	uint32_t burst_size;
-	uint32_t reg_val;
-
-	/* Get interrupt sources and clear interrupts. */
-	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
-	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
-
-	if (reg_val & AXI_DMAC_IRQ_SOT) {
-		if (dmac->remaining_size) {
-			/** See if remaining size is bigger than max transfer size and
-			 * set burst size. */
-			if (dmac->remaining_size > dmac->max_length) {
-				burst_size = dmac->max_length;
-			} else {
-				burst_size = dmac->remaining_size - 1;
-			}
-
-			/* The current transfer was started; set up the new one. */
-			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_ADDRESS, dmac->next_src_addr);
-			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_STRIDE, 0x0);
-			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_ADDRESS, dmac->next_dest_addr);
-			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_STRIDE, 0x0);
-			axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, burst_size);
-			axi_dmac_write(dmac, AXI_DMAC_REG_Y_LENGTH, 0x0);
-
-			/* Compute parameters for the next transfer. */
-			dmac->remaining_size = dmac->remaining_size - (burst_size + 1);
-			/* Address must advance with +1 since the DMAC writes X_LENGTH+1. */
-			dmac->next_src_addr = dmac->next_src_addr + (burst_size + 1);
-			dmac->next_dest_addr = dmac->next_dest_addr + (burst_size + 1);
-
-			/* If transfer finished advance src address so that transfer_done can be set*/
-			if (!dmac->remaining_size) {
-				dmac->next_src_addr = dmac->next_src_addr + (burst_size + 1);
-			}
-
-			/* Trigger the current transfer */
-			axi_dmac_write(dmac, AXI_DMAC_REG_TRANSFER_SUBMIT, AXI_DMAC_TRANSFER_SUBMIT);
-		}
-	}
-	if (reg_val & AXI_DMAC_IRQ_EOT) {
-		if (!dmac->remaining_size) {
-			if(dmac->next_src_addr > (dmac->init_addr + dmac->transfer.size)) {
-				dmac->transfer.transfer_done = true;
-				dmac->next_src_addr = 0;
-				dmac->next_dest_addr = 0;
-			}
-		}
-	}
+	axi_dmac_handle_irq((struct axi_dmac *)instance);
 }
 
 /*******************************************************************************
@@ -282,10 +312,14 @@ int32_t axi_dmac_is_transfer_ready(struct axi_dmac *dmac, bool *rdy)
 *******************************************************************************/
 static int32_t axi_dmac_detect_caps(struct axi_dmac *dmac)
 {
-	uint32_t reg_val, initial_reg_val = 0;
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, dmac->base, 24);
+	uint32_t reg_val = 0, initial_reg_val = 0;
 	uint32_t src_mem_mapped = 0;
 	uint32_t dest_mem_mapped = 0;
 	uint32_t intf_desc = 0;
+	uint32_t dest_high = 0;
+	uint32_t src_high = 0;
+	int32_t ret;
 
 	dmac->max_length = -1;
 	dmac->direction = INVALID_DIR;
@@ -294,23 +328,44 @@ static int32_t axi_dmac_detect_caps(struct axi_dmac *dmac)
 
 	/* Check if HW cyclic possible */
 	axi_dmac_read(dmac, AXI_DMAC_REG_FLAGS, &initial_reg_val);
-	axi_dmac_write(dmac, AXI_DMAC_REG_FLAGS, DMA_CYCLIC);
-	axi_dmac_read(dmac, AXI_DMAC_REG_FLAGS, &reg_val);
-	if (reg_val == DMA_CYCLIC)
-		dmac->hw_cyclic = true;
+	no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_FLAGS, DMA_CYCLIC);
+	no_os_axi_io_batch_read(&batch, AXI_DMAC_REG_FLAGS, &reg_val);
 	/* Restore initial value for AXI_DMAC_REG_FLAGS register */
-	axi_dmac_write(dmac, AXI_DMAC_REG_FLAGS, initial_reg_val);
+	no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_FLAGS, initial_reg_val);
 
 	/* Get maximum burst size and set value. */
-	axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, dmac->max_length);
-	axi_dmac_read(dmac, AXI_DMAC_REG_X_LENGTH, &dmac->max_length);
+	no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_X_LENGTH, dmac->max_length);
+	no_os_axi_io_batch_read(&batch, AXI_DMAC_REG_X_LENGTH, &dmac->max_length);
+
+	/* Y_LENGTH and the high address registers only exist if enabled. */
+	no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_Y_LENGTH, 0xffffffff);
+	no_os_axi_io_batch_read(&batch, AXI_DMAC_REG_Y_LENGTH, &dmac->max_y_length);
+	no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_DEST_ADDRESS_HIGH, 0xffffffff);
+	no_os_axi_io_batch_read(&batch, AXI_DMAC_REG_DEST_ADDRESS_HIGH, &dest_high);
+	no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_SRC_ADDRESS_HIGH, 0xffffffff);
+	no_os_axi_io_batch_read(&batch, AXI_DMAC_REG_SRC_ADDRESS_HIGH, &src_high);
 
 	/* Get transfer direction and set value. */
-	axi_dmac_write(dmac, AXI_DMAC_REG_DEST_ADDRESS, 0xffffffff);
-	axi_dmac_read(dmac, AXI_DMAC_REG_DEST_ADDRESS, &dest_mem_mapped);
-	axi_dmac_write(dmac, AXI_DMAC_REG_SRC_ADDRESS, 0xffffffff);
-	axi_dmac_read(dmac, AXI_DMAC_REG_SRC_ADDRESS, &src_mem_mapped);
-	axi_dmac_read(dmac, AXI_DMAC_REG_INTF_DESC, &intf_desc);
+	no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_DEST_ADDRESS, 0xffffffff);
+	no_os_axi_io_batch_read(&batch, AXI_DMAC_REG_DEST_ADDRESS, &dest_mem_mapped);
+	no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_SRC_ADDRESS, 0xffffffff);
+	no_os_axi_io_batch_read(&batch, AXI_DMAC_REG_SRC_ADDRESS, &src_mem_mapped);
+	no_os_axi_io_batch_read(&batch, AXI_DMAC_REG_INTF_DESC, &intf_desc);
+
+	/* Leave the probed registers at their reset value. */
+	no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_Y_LENGTH, 0);
+	no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_DEST_ADDRESS_HIGH, 0);
+	no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_SRC_ADDRESS_HIGH, 0);
+	no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_DEST_ADDRESS, 0);
+	no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_SRC_ADDRESS, 0);
+	ret = no_os_axi_io_batch_exec(&batch);
+	if (ret)
+		return ret;
+
+	if (reg_val == DMA_CYCLIC)
+		dmac->hw_cyclic = true;
+	dmac->hw_2d = dmac->max_y_length != 0;
+	dmac->hw_addr64 = dest_high || src_high;
 	dmac->width_dst = no_os_field_get(AXI_DMAC_DMA_BPB_DEST, intf_desc);
 	dmac->width_dst = (1 << dmac->width_dst);
 	dmac->width_src = no_os_field_get(AXI_DMAC_DMA_BPB_SRC, intf_desc);
@@ -349,11 +404,17 @@ int32_t axi_dmac_init(struct axi_dmac **dmac_core,
 	dmac->name = init->name;
 	dmac->base = init->base;
 	dmac->irq_option = init->irq_option;
+	dmac->spin_us = init->spin_us;
 
 	int32_t status = axi_dmac_detect_caps(dmac);
 	if (status < 0)
 		goto free;
 
+	/* Platforms without a semaphore implementation leave it NULL and the
+	 * completion is polled. */
+	if (dmac->irq_option == IRQ_ENABLED)
+		no_os_semaphore_init(&dmac->done_sem);
+
 	*dmac_core = dmac;
 
 	return 0;
@@ -375,140 +436,184 @@ int32_t axi_dmac_remove(struct axi_dmac *dmac)
 	if (!dmac)
 		return -1;
 
+	if (dmac->done_sem)
+		no_os_semaphore_remove(dmac->done_sem);
 	no_os_free(dmac);
 
 	return 0;
 }
 
 /*******************************************************************************
- * @brief Start a DMA transfer.
+ * @brief Check that a descriptor can be handled by the core.
+ *
+ * @param dmac - DMAC istance.
+ * @param desc - The descriptor.
+ *
+ * @return 0 if the descriptor is supported, negative error code otherwise.
+*******************************************************************************/
+static int32_t axi_dmac_check_desc(struct axi_dmac *dmac,
+				   const struct axi_dma_desc *desc)
+{
+	if (!desc->x_len)
+		return -EINVAL;
+
+	if (desc->y_len > 1) {
+		if (!dmac->hw_2d || desc->y_len - 1 > dmac->max_y_length ||
+		    desc->x_len - 1 > dmac->max_length)
+			return -ENOTSUP;
+	} else if (desc->src_stride || desc->dest_stride) {
+		return -EINVAL;
+	}
+
+	if (!dmac->hw_addr64 && ((desc->src_addr | desc->dest_addr) >> 32))
+		return -ENOTSUP;
+
+	return 0;
+}
+
+/*******************************************************************************
+ * @brief Start a DMA transfer. If dma_transfer->desc is set, the descriptor
+ *			chain is transferred, otherwise a single contiguous transfer of
+ *			dma_transfer->size bytes is done. As many transfers as the hardware
+ *			queue allows are submitted here, the rest from the ISR (or from
+ *			axi_dmac_transfer_wait_completion() if the IRQ is not used).
  *
  * @param dmac - DMAC istance.
  * @param dma_transfer - Structure containing transfer details.
  *
- * @return 0 for success, -1 in case of failure.
+ * @return 0 for success, negative error code otherwise.
 *******************************************************************************/
 int32_t axi_dmac_transfer_start(struct axi_dmac *dmac,
 				struct axi_dma_transfer *dma_transfer)
 {
-	uint32_t reg_val, burst_size;
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, dmac->base, 8);
+	uint32_t reg_val, i;
+	uint32_t flags = 0;
+	int32_t ret;
 
-	if (dma_transfer->size == 0)
+	if (dma_transfer->desc ? !dma_transfer->nb_desc : !dma_transfer->size)
 		return 0; /* Nothing to do. */
 
-	/* Set current transfer parameters. */
-	dmac->transfer.size = dma_transfer->size;
-	dmac->transfer.cyclic = dma_transfer->cyclic;
-	dmac->transfer.dest_addr = dma_transfer->dest_addr;
-	dmac->transfer.src_addr = dma_transfer->src_addr;
-
-	dmac->remaining_size = dma_transfer->size;
-	dmac->next_dest_addr = dma_transfer->dest_addr;
-	dmac->next_src_addr = dma_transfer->src_addr;
-
-	/* If HW cyclic transfer selected and not available, show error */
-	/* HW cyclic transfer available only for MEM to DEV transfers. */
-	if ((!dmac->hw_cyclic) && (dma_transfer->cyclic == CYCLIC)) {
-		printf("Transfer mode not supported!\n");
-		return -1;
+	/*
+	 * Keep the ISR out while the transfer state is set up and the first
+	 * transfers are queued. The sources raised meanwhile stay latched and
+	 * interrupt once unmasked.
+	 */
+	ret = axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK,
+			     AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT);
+	if (ret)
+		return ret;
+
+	if (dma_transfer->desc) {
+		dmac->desc = dma_transfer->desc;
+		dmac->nb_desc = dma_transfer->nb_desc;
+	} else {
+		dmac->single_desc.src_addr = dma_transfer->src_addr;
+		dmac->single_desc.dest_addr = dma_transfer->dest_addr;
+		dmac->single_desc.x_len = dma_transfer->size;
+		dmac->single_desc.y_len = 1;
+		dmac->single_desc.src_stride = 0;
+		dmac->single_desc.dest_stride = 0;
+		dmac->desc = &dmac->single_desc;
+		dmac->nb_desc = 1;
 	}
 
-	/* Cyclic transfers not possible for DEV_TO_MEM and MEM_TO_MEM transmissions. */
-	if ((dmac->direction == DMA_DEV_TO_MEM)
-	    || (dmac->direction == DMA_MEM_TO_MEM)) {
-		if (dma_transfer->cyclic == CYCLIC) {
+	for (i = 0; i < dmac->nb_desc; i++) {
+		ret = axi_dmac_check_desc(dmac, &dmac->desc[i]);
+		if (ret) {
 			printf("Transfer mode not supported!\n");
-			return -1;
+			goto unmask;
 		}
 	}
 
-	/* Clear the DMA_CYCLIC flag for all transfers */
-	axi_dmac_read(dmac, AXI_DMAC_REG_FLAGS, &reg_val);
-	reg_val = reg_val & ~DMA_CYCLIC;
-	axi_dmac_write(dmac, AXI_DMAC_REG_FLAGS, reg_val);
-
-	/* Cyclic transfers set to HW for MEM to DEV if smaller than maximum transfer size
-	 * and DMA has this feature. */
-	if ((dmac->direction == DMA_MEM_TO_DEV) && (dmac->transfer.cyclic == CYCLIC)
-	    && ((dmac->remaining_size - 1) <= dmac->max_length) && (dmac->hw_cyclic)) {
-		axi_dmac_read(dmac, AXI_DMAC_REG_FLAGS, &reg_val);
-		reg_val = reg_val | DMA_CYCLIC;
-		axi_dmac_write(dmac, AXI_DMAC_REG_FLAGS, reg_val);
+	/* Cyclic transfers are repeated by the HW for MEM to DEV if they fit in
+	 * a single transfer and DMA has this feature. Otherwise the driver
+	 * restarts the chain from the ISR, so the DMAC interrupt is needed. */
+	if ((dmac->direction == DMA_MEM_TO_DEV) && (dma_transfer->cyclic == CYCLIC)
+	    && (dmac->nb_desc == 1) && (dmac->hw_cyclic)
+	    && ((dmac->desc[0].y_len > 1)
+		|| ((dmac->desc[0].x_len - 1) <= dmac->max_length))) {
+		flags = DMA_CYCLIC;
+	} else if ((dma_transfer->cyclic == CYCLIC)
+		   && ((dmac->irq_option != IRQ_ENABLED)
+		       || (dmac->direction == DMA_MEM_TO_MEM))) {
+		printf("Transfer mode not supported!\n");
+		ret = -1;
+		goto unmask;
 	}
 
+	/* Set current transfer parameters. */
+	dmac->transfer.size = dma_transfer->size;
+	dmac->transfer.cyclic = dma_transfer->cyclic;
+	dmac->transfer.dest_addr = dma_transfer->dest_addr;
+	dmac->transfer.src_addr = dma_transfer->src_addr;
+	dmac->transfer.transfer_done = false;
+	dmac->desc_done = dma_transfer->desc_done;
+	dmac->desc_done_ctx = dma_transfer->desc_done_ctx;
+
+	dmac->desc_idx = 0;
+	dmac->desc_offset = 0;
+	dmac->active_ids = 0;
+	dmac->hw_cyclic_active = flags == DMA_CYCLIC;
+
+	/* Drop the tokens left by previous transfers or by initialization. */
+	if (dmac->done_sem)
+		while (!no_os_semaphore_take_timeout(dmac->done_sem, 0))
+			;
+
+	/* Clear the DMA_CYCLIC flag for all other transfers */
+	no_os_axi_io_batch_update(&batch, AXI_DMAC_REG_FLAGS, DMA_CYCLIC, flags);
+	no_os_axi_io_batch_read(&batch, AXI_DMAC_REG_CTRL, &reg_val);
+	ret = no_os_axi_io_batch_exec(&batch);
+	if (ret)
+		goto unmask;
+
 	/* Enable DMA if not already enabled. */
-	axi_dmac_read(dmac, AXI_DMAC_REG_CTRL, &reg_val);
 	if (!(reg_val & AXI_DMAC_CTRL_ENABLE)) {
-		axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, 0x0);
-		axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, AXI_DMAC_CTRL_ENABLE);
-		axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK, 0x0);
+		no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_CTRL, 0x0);
+		no_os_axi_io_batch_write(&batch, AXI_DMAC_REG_CTRL, AXI_DMAC_CTRL_ENABLE);
 	}
 
-	axi_dmac_read(dmac, AXI_DMAC_REG_TRANSFER_SUBMIT, &reg_val);
-	/* If we don't have a start of transfer then start compute
-	 * values and trigger next transfer. */
-	if (!(reg_val & AXI_DMAC_QUEUE_FULL)) {
-		switch (dmac->direction) {
-		case DMA_DEV_TO_MEM:
-			dmac->init_addr = dmac->next_dest_addr;
-			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_ADDRESS, dmac->next_dest_addr);
-			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_STRIDE, 0x0);
-			break;
-		case DMA_MEM_TO_DEV:
-			dmac->init_addr = dmac->next_src_addr;
-			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_ADDRESS, dmac->next_src_addr);
-			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_STRIDE, 0x0);
-			break;
-		case DMA_MEM_TO_MEM:
-			dmac->init_addr = dmac->next_src_addr;
-			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_ADDRESS, dmac->next_dest_addr);
-			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_STRIDE, 0x0);
-			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_ADDRESS, dmac->next_src_addr);
-			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_STRIDE, 0x0);
-			break;
-		default:
-			return -1; /* Other directions are not supported yet. */
-		}
+	no_os_axi_io_batch_read(&batch, AXI_DMAC_REG_TRANSFER_SUBMIT, &reg_val);
+	ret = no_os_axi_io_batch_exec(&batch);
+	if (ret)
+		goto unmask;
 
-		/* Compute the burst size. */
-		if (dmac->remaining_size > dmac->max_length) {
-			burst_size = dmac->max_length;
-		} else {
-			burst_size = dmac->remaining_size - 1;
-		}
+	/* The queue is still full with a previous transfer. */
+	if (reg_val & AXI_DMAC_QUEUE_FULL) {
+		ret = -1;
+		goto unmask;
+	}
 
-		/* Compute next address (src or dest, or both, depending on type of transfer). */
-		switch (dmac->direction) {
-		case DMA_DEV_TO_MEM:
-			dmac->next_dest_addr = dmac->next_dest_addr + (burst_size + 1);
-			break;
-		case DMA_MEM_TO_DEV:
-			dmac->next_src_addr = dmac->next_src_addr + (burst_size + 1);
-			break;
-		case DMA_MEM_TO_MEM:
-			dmac->next_dest_addr = dmac->next_dest_addr + (burst_size + 1);
-			dmac->next_src_addr = dmac->next_src_addr + (burst_size + 1);
-			break;
-		default:
-			return -1;
-		}
+	ret = axi_dmac_queue_desc(dmac);
 
-		/* Compute remaining size. */
-		dmac->remaining_size = dmac->remaining_size - (burst_size + 1);
+unmask:
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK, 0x0);
 
-		/* Specify the length of the transfer and trigger transfer. */
-		axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, burst_size);
-		axi_dmac_write(dmac, AXI_DMAC_REG_Y_LENGTH, 0x0);
-		axi_dmac_write(dmac, AXI_DMAC_REG_TRANSFER_SUBMIT, AXI_DMAC_TRANSFER_SUBMIT);
-	} else {
-		return -1;
-	}
+	return ret;
+}
 
-	return 0;
+/*******************************************************************************
+ * @brief Check if the transfer is done, servicing the DMAC without IRQ.
+ *
+ * @param dmac - DMAC istance.
+ *
+ * @return true if the transfer is done.
+*******************************************************************************/
+static bool axi_dmac_poll_done(struct axi_dmac *dmac)
+{
+	if (!dmac->transfer.transfer_done && dmac->irq_option == IRQ_DISABLED)
+		axi_dmac_handle_irq(dmac);
+
+	return dmac->transfer.transfer_done;
 }
 
 /*******************************************************************************
- * @brief Wait for DMA transfer to be completed.
+ * @brief Wait for DMA transfer to be completed. The completion is first
+ *			busy-waited for spin_us, which gives the lowest latency for
+ *			short transfers. Then, if the IRQ is used and the platform
+ *			provides semaphores, the caller sleeps until the ISR signals
+ *			the completion. Otherwise the completion is polled each 1 ms.
  *
  * @param dmac - DMAC istance.
  * @param timeout_ms - Number of ms to wait for completion of transfer.
@@ -519,29 +624,32 @@ int32_t axi_dmac_transfer_wait_completion(struct axi_dmac *dmac,
 		uint32_t timeout_ms)
 {
 	uint32_t timeout = 0;
-	uint32_t reg_val = 0;
-
-	if (dmac->irq_option == IRQ_ENABLED) {
-		while (!dmac->transfer.transfer_done) {
-			timeout++;
-			no_os_mdelay(1);
-			if (timeout == timeout_ms) {
-				printf("Error transferring data using DMA.\n");
-				return -1;
-			}
+	uint32_t spin;
+	int ret;
+
+	for (spin = 0; spin < dmac->spin_us; spin++) {
+		if (axi_dmac_poll_done(dmac))
+			return 0;
+		no_os_udelay(1);
+	}
+
+	if (dmac->done_sem && !dmac->transfer.transfer_done) {
+		ret = no_os_semaphore_take_timeout(dmac->done_sem, timeout_ms);
+		if (!ret || dmac->transfer.transfer_done)
+			return 0;
+		if (ret != -ENOSYS) {
+			printf("Error transferring data using DMA.\n");
+			return -1;
 		}
-	} else if (dmac->irq_option == IRQ_DISABLED) {
-		axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
-		while (reg_val != (AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT)) {
-			timeout++;
-			no_os_mdelay(1);
-			if (timeout == timeout_ms) {
-				printf("Error transferring data using DMA.\n");
-				return -1;
-			}
-			axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
+	}
+
+	while (!axi_dmac_poll_done(dmac)) {
+		timeout++;
+		no_os_mdelay(1);
+		if (timeout == timeout_ms) {
+			printf("Error transferring data using DMA.\n");
+			return -1;
 		}
-		axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
 	}
 
 	return 0;
@@ -557,4 +665,226 @@ int32_t axi_dmac_transfer_wait_completion(struct axi_dmac *dmac,
 void axi_dmac_transfer_stop(struct axi_dmac *dmac)
 {
 	axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, AXI_DMAC_CTRL_DISABLE);
+	dmac->desc_idx = dmac->nb_desc;
+	dmac->active_ids = 0;
+}
+
+/*******************************************************************************
+ * @brief DMAC callback, called from the ISR when a block of a ring is filled.
+ *
+ * @param ctx - The ring.
+ * @param desc_idx - Index of the filled block.
+ *
+ * @return None
+*******************************************************************************/
+static void axi_dmac_ring_block_done(void *ctx, uint32_t desc_idx)
+{
+	struct axi_dmac_ring *ring = ctx;
+
+	if (ring->timestamps)
+		ring->timestamps[desc_idx] = ring->get_timestamp();
+	ring->blocks_done++;
+	if (ring->block_sem)
+		no_os_semaphore_give_from_isr(ring->block_sem);
+}
+
+/*******************************************************************************
+ * @brief Allocate a ring of blocks and start a cyclic DEV to MEM transfer over
+ *			it. The ring starts on a cache line and is padded to a whole
+ *			number of cache lines. It is invalidated before the DMA starts,
+ *			so no dirty line of it can later be written back over the data.
+ *			The ring is refilled from the DMAC ISR, so the DMAC must be in
+ *			IRQ_ENABLED mode.
+ *
+ * @param dmac - DMAC istance.
+ * @param ring - The ring, zeroed or stopped.
+ * @param param - Ring parameters.
+ *
+ * @return 0 for success, negative error code otherwise.
+*******************************************************************************/
+int32_t axi_dmac_ring_start(struct axi_dmac *dmac, struct axi_dmac_ring *ring,
+			    const struct axi_dmac_ring_param *param)
+{
+	struct axi_dma_transfer transfer = {
+		.cyclic = CYCLIC,
+		.nb_desc = param->nb_blocks,
+		.desc_done = axi_dmac_ring_block_done,
+		.desc_done_ctx = ring,
+	};
+	uint32_t ring_size;
+	uint32_t i;
+	int32_t ret;
+
+	if (param->nb_blocks < 2 || !param->block_size)
+		return -EINVAL;
+	if (dmac->irq_option != IRQ_ENABLED)
+		return -EINVAL;
+	if (ring->buf)
+		return -EBUSY;
+
+	ring_size = no_os_align(param->nb_blocks * param->block_size,
+				AXI_DMAC_CACHE_LINE);
+	ring->alloc = no_os_malloc(ring_size + AXI_DMAC_CACHE_LINE - 1);
+	if (!ring->alloc)
+		return -ENOMEM;
+	ring->buf = (uint8_t *)no_os_align((uintptr_t)ring->alloc,
+					   AXI_DMAC_CACHE_LINE);
+
+	ring->desc = no_os_calloc(param->nb_blocks, sizeof(*ring->desc));
+	if (!ring->desc) {
+		ret = -ENOMEM;
+		goto free_buf;
+	}
+
+	ring->timestamps = NULL;
+	if (param->get_timestamp) {
+		ring->timestamps = no_os_calloc(param->nb_blocks,
+						sizeof(*ring->timestamps));
+		if (!ring->timestamps) {
+			ret = -ENOMEM;
+			goto free_desc;
+		}
+	}
+
+	for (i = 0; i < param->nb_blocks; i++) {
+		ring->desc[i].dest_addr =
+			(uintptr_t)(ring->buf + i * param->block_size);
+		ring->desc[i].x_len = param->block_size;
+	}
+
+	ring->nb_blocks = param->nb_blocks;
+	ring->block_size = param->block_size;
+	ring->blocks_done = 0;
+	ring->blocks_read = 0;
+	ring->overruns = 0;
+	ring->stalls = dmac->stalls;
+	/* A cyclic transfer never gives done_sem, so the ring uses it */
+	ring->block_sem = dmac->done_sem;
+	ring->get_timestamp = param->get_timestamp;
+	ring->dcache_invalidate_range = param->dcache_invalidate_range;
+
+	if (ring->dcache_invalidate_range)
+		ring->dcache_invalidate_range((uintptr_t)ring->buf, ring_size);
+
+	transfer.desc = ring->desc;
+	ret = axi_dmac_transfer_start(dmac, &transfer);
+	if (ret < 0)
+		goto free_timestamps;
+
+	return 0;
+
+free_timestamps:
+	no_os_free(ring->timestamps);
+	ring->timestamps = NULL;
+free_desc:
+	no_os_free(ring->desc);
+	ring->desc = NULL;
+free_buf:
+	no_os_free(ring->alloc);
+	ring->alloc = NULL;
+	ring->buf = NULL;
+
+	return ret;
+}
+
+/*******************************************************************************
+ * @brief Read the oldest block of a ring. Blocks overwritten by the DMA before
+ *			being read and blocks dropped while the DMA stalled are counted
+ *			as overruns. If no block is ready, the caller sleeps until the
+ *			DMAC ISR fills one. Platforms without semaphores poll each
+ *			10 us instead.
+ *
+ * @param dmac - DMAC istance.
+ * @param ring - The ring.
+ * @param buf - Where to copy the block, block_size bytes.
+ * @param info - Optional, filled with the sequence number, completion time
+ *			and overrun count of the block.
+ * @param timeout_ms - Number of ms to wait for a block.
+ *
+ * @return 0 for success, negative error code otherwise.
+*******************************************************************************/
+int32_t axi_dmac_ring_read(struct axi_dmac *dmac, struct axi_dmac_ring *ring,
+			   void *buf, struct axi_dmac_block_info *info,
+			   uint32_t timeout_ms)
+{
+	uint32_t timeout = 0;
+	uint32_t pending;
+	uint32_t stalls;
+	uint32_t idx;
+	uint8_t *block;
+	int ret;
+
+	if (!ring->buf)
+		return -EINVAL;
+
+	while (ring->blocks_done == ring->blocks_read) {
+		if (ring->block_sem) {
+			/* Tokens of blocks already read only cause a recheck */
+			ret = no_os_semaphore_take_timeout(ring->block_sem,
+							   timeout_ms);
+			if (!ret)
+				continue;
+			if (ret != -ENOSYS)
+				return ret;
+		}
+		if (timeout++ == timeout_ms * 100)
+			return -ETIMEDOUT;
+		no_os_udelay(10);
+	}
+
+	stalls = dmac->stalls;
+	ring->overruns += stalls - ring->stalls;
+	ring->stalls = stalls;
+
+	/* The DMA is writing the block following the last filled one, so at
+	 * most nb_blocks - 1 blocks can be read. */
+	pending = ring->blocks_done - ring->blocks_read;
+	if (pending >= ring->nb_blocks) {
+		ring->overruns += pending - (ring->nb_blocks - 1);
+		ring->blocks_read = ring->blocks_done - (ring->nb_blocks - 1);
+	}
+
+	idx = ring->blocks_read % ring->nb_blocks;
+	block = ring->buf + idx * ring->block_size;
+	if (ring->dcache_invalidate_range)
+		ring->dcache_invalidate_range((uintptr_t)block, ring->block_size);
+	memcpy(buf, block, ring->block_size);
+
+	if (info) {
+		info->seq = ring->blocks_read;
+		info->timestamp = ring->timestamps ? ring->timestamps[idx] : 0;
+	}
+
+	/* The block was overwritten while being copied. */
+	if (ring->blocks_done - ring->blocks_read >= ring->nb_blocks)
+		ring->overruns++;
+	ring->blocks_read++;
+
+	if (info)
+		info->overruns = ring->overruns;
+
+	return 0;
+}
+
+/*******************************************************************************
+ * @brief Stop the transfer of a ring and free it.
+ *
+ * @param dmac - DMAC istance.
+ * @param ring - The ring.
+ *
+ * @return None
+*******************************************************************************/
+void axi_dmac_ring_stop(struct axi_dmac *dmac, struct axi_dmac_ring *ring)
+{
+	if (!ring->buf)
+		return;
+
+	axi_dmac_transfer_stop(dmac);
+	no_os_free(ring->timestamps);
+	no_os_free(ring->desc);
+	no_os_free(ring->alloc);
+	ring->timestamps = NULL;
+	ring->desc = NULL;
+	ring->alloc = NULL;
+	ring->buf = NULL;
 }
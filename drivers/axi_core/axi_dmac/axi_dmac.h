@@ -77,6 +77,19 @@
 #define AXI_DMAC_REG_DEST_STRIDE		0x420
 #define AXI_DMAC_REG_SRC_STRIDE			0x424
 #define AXI_DMAC_REG_TRANSFER_DONE		0x428
+#define AXI_DMAC_REG_DEST_ADDRESS_HIGH	0x490
+#define AXI_DMAC_REG_SRC_ADDRESS_HIGH	0x494
+
+/* Maximum number of transfer IDs tracked by the driver */
+#define AXI_DMAC_MAX_TRANSFER_ID		32
+/* Transfer ID not completing a descriptor */
+#define AXI_DMAC_NO_DESC				UINT32_MAX
+
+/* Alignment of the DMA rings, so that cache maintenance on them does not
+ * touch other data */
+#ifndef AXI_DMAC_CACHE_LINE
+#define AXI_DMAC_CACHE_LINE				64
+#endif
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -105,12 +118,42 @@ enum cyclic_transfer {
 	CYCLIC = 1
 };
 
+/**
+ * @struct axi_dma_desc
+ * @brief Element of a DMA descriptor chain. A descriptor with y_len bigger
+ * than 1 is a 2D transfer of y_len rows of x_len bytes, each row starting
+ * stride bytes after the previous one. 1D descriptors longer than the
+ * maximum transfer length of the core are split by the driver.
+ */
+struct axi_dma_desc {
+	/** Source address, ignored for DMA_DEV_TO_MEM */
+	uint64_t src_addr;
+	/** Destination address, ignored for DMA_MEM_TO_DEV */
+	uint64_t dest_addr;
+	/** Number of bytes per row */
+	uint32_t x_len;
+	/** Number of rows, 0 or 1 for 1D transfers */
+	uint32_t y_len;
+	/** Distance in bytes between the start of two source rows */
+	uint32_t src_stride;
+	/** Distance in bytes between the start of two destination rows */
+	uint32_t dest_stride;
+};
+
 struct axi_dma_transfer {
 	uint32_t size;
 	volatile bool transfer_done;
 	enum cyclic_transfer cyclic;
-	uint32_t src_addr;
-	uint32_t dest_addr;
+	uint64_t src_addr;
+	uint64_t dest_addr;
+	/** Optional descriptor chain, used instead of size/src/dest if set */
+	struct axi_dma_desc *desc;
+	/** Number of descriptors in the chain */
+	uint32_t nb_desc;
+	/** Optional, called from the ISR each time a descriptor is completed */
+	void (*desc_done)(void *ctx, uint32_t desc_idx);
+	/** Context passed to desc_done */
+	void *desc_done_ctx;
 };
 
 struct axi_dmac {
@@ -119,21 +162,99 @@ struct axi_dmac {
 	enum use_irq irq_option;
 	enum dma_direction direction;
 	bool hw_cyclic;
+	bool hw_2d;
+	bool hw_addr64;
+	bool hw_cyclic_active;
 	uint32_t max_length;
+	uint32_t max_y_length;
 	uint32_t width_dst;
 	uint32_t width_src;
 	volatile struct axi_dma_transfer transfer;
-	//Current sub-transfer properties
-	uint32_t init_addr;
-	uint32_t remaining_size;
-	uint32_t next_src_addr;
-	uint32_t next_dest_addr;
+	/* Descriptor chain being transferred */
+	struct axi_dma_desc single_desc;
+	struct axi_dma_desc *desc;
+	uint32_t nb_desc;
+	/* Next descriptor to be queued and bytes of it already queued */
+	volatile uint32_t desc_idx;
+	volatile uint32_t desc_offset;
+	/* IDs of the transfers queued in hardware and not completed */
+	volatile uint32_t active_ids;
+	/* Descriptor completed by each transfer ID */
+	uint32_t id_desc[AXI_DMAC_MAX_TRANSFER_ID];
+	void (*desc_done)(void *ctx, uint32_t desc_idx);
+	void *desc_done_ctx;
+	/* Given by the ISR when the transfer is done */
+	void *done_sem;
+	uint32_t spin_us;
+	/* Times a software cyclic transfer ran out of queued transfers */
+	volatile uint32_t stalls;
 };
 
 struct axi_dmac_init {
 	const char *name;
 	uint32_t base;
 	enum use_irq irq_option;
+	/* Time to busy-wait for completion before sleeping, in us */
+	uint32_t spin_us;
+};
+
+/**
+ * @struct axi_dmac_ring_param
+ * @brief Parameters of a DEV to MEM ring of blocks filled continuously.
+ */
+struct axi_dmac_ring_param {
+	/** Number of blocks, at least 2 */
+	uint32_t nb_blocks;
+	/** Size of a block in bytes */
+	uint32_t block_size;
+	/** Optional, time source used to timestamp the completed blocks */
+	uint64_t (*get_timestamp)(void);
+	/** Optional, invalidate the data cache for the given address range */
+	void (*dcache_invalidate_range)(uint32_t address, uint32_t bytes_count);
+};
+
+/**
+ * @struct axi_dmac_ring
+ * @brief Ring of blocks filled by a software cyclic DEV to MEM transfer.
+ * The DMAC ISR refills the hardware queue and counts the completed blocks,
+ * the reader copies them out in order.
+ */
+struct axi_dmac_ring {
+	/** Cache line aligned ring, nb_blocks blocks of block_size bytes */
+	uint8_t *buf;
+	/** Allocation holding buf */
+	void *alloc;
+	/** One DMA descriptor per block */
+	struct axi_dma_desc *desc;
+	/** Completion time of each block, NULL without time source */
+	uint64_t *timestamps;
+	uint32_t nb_blocks;
+	uint32_t block_size;
+	/** Number of blocks filled by the DMA, updated from the DMAC ISR */
+	volatile uint32_t blocks_done;
+	/** Number of blocks read */
+	uint32_t blocks_read;
+	/** Number of blocks lost since the ring was started */
+	uint32_t overruns;
+	/** DMAC stalls already counted in overruns */
+	uint32_t stalls;
+	/** Given from the DMAC ISR for each filled block, NULL to poll */
+	void *block_sem;
+	uint64_t (*get_timestamp)(void);
+	void (*dcache_invalidate_range)(uint32_t address, uint32_t bytes_count);
+};
+
+/**
+ * @struct axi_dmac_block_info
+ * @brief Description of a block read from a ring.
+ */
+struct axi_dmac_block_info {
+	/** Index of the block since the ring was started */
+	uint32_t seq;
+	/** Time at which the DMA completed the block, 0 without time source */
+	uint64_t timestamp;
+	/** Number of blocks lost since the ring was started */
+	uint32_t overruns;
 };
 
 /******************************************************************************/
@@ -142,6 +263,7 @@ struct axi_dmac_init {
 void axi_dmac_dev_to_mem_isr(void *instance);
 void axi_dmac_mem_to_dev_isr(void *instance);
 void axi_dmac_mem_to_mem_isr(void *instance);
+void axi_dmac_isr(void *instance);
 void axi_dmac_write_isr(void *instance);
 int32_t axi_dmac_read(struct axi_dmac *dmac, uint32_t reg_addr,
 		      uint32_t *reg_data);
@@ -156,5 +278,11 @@ int32_t axi_dmac_transfer_start(struct axi_dmac *dmac,
 int32_t axi_dmac_transfer_wait_completion(struct axi_dmac *dmac,
 		uint32_t timeout_ms);
 void axi_dmac_transfer_stop(struct axi_dmac *dmac);
+int32_t axi_dmac_ring_start(struct axi_dmac *dmac, struct axi_dmac_ring *ring,
+			    const struct axi_dmac_ring_param *param);
+int32_t axi_dmac_ring_read(struct axi_dmac *dmac, struct axi_dmac_ring *ring,
+			   void *buf, struct axi_dmac_block_info *info,
+			   uint32_t timeout_ms);
+void axi_dmac_ring_stop(struct axi_dmac *dmac, struct axi_dmac_ring *ring);
 
 #endif
@@ -57,6 +57,9 @@
 
 #define STORAGE_BITS 16
 
+/* Time to wait for a DMA block, in ms */
+#define IIO_AXI_ADC_DMA_TIMEOUT	500
+
 /**
  * @brief get_cf_calibphase().
  * @param device - Physical instance of a iio_axi_adc_desc device.
@@ -340,6 +343,49 @@ int32_t iio_axi_adc_prepare_transfer(void *dev, uint32_t mask)
 	return axi_adc_update_active_channels(iio_adc->adc, mask);
 }
 
+/**
+ * @brief Stop streaming and free the DMA ring.
+ * @param iio_adc - Instance of the iio_axi_adc
+ */
+static void iio_axi_adc_stream_stop(struct iio_axi_adc_desc *iio_adc)
+{
+	if (!iio_adc->ring.buf)
+		return;
+
+	axi_dmac_ring_stop(iio_adc->dmac, &iio_adc->ring);
+	iio_adc->overflows += iio_adc->ring.overruns;
+	iio_adc->ring.overruns = 0;
+}
+
+/**
+ * @brief Read the oldest block of the streaming ring, (re)starting the ring
+ * if the block size changed. Blocks lost by the DMA are counted as overflows.
+ * @param iio_adc - Instance of the iio_axi_adc
+ * @param buff - Buffer where to read samples
+ * @param bytes - Number of bytes to read
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int32_t iio_axi_adc_stream_read(struct iio_axi_adc_desc *iio_adc,
+				       void *buff, uint32_t bytes)
+{
+	struct axi_dmac_ring_param param = {
+		.nb_blocks = iio_adc->stream_blocks,
+		.block_size = bytes,
+		.dcache_invalidate_range = iio_adc->dcache_invalidate_range,
+	};
+	int32_t ret;
+
+	if (!iio_adc->ring.buf || iio_adc->ring.block_size != bytes) {
+		iio_axi_adc_stream_stop(iio_adc);
+		ret = axi_dmac_ring_start(iio_adc->dmac, &iio_adc->ring, &param);
+		if (ret)
+			return ret;
+	}
+
+	return axi_dmac_ring_read(iio_adc->dmac, &iio_adc->ring, buff, NULL,
+				  IIO_AXI_ADC_DMA_TIMEOUT);
+}
+
 /**
  * @brief Update active channels
  * @param dev - Instance of the iio_axi_adc
@@ -371,11 +417,16 @@ int32_t	iio_axi_adc_read_dev(void *dev, void *buff, uint32_t nb_samples)
 		// Address of data destination
 		.dest_addr = (uintptr_t)buff
 	};
+
+	if (iio_adc->stream_blocks)
+		return iio_axi_adc_stream_read(iio_adc, buff, bytes);
+
 	ret = axi_dmac_transfer_start(iio_adc->dmac, &transfer);
 	if (ret < 0)
 		return ret;
 	/* Wait until transfer finishes */
-	ret = axi_dmac_transfer_wait_completion(iio_adc->dmac, 500);
+	ret = axi_dmac_transfer_wait_completion(iio_adc->dmac,
+						IIO_AXI_ADC_DMA_TIMEOUT);
 	if(ret)
 		return ret;
 
@@ -385,6 +436,28 @@ int32_t	iio_axi_adc_read_dev(void *dev, void *buff, uint32_t nb_samples)
 	return 0;
 }
 
+/**
+ * @brief Stop streaming when the buffer is closed.
+ * @param dev - Instance of the iio_axi_adc
+ * @return 0 in case of success or negative value otherwise.
+ */
+int32_t iio_axi_adc_end_transfer(void *dev)
+{
+	iio_axi_adc_stream_stop(dev);
+
+	return 0;
+}
+
+/**
+ * @brief Get the number of blocks lost while streaming.
+ * @param desc - Instance of the iio_axi_adc
+ * @return Number of blocks overwritten by the DMA before being read.
+ */
+uint32_t iio_axi_adc_get_overflows(struct iio_axi_adc_desc *desc)
+{
+	return desc->overflows + desc->ring.overruns;
+}
+
 /**
  * @brief Delete iio_device.
  * @param iio_device - Structure describing a device, channels and attributes.
@@ -451,6 +524,7 @@ static int32_t iio_axi_adc_create_device_descriptor(
 	}
 
 	iio_device->pre_enable = iio_axi_adc_prepare_transfer;
+	iio_device->post_disable = iio_axi_adc_end_transfer;
 	iio_device->read_dev = iio_axi_adc_read_dev;
 
 	return 0;
@@ -508,6 +582,14 @@ int32_t iio_axi_adc_init(struct iio_axi_adc_desc **desc,
 	if (init->rx_dmac) {
 		iio_axi_adc_inst->dmac = init->rx_dmac;
 		iio_axi_adc_inst->dcache_invalidate_range = init->dcache_invalidate_range;
+		if (init->stream_blocks >= 2)
+			iio_axi_adc_inst->stream_blocks = init->stream_blocks;
+	}
+	/* The ring is refilled from the DMAC interrupt. */
+	if (iio_axi_adc_inst->stream_blocks &&
+	    init->rx_dmac->irq_option != IRQ_ENABLED) {
+		no_os_free(iio_axi_adc_inst);
+		return -EINVAL;
 	}
 	iio_axi_adc_inst->get_sampling_frequency = init->get_sampling_frequency;
 
@@ -540,6 +622,8 @@ int32_t iio_axi_adc_remove(struct iio_axi_adc_desc *desc)
 	if (!desc)
 		return -1;
 
+	iio_axi_adc_stream_stop(desc);
+
 	status = iio_axi_adc_delete_device_descriptor(desc);
 	if (status < 0)
 		return status;
@@ -74,6 +74,12 @@ struct iio_axi_adc_desc {
 	char (*ch_names)[20];
 	/** Custom data format */
 	struct scan_type *scan_type_common;
+	/** Number of DMA blocks of the streaming ring, 0 if not streaming */
+	uint32_t stream_blocks;
+	/** Streaming ring */
+	struct axi_dmac_ring ring;
+	/** Number of blocks lost by the previous streaming rings */
+	uint32_t overflows;
 };
 
 /**
@@ -93,6 +99,10 @@ struct iio_axi_adc_init_param {
 	/** Custom data format (unpopulated if not used, set to default)
 	    Common to all channels */
 	struct scan_type *scan_type_common;
+	/** Number of DMA blocks kept in flight for continuous capture. Must be
+	    at least 2 to enable streaming, 0 for one DMA transfer per read.
+	    Streaming needs rx_dmac in IRQ_ENABLED mode */
+	uint32_t stream_blocks;
 };
 
 /******************************************************************************/
@@ -107,6 +117,9 @@ int32_t iio_axi_adc_init(struct iio_axi_adc_desc **desc,
 void iio_axi_adc_get_dev_descriptor(struct iio_axi_adc_desc *desc,
 				    struct iio_device **dev_descriptor);
 
+/* Get the number of blocks lost while streaming. */
+uint32_t iio_axi_adc_get_overflows(struct iio_axi_adc_desc *desc);
+
 /* Free the resources allocated by iio_axi_adc_init(). */
 int32_t iio_axi_adc_remove(struct iio_axi_adc_desc *desc);
 
@@ -172,6 +172,7 @@ int adxcvr_drp_read(struct adxcvr *xcvr,
 		    unsigned int reg,
 		    unsigned int *val)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, xcvr->base, 2);
 	uint32_t drp_sel, drp_addr;
 	int32_t ret;
 
@@ -182,8 +183,12 @@ int adxcvr_drp_read(struct adxcvr *xcvr,
 
 	drp_sel = drp_port & 0xFF;
 
-	adxcvr_write(xcvr, ADXCVR_REG_DRP_SEL(drp_addr), drp_sel);
-	adxcvr_write(xcvr, ADXCVR_REG_DRP_CTRL(drp_addr), ADXCVR_DRP_CTRL_ADDR(reg));
+	no_os_axi_io_batch_write(&batch, ADXCVR_REG_DRP_SEL(drp_addr), drp_sel);
+	no_os_axi_io_batch_write(&batch, ADXCVR_REG_DRP_CTRL(drp_addr),
+				 ADXCVR_DRP_CTRL_ADDR(reg));
+	ret = no_os_axi_io_batch_exec(&batch);
+	if (ret)
+		return ret;
 
 	ret = adxcvr_drp_wait_idle(xcvr, drp_addr);
 	if (ret < 0)
@@ -207,6 +212,7 @@ int adxcvr_drp_write(struct adxcvr *xcvr,
 		     unsigned int reg,
 		     unsigned int val)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, xcvr->base, 2);
 	uint32_t drp_sel, drp_addr;
 	int32_t ret;
 
@@ -217,9 +223,13 @@ int adxcvr_drp_write(struct adxcvr *xcvr,
 
 	drp_sel = drp_port & 0xFF;
 
-	adxcvr_write(xcvr, ADXCVR_REG_DRP_SEL(drp_addr), drp_sel);
-	adxcvr_write(xcvr, ADXCVR_REG_DRP_CTRL(drp_addr), (ADXCVR_DRP_CTRL_WR |
-			ADXCVR_DRP_CTRL_ADDR(reg) | ADXCVR_DRP_CTRL_WDATA(val)));
+	no_os_axi_io_batch_write(&batch, ADXCVR_REG_DRP_SEL(drp_addr), drp_sel);
+	no_os_axi_io_batch_write(&batch, ADXCVR_REG_DRP_CTRL(drp_addr),
+				 (ADXCVR_DRP_CTRL_WR | ADXCVR_DRP_CTRL_ADDR(reg) |
+				  ADXCVR_DRP_CTRL_WDATA(val)));
+	ret = no_os_axi_io_batch_exec(&batch);
+	if (ret)
+		return ret;
 
 	ret = adxcvr_drp_wait_idle(xcvr, drp_addr);
 	if (ret < 0)
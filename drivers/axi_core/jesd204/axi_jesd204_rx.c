@@ -194,10 +194,12 @@ int32_t axi_jesd204_rx_read(struct axi_jesd204_rx *jesd,
  */
 int32_t axi_jesd204_rx_lane_clk_enable(struct axi_jesd204_rx *jesd)
 {
-	axi_jesd204_rx_write(jesd, JESD204_RX_REG_SYSREF_STATUS, 0x3);
-	axi_jesd204_rx_write(jesd, JESD204_RX_REG_LINK_DISABLE, 0x0);
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, jesd->base, 2);
 
-	return 0;
+	no_os_axi_io_batch_write(&batch, JESD204_RX_REG_SYSREF_STATUS, 0x3);
+	no_os_axi_io_batch_write(&batch, JESD204_RX_REG_LINK_DISABLE, 0x0);
+
+	return no_os_axi_io_batch_exec(&batch);
 }
 
 /**
@@ -217,6 +219,7 @@ int32_t axi_jesd204_rx_lane_clk_disable(struct axi_jesd204_rx *jesd)
  */
 uint32_t axi_jesd204_rx_status_read(struct axi_jesd204_rx *jesd)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, jesd->base, 6);
 	uint32_t link_disabled;
 	uint32_t link_status;
 	uint32_t sysref_status;
@@ -228,12 +231,14 @@ uint32_t axi_jesd204_rx_status_read(struct axi_jesd204_rx *jesd)
 	uint32_t lmfc_rate;
 	const char *l_status;
 
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_STATE, &link_disabled);
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_STATUS, &link_status);
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_SYSREF_STATUS, &sysref_status);
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_CLK_RATIO, &clock_ratio);
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_SYSREF_CONF, &sysref_config);
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_CONF0, &link_config0);
+	no_os_axi_io_batch_read(&batch, JESD204_RX_REG_LINK_STATE, &link_disabled);
+	no_os_axi_io_batch_read(&batch, JESD204_RX_REG_LINK_STATUS, &link_status);
+	no_os_axi_io_batch_read(&batch, JESD204_RX_REG_SYSREF_STATUS, &sysref_status);
+	no_os_axi_io_batch_read(&batch, JESD204_RX_REG_LINK_CLK_RATIO, &clock_ratio);
+	no_os_axi_io_batch_read(&batch, JESD204_RX_REG_SYSREF_CONF, &sysref_config);
+	no_os_axi_io_batch_read(&batch, JESD204_RX_REG_LINK_CONF0, &link_config0);
+	if (no_os_axi_io_batch_exec(&batch))
+		return -1;
 
 	printf("%s status:\n", jesd->name);
 
@@ -346,10 +351,7 @@ static int32_t axi_jesd204_rx_laneinfo_8b10b_read(struct axi_jesd204_rx *jesd,
 	if (!(lane_status & NO_OS_BIT(5)))
 		return -1;
 
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_ILAS(lane, 0), &val[0]);
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_ILAS(lane, 1), &val[1]);
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_ILAS(lane, 2), &val[2]);
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_ILAS(lane, 3), &val[3]);
+	no_os_axi_io_read_multi(jesd->base, JESD204_RX_REG_ILAS(lane, 0), val, 4);
 
 	printf("\tDID: %"PRIu32", BID: %"PRIu32", LID: %"PRIu32", "
 	       "L: %"PRIu32", SCR: %"PRIu32", F: %"PRIu32"\n",
@@ -766,8 +768,7 @@ static int axi_jesd204_rx_jesd204_link_enable(struct jesd204_dev *jdev,
 		       __func__, lnk->link_id, ret);
 		return ret;
 	}
-	axi_jesd204_rx_write(jesd, JESD204_RX_REG_SYSREF_STATUS, 0x3);
-	axi_jesd204_rx_write(jesd, JESD204_RX_REG_LINK_DISABLE, 0x0);
+	axi_jesd204_rx_lane_clk_enable(jesd);
 #if 0
 	if (!jesd->irq)
 		schedule_delayed_work(&jesd->watchdog_work, HZ);
@@ -841,6 +842,7 @@ static const struct jesd204_dev_data jesd204_axi_jesd204_rx_init = {
 int32_t axi_jesd204_rx_init_legacy(struct axi_jesd204_rx **jesd204,
 				   const struct jesd204_rx_init *init)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, init->base, 4);
 	struct axi_jesd204_rx *jesd;
 	uint32_t synth_1;
 	uint32_t magic;
@@ -863,7 +865,13 @@ int32_t axi_jesd204_rx_init_legacy(struct axi_jesd204_rx **jesd204,
 		goto err;
 	}
 
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_VERSION, &jesd->version);
+	no_os_axi_io_batch_read(&batch, JESD204_RX_REG_VERSION, &jesd->version);
+	no_os_axi_io_batch_read(&batch, JESD204_RX_REG_SYNTH_NUM_LANES, &jesd->num_lanes);
+	no_os_axi_io_batch_read(&batch, JESD204_RX_REG_SYNTH_DATA_PATH_WIDTH, &tmp);
+	no_os_axi_io_batch_read(&batch, JESD204_RX_REG_SYNTH_REG_1, &synth_1);
+	if (no_os_axi_io_batch_exec(&batch))
+		goto err;
+
 	if (PCORE_VERSION_MAJOR(jesd->version) != 1) {
 		printf("%s: Unsupported peripheral version %"
 		       ""PRIu32".%"PRIu32".%"PRIu32"\n",
@@ -874,13 +882,8 @@ int32_t axi_jesd204_rx_init_legacy(struct axi_jesd204_rx **jesd204,
 		goto err;
 	}
 
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_SYNTH_NUM_LANES,
-			    &jesd->num_lanes);
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_SYNTH_DATA_PATH_WIDTH, &tmp);
 	jesd->data_path_width = 1 << JESD204_SYNTH_DATA_PATH_WIDTH_GET(tmp);
 	jesd->tpl_data_path_width = JESD204_TPL_DATA_PATH_WIDTH_GET(tmp);
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_SYNTH_REG_1,
-			    &synth_1);
 	jesd->encoder = JESD204_RX_ENCODER_GET(synth_1);
 
 	if (jesd->encoder == JESD204_ENCODER_UNKNOWN)
@@ -917,6 +920,7 @@ err:
 int32_t axi_jesd204_rx_init(struct axi_jesd204_rx **jesd204,
 			    const struct jesd204_rx_init *init)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, init->base, 4);
 	struct axi_jesd204_rx_jesd204_priv *priv;
 	struct axi_jesd204_rx *jesd;
 	uint32_t synth_1;
@@ -940,7 +944,13 @@ int32_t axi_jesd204_rx_init(struct axi_jesd204_rx **jesd204,
 		goto err;
 	}
 
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_VERSION, &jesd->version);
+	no_os_axi_io_batch_read(&batch, JESD204_RX_REG_VERSION, &jesd->version);
+	no_os_axi_io_batch_read(&batch, JESD204_RX_REG_SYNTH_NUM_LANES, &jesd->num_lanes);
+	no_os_axi_io_batch_read(&batch, JESD204_RX_REG_SYNTH_DATA_PATH_WIDTH, &tmp);
+	no_os_axi_io_batch_read(&batch, JESD204_RX_REG_SYNTH_REG_1, &synth_1);
+	if (no_os_axi_io_batch_exec(&batch))
+		goto err;
+
 	if (PCORE_VERSION_MAJOR(jesd->version) != 1) {
 		printf("%s: Unsupported peripheral version %"
 		       ""PRIu32".%"PRIu32".%"PRIu32"\n",
@@ -951,13 +961,8 @@ int32_t axi_jesd204_rx_init(struct axi_jesd204_rx **jesd204,
 		goto err;
 	}
 
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_SYNTH_NUM_LANES,
-			    &jesd->num_lanes);
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_SYNTH_DATA_PATH_WIDTH, &tmp);
 	jesd->data_path_width = 1 << JESD204_SYNTH_DATA_PATH_WIDTH_GET(tmp);
 	jesd->tpl_data_path_width = JESD204_TPL_DATA_PATH_WIDTH_GET(tmp);
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_SYNTH_REG_1,
-			    &synth_1);
 	jesd->encoder = JESD204_RX_ENCODER_GET(synth_1);
 
 	if (jesd->encoder == JESD204_ENCODER_UNKNOWN)
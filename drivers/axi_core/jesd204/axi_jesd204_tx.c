@@ -152,10 +152,12 @@ int32_t axi_jesd204_tx_read(struct axi_jesd204_tx *jesd,
  */
 int32_t axi_jesd204_tx_lane_clk_enable(struct axi_jesd204_tx *jesd)
 {
-	axi_jesd204_tx_write(jesd, JESD204_TX_REG_SYSREF_STATUS, 0x3);
-	axi_jesd204_tx_write(jesd, JESD204_TX_REG_LINK_DISABLE, 0x0);
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, jesd->base, 2);
 
-	return 0;
+	no_os_axi_io_batch_write(&batch, JESD204_TX_REG_SYSREF_STATUS, 0x3);
+	no_os_axi_io_batch_write(&batch, JESD204_TX_REG_LINK_DISABLE, 0x0);
+
+	return no_os_axi_io_batch_exec(&batch);
 }
 
 /**
@@ -175,6 +177,7 @@ int32_t axi_jesd204_tx_lane_clk_disable(struct axi_jesd204_tx *jesd)
  */
 uint32_t axi_jesd204_tx_status_read(struct axi_jesd204_tx *jesd)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, jesd->base, 6);
 	uint32_t link_disabled;
 	uint32_t link_status;
 	uint32_t sysref_status;
@@ -186,12 +189,14 @@ uint32_t axi_jesd204_tx_status_read(struct axi_jesd204_tx *jesd)
 	uint32_t lmfc_rate;
 	const char *status;
 
-	axi_jesd204_tx_read(jesd, JESD204_TX_REG_LINK_STATE, &link_disabled);
-	axi_jesd204_tx_read(jesd, JESD204_TX_REG_LINK_STATUS, &link_status);
-	axi_jesd204_tx_read(jesd, JESD204_TX_REG_SYSREF_STATUS, &sysref_status);
-	axi_jesd204_tx_read(jesd, JESD204_TX_REG_LINK_CLK_RATIO, &clock_ratio);
-	axi_jesd204_tx_read(jesd, JESD204_TX_REG_SYSREF_CONF, &sysref_config);
-	axi_jesd204_tx_read(jesd, JESD204_TX_REG_CONF0, &link_config0);
+	no_os_axi_io_batch_read(&batch, JESD204_TX_REG_LINK_STATE, &link_disabled);
+	no_os_axi_io_batch_read(&batch, JESD204_TX_REG_LINK_STATUS, &link_status);
+	no_os_axi_io_batch_read(&batch, JESD204_TX_REG_SYSREF_STATUS, &sysref_status);
+	no_os_axi_io_batch_read(&batch, JESD204_TX_REG_LINK_CLK_RATIO, &clock_ratio);
+	no_os_axi_io_batch_read(&batch, JESD204_TX_REG_SYSREF_CONF, &sysref_config);
+	no_os_axi_io_batch_read(&batch, JESD204_TX_REG_CONF0, &link_config0);
+	if (no_os_axi_io_batch_exec(&batch))
+		return -1;
 
 	printf("%s status:\n", jesd->name);
 
@@ -322,40 +327,30 @@ uint32_t axi_jesd204_tx_calc_ilas_chksum_legacy(const struct jesd204_tx_config
 static void axi_jesd204_tx_set_lane_ilas(struct axi_jesd204_tx *jesd,
 		struct jesd204_link *config, unsigned int lane_id, unsigned int lane)
 {
-	unsigned int i;
-	unsigned int val;
-
-	for (i = 0; i < 4; i++) {
-		switch (i) {
-		case 0:
-			val = config->device_id << 8;
-			val |= config->bank_id << 24;
-			break;
-		case 1:
-			val = lane_id;
-			val |= (config->num_lanes - 1) << 8;
-			val |= config->scrambling << 15;
-			val |= (config->octets_per_frame - 1) << 16;
-			val |= (config->frames_per_multiframe - 1) << 24;
-			break;
-		case 2:
-			val = config->num_converters - 1;
-			val |= (config->converter_resolution - 1) << 8;
-			val |= config->ctrl_bits_per_sample << 14;
-			val |= (config->bits_per_sample - 1) << 16;
-			val |= config->subclass << 21;
-			val |= (config->samples_per_conv_frame ? config->samples_per_conv_frame  - 1 :
-				0) << 24;
-			val |= config->jesd_version << 29;
-			break;
-		case 3:
-			val = config->high_density << 7;
-			val |= axi_jesd204_tx_calc_ilas_chksum(config, lane_id) << 24;
-			break;
-		}
-
-		axi_jesd204_tx_write(jesd, JESD204_TX_REG_ILAS(lane, i), val);
-	}
+	uint32_t val[4];
+
+	val[0] = config->device_id << 8;
+	val[0] |= config->bank_id << 24;
+
+	val[1] = lane_id;
+	val[1] |= (config->num_lanes - 1) << 8;
+	val[1] |= config->scrambling << 15;
+	val[1] |= (config->octets_per_frame - 1) << 16;
+	val[1] |= (config->frames_per_multiframe - 1) << 24;
+
+	val[2] = config->num_converters - 1;
+	val[2] |= (config->converter_resolution - 1) << 8;
+	val[2] |= config->ctrl_bits_per_sample << 14;
+	val[2] |= (config->bits_per_sample - 1) << 16;
+	val[2] |= config->subclass << 21;
+	val[2] |= (config->samples_per_conv_frame ? config->samples_per_conv_frame  - 1 :
+		0) << 24;
+	val[2] |= config->jesd_version << 29;
+
+	val[3] = config->high_density << 7;
+	val[3] |= axi_jesd204_tx_calc_ilas_chksum(config, lane_id) << 24;
+
+	no_os_axi_io_write_multi(jesd->base, JESD204_TX_REG_ILAS(lane, 0), val, 4);
 }
 
 /**
@@ -367,41 +362,31 @@ static void axi_jesd204_tx_set_lane_ilas(struct axi_jesd204_tx *jesd,
 void axi_jesd204_tx_set_lane_ilas_legacy(struct axi_jesd204_tx *jesd,
 		struct jesd204_tx_config *config, uint32_t lane)
 {
-	uint32_t i;
-	uint32_t val;
+	uint32_t val[4];
 
 	config->lane_id = lane;
 
-	for (i = 0; i < 4; i++) {
-		switch (i) {
-		case 0:
-			val = config->device_id << 8;
-			val |= config->bank_id << 24;
-			break;
-		case 1:
-			val = config->lane_id;
-			val |= (config->lanes_per_device - 1) << 8;
-			val |= config->enable_scrambling << 15;
-			val |= (config->octets_per_frame - 1) << 16;
-			val |= (config->frames_per_multiframe - 1) << 24;
-			break;
-		case 2:
-			val = (config->converters_per_device - 1);
-			val |= (config->resolution - 1) << 8;
-			val |= config->control_bits_per_sample << 14;
-			val |= (config->bits_per_sample - 1) << 16;
-			val |= config->subclass_version << 21;
-			val |= (config->samples_per_frame - 1) << 24;
-			val |= config->jesd_version << 29;
-			break;
-		case 3:
-			val = config->high_density << 7;
-			val |= axi_jesd204_tx_calc_ilas_chksum_legacy(config) << 24;
-			break;
-		}
+	val[0] = config->device_id << 8;
+	val[0] |= config->bank_id << 24;
 
-		axi_jesd204_tx_write(jesd, JESD204_TX_REG_ILAS(lane, i), val);
-	}
+	val[1] = config->lane_id;
+	val[1] |= (config->lanes_per_device - 1) << 8;
+	val[1] |= config->enable_scrambling << 15;
+	val[1] |= (config->octets_per_frame - 1) << 16;
+	val[1] |= (config->frames_per_multiframe - 1) << 24;
+
+	val[2] = (config->converters_per_device - 1);
+	val[2] |= (config->resolution - 1) << 8;
+	val[2] |= config->control_bits_per_sample << 14;
+	val[2] |= (config->bits_per_sample - 1) << 16;
+	val[2] |= config->subclass_version << 21;
+	val[2] |= (config->samples_per_frame - 1) << 24;
+	val[2] |= config->jesd_version << 29;
+
+	val[3] = config->high_density << 7;
+	val[3] |= axi_jesd204_tx_calc_ilas_chksum_legacy(config) << 24;
+
+	no_os_axi_io_write_multi(jesd->base, JESD204_TX_REG_ILAS(lane, 0), val, 4);
 }
 
 /**
@@ -647,8 +632,7 @@ static int axi_jesd204_tx_jesd204_clks_enable(struct jesd204_dev *jdev,
 
 	axi_jesd204_tx_write(jesd, JESD204_TX_REG_LINK_DISABLE, 0x1);
 	no_os_udelay(1);
-	axi_jesd204_tx_write(jesd, JESD204_TX_REG_SYSREF_STATUS, 0x3);
-	axi_jesd204_tx_write(jesd, JESD204_TX_REG_LINK_DISABLE, 0x0);
+	axi_jesd204_tx_lane_clk_enable(jesd);
 
 	return JESD204_STATE_CHANGE_DONE;
 }
@@ -735,6 +719,7 @@ static const struct jesd204_dev_data jesd204_axi_jesd204_tx_init = {
 int32_t axi_jesd204_tx_init_legacy(struct axi_jesd204_tx **jesd204,
 				   const struct jesd204_tx_init *init)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, init->base, 4);
 	struct axi_jesd204_tx *jesd;
 	uint32_t synth_1;
 	uint32_t magic;
@@ -758,7 +743,13 @@ int32_t axi_jesd204_tx_init_legacy(struct axi_jesd204_tx **jesd204,
 		goto err;
 	}
 
-	axi_jesd204_tx_read(jesd, JESD204_TX_REG_VERSION, &version);
+	no_os_axi_io_batch_read(&batch, JESD204_TX_REG_VERSION, &version);
+	no_os_axi_io_batch_read(&batch, JESD204_TX_REG_CONF_NUM_LANES, &jesd->num_lanes);
+	no_os_axi_io_batch_read(&batch, JESD204_TX_REG_CONF_DATA_PATH_WIDTH, &tmp);
+	no_os_axi_io_batch_read(&batch, JESD204_TX_REG_SYNTH_REG_1, &synth_1);
+	if (no_os_axi_io_batch_exec(&batch))
+		goto err;
+
 	if (PCORE_VERSION_MAJOR(version) != 1) {
 		printf("%s: Unsupported peripheral version %"
 		       ""PRIu32".%"PRIu32".%"PRIu32"\n",
@@ -769,14 +760,9 @@ int32_t axi_jesd204_tx_init_legacy(struct axi_jesd204_tx **jesd204,
 		goto err;
 	}
 
-	axi_jesd204_tx_read(jesd, JESD204_TX_REG_CONF_NUM_LANES,
-			    &jesd->num_lanes);
-	axi_jesd204_tx_read(jesd, JESD204_TX_REG_CONF_DATA_PATH_WIDTH, &tmp);
 	jesd->data_path_width = 1 << JESD204_SYNTH_DATA_PATH_WIDTH_GET(tmp);
 	jesd->tpl_data_path_width = JESD204_TPL_DATA_PATH_WIDTH_GET(tmp);
 
-	axi_jesd204_tx_read(jesd, JESD204_TX_REG_SYNTH_REG_1,
-			    &synth_1);
 	jesd->encoder = JESD204_TX_ENCODER_GET(synth_1);
 	if (jesd->encoder == JESD204_ENCODER_UNKNOWN)
 		jesd->encoder = JESD204_ENCODER_8B10B;
@@ -825,6 +811,7 @@ err:
 int32_t axi_jesd204_tx_init(struct axi_jesd204_tx **jesd204,
 			    const struct jesd204_tx_init *init)
 {
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, init->base, 4);
 	struct axi_jesd204_tx_jesd204_priv *priv;
 	struct axi_jesd204_tx *jesd;
 	uint32_t synth_1;
@@ -849,7 +836,13 @@ int32_t axi_jesd204_tx_init(struct axi_jesd204_tx **jesd204,
 		goto err;
 	}
 
-	axi_jesd204_tx_read(jesd, JESD204_TX_REG_VERSION, &version);
+	no_os_axi_io_batch_read(&batch, JESD204_TX_REG_VERSION, &version);
+	no_os_axi_io_batch_read(&batch, JESD204_TX_REG_CONF_NUM_LANES, &jesd->num_lanes);
+	no_os_axi_io_batch_read(&batch, JESD204_TX_REG_CONF_DATA_PATH_WIDTH, &tmp);
+	no_os_axi_io_batch_read(&batch, JESD204_TX_REG_SYNTH_REG_1, &synth_1);
+	if (no_os_axi_io_batch_exec(&batch))
+		goto err;
+
 	if (PCORE_VERSION_MAJOR(version) != 1) {
 		printf("%s: Unsupported peripheral version %"
 		       ""PRIu32".%"PRIu32".%"PRIu32"\n",
@@ -860,14 +853,9 @@ int32_t axi_jesd204_tx_init(struct axi_jesd204_tx **jesd204,
 		goto err;
 	}
 
-	axi_jesd204_tx_read(jesd, JESD204_TX_REG_CONF_NUM_LANES,
-			    &jesd->num_lanes);
-	axi_jesd204_tx_read(jesd, JESD204_TX_REG_CONF_DATA_PATH_WIDTH, &tmp);
 	jesd->data_path_width = 1 << JESD204_SYNTH_DATA_PATH_WIDTH_GET(tmp);
 	jesd->tpl_data_path_width = JESD204_TPL_DATA_PATH_WIDTH_GET(tmp);
 
-	axi_jesd204_tx_read(jesd, JESD204_TX_REG_SYNTH_REG_1,
-			    &synth_1);
 	jesd->encoder = JESD204_TX_ENCODER_GET(synth_1);
 	if (jesd->encoder == JESD204_ENCODER_UNKNOWN)
 		jesd->encoder = JESD204_ENCODER_8B10B;
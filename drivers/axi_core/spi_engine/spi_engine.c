@@ -51,6 +51,7 @@ significant delays */
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sleep.h>
 #include <inttypes.h>
 
@@ -80,6 +81,17 @@ const struct no_os_spi_platform_ops spi_eng_platform_ops = {
  */
 static uint8_t _sync_id = 0x01;
 
+/**
+ * @brief Program held by the offload memory of each engine core. The memory
+ * 	belongs to the core, which can be shared by several descriptors, so
+ * 	it is tracked by base address instead of by descriptor.
+ *
+ */
+static struct {
+	uint32_t				base;
+	struct spi_engine_offload_program	*prog;
+} _offload_loaded[SPI_ENGINE_MAX_INSTANCES];
+
 /******************************************************************************/
 /************************** Functions Implementation **************************/
 /******************************************************************************/
@@ -230,162 +242,69 @@ static int32_t spi_get_sleep_div(struct no_os_spi_desc *desc,
 }
 
 /**
- * @brief Create a new commands queue used in a spi transfer
+ * @brief Add an instruction at the end of a program
  *
- * @param fifo Command buffer, usualy used in fifo mode
- * @param cmd Command with wich the buffer will be initiated
- * @return int32_t Failure if the memory allocation failed
+ * @param program The program the instruction is added to
+ * @param cmd Instruction to be added
+ * @return int32_t - 0 if the instruction was added
+ *		   - -EINVAL if the program is full
  */
-static int32_t spi_engine_queue_new_cmd(struct spi_engine_cmd_queue **fifo,
-					uint32_t cmd)
+static int32_t spi_engine_program_add(struct spi_engine_program *program,
+				      uint32_t cmd)
 {
-	struct spi_engine_cmd_queue *local_fifo;
+	if (program->len == SPI_ENGINE_MAX_PROGRAM_LEN)
+		return -EINVAL;
 
-	local_fifo = (spi_engine_cmd_queue*)no_os_malloc(sizeof(*local_fifo));
-
-	if(!local_fifo)
-		return -1;
-
-	local_fifo->cmd = cmd;
-	local_fifo->next = NULL;
-	*fifo = local_fifo;
+	program->cmds[program->len++] = cmd;
 
 	return 0;
 }
 
 /**
- * @brief Add a command at the end of an existing queue
- *
- * @param fifo Command buffer, usualy used in fifo mode
- * @param cmd Command to be added
- */
-static void spi_engine_queue_add_cmd(struct spi_engine_cmd_queue **fifo,
-				     uint32_t cmd)
-{
-	struct spi_engine_cmd_queue *to_add = NULL;
-	struct spi_engine_cmd_queue *local_fifo;
-
-	local_fifo = *fifo;
-	while (local_fifo->next != NULL) {
-		// Get the last element
-		local_fifo = local_fifo->next;
-	}
-
-	// Create a new element
-	spi_engine_queue_new_cmd(&to_add, cmd);
-	// Add as the next element
-	local_fifo->next = to_add;
-}
-
-/**
- * @brief Add a command at the beginning of an existing queue
- *
- * @param fifo Command buffer, usualy used in fifo mode
- * @param cmd Command to be added
- */
-static void spi_engine_queue_append_cmd(struct spi_engine_cmd_queue **fifo,
-					uint32_t cmd)
-{
-	struct spi_engine_cmd_queue *to_add = NULL;
-
-	// Create a new element
-	spi_engine_queue_new_cmd(&to_add, cmd);
-	// Interchange the addresses
-	to_add->next = *fifo;
-	*fifo = to_add;
-}
-
-
-/**
- * @brief Get the command from the beginning of the queue
- *
- * @param fifo Command buffer, usualy used in fifo mode
- * @param cmd Value of the command that was extracted
- * @return int32_t Return -1 if the queue is empty
- */
-static int32_t spi_engine_queue_get_cmd(struct spi_engine_cmd_queue **fifo,
-					uint32_t *cmd)
-{
-	struct spi_engine_cmd_queue *local_fifo;
-
-	if (!*fifo)
-		return -1;
-
-	local_fifo = *fifo;
-	*cmd = local_fifo->cmd;
-	if ((*fifo)->next) {
-		*fifo = local_fifo->next;
-		no_os_free(local_fifo);
-	} else {
-		no_os_free(*fifo);
-		*fifo = NULL;
-	}
-
-	return 0;
-}
-
-/**
- * @brief Free the memory allocated by a queue
- *
- * @param fifo The queue that needs it's memory freed
- * @return int32_t This function allways returns 0
- */
-static int32_t spi_engine_queue_no_os_free(struct spi_engine_cmd_queue **fifo)
-{
-	if(*fifo && (*fifo)->next)
-		spi_engine_queue_no_os_free(&(*fifo)->next);
-	if((*fifo) != NULL) {
-		no_os_free(*fifo);
-		*fifo = NULL;
-	}
-
-	return 0;
-}
-
-/**
- * @brief Write the SPI engine's command fifo
+ * @brief Write a number of words in one of the SPI engine's fifos or
+ * 	offload memories
  *
  * @param desc Decriptor containing SPI Engine's parameters
- * @param cmd The command that will be written
- * @return int32_t Returns -1 if the the axi transfer failed
+ * @param reg_addr The address of the fifo register
+ * @param data Words that will be written
+ * @param len Number of words
+ * @return int32_t - 0 if the words were written
+ *		   - negative error code if the axi transfer failed
  */
-static int32_t spi_engine_write_cmd_reg(struct spi_engine_desc *desc,
-					uint32_t cmd)
+static int32_t spi_engine_write_fifo(struct spi_engine_desc *desc,
+				     uint32_t reg_addr,
+				     const uint32_t *data,
+				     uint32_t len)
 {
-	int32_t ret;
-
-	/* Check if offload is enabled */
-	if(desc->offload_config & (OFFLOAD_TX_EN | OFFLOAD_RX_EN)) {
-		ret = spi_engine_write(desc,
-				       SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
-				       cmd);
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, desc->spi_engine_baseaddr, 16);
+	uint32_t i;
 
-	} else {
-		ret = spi_engine_write(desc,
-				       SPI_ENGINE_REG_CMD_FIFO,
-				       cmd);
-	}
+	for (i = 0; i < len; i++)
+		no_os_axi_io_batch_write(&batch, reg_addr, data[i]);
 
-	return ret;
+	return no_os_axi_io_batch_exec(&batch);
 }
 
 /**
- * @brief Write a transfer command to the SPI engine's command fifo
+ * @brief Compile a transfer command
  *
  * @param desc Decriptor containing SPI Engine's parameters
+ * @param program The program the instruction is added to
  * @param read_write Read/Write operation flag
  * @param bytes_number Number of bytes to transfer
- * @return int32_t This function allways returns 0
+ * @return int32_t - 0 if the instruction was added
+ *		   - -EINVAL if the program is full
  */
-static int32_t spi_engine_transfer(struct spi_engine_desc *desc,
-				   uint8_t read_write,
-				   uint8_t bytes_number)
+static int32_t spi_engine_compile_transfer(struct spi_engine_desc *desc,
+		struct spi_engine_program *program,
+		uint8_t read_write,
+		uint8_t bytes_number)
 {
 	uint8_t words_number;
 
 	words_number = spi_get_words_number(desc, bytes_number);
 
-	desc->offload_tx_len += words_number;
+	program->words += words_number;
 
 	/*
 	 * Engine Wiki:
@@ -395,24 +314,26 @@ static int32_t spi_engine_transfer(struct spi_engine_desc *desc,
 	 * The words number is zero based
 	 */
 
-	spi_engine_write_cmd_reg(desc,
-				 SPI_ENGINE_CMD_TRANSFER(read_write,
-						 words_number  - 1));
-
-	return 0;
+	return spi_engine_program_add(program,
+				      SPI_ENGINE_CMD_TRANSFER(read_write,
+						      words_number - 1));
 }
 
 /**
- * @brief Change the state of the chip select port
+ * @brief Compile a change of the chip select port state
  *
  * @param desc Decriptor containing SPI interface parameters
+ * @param program The program the instruction is added to
  * @param assert Chip select state.
  * 		 The supported values are :
  * 			-true (HIGH)
  * 			-false (LOW)
+ * @return int32_t - 0 if the instruction was added
+ *		   - -EINVAL if the program is full
  */
-static void spi_engine_set_cs(struct no_os_spi_desc *desc,
-			      bool assert)
+static int32_t spi_engine_compile_cs(struct no_os_spi_desc *desc,
+				     struct spi_engine_program *program,
+				     bool assert)
 {
 	uint8_t			mask;
 	struct spi_engine_desc	*eng_desc;
@@ -424,40 +345,44 @@ static void spi_engine_set_cs(struct no_os_spi_desc *desc,
 	if (!assert)
 		mask ^= NO_OS_BIT(desc->chip_select);
 
-	spi_engine_write_cmd_reg(eng_desc,
-				 SPI_ENGINE_CMD_ASSERT(eng_desc->cs_delay,
-						 mask));
+	return spi_engine_program_add(program,
+				      SPI_ENGINE_CMD_ASSERT(eng_desc->cs_delay,
+						      mask));
 }
 
 /**
- * @brief Add a delay bewtheen the engine commands
+ * @brief Compile a delay bewtheen the engine commands
  *
  * @param desc Decriptor containing SPI interface parameters
+ * @param program The program the instruction is added to
  * @param sleep_time_ns Number of nanoseconds to sleep between commands
+ * @return int32_t - 0 if the instruction was added
+ *		   - -EINVAL if the program is full
  */
-static void spi_gen_sleep_ns(struct no_os_spi_desc *desc,
-			     uint32_t sleep_time_ns)
+static int32_t spi_engine_compile_sleep(struct no_os_spi_desc *desc,
+					struct spi_engine_program *program,
+					uint32_t sleep_time_ns)
 {
-	uint32_t 		sleep_div;
-	struct spi_engine_desc	*eng_desc;
-
-	eng_desc = desc->extra;
+	uint32_t sleep_div;
 
 	spi_get_sleep_div(desc, sleep_time_ns, &sleep_div);
 
-	spi_engine_write_cmd_reg(eng_desc, SPI_ENGINE_CMD_SLEEP(sleep_div));
+	return spi_engine_program_add(program, SPI_ENGINE_CMD_SLEEP(sleep_div));
 }
 
 /**
  * @brief Spi engine command interpreter
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param cmd Command to send to the engine
- * @return int32_t - 0 if the command is transfered
- *		   - -1 if the command format is invalid
+ * @param program The program the instructions are added to
+ * @param cmd Command to be compiled
+ * @return int32_t - 0 if the command was compiled
+ *		   - -EINVAL if the command format is invalid or the program
+ *		   is full
  */
-static int32_t spi_engine_write_cmd(struct no_os_spi_desc *desc,
-				    uint32_t cmd)
+static int32_t spi_engine_compile_cmd(struct no_os_spi_desc *desc,
+				      struct spi_engine_program *program,
+				      uint32_t cmd)
 {
 	uint8_t				engine_command;
 	uint8_t				parameter;
@@ -472,16 +397,16 @@ static int32_t spi_engine_write_cmd(struct no_os_spi_desc *desc,
 
 	switch(engine_command) {
 	case SPI_ENGINE_INST_TRANSFER:
-		spi_engine_transfer(desc_extra, modifier, parameter);
-		break;
+		return spi_engine_compile_transfer(desc_extra, program,
+						   modifier, parameter);
 
 	case SPI_ENGINE_INST_ASSERT:
 		if(parameter == 0xFF) {
 			/* Set the CS HIGH */
-			spi_engine_set_cs(desc, true);
+			return spi_engine_compile_cs(desc, program, true);
 		} else if(parameter == 0x00) {
 			/* Set the CS LOW */
-			spi_engine_set_cs(desc, false);
+			return spi_engine_compile_cs(desc, program, false);
 		}
 		break;
 
@@ -490,50 +415,37 @@ static int32_t spi_engine_write_cmd(struct no_os_spi_desc *desc,
 	case SPI_ENGINE_INST_SYNC_SLEEP:
 		/* SYNC instruction */
 		if(modifier == 0x00) {
-			spi_engine_write_cmd_reg(desc_extra, cmd);
+			return spi_engine_program_add(program, cmd);
 		} else if(modifier == 0x01) {
-			spi_gen_sleep_ns(desc, parameter);
+			return spi_engine_compile_sleep(desc, program,
+							parameter);
 		}
 		break;
 	case SPI_ENGINE_INST_CONFIG:
-		spi_engine_write_cmd_reg(desc_extra, cmd);
-
-		break;
+		return spi_engine_program_add(program, cmd);
 
 	default:
 
-		return -1;
+		return -EINVAL;
 	}
 
 	return 0;
 }
 
 /**
- * @brief Prepare the command queue before sending it to the engine
+ * @brief Compile the configuration instructions every program starts with
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param msg Structure used to store the transfer messages
- * @return int32_t This function allways returns 0
+ * @param program The program the instructions are added to
  */
-static int32_t spi_engine_compile_message(struct no_os_spi_desc *desc,
-		struct spi_engine_msg *msg)
+static void spi_engine_compile_config(struct no_os_spi_desc *desc,
+				      struct spi_engine_program *program)
 {
 	struct spi_engine_desc	*desc_extra;
 	uint8_t cfg_reg;
 
 	desc_extra = desc->extra;
 
-	/* Configure the prescaler */
-	spi_engine_queue_append_cmd(&msg->cmds,
-				    SPI_ENGINE_CMD_CONFIG(
-					    SPI_ENGINE_CMD_REG_CLK_DIV,
-					    desc_extra->clk_div));
-
-	/* Set the data transfer length */
-	spi_engine_queue_append_cmd(&msg->cmds,
-				    SPI_ENGINE_CMD_CONFIG(
-					    SPI_ENGINE_CMD_DATA_TRANSFER_LEN,
-					    desc_extra->data_width));
 	/*
 	 * Configure the spi mode :
 	 * 	- sdo_idle_state
@@ -545,80 +457,104 @@ static int32_t spi_engine_compile_message(struct no_os_spi_desc *desc,
 	if (desc_extra->sdo_idle_state != 0)
 		cfg_reg |= SPI_ENGINE_CONFIG_SDO_IDLE;
 
-	spi_engine_queue_append_cmd(&msg->cmds,
-				    SPI_ENGINE_CMD_CONFIG(
-					    SPI_ENGINE_CMD_REG_CONFIG,
-					    cfg_reg));
+	spi_engine_program_add(program,
+			       SPI_ENGINE_CMD_CONFIG(SPI_ENGINE_CMD_REG_CONFIG,
+					       cfg_reg));
 
-	/* Add a sync command to signal that the transfer has finished */
-	spi_engine_queue_add_cmd(&msg->cmds, SPI_ENGINE_CMD_SYNC(_sync_id));
+	/* Set the data transfer length */
+	spi_engine_program_add(program,
+			       SPI_ENGINE_CMD_CONFIG(
+				       SPI_ENGINE_CMD_DATA_TRANSFER_LEN,
+				       desc_extra->data_width));
 
-	return 0;
+	/* Configure the prescaler */
+	spi_engine_program_add(program,
+			       SPI_ENGINE_CMD_CONFIG(SPI_ENGINE_CMD_REG_CLK_DIV,
+					       desc_extra->clk_div));
 }
 
 /**
- * @brief Initiate a spi transfer
+ * @brief Compile a message into the engine instructions that have to be
+ * 	written to the command fifo or to the offload command memory. The
+ * 	program can be replayed as long as the transfer settings are not
+ * 	changed.
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param msg Structure used to store the transfer messages
- * @return int32_t - 0 if the transfer finished
- *		   - -1 if the memory allocation failed
+ * @param cmds Message commands
+ * @param no_commands Number of message commands
+ * @param program The compiled program
+ * @return int32_t - 0 if the message was compiled
+ *		   - -EINVAL if a command is invalid or the program does not
+ *		   fit in SPI_ENGINE_MAX_PROGRAM_LEN instructions
  */
-static int32_t spi_engine_transfer_message(struct no_os_spi_desc *desc,
-		struct spi_engine_msg *msg)
+int32_t spi_engine_compile_message(struct no_os_spi_desc *desc,
+				   const uint32_t *cmds,
+				   uint32_t no_commands,
+				   struct spi_engine_program *program)
 {
-	uint32_t		i;
-	uint32_t		data;
-	uint32_t		sync_id;
-	bool 			offload_en;
-	struct spi_engine_desc	*desc_extra;
-
-	desc_extra = desc->extra;
+	uint32_t i;
+	int32_t ret;
 
-	spi_engine_compile_message(desc, msg);
+	program->len = 0;
+	program->words = 0;
 
-	offload_en = (desc_extra->offload_config & OFFLOAD_TX_EN) |
-		     (desc_extra->offload_config & OFFLOAD_RX_EN);
+	spi_engine_compile_config(desc, program);
 
-	/* Write the command fifo buffer */
-	while(msg->cmds != NULL) {
-		spi_engine_queue_get_cmd(&msg->cmds, &data);
-		spi_engine_write_cmd(desc, data);
+	for (i = 0; i < no_commands; i++) {
+		ret = spi_engine_compile_cmd(desc, program, cmds[i]);
+		if (ret)
+			return ret;
 	}
 
-	/* Write a number of tx_length WORDS on the SDO line */
+	/* Add a sync command to signal that the transfer has finished */
+	return spi_engine_program_add(program, SPI_ENGINE_CMD_SYNC(_sync_id));
+}
 
-	if(offload_en) {
-		for(i = 0; i < desc_extra->offload_tx_len; i++)
-			spi_engine_write(desc_extra,
-					 SPI_ENGINE_REG_OFFLOAD_SDO_MEM(0),
-					 msg->tx_buf[i]);
+/**
+ * @brief Get the program held by the offload memory of an engine core
+ *
+ * @param base Base address of the engine core
+ * @return struct spi_engine_offload_program* The program, NULL if unknown
+ */
+static struct spi_engine_offload_program *spi_engine_offload_loaded(
+	uint32_t base)
+{
+	uint32_t i;
 
-	} else {
-		for(i = 0; i < msg->length; i++)
-			spi_engine_write(desc_extra,
-					 SPI_ENGINE_REG_SDO_DATA_FIFO,
-					 msg->tx_buf[i]);
-		do {
-			spi_engine_read(desc_extra,
-					SPI_ENGINE_REG_SYNC_ID,
-					&sync_id);
-		}
-		/* Wait for the end sync signal */
-		while(sync_id != _sync_id);
-		_sync_id++;
-
-		/* Read a number of rx_length WORDS from the SDI line and store
-		them */
-		for(i = 0; i < msg->length; i++) {
-			spi_engine_read(desc_extra,
-					SPI_ENGINE_REG_SDI_DATA_FIFO,
-					&data);
-			msg->rx_buf[i] = data;
+	for (i = 0; i < SPI_ENGINE_MAX_INSTANCES; i++)
+		if (_offload_loaded[i].prog && _offload_loaded[i].base == base)
+			return _offload_loaded[i].prog;
+
+	return NULL;
+}
+
+/**
+ * @brief Record the program held by the offload memory of an engine core.
+ * 	If all the slots are used, the program is not recorded and the
+ * 	offload memory is rewritten on the next transfer.
+ *
+ * @param base Base address of the engine core
+ * @param prog The program, NULL if the content is unknown
+ */
+static void spi_engine_offload_set_loaded(uint32_t base,
+		struct spi_engine_offload_program *prog)
+{
+	uint32_t i;
+	int32_t free_slot = -1;
+
+	for (i = 0; i < SPI_ENGINE_MAX_INSTANCES; i++) {
+		if (_offload_loaded[i].prog && _offload_loaded[i].base == base) {
+			_offload_loaded[i].prog = prog;
+			return;
 		}
+		if (!_offload_loaded[i].prog && free_slot < 0)
+			free_slot = i;
 	}
 
-	return 0;
+	if (prog && free_slot >= 0) {
+		_offload_loaded[free_slot].base = base;
+		_offload_loaded[free_slot].prog = prog;
+	}
 }
 
 /**
@@ -647,7 +583,7 @@ int32_t spi_engine_init(struct no_os_spi_desc **desc,
 		return -1;
 	}
 
-	eng_desc = (struct spi_engine_desc*)no_os_malloc(sizeof(*eng_desc));
+	eng_desc = (struct spi_engine_desc*)no_os_calloc(1, sizeof(*eng_desc));
 
 	if (!eng_desc)
 		return -1;
@@ -667,6 +603,9 @@ int32_t spi_engine_init(struct no_os_spi_desc **desc,
 	eng_desc->clk_div =  eng_desc->ref_clk_hz /
 			     (2 * param->max_speed_hz) - 1;
 
+	/* The reset clears the offload memories */
+	spi_engine_offload_set_loaded(eng_desc->spi_engine_baseaddr, NULL);
+
 	/* Perform a reset */
 	spi_engine_write(eng_desc, SPI_ENGINE_REG_RESET, 0x01);
 	usleep(1000);
@@ -698,21 +637,29 @@ int32_t spi_engine_init(struct no_os_spi_desc **desc,
  * @param data Pointer to data buffer
  * @param bytes_number Number of bytes to transfer
  * @return int32_t - 0 if the transfer finished
- *		   - -1 if the memory allocation or transfer failed
+ *		   - negative error code if the transfer failed
  */
 int32_t spi_engine_write_and_read(struct no_os_spi_desc *desc,
 				  uint8_t *data,
 				  uint16_t bytes_number)
 {
-	uint8_t 		i;
-	uint8_t 		word_len;
-	uint8_t 		words_number;
-	int32_t 		ret;
-	struct spi_engine_msg	msg;
-	struct spi_engine_desc	*desc_extra;
+	uint32_t 			i;
+	uint32_t 			j;
+	uint32_t			word;
+	uint32_t			sync_id;
+	uint32_t			cmds[4];
+	uint8_t 			word_len;
+	uint8_t 			words_number;
+	int32_t 			ret;
+	struct spi_engine_program	program;
+	struct spi_engine_desc		*desc_extra;
 
 	desc_extra = desc->extra;
 
+	/* The engine is used by a continuous capture */
+	if (desc_extra->stream.buf)
+		return -EBUSY;
+
 	/* If we want to access SPI interface and SPI engine offload module was
 	 * activated, we need to disable it
 	 * This is set in spi_engine_offload_init() */
@@ -722,41 +669,86 @@ int32_t spi_engine_write_and_read(struct no_os_spi_desc *desc,
 
 	words_number = spi_get_words_number(desc_extra, bytes_number);
 
-	msg.cmds = (spi_engine_cmd_queue*)no_os_malloc(sizeof(*msg.cmds));
-	if (!msg.cmds)
-		return -1;
-
-	msg.tx_buf =(uint32_t*)no_os_calloc(words_number, sizeof(msg.tx_buf[0]));
-	msg.rx_buf =(uint32_t*)no_os_calloc(words_number, sizeof(msg.rx_buf[0]));
-	msg.length = words_number;
-
 	/* Get the length of transfered word */
 	word_len = spi_get_word_lenght(desc_extra);
 
 	/* Make sure the CS is HIGH before starting a transaction */
-	msg.cmds->next = NULL;
-	msg.cmds->cmd = CS_HIGH;
-	spi_engine_queue_add_cmd(&msg.cmds, CS_LOW);
-	spi_engine_queue_add_cmd(&msg.cmds, WRITE_READ(bytes_number));
-	spi_engine_queue_add_cmd(&msg.cmds, CS_HIGH);
+	cmds[0] = CS_HIGH;
+	cmds[1] = CS_LOW;
+	cmds[2] = WRITE_READ(bytes_number);
+	cmds[3] = CS_HIGH;
 
-	/* Pack the bytes into engine WORDS */
-	for (i = 0; i < bytes_number; i++)
-		msg.tx_buf[i / word_len] |= data[i] << (desc_extra->data_width-
-							(i % word_len + 1) * 8);
+	ret = spi_engine_compile_message(desc, cmds, NO_OS_ARRAY_SIZE(cmds),
+					 &program);
+	if (ret)
+		return ret;
 
-	ret = spi_engine_transfer_message(desc, &msg);
+	/* Write the command fifo buffer */
+	ret = spi_engine_write_fifo(desc_extra, SPI_ENGINE_REG_CMD_FIFO,
+				    program.cmds, program.len);
+	if (ret)
+		return ret;
+
+	/* Pack the bytes into engine WORDS and write them on the SDO line */
+	for (i = 0; i < words_number; i++) {
+		word = 0;
+		for (j = 0; j < word_len && i * word_len + j < bytes_number; j++)
+			word |= data[i * word_len + j] <<
+				(desc_extra->data_width - (j + 1) * 8);
+		spi_engine_write(desc_extra, SPI_ENGINE_REG_SDO_DATA_FIFO, word);
+	}
 
-	for (i = 0; i < bytes_number; i++)
-		data[i] = msg.rx_buf[(i) / word_len] >>
-			  (desc_extra->data_width -
-			   ((i) % word_len + 1) * 8);
+	do {
+		spi_engine_read(desc_extra, SPI_ENGINE_REG_SYNC_ID, &sync_id);
+	}
+	/* Wait for the end sync signal */
+	while(sync_id != _sync_id);
+	_sync_id++;
+
+	/* Read the WORDS from the SDI line and unpack them */
+	for (i = 0; i < words_number; i++) {
+		spi_engine_read(desc_extra, SPI_ENGINE_REG_SDI_DATA_FIFO, &word);
+		for (j = 0; j < word_len && i * word_len + j < bytes_number; j++)
+			data[i * word_len + j] = word >>
+						 (desc_extra->data_width -
+						  (j + 1) * 8);
+	}
 
-	spi_engine_queue_no_os_free(&msg.cmds);
-	no_os_free(msg.tx_buf);
-	no_os_free(msg.rx_buf);
+	return 0;
+}
 
-	return ret;
+/**
+ * @brief Initialize a DMAC used by the offload module. A DMAC that was
+ * 	already initialized for the same core and IRQ mode is kept.
+ *
+ * @param dmac The DMAC
+ * @param name Name of the DMAC
+ * @param base Base address where the DMAC core is situated
+ * @param irq_option Whether the DMAC interrupt is serviced
+ * @return int32_t - 0 if the DMAC was initialized
+ *		   - -1 if the initialization failed
+ */
+static int32_t spi_engine_offload_dma_init(struct axi_dmac **dmac,
+		const char *name,
+		uint32_t base,
+		enum use_irq irq_option)
+{
+	struct axi_dmac_init dmac_init = {
+		.name = name,
+		.base = base,
+		.irq_option = irq_option,
+	};
+
+	if (*dmac && (*dmac)->base == base &&
+	    (*dmac)->irq_option == irq_option)
+		return 0;
+
+	if (*dmac) {
+		axi_dmac_remove(*dmac);
+		*dmac = NULL;
+	}
+
+	return axi_dmac_init(dmac, &dmac_init);
 }
 
 /**
@@ -764,13 +756,13 @@ int32_t spi_engine_write_and_read(struct no_os_spi_desc *desc,
  *
  * @param desc Decriptor containing SPI interface parameters
  * @param param Structure containing the offload init parameters
- * @return int32_t This function allways returns 0
+ * @return int32_t - 0 if the offload module was initialized
+ *		   - -1 if the DMAC initialization failed
  */
 int32_t spi_engine_offload_init(struct no_os_spi_desc *desc,
 				const struct spi_engine_offload_init_param *param)
 {
 	struct spi_engine_desc	*eng_desc;
-	struct axi_dmac_init	dmac_init;
 
 	eng_desc = desc->extra;
 
@@ -785,19 +777,18 @@ int32_t spi_engine_offload_init(struct no_os_spi_desc *desc,
 			eng_desc->cyclic = NO;
 	}
 
-	dmac_init.irq_option = IRQ_DISABLED;
 	if(param->offload_config & OFFLOAD_TX_EN) {
-		dmac_init.name = "DAC DMAC";
-		dmac_init.base = param->tx_dma_baseaddr;
-		axi_dmac_init(&eng_desc->offload_tx_dma, &dmac_init);
-		if(!eng_desc->offload_tx_dma)
+		if (spi_engine_offload_dma_init(&eng_desc->offload_tx_dma,
+						"DAC DMAC",
+						param->tx_dma_baseaddr,
+						param->irq_option))
 			return -1;
 	}
 	if(param->offload_config & OFFLOAD_RX_EN) {
-		dmac_init.name = "ADC DMAC";
-		dmac_init.base = param->rx_dma_baseaddr;
-		axi_dmac_init(&eng_desc->offload_rx_dma, &dmac_init);
-		if(!eng_desc->offload_rx_dma)
+		if (spi_engine_offload_dma_init(&eng_desc->offload_rx_dma,
+						"ADC DMAC",
+						param->rx_dma_baseaddr,
+						param->irq_option))
 			return -1;
 	}
 
@@ -805,20 +796,222 @@ int32_t spi_engine_offload_init(struct no_os_spi_desc *desc,
 }
 
 /**
- * @brief Initiate a SPI transfer in offload mode
+ * @brief Get the compiled program of an offload message. The programs are
+ * 	looked up by the message commands and the transfer settings they were
+ * 	compiled for. If none matches, the least recently used one is
+ * 	replaced.
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param msg Offload message
+ * @return struct spi_engine_offload_program* The program, NULL if the
+ * 	message could not be compiled
+ */
+static struct spi_engine_offload_program *
+spi_engine_offload_get_program(struct no_os_spi_desc *desc,
+			       const struct spi_engine_offload_message *msg)
+{
+	struct spi_engine_offload_program	*prog;
+	struct spi_engine_offload_program	*lru = NULL;
+	struct spi_engine_desc			*eng_desc;
+	uint32_t				i;
+
+	eng_desc = desc->extra;
+
+	if (msg->no_commands + SPI_ENGINE_PROGRAM_OVERHEAD >
+	    SPI_ENGINE_MAX_PROGRAM_LEN)
+		return NULL;
+
+	for (i = 0; i < SPI_ENGINE_OFFLOAD_CACHE_SIZE; i++) {
+		prog = &eng_desc->offload_cache[i];
+		if (prog->program.len &&
+		    prog->no_commands == msg->no_commands &&
+		    prog->clk_div == eng_desc->clk_div &&
+		    prog->max_speed_hz == desc->max_speed_hz &&
+		    prog->data_width == eng_desc->data_width &&
+		    prog->mode == desc->mode &&
+		    prog->chip_select == desc->chip_select &&
+		    prog->cs_delay == eng_desc->cs_delay &&
+		    prog->sdo_idle_state == eng_desc->sdo_idle_state &&
+		    !memcmp(prog->msg_cmds, msg->commands,
+			    msg->no_commands * sizeof(msg->commands[0]))) {
+			prog->last_use = ++eng_desc->offload_use;
+			return prog;
+		}
+
+		if (!lru || prog->last_use < lru->last_use)
+			lru = prog;
+	}
+
+	if (spi_engine_offload_loaded(eng_desc->spi_engine_baseaddr) == lru)
+		spi_engine_offload_set_loaded(eng_desc->spi_engine_baseaddr, NULL);
+
+	if (spi_engine_compile_message(desc, msg->commands, msg->no_commands,
+				       &lru->program)) {
+		lru->program.len = 0;
+		return NULL;
+	}
+
+	memcpy(lru->msg_cmds, msg->commands,
+	       msg->no_commands * sizeof(msg->commands[0]));
+	lru->no_commands = msg->no_commands;
+	lru->clk_div = eng_desc->clk_div;
+	lru->max_speed_hz = desc->max_speed_hz;
+	lru->data_width = eng_desc->data_width;
+	lru->mode = desc->mode;
+	lru->chip_select = desc->chip_select;
+	lru->cs_delay = eng_desc->cs_delay;
+	lru->sdo_idle_state = eng_desc->sdo_idle_state;
+	lru->last_use = ++eng_desc->offload_use;
+
+	return lru;
+}
+
+/**
+ * @brief Compile an offload message that does not fit in a cached program
+ * 	and write it in the offload command memory, in chunks of
+ * 	SPI_ENGINE_MAX_PROGRAM_LEN instructions.
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param msg Offload message
+ * @param words Number of words moved by the message
+ * @return int32_t - 0 if the program was written
+ *		   - negative error code otherwise
+ */
+static int32_t spi_engine_offload_write_program(struct no_os_spi_desc *desc,
+		const struct spi_engine_offload_message *msg,
+		uint32_t *words)
+{
+	struct spi_engine_program	program;
+	struct spi_engine_desc		*eng_desc;
+	uint32_t			i;
+	int32_t				ret;
+
+	eng_desc = desc->extra;
+
+	program.len = 0;
+	program.words = 0;
+
+	spi_engine_compile_config(desc, &program);
+
+	/* Each message command is compiled into a single instruction */
+	for (i = 0; i <= msg->no_commands; i++) {
+		if (program.len == SPI_ENGINE_MAX_PROGRAM_LEN) {
+			ret = spi_engine_write_fifo(eng_desc,
+						    SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
+						    program.cmds, program.len);
+			if (ret)
+				return ret;
+			program.len = 0;
+		}
+
+		if (i == msg->no_commands)
+			/* Add a sync command to signal that the transfer has
+			finished */
+			ret = spi_engine_program_add(&program,
+						     SPI_ENGINE_CMD_SYNC(_sync_id));
+		else
+			ret = spi_engine_compile_cmd(desc, &program,
+						     msg->commands[i]);
+		if (ret)
+			return ret;
+	}
+
+	*words = program.words;
+
+	return spi_engine_write_fifo(eng_desc, SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
+				     program.cmds, program.len);
+}
+
+/**
+ * @brief Write the program and the data of an offload message in the offload
+ * 	memories, unless they already hold them. Messages longer than
+ * 	SPI_ENGINE_MAX_PROGRAM_LEN - SPI_ENGINE_PROGRAM_OVERHEAD commands are
+ * 	not cached and are written on every call.
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param msg Offload message
+ * @param words Number of words moved by the message
+ * @return int32_t - 0 if the offload memories hold the message
+ *		   - negative error code otherwise
+ */
+static int32_t spi_engine_offload_load(struct no_os_spi_desc *desc,
+				       const struct spi_engine_offload_message *msg,
+				       uint32_t *words)
+{
+	struct spi_engine_offload_program	*prog;
+	struct spi_engine_desc			*eng_desc;
+	uint32_t				base;
+	int32_t					ret;
+
+	eng_desc = desc->extra;
+	base = eng_desc->spi_engine_baseaddr;
+
+	if (msg->no_commands + SPI_ENGINE_PROGRAM_OVERHEAD >
+	    SPI_ENGINE_MAX_PROGRAM_LEN) {
+		prog = NULL;
+	} else {
+		prog = spi_engine_offload_get_program(desc, msg);
+		if (!prog)
+			return -EINVAL;
+
+		/* Write a number of tx_length WORDS on the SDO line */
+		*words = prog->program.words;
+
+		if (spi_engine_offload_loaded(base) == prog &&
+		    *words <= SPI_ENGINE_MAX_PROGRAM_LEN &&
+		    !memcmp(eng_desc->offload_sdo, msg->commands_data,
+			    *words * sizeof(msg->commands_data[0])))
+			return 0;
+	}
+
+	spi_engine_offload_set_loaded(base, NULL);
+
+	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_RESET(0), 1);
+	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_RESET(0), 0);
+
+	if (prog)
+		ret = spi_engine_write_fifo(eng_desc,
+					    SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
+					    prog->program.cmds,
+					    prog->program.len);
+	else
+		ret = spi_engine_offload_write_program(desc, msg, words);
+	if (ret)
+		return ret;
+
+	ret = spi_engine_write_fifo(eng_desc, SPI_ENGINE_REG_OFFLOAD_SDO_MEM(0),
+				    msg->commands_data, *words);
+	if (ret)
+		return ret;
+
+	if (prog && *words <= SPI_ENGINE_MAX_PROGRAM_LEN) {
+		memcpy(eng_desc->offload_sdo, msg->commands_data,
+		       *words * sizeof(msg->commands_data[0]));
+		spi_engine_offload_set_loaded(base, prog);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Initiate a SPI transfer in offload mode. The offload memories are
+ * 	written only if they do not already hold the message program and data.
+ * 	The function returns when the RX DMA transfer, or the TX DMA transfer
+ * 	if it is not cyclic, is done. The offload module is stopped once the RX
+ * 	transfer is done.
  *
  * @param desc Decriptor containing SPI interface parameters
  * @param msg Offload message that get's to be transferred
  * @param no_samples Number of time the messages will be transferred
- * @return int32_t This function allways returns 0
+ * @return int32_t - 0 if the transfer finished
+ *		   - negative error code otherwise
  */
 int32_t spi_engine_offload_transfer(struct no_os_spi_desc *desc,
 				    struct spi_engine_offload_message msg,
 				    uint32_t no_samples)
 {
-	struct spi_engine_msg	transfer;
 	struct spi_engine_desc	*eng_desc;
-	uint32_t 		i;
+	uint32_t		words;
 	int32_t			ret;
 
 	eng_desc = desc->extra;
@@ -828,30 +1021,16 @@ int32_t spi_engine_offload_transfer(struct no_os_spi_desc *desc,
 	     (eng_desc->offload_config & OFFLOAD_RX_EN)))
 		return -1;
 
-	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_RESET(0), 1);
-	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_RESET(0), 0);
+	/* The offload module is used by a continuous capture */
+	if (eng_desc->stream.buf)
+		return -EBUSY;
 
-	eng_desc->offload_tx_len = 0;
-	eng_desc->offload_rx_len = 0;
-
-	transfer.cmds = (spi_engine_cmd_queue*)no_os_malloc(sizeof(*transfer.cmds));
-
-	if (!transfer.cmds)
-		return -1;
-
-	transfer.tx_buf = msg.commands_data;
-
-	/* Load the commands into the message */
-	transfer.cmds->next = NULL;
-	transfer.cmds->cmd = msg.commands[0];
-	i = 1;
-	while(i < msg.no_commands) {
-		spi_engine_queue_add_cmd(&transfer.cmds, msg.commands[i++]);
-
-	}
+	ret = spi_engine_offload_load(desc, &msg, &words);
+	if (ret)
+		return ret;
 
-	ret = 0;
-	spi_engine_transfer_message(desc, &transfer);
+	eng_desc->offload_tx_len = words;
+	eng_desc->offload_rx_len = 0;
 
 	/* Start transfer */
 	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0x0001);
@@ -870,7 +1049,15 @@ int32_t spi_engine_offload_transfer(struct no_os_spi_desc *desc,
 		};
 		ret = axi_dmac_transfer_start(eng_desc->offload_tx_dma, &tx_transfer);
 		if (ret)
-			goto error;
+			return ret;
+
+		if (!(eng_desc->offload_config & OFFLOAD_RX_EN) &&
+		    eng_desc->cyclic == NO) {
+			ret = axi_dmac_transfer_wait_completion(
+				      eng_desc->offload_tx_dma, 500);
+			if (ret)
+				return ret;
+		}
 	}
 
 	if(eng_desc->offload_config & OFFLOAD_RX_EN) {
@@ -888,18 +1075,147 @@ int32_t spi_engine_offload_transfer(struct no_os_spi_desc *desc,
 		};
 		ret = axi_dmac_transfer_start(eng_desc->offload_rx_dma, &rx_transfer);
 		if (ret)
-			goto error;
+			return ret;
 		ret = axi_dmac_transfer_wait_completion(eng_desc->offload_rx_dma, 500);
 		if (ret)
-			goto error;
+			return ret;
+
+		/* Stop the offload, so no sample is left behind until the next
+		transfer */
+		spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0);
 	}
 
-	usleep(1000);
+	return 0;
+}
+
+/**
+ * @brief Start a continuous capture using the offload module. The message
+ * 	is executed for each trigger and the samples are written by one cyclic
+ * 	DMA transfer in a ring of blocks, which are read with
+ * 	spi_engine_offload_stream_read(). The ring is refilled and the block
+ * 	timestamps are taken from the DMAC ISR, so the RX DMAC must be in
+ * 	IRQ_ENABLED mode and spi_engine_offload_rx_isr() registered.
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param param Structure containing the capture parameters
+ * @return int32_t - 0 if the capture was started
+ *		   - negative error code otherwise
+ */
+int32_t spi_engine_offload_stream_start(struct no_os_spi_desc *desc,
+					const struct spi_engine_offload_stream_param *param)
+{
+	struct axi_dmac_ring_param	ring_param;
+	struct spi_engine_desc		*eng_desc;
+	uint32_t			words;
+	int32_t				ret;
+
+	eng_desc = desc->extra;
+
+	if (!param || !param->msg || !param->samples_per_block ||
+	    param->nb_blocks < 2)
+		return -EINVAL;
 
-error:
-	spi_engine_queue_no_os_free(&transfer.cmds);
+	if (!(eng_desc->offload_config & OFFLOAD_RX_EN) ||
+	    eng_desc->offload_rx_dma->irq_option != IRQ_ENABLED)
+		return -EINVAL;
 
-	return ret;
+	if (eng_desc->stream.buf)
+		return -EBUSY;
+
+	ret = spi_engine_offload_load(desc, param->msg, &words);
+	if (ret)
+		return ret;
+
+	eng_desc->offload_tx_len = words;
+	eng_desc->offload_rx_len = 0;
+
+	ring_param.nb_blocks = param->nb_blocks;
+	ring_param.block_size = eng_desc->offload_rx_dma->width_src * words *
+				param->samples_per_block;
+	ring_param.get_timestamp = param->get_timestamp;
+	ring_param.dcache_invalidate_range = param->dcache_invalidate_range;
+	ret = axi_dmac_ring_start(eng_desc->offload_rx_dma, &eng_desc->stream,
+				  &ring_param);
+	if (ret)
+		return ret;
+
+	/* Start transfer */
+	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0x0001);
+
+	return 0;
+}
+
+/**
+ * @brief Read the oldest block of a continuous capture. If the reader falls
+ * 	more than nb_blocks - 1 blocks behind, the oldest blocks are
+ * 	overwritten by the DMA, skipped and counted as overruns. The blocks
+ * 	dropped while the DMA stalled are counted as overruns too.
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param buf Buffer where the block is copied
+ * @param info Optional, information about the block. The index of its first
+ * 	sample is info->seq * samples_per_block
+ * @param timeout_ms Number of ms to wait for a block
+ * @return int32_t - 0 if a block was read
+ *		   - -ETIMEDOUT if no block was filled in time
+ *		   - negative error code otherwise
+ */
+int32_t spi_engine_offload_stream_read(struct no_os_spi_desc *desc,
+				       void *buf,
+				       struct axi_dmac_block_info *info,
+				       uint32_t timeout_ms)
+{
+	struct spi_engine_desc *eng_desc = desc->extra;
+
+	return axi_dmac_ring_read(eng_desc->offload_rx_dma, &eng_desc->stream,
+				  buf, info, timeout_ms);
+}
+
+/**
+ * @brief Stop a continuous capture and free its DMA ring
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @return int32_t This function allways returns 0
+ */
+int32_t spi_engine_offload_stream_stop(struct no_os_spi_desc *desc)
+{
+	struct spi_engine_desc *eng_desc = desc->extra;
+
+	if (!eng_desc->stream.buf)
+		return 0;
+
+	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0);
+	axi_dmac_ring_stop(eng_desc->offload_rx_dma, &eng_desc->stream);
+
+	return 0;
+}
+
+/**
+ * @brief Interrupt service routine of the offload RX DMAC, to be registered
+ * 	for the DMAC interrupt when it is used in IRQ_ENABLED mode
+ *
+ * @param ctx Decriptor containing SPI interface parameters
+ */
+void spi_engine_offload_rx_isr(void *ctx)
+{
+	struct no_os_spi_desc	*desc = ctx;
+	struct spi_engine_desc	*eng_desc = desc->extra;
+
+	if (eng_desc->offload_rx_dma)
+		axi_dmac_isr(eng_desc->offload_rx_dma);
+}
+
+/**
+ * @brief Get the number of blocks lost by a continuous capture
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @return uint32_t Number of blocks overwritten by the DMA before being read
+ */
+uint32_t spi_engine_offload_stream_get_overruns(struct no_os_spi_desc *desc)
+{
+	struct spi_engine_desc *eng_desc = desc->extra;
+
+	return eng_desc->stream.overruns;
 }
 
 /**
@@ -910,13 +1226,23 @@ error:
  */
 int32_t spi_engine_remove(struct no_os_spi_desc *desc)
 {
-	struct spi_engine_desc	*eng_desc;
+	struct spi_engine_offload_program	*prog;
+	struct spi_engine_desc			*eng_desc;
 
 	eng_desc = desc->extra;
 
-	if(eng_desc->offload_config & OFFLOAD_TX_EN)
+	spi_engine_offload_stream_stop(desc);
+
+	/* Forget the loaded program if it belongs to this descriptor */
+	prog = spi_engine_offload_loaded(eng_desc->spi_engine_baseaddr);
+	if (prog >= eng_desc->offload_cache &&
+	    prog < eng_desc->offload_cache + SPI_ENGINE_OFFLOAD_CACHE_SIZE)
+		spi_engine_offload_set_loaded(eng_desc->spi_engine_baseaddr,
+					      NULL);
+
+	if(eng_desc->offload_tx_dma)
 		axi_dmac_remove(eng_desc->offload_tx_dma);
-	if(eng_desc->offload_config & OFFLOAD_RX_EN)
+	if(eng_desc->offload_rx_dma)
 		axi_dmac_remove(eng_desc->offload_rx_dma);
 	no_os_free(desc->extra);
 	no_os_free(desc);
@@ -925,6 +1251,8 @@ int32_t spi_engine_remove(struct no_os_spi_desc *desc)
 }
 
 #else
+#include "no_os_error.h"
+
 int32_t spi_engine_write(struct spi_engine_desc *desc,
 			 uint32_t reg_addr,
 			 uint32_t reg_data)
@@ -963,6 +1291,14 @@ int32_t spi_engine_offload_init(struct no_os_spi_desc *desc,
 	return 0;
 }
 
+int32_t spi_engine_compile_message(struct no_os_spi_desc *desc,
+				   const uint32_t *cmds,
+				   uint32_t no_commands,
+				   struct spi_engine_program *program)
+{
+	return -ENOSYS;
+}
+
 int32_t spi_engine_offload_transfer(struct no_os_spi_desc *desc,
 				    struct spi_engine_offload_message msg,
 				    uint32_t no_samples)
@@ -970,6 +1306,32 @@ int32_t spi_engine_offload_transfer(struct no_os_spi_desc *desc,
 	return 0;
 }
 
+int32_t spi_engine_offload_stream_start(struct no_os_spi_desc *desc,
+					const struct spi_engine_offload_stream_param *param)
+{
+	return -ENOSYS;
+}
+
+int32_t spi_engine_offload_stream_read(struct no_os_spi_desc *desc,
+				       void *buf,
+				       struct axi_dmac_block_info *info,
+				       uint32_t timeout_ms)
+{
+	return -ENOSYS;
+}
+
+int32_t spi_engine_offload_stream_stop(struct no_os_spi_desc *desc)
+{
+	return 0;
+}
+
+uint32_t spi_engine_offload_stream_get_overruns(struct no_os_spi_desc *desc)
+{
+	return 0;
+}
+
+void spi_engine_offload_rx_isr(void *ctx) { }
+
 int32_t spi_engine_set_transfer_width(struct no_os_spi_desc *desc,
 				      uint8_t data_wdith)
 {
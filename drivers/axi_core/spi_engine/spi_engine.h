@@ -61,6 +61,11 @@
 
 #define SPI_ENGINE_MSG_QUEUE_END	0xFFFFFFFF
 
+/* Number of compiled offload programs kept by the engine descriptor */
+#ifndef SPI_ENGINE_OFFLOAD_CACHE_SIZE
+#define SPI_ENGINE_OFFLOAD_CACHE_SIZE	4
+#endif
+
 /* Spi engine commands */
 #define	WRITE(no_bytes)			((SPI_ENGINE_INST_TRANSFER << 12) |\
 	(SPI_ENGINE_INSTRUCTION_TRANSFER_W << 8) | no_bytes)
@@ -102,6 +107,36 @@ struct spi_engine_init_param {
 };
 
 
+/**
+ * @struct spi_engine_offload_program
+ * @brief  Offload program compiled from a message, along with the message
+ * commands and the transfer settings it was compiled for
+ */
+struct spi_engine_offload_program {
+	/** Commands of the message the program was compiled from */
+	uint32_t		msg_cmds[SPI_ENGINE_MAX_PROGRAM_LEN];
+	/** Number of commands of the message */
+	uint32_t		no_commands;
+	/** Clock divider the program was compiled for */
+	uint32_t		clk_div;
+	/** SPI clock frequency the sleep commands were computed for */
+	uint32_t		max_speed_hz;
+	/** Data width the program was compiled for */
+	uint8_t			data_width;
+	/** SPI mode the program was compiled for */
+	uint8_t			mode;
+	/** Chip select the program was compiled for */
+	uint8_t			chip_select;
+	/** Chip select delay the program was compiled for */
+	uint8_t			cs_delay;
+	/** SDO idle state the program was compiled for */
+	uint8_t			sdo_idle_state;
+	/** Value of the use counter when the program was last used */
+	uint32_t		last_use;
+	/** The compiled program */
+	struct spi_engine_program	program;
+};
+
 /**
  * @struct spi_engine_desc
  * @brief  Structure representing an SPI engine device
@@ -139,6 +174,15 @@ struct spi_engine_desc {
 	uint8_t 		max_data_width;
 	/**  output of SDO when CS is inactive or read-only transfers */
 	uint8_t			sdo_idle_state;
+	/** Compiled offload programs */
+	struct spi_engine_offload_program
+		offload_cache[SPI_ENGINE_OFFLOAD_CACHE_SIZE];
+	/** Use counter of the offload programs */
+	uint32_t		offload_use;
+	/** Data written in the offload SDO memory with the last program */
+	uint32_t		offload_sdo[SPI_ENGINE_MAX_PROGRAM_LEN];
+	/** Ring of the continuous offload capture */
+	struct axi_dmac_ring	stream;
 };
 
 
@@ -155,6 +199,9 @@ struct spi_engine_offload_init_param {
 	uint32_t	dma_flags;
 	/** Offload's module transfer direction : TX, RX or both */
 	uint8_t		offload_config;
+	/** Whether the DMAC interrupts are serviced. Continuous capture needs
+	 * IRQ_ENABLED, with spi_engine_offload_rx_isr() registered */
+	enum use_irq	irq_option;
 };
 
 /**
@@ -177,6 +224,25 @@ struct spi_engine_offload_message {
 	uint32_t rx_addr;
 };
 
+/**
+ * @struct spi_engine_offload_stream_param
+ * @brief  Structure containing the parameters of a continuous offload capture
+ */
+struct spi_engine_offload_stream_param {
+	/** Message executed by the offload module for each sample. rx_addr is
+	 * not used, the samples are captured in a ring allocated by the
+	 * driver */
+	struct spi_engine_offload_message *msg;
+	/** Number of samples (message executions) in a block */
+	uint32_t samples_per_block;
+	/** Number of blocks of the DMA ring, at least 2 */
+	uint32_t nb_blocks;
+	/** Optional time source for the block timestamps */
+	uint64_t (*get_timestamp)(void);
+	/** Invalidate the Data cache for the given address range */
+	void (*dcache_invalidate_range)(uint32_t address, uint32_t bytes_count);
+};
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -211,11 +277,36 @@ int32_t spi_engine_remove(struct no_os_spi_desc *desc);
 int32_t spi_engine_offload_init(struct no_os_spi_desc *desc,
 				const struct spi_engine_offload_init_param *param);
 
+/* Compile a message into engine instructions */
+int32_t spi_engine_compile_message(struct no_os_spi_desc *desc,
+				   const uint32_t *cmds,
+				   uint32_t no_commands,
+				   struct spi_engine_program *program);
+
 /* Write and read data over SPI using the offload module */
 int32_t spi_engine_offload_transfer(struct no_os_spi_desc *desc,
 				    struct spi_engine_offload_message msg,
 				    uint32_t no_samples);
 
+/* Start a continuous capture using the offload module */
+int32_t spi_engine_offload_stream_start(struct no_os_spi_desc *desc,
+					const struct spi_engine_offload_stream_param *param);
+
+/* Read the oldest block of a continuous capture */
+int32_t spi_engine_offload_stream_read(struct no_os_spi_desc *desc,
+				       void *buf,
+				       struct axi_dmac_block_info *info,
+				       uint32_t timeout_ms);
+
+/* Stop a continuous capture */
+int32_t spi_engine_offload_stream_stop(struct no_os_spi_desc *desc);
+
+/* Get the number of blocks lost by a continuous capture */
+uint32_t spi_engine_offload_stream_get_overruns(struct no_os_spi_desc *desc);
+
+/* Interrupt service routine of the offload RX DMAC */
+void spi_engine_offload_rx_isr(void *ctx);
+
 /* Set SPI transfer width */
 int32_t spi_engine_set_transfer_width(struct no_os_spi_desc *desc,
 				      uint8_t data_wdith);
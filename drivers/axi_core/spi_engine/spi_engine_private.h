@@ -143,16 +143,28 @@
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
 
-typedef struct spi_engine_cmd_queue {
-	uint32_t	cmd;
-	struct		spi_engine_cmd_queue *next;
-} spi_engine_cmd_queue;
-
-typedef struct spi_engine_msg {
-	uint32_t			*tx_buf;
-	uint32_t			*rx_buf;
-	uint32_t			length;
-	struct spi_engine_cmd_queue	*cmds;
-} spi_engine_msg;
+/* Maximum number of instructions of a compiled message. Longer offload
+messages are not cached and are written to the offload memory in chunks. */
+#ifndef SPI_ENGINE_MAX_PROGRAM_LEN
+#define SPI_ENGINE_MAX_PROGRAM_LEN	32
+#endif
+
+/* Instructions added to the message commands by the compiler: the config
+prologue and the closing SYNC */
+#define SPI_ENGINE_PROGRAM_OVERHEAD	4
+
+/* Number of engine cores whose offload memory content is tracked */
+#ifndef SPI_ENGINE_MAX_INSTANCES
+#define SPI_ENGINE_MAX_INSTANCES	4
+#endif
+
+/* Engine instructions compiled from a message, ready to be written to the
+command FIFO or to the offload command memory */
+typedef struct spi_engine_program {
+	uint32_t	cmds[SPI_ENGINE_MAX_PROGRAM_LEN];
+	uint32_t	len;
+	/* Number of words moved by the transfer instructions */
+	uint32_t	words;
+} spi_engine_program;
 
 #endif // SPI_ENGINE_PRIVATE_H
@@ -407,16 +407,24 @@ int32_t adas1000_read_data(struct adas1000_dev *device, uint8_t *data_buff,
  */
 uint32_t adas1000_compute_frame_crc(struct adas1000_dev * device, uint8_t *buff)
 {
+	/* Tables are built once, on the first frame of each type */
+	NO_OS_DECLARE_CRC16_TABLE(adas1000_crc16);
+	NO_OS_DECLARE_CRC24_TABLE(adas1000_crc24);
+	static bool crc16_ready, crc24_ready;
 	uint32_t crc = 0xFFFFFFFFul;
 
 	/** Select the CRC poly and word size based on the frame rate. */
 	if(device->frame_rate == ADAS1000_128KHZ_FRAME_RATE) {
-		NO_OS_DECLARE_CRC16_TABLE(adas1000_crc16);
-		no_os_crc16_populate_msb(adas1000_crc16, CRC_POLY_128KHZ);
+		if (!crc16_ready) {
+			no_os_crc16_populate_msb(adas1000_crc16, CRC_POLY_128KHZ);
+			crc16_ready = true;
+		}
 		return no_os_crc16(adas1000_crc16, buff, device->frame_size, (uint16_t)crc);
 	} else {
-		NO_OS_DECLARE_CRC24_TABLE(adas1000_crc24);
-		no_os_crc24_populate_msb(adas1000_crc24, CRC_POLY_2KHZ_16KHZ);
+		if (!crc24_ready) {
+			no_os_crc24_populate_msb(adas1000_crc24, CRC_POLY_2KHZ_16KHZ);
+			crc24_ready = true;
+		}
 		return no_os_crc24(adas1000_crc24, buff, device->frame_size, crc);
 	}
 }
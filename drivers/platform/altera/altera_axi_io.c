@@ -77,3 +77,84 @@ int32_t no_os_axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
 	return 0;
 }
 
+/**
+ * @brief AXI IO Altera specific read of consecutive registers.
+ * @param base - Base address
+ * @param offset - Address offset of the first register
+ * @param data - buffer where returned data is stored
+ * @param count - number of registers to read
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_axi_io_read_multi(uint32_t base, uint32_t offset, uint32_t *data,
+				uint32_t count)
+{
+	uint32_t i;
+
+	if (!data)
+		return -EINVAL;
+
+	for (i = 0; i < count; i++)
+		data[i] = IORD_32DIRECT(base, offset + i * 4);
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO Altera specific write of consecutive registers.
+ * @param base - Base address
+ * @param offset - Address offset of the first register
+ * @param data - data to be written
+ * @param count - number of registers to write
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_axi_io_write_multi(uint32_t base, uint32_t offset,
+				 const uint32_t *data, uint32_t count)
+{
+	uint32_t i;
+
+	if (!data)
+		return -EINVAL;
+
+	for (i = 0; i < count; i++)
+		IOWR_32DIRECT(base, offset + i * 4, data[i]);
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO Altera specific execution of a register operations sequence.
+ * @param base - Base address
+ * @param ops - operations, executed in order
+ * @param nb_ops - number of operations
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_axi_io_exec(uint32_t base, struct no_os_axi_io_op *ops,
+			  uint32_t nb_ops)
+{
+	uint32_t i, val;
+
+	if (!ops)
+		return -EINVAL;
+
+	for (i = 0; i < nb_ops; i++) {
+		switch (ops[i].type) {
+		case NO_OS_AXI_IO_OP_READ:
+			*ops[i].data = IORD_32DIRECT(base, ops[i].offset);
+			break;
+		case NO_OS_AXI_IO_OP_WRITE:
+			IOWR_32DIRECT(base, ops[i].offset, ops[i].val);
+			break;
+		case NO_OS_AXI_IO_OP_UPDATE:
+			val = IORD_32DIRECT(base, ops[i].offset);
+			if (ops[i].data)
+				*ops[i].data = val;
+			val = (val & ~ops[i].mask) | (ops[i].val & ops[i].mask);
+			IOWR_32DIRECT(base, ops[i].offset, val);
+			break;
+		default:
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
@@ -39,6 +39,7 @@
 
 #include <FreeRTOS.h>
 #include "no_os_semaphore.h"
+#include "no_os_error.h"
 #include "semphr.h"
 
 /**
@@ -49,11 +50,9 @@
 __attribute__((weak)) inline void no_os_semaphore_init(void **semaphore)
 {
 	if (*semaphore == NULL) {
-		SemaphoreHandle_t* semaphoreTmp = (SemaphoreHandle_t *)no_os_calloc(1,
-						  sizeof(SemaphoreHandle_t));
-
-		*semaphore = xSemaphoreCreate();
-		xSemaphoreGive(*semaphore);
+		*semaphore = xSemaphoreCreateBinary();
+		if (*semaphore)
+			xSemaphoreGive(*semaphore);
 	}
 }
 
@@ -68,6 +67,25 @@ __attribute__((weak)) inline void no_os_semaphore_take(void *semaphore)
 		xSemaphoreTake((SemaphoreHandle_t)semaphore, portMAX_DELAY);
 }
 
+/**
+ * @brief Take token from semaphore, waiting at most timeout_ms.
+ * semaphore - Pointer toward the semaphore.
+ * timeout_ms - Maximum time to wait, in milliseconds.
+ * @return 0 if a token was taken, negative error code otherwise.
+ */
+__attribute__((weak)) int no_os_semaphore_take_timeout(void *semaphore,
+		uint32_t timeout_ms)
+{
+	if (semaphore == NULL)
+		return -EINVAL;
+
+	if (xSemaphoreTake((SemaphoreHandle_t)semaphore,
+			   pdMS_TO_TICKS(timeout_ms)) != pdTRUE)
+		return -ETIMEDOUT;
+
+	return 0;
+}
+
 /**
  * @brief Give token to semaphore
  * semaphore - Pointer toward the semaphore.
@@ -79,6 +97,22 @@ __attribute((weak)) inline void no_os_semaphore_give(void *semaphore)
 		xSemaphoreGive((SemaphoreHandle_t)semaphore);
 }
 
+/**
+ * @brief Give token to semaphore from an interrupt handler.
+ * semaphore - Pointer toward the semaphore.
+ * @return None.
+ */
+__attribute__((weak)) void no_os_semaphore_give_from_isr(void *semaphore)
+{
+	BaseType_t woken = pdFALSE;
+
+	if (semaphore == NULL)
+		return;
+
+	xSemaphoreGiveFromISR((SemaphoreHandle_t)semaphore, &woken);
+	portYIELD_FROM_ISR(woken);
+}
+
 /**
  * @brief Remove semaphore.
  * semaphore - Pointer toward the semaphore.
@@ -44,6 +44,7 @@
 #include <stdint.h>
 #include "no_os_error.h"
 #include "no_os_util.h"
+#include "no_os_axi_io.h"
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
@@ -80,3 +81,58 @@ int32_t no_os_axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
 
 	return 0;
 }
+
+/**
+ * @brief AXI IO generic read of consecutive registers.
+ * @param base - Base address
+ * @param offset - Address offset of the first register
+ * @param data - buffer where returned data is stored
+ * @param count - number of registers to read
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_read_multi(uint32_t base, uint32_t offset, uint32_t *data,
+				uint32_t count)
+{
+	NO_OS_UNUSED_PARAM(base);
+	NO_OS_UNUSED_PARAM(offset);
+	NO_OS_UNUSED_PARAM(data);
+	NO_OS_UNUSED_PARAM(count);
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO generic write of consecutive registers.
+ * @param base - Base address
+ * @param offset - Address offset of the first register
+ * @param data - data to be written
+ * @param count - number of registers to write
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_write_multi(uint32_t base, uint32_t offset,
+				 const uint32_t *data, uint32_t count)
+{
+	NO_OS_UNUSED_PARAM(base);
+	NO_OS_UNUSED_PARAM(offset);
+	NO_OS_UNUSED_PARAM(data);
+	NO_OS_UNUSED_PARAM(count);
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO generic execution of a register operations sequence.
+ * @param base - Base address
+ * @param ops - operations, executed in order
+ * @param nb_ops - number of operations
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_exec(uint32_t base, struct no_os_axi_io_op *ops,
+			  uint32_t nb_ops)
+{
+	NO_OS_UNUSED_PARAM(base);
+	NO_OS_UNUSED_PARAM(ops);
+	NO_OS_UNUSED_PARAM(nb_ops);
+
+	return 0;
+}
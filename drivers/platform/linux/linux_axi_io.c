@@ -40,153 +40,355 @@
 /******************************************************************************/
 /***************************** Include Files **********************************/
 /******************************************************************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/mman.h>
 #include "no_os_error.h"
+#include "no_os_util.h"
 #include "no_os_axi_io.h"
+#include "linux_axi_io.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct linux_axi_io_window
+ * @brief Register region kept mapped between accesses.
+ */
+struct linux_axi_io_window {
+	/** UIO index or base address */
+	uint32_t base;
+	/** File descriptor of the mapped device. -1 for the mock backend */
+	int fd;
+	/** Address returned by mmap() */
+	uint8_t *addr;
+	/** Mapped size in bytes */
+	size_t size;
+	/** Offset of base inside the first mapped page */
+	size_t page_off;
+};
+
+/******************************************************************************/
+/************************ Variable Declarations *******************************/
+/******************************************************************************/
+
+static struct linux_axi_io_window windows[LINUX_AXI_IO_MAX_WINDOWS];
+static uint32_t nb_windows;
+static pthread_mutex_t windows_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
 /**
- * @brief AXI IO through UIO read/write function.
- * @param base - UIO index (/dev/uioX).
- * @param offset - Address offset.
- * @param read - Location where read data will be stored.
- * @param write - Data to be written.
- * @return 0 in case of success, -1 otherwise.
+ * @brief Open the device backing a window and get the initial map size.
+ * @param win - Window to be opened.
+ * @param size - Where to store the size of the region, if known.
+ * @return 0 in case of success, negative error code otherwise.
  */
-static int32_t uio_read_write(uint32_t base, uint32_t offset, uint32_t *read,
-			      uint32_t *write)
+static int32_t linux_axi_io_open(struct linux_axi_io_window *win, size_t *size)
 {
-	char buf[32];
-	int ret;
-	int uio_fd;
-	int32_t status = 0;
-	void *uio_addr;
+#if defined(LINUX_AXI_IO_MOCK)
+	win->fd = -1;
+	win->page_off = 0;
+	*size = LINUX_AXI_IO_WINDOW_SIZE;
+#elif defined(DEVMEM)
+	long page_size = sysconf(_SC_PAGESIZE);
 
-	sprintf(buf, "/dev/uio%"PRIu32"", base);
+	win->fd = open("/dev/mem", O_RDWR | O_SYNC);
+	if (win->fd < 0) {
+		printf("%s: Can't open /dev/mem\n\r", __func__);
+		return -errno;
+	}
+	win->page_off = win->base & (page_size - 1);
+	*size = LINUX_AXI_IO_WINDOW_SIZE;
+#else
+	char buf[64];
+	FILE *f;
 
-	uio_fd = open(buf, O_RDWR);
-	if (uio_fd < 0) {
+	sprintf(buf, "/dev/uio%"PRIu32"", win->base);
+	win->fd = open(buf, O_RDWR);
+	if (win->fd < 0) {
 		printf("%s: Can't open %s\n\r", __func__, buf);
-		return -1;
+		return -errno;
 	}
+	win->page_off = 0;
 
-	uio_addr = mmap(NULL,
-			offset + sizeof(*read),
-			PROT_READ|PROT_WRITE,
-			MAP_SHARED,
-			uio_fd,
-			0);
-	if (uio_addr == MAP_FAILED) {
-		printf("%s: mmap() failed\n\r", __func__);
-		status = -1;
-		goto close;
+	/* Map the whole region advertised by the UIO driver */
+	*size = LINUX_AXI_IO_WINDOW_SIZE;
+	sprintf(buf, "/sys/class/uio/uio%"PRIu32"/maps/map0/size", win->base);
+	f = fopen(buf, "r");
+	if (f) {
+		if (fscanf(f, "%zx", size) != 1 || !*size)
+			*size = LINUX_AXI_IO_WINDOW_SIZE;
+		fclose(f);
 	}
+#endif
 
-	if (read)
-		*read = *(uint32_t *)((uintptr_t)uio_addr + offset);
-	if (write)
-		*(uint32_t *)((uintptr_t)uio_addr + offset) = *write;
+	return 0;
+}
+
+/**
+ * @brief Map (or grow the mapping of) a window. Device memory is mapped
+ * VM_PFNMAP, which mremap() can not grow, so a larger window is mapped next
+ * to the old one and the old one is unmapped only once the new one is valid.
+ * @param win - Window to be mapped.
+ * @param size - Number of bytes needed after the start of the first page.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t linux_axi_io_map(struct linux_axi_io_window *win, size_t size)
+{
+	long page_size = sysconf(_SC_PAGESIZE);
+	void *addr;
 
-	ret = munmap(uio_addr, offset + sizeof(*read));
-	if (ret < 0) {
-		printf("%s: munmap() failed\n\r", __func__);
-		status = -1;
+	size = NO_OS_DIV_ROUND_UP(size, page_size) * page_size;
+
+#if defined(LINUX_AXI_IO_MOCK)
+	addr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+		    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#else
+	addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+		    win->fd, win->base - win->page_off);
+#endif
+	if (addr == MAP_FAILED) {
+		printf("%s: mmap() failed\n\r", __func__);
+		return -errno;
 	}
 
-close:
-	ret = close(uio_fd);
-	if (ret < 0) {
-		printf("%s: Can't close %s\n\r", __func__, buf);
-		status = -1;
+	if (win->addr) {
+#if defined(LINUX_AXI_IO_MOCK)
+		/* Anonymous memory is the register content of the mock backend */
+		memcpy(addr, win->addr, win->size);
+#endif
+		munmap(win->addr, win->size);
 	}
 
-	return status;
+	win->addr = addr;
+	win->size = size;
+
+	return 0;
 }
 
-#ifdef DEVMEM
 /**
- * @brief AXI IO through devmem read/write function.
- * @param base - Base address.
+ * @brief Get the address of len bytes at offset from base, mapping the
+ * region the first time it is accessed. Must be called with windows_lock
+ * held.
+ * @param base - UIO index (/dev/uioX)/base address.
  * @param offset - Address offset.
- * @param read - Location where read data will be stored.
- * @param write - Data to be written.
- * @return 0 in case of success, -1 otherwise.
+ * @param len - Number of bytes to be accessed.
+ * @param reg - Where to store the address.
+ * @return 0 in case of success, negative error code otherwise.
  */
-static int32_t devmem_read_write(uint32_t base, uint32_t offset, uint32_t *read,
-				 uint32_t *write)
+static int32_t linux_axi_io_get(uint32_t base, uint32_t offset, uint32_t len,
+				volatile uint32_t **reg)
 {
-	char command[64];
-	char answer[64];
-	FILE *stream;
+	struct linux_axi_io_window *win = NULL;
+	size_t size = 0;
+	uint32_t i;
 	int32_t ret;
 
-	if (write)
-		ret = snprintf(command, sizeof(command),
-			       "busybox devmem 0x%x w 0x%x", base + offset, *write);
-	else if (read)
-		ret = snprintf(command, sizeof(command),
-			       "busybox devmem 0x%x", base + offset);
-	else
-		return -1;
-
-	if (ret < 0 || ret >= (int32_t) sizeof(command))
-		return -1;
-
-	stream = popen(command, "r");
-	if (stream == NULL)
-		return -1;
-
-	if (!(fgets(answer, sizeof(answer), stream))) {
-		ret = -1;
-		goto close;
+	for (i = 0; i < nb_windows; i++) {
+		if (windows[i].base == base) {
+			win = &windows[i];
+			break;
+		}
+	}
+
+	if (!win) {
+		if (nb_windows == LINUX_AXI_IO_MAX_WINDOWS)
+			return -ENOMEM;
+
+		win = &windows[nb_windows];
+		win->base = base;
+		win->addr = NULL;
+		ret = linux_axi_io_open(win, &size);
+		if (ret)
+			return ret;
+
+		ret = linux_axi_io_map(win, no_os_max(size, win->page_off +
+						      offset + len));
+		if (ret) {
+			if (win->fd >= 0)
+				close(win->fd);
+			return ret;
+		}
+		nb_windows++;
+	} else if (win->page_off + offset + len > win->size) {
+		ret = linux_axi_io_map(win, win->page_off + offset + len);
+		if (ret)
+			return ret;
+	}
+
+	*reg = (volatile uint32_t *)(win->addr + win->page_off + offset);
+
+	return 0;
+}
+
+/**
+ * @brief Unmap all the register windows and close their devices.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t linux_axi_io_release(void)
+{
+	int32_t status = 0;
+	uint32_t i;
+
+	pthread_mutex_lock(&windows_lock);
+	for (i = 0; i < nb_windows; i++) {
+		if (munmap(windows[i].addr, windows[i].size) < 0) {
+			printf("%s: munmap() failed\n\r", __func__);
+			status = -errno;
+		}
+		if (windows[i].fd >= 0 && close(windows[i].fd) < 0)
+			status = -errno;
 	}
+	nb_windows = 0;
+	pthread_mutex_unlock(&windows_lock);
+
+	return status;
+}
+
+/**
+ * @brief AXI IO through UIO/devmem read of consecutive registers.
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @param offset - Address offset of the first register.
+ * @param data - Location where read data will be stored.
+ * @param count - Number of registers to read.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_axi_io_read_multi(uint32_t base, uint32_t offset, uint32_t *data,
+				uint32_t count)
+{
+	volatile uint32_t *reg;
+	uint32_t i;
+	int32_t ret;
 
-	if (read)
-		*read = strtol(answer, NULL, 0);
+	if (!data || !count)
+		return -EINVAL;
 
-	ret = 0;
-close:
-	pclose(stream);
+	pthread_mutex_lock(&windows_lock);
+	ret = linux_axi_io_get(base, offset, count * sizeof(*data), &reg);
+	if (!ret)
+		for (i = 0; i < count; i++)
+			data[i] = reg[i];
+	pthread_mutex_unlock(&windows_lock);
 
 	return ret;
 }
-#endif //DEVMEM
+
+/**
+ * @brief AXI IO through UIO/devmem write of consecutive registers.
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @param offset - Address offset of the first register.
+ * @param data - Data to be written.
+ * @param count - Number of registers to write.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_axi_io_write_multi(uint32_t base, uint32_t offset,
+				 const uint32_t *data, uint32_t count)
+{
+	volatile uint32_t *reg;
+	uint32_t i;
+	int32_t ret;
+
+	if (!data || !count)
+		return -EINVAL;
+
+	pthread_mutex_lock(&windows_lock);
+	ret = linux_axi_io_get(base, offset, count * sizeof(*data), &reg);
+	if (!ret)
+		for (i = 0; i < count; i++)
+			reg[i] = data[i];
+	pthread_mutex_unlock(&windows_lock);
+
+	return ret;
+}
+
+/**
+ * @brief AXI IO through UIO/devmem execution of a register operations
+ * sequence. The window covering all the operations is looked up once and
+ * the sequence is executed without releasing the lock.
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @param ops - Operations, executed in order.
+ * @param nb_ops - Number of operations.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_axi_io_exec(uint32_t base, struct no_os_axi_io_op *ops,
+			  uint32_t nb_ops)
+{
+	uint32_t lo = UINT32_MAX, hi = 0;
+	volatile uint32_t *reg, *win;
+	uint32_t i, val;
+	int32_t ret;
+
+	if (!ops)
+		return -EINVAL;
+	if (!nb_ops)
+		return 0;
+
+	for (i = 0; i < nb_ops; i++) {
+		lo = no_os_min(lo, ops[i].offset);
+		hi = no_os_max(hi, ops[i].offset);
+	}
+
+	pthread_mutex_lock(&windows_lock);
+	ret = linux_axi_io_get(base, lo, hi - lo + sizeof(uint32_t), &win);
+	for (i = 0; !ret && i < nb_ops; i++) {
+		reg = win + (ops[i].offset - lo) / sizeof(uint32_t);
+		switch (ops[i].type) {
+		case NO_OS_AXI_IO_OP_READ:
+			*ops[i].data = *reg;
+			break;
+		case NO_OS_AXI_IO_OP_WRITE:
+			*reg = ops[i].val;
+			break;
+		case NO_OS_AXI_IO_OP_UPDATE:
+			val = *reg;
+			if (ops[i].data)
+				*ops[i].data = val;
+			*reg = (val & ~ops[i].mask) | (ops[i].val & ops[i].mask);
+			break;
+		default:
+			ret = -EINVAL;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&windows_lock);
+
+	return ret;
+}
+
 /**
  * @brief AXI IO through UIO/devmem read function.
  * @param base - UIO index (/dev/uioX)/base address.
  * @param offset - Address offset.
  * @param data - Location where read data will be stored.
- * @return 0 in case of success, -1 otherwise.
+ * @return 0 in case of success, negative error code otherwise.
  */
 int32_t no_os_axi_io_read(uint32_t base, uint32_t offset, uint32_t *data)
 {
-#ifdef DEVMEM
-	return devmem_read_write(base, offset, data, NULL);
-#else
-	return uio_read_write(base, offset, data, NULL);
-#endif
+	return no_os_axi_io_read_multi(base, offset, data, 1);
 }
 
 /**
- * @brief AXI IO through UIO specific write function.
- * @param base - UIO index (/dev/uioX).
+ * @brief AXI IO through UIO/devmem write function.
+ * @param base - UIO index (/dev/uioX)/base address.
  * @param offset - Address offset.
  * @param data - Data to be written.
- * @return 0 in case of success, -1 otherwise.
+ * @return 0 in case of success, negative error code otherwise.
  */
 int32_t no_os_axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
 {
-#ifdef DEVMEM
-	return devmem_read_write(base, offset, NULL, &data);
-#else
-	return uio_read_write(base, offset, NULL, &data);
-#endif
+	return no_os_axi_io_write_multi(base, offset, &data, 1);
 }
@@ -0,0 +1,61 @@
+/*******************************************************************************
+ *   @file   linux/linux_axi_io.h
+ *   @brief  Linux platform specific AXI IO helpers.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef LINUX_AXI_IO_H_
+#define LINUX_AXI_IO_H_
+
+#include <stdint.h>
+#include "no_os_axi_io.h"
+
+/** Maximum number of register windows kept mapped at the same time */
+#ifndef LINUX_AXI_IO_MAX_WINDOWS
+#define LINUX_AXI_IO_MAX_WINDOWS	16
+#endif
+
+/**
+ * Size mapped on first access when the region size is not reported by the
+ * kernel (devmem, mock). Windows grow on demand if accessed past this size.
+ */
+#ifndef LINUX_AXI_IO_WINDOW_SIZE
+#define LINUX_AXI_IO_WINDOW_SIZE	0x10000
+#endif
+
+/* Unmap all the register windows. */
+int32_t linux_axi_io_release(void);
+
+#endif // LINUX_AXI_IO_H_
@@ -0,0 +1,194 @@
+/***************************************************************************//**
+ *   @file   linux/linux_semaphore.c
+ *   @brief  Implementation of Linux platform semaphore.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include "linux_semaphore.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct linux_semaphore
+ * @brief Counting semaphore built on a pthread condition variable.
+ */
+struct linux_semaphore {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint32_t count;
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Initialize semaphore. Like on the other platforms, the semaphore
+ * holds one token after initialization.
+ * @param semaphore - Pointer toward the semaphore.
+ * @return None.
+ */
+void no_os_semaphore_init(void **semaphore)
+{
+	struct linux_semaphore *sem;
+	pthread_condattr_t attr;
+
+	if (*semaphore)
+		return;
+
+	sem = calloc(1, sizeof(*sem));
+	if (!sem)
+		return;
+
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&sem->cond, &attr);
+	pthread_condattr_destroy(&attr);
+	pthread_mutex_init(&sem->lock, NULL);
+	sem->count = 1;
+
+	*semaphore = sem;
+}
+
+/**
+ * @brief Take token from semaphore, waiting at most timeout_ms.
+ * @param semaphore - Pointer toward the semaphore.
+ * @param timeout_ms - Maximum time to wait, in milliseconds.
+ * @return 0 if a token was taken, negative error code otherwise.
+ */
+int no_os_semaphore_take_timeout(void *semaphore, uint32_t timeout_ms)
+{
+	struct linux_semaphore *sem = semaphore;
+	struct timespec deadline;
+	int ret = 0;
+
+	if (!sem)
+		return -EINVAL;
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += timeout_ms / 1000;
+	deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+	if (deadline.tv_nsec >= 1000000000L) {
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000L;
+	}
+
+	pthread_mutex_lock(&sem->lock);
+	while (!sem->count && !ret)
+		ret = pthread_cond_timedwait(&sem->cond, &sem->lock, &deadline);
+	if (sem->count) {
+		sem->count--;
+		ret = 0;
+	}
+	pthread_mutex_unlock(&sem->lock);
+
+	return ret ? -ret : 0;
+}
+
+/**
+ * @brief Take token from semaphore.
+ * @param semaphore - Pointer toward the semaphore.
+ * @return None.
+ */
+void no_os_semaphore_take(void *semaphore)
+{
+	struct linux_semaphore *sem = semaphore;
+
+	if (!sem)
+		return;
+
+	pthread_mutex_lock(&sem->lock);
+	while (!sem->count)
+		pthread_cond_wait(&sem->cond, &sem->lock);
+	sem->count--;
+	pthread_mutex_unlock(&sem->lock);
+}
+
+/**
+ * @brief Give token to semaphore.
+ * @param semaphore - Pointer toward the semaphore.
+ * @return None.
+ */
+void no_os_semaphore_give(void *semaphore)
+{
+	struct linux_semaphore *sem = semaphore;
+
+	if (!sem)
+		return;
+
+	pthread_mutex_lock(&sem->lock);
+	sem->count++;
+	pthread_cond_signal(&sem->cond);
+	pthread_mutex_unlock(&sem->lock);
+}
+
+/**
+ * @brief Give token to semaphore from an interrupt handler. Interrupts are
+ * handled by threads on Linux, so this is the same as no_os_semaphore_give().
+ * @param semaphore - Pointer toward the semaphore.
+ * @return None.
+ */
+void no_os_semaphore_give_from_isr(void *semaphore)
+{
+	no_os_semaphore_give(semaphore);
+}
+
+/**
+ * @brief Remove semaphore.
+ * @param semaphore - Pointer toward the semaphore.
+ * @return None.
+ */
+void no_os_semaphore_remove(void *semaphore)
+{
+	struct linux_semaphore *sem = semaphore;
+
+	if (!sem)
+		return;
+
+	pthread_cond_destroy(&sem->cond);
+	pthread_mutex_destroy(&sem->lock);
+	free(sem);
+}
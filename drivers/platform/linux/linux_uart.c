@@ -42,15 +42,26 @@
 /******************************************************************************/
 #include "no_os_error.h"
 #include "no_os_alloc.h"
+#include "no_os_circular_buffer.h"
 #include "linux_uart.h"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <termios.h>
 #include <unistd.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
 
+/* Size of the receive ring used when asynchronous_rx is set */
+#ifndef LINUX_UART_RX_RING_SIZE
+#define LINUX_UART_RX_RING_SIZE	4096
+#endif
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -64,12 +75,164 @@ struct linux_uart_desc {
 	int fd;
 	/** structure containing the terminal flags/settings */
 	struct termios *terminal;
+	/** Thread filling the receive ring */
+	pthread_t rx_thread;
+	/** eventfd used to stop rx_thread */
+	int stop_fd;
 };
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
+/**
+ * @brief Wait until the UART device can be read or written.
+ * @param fd - File descriptor of the device.
+ * @param events - POLLIN or POLLOUT.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int linux_uart_wait(int fd, short events)
+{
+	struct pollfd pfd = {
+		.fd = fd,
+		.events = events
+	};
+
+	if (poll(&pfd, 1, -1) < 0 && errno != EINTR)
+		return -errno;
+
+	return 0;
+}
+
+/**
+ * @brief Receive thread. Reads the device into the receive ring as data
+ * arrives, so the bytes are not lost while the application is busy.
+ * @param arg - The UART descriptor.
+ * @return NULL.
+ */
+static void *linux_uart_rx_thread(void *arg)
+{
+	struct no_os_uart_desc *desc = arg;
+	struct linux_uart_desc *linux_desc = desc->extra;
+	struct pollfd fds[2] = {
+		{ .fd = linux_desc->stop_fd, .events = POLLIN },
+		{ .fd = linux_desc->fd, .events = POLLIN },
+	};
+	bool hup = false;
+	uint32_t len;
+	void *buf;
+	int ret, nfds;
+
+	while (true) {
+		/*
+		 * Stop reading while the ring is full or the other end of
+		 * the line is closed and check again later. Data is kept by
+		 * the tty meanwhile.
+		 */
+		ret = no_os_cb_spsc_prepare_write(desc->rx_ring,
+						  LINUX_UART_RX_RING_SIZE,
+						  &buf, &len);
+		nfds = (ret || hup) ? 1 : 2;
+		fds[0].revents = 0;
+		fds[1].revents = 0;
+		ret = poll(fds, nfds, nfds == 1 ? 1 : -1);
+		if (ret < 0 && errno != EINTR)
+			break;
+		if (fds[0].revents)
+			break;
+
+		hup = false;
+		if (fds[1].revents & POLLIN) {
+			ret = read(linux_desc->fd, buf, len);
+			if (ret > 0)
+				no_os_cb_spsc_end_write(desc->rx_ring, ret);
+		} else if (fds[1].revents & (POLLHUP | POLLERR)) {
+			hup = true;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Allocate the receive ring and start the receive thread.
+ * @param desc - The UART descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int linux_uart_rx_start(struct no_os_uart_desc *desc)
+{
+	struct linux_uart_desc *linux_desc = desc->extra;
+	int ret;
+
+	ret = no_os_cb_spsc_init(&desc->rx_ring, LINUX_UART_RX_RING_SIZE);
+	if (ret)
+		return ret;
+
+	linux_desc->stop_fd = eventfd(0, EFD_CLOEXEC);
+	if (linux_desc->stop_fd < 0) {
+		ret = -errno;
+		goto free_ring;
+	}
+
+	ret = pthread_create(&linux_desc->rx_thread, NULL,
+			     linux_uart_rx_thread, desc);
+	if (ret) {
+		ret = -ret;
+		goto close_stop;
+	}
+
+	return 0;
+
+close_stop:
+	close(linux_desc->stop_fd);
+free_ring:
+	no_os_cb_spsc_remove(desc->rx_ring);
+	desc->rx_ring = NULL;
+
+	return ret;
+}
+
+/**
+ * @brief Stop the receive thread and free the receive ring.
+ * @param desc - The UART descriptor.
+ */
+static void linux_uart_rx_stop(struct no_os_uart_desc *desc)
+{
+	struct linux_uart_desc *linux_desc = desc->extra;
+
+	eventfd_write(linux_desc->stop_fd, 1);
+	pthread_join(linux_desc->rx_thread, NULL);
+	close(linux_desc->stop_fd);
+	no_os_cb_spsc_remove(desc->rx_ring);
+	desc->rx_ring = NULL;
+}
+
+/**
+ * @brief Copy the received data out of the receive ring.
+ * @param desc - The UART descriptor.
+ * @param data - Pointer to buffer where data will be stored.
+ * @param bytes_number - Maximum number of bytes to read.
+ * @return Number of bytes read or -EAGAIN if the ring is empty.
+ */
+static int32_t linux_uart_ring_read(struct no_os_uart_desc *desc,
+				    uint8_t *data, uint32_t bytes_number)
+{
+	uint32_t count = 0;
+	uint32_t len;
+	void *buf;
+
+	/* At most two regions, if the data wraps around */
+	while (count < bytes_number &&
+	       !no_os_cb_spsc_prepare_read(desc->rx_ring, bytes_number - count,
+					   &buf, &len)) {
+		memcpy(&data[count], buf, len);
+		no_os_cb_spsc_end_read(desc->rx_ring, len);
+		count += len;
+	}
+
+	return count ? (int32_t)count : -EAGAIN;
+}
+
 /**
  * @brief Initialize the UART communication peripheral.
  * @param desc - The UART descriptor.
@@ -169,6 +332,33 @@ static int32_t linux_uart_init(struct no_os_uart_desc **desc,
 	case 38400:
 		speed = B38400;
 		break;
+	case 57600:
+		speed = B57600;
+		break;
+	case 115200:
+		speed = B115200;
+		break;
+	case 230400:
+		speed = B230400;
+		break;
+	case 460800:
+		speed = B460800;
+		break;
+	case 921600:
+		speed = B921600;
+		break;
+	case 1000000:
+		speed = B1000000;
+		break;
+	case 2000000:
+		speed = B2000000;
+		break;
+	case 3000000:
+		speed = B3000000;
+		break;
+	case 4000000:
+		speed = B4000000;
+		break;
 	default:
 		ret = -EINVAL;
 		goto free;
@@ -222,6 +412,14 @@ static int32_t linux_uart_init(struct no_os_uart_desc **desc,
 
 	tcflush(linux_desc->fd, TCIOFLUSH);
 
+	descriptor->rx_fifo = NULL;
+	descriptor->rx_ring = NULL;
+	if (param->asynchronous_rx) {
+		ret = linux_uart_rx_start(descriptor);
+		if (ret)
+			goto free;
+	}
+
 	*desc = descriptor;
 
 	return 0;
@@ -250,10 +448,14 @@ static int32_t linux_uart_remove(struct no_os_uart_desc *desc)
 
 	linux_desc = desc->extra;
 
+	if (desc->rx_ring)
+		linux_uart_rx_stop(desc);
+
 	ret = close(linux_desc->fd);
 	if (ret < 0)
 		printf("%s: Can't close device\n\r", __func__);
 
+	no_os_free(linux_desc->terminal);
 	no_os_free(desc->extra);
 	no_os_free(desc);
 
@@ -264,8 +466,9 @@ static int32_t linux_uart_remove(struct no_os_uart_desc *desc)
  * @brief Write data to UART device.
  * @param desc - Instance of UART.
  * @param data - Pointer to buffer containing data.
- * @param bytes_number - Number of bytes to read.
- * @return 0 in case of success, -1 otherwise.
+ * @param bytes_number - Number of bytes to write.
+ * @return Number of bytes written in case of success, negative error code
+ * otherwise.
  */
 static int32_t linux_uart_write(struct no_os_uart_desc *desc,
 				const uint8_t *data,
@@ -278,20 +481,35 @@ static int32_t linux_uart_write(struct no_os_uart_desc *desc,
 	linux_desc = desc->extra;
 
 	while (count < bytes_number) {
-		ret = write(linux_desc->fd, data, bytes_number);
-		if (ret > 0)
+		ret = write(linux_desc->fd, &data[count], bytes_number - count);
+		if (ret > 0) {
 			count += ret;
+			continue;
+		}
+		if (ret < 0 && errno != EAGAIN && errno != EINTR)
+			return -errno;
+
+		/* Wait for room in the tty buffer instead of spinning */
+		ret = linux_uart_wait(linux_desc->fd, POLLOUT);
+		if (ret)
+			return ret;
 	}
 
-	return 0;
+	return count;
 };
 
 /**
  * @brief Read data from UART device.
+ *
+ * If the UART was initialized with asynchronous_rx, the data received so
+ * far is returned. Otherwise the function blocks until bytes_number bytes
+ * are received.
+ *
  * @param desc - Instance of UART.
  * @param data - Pointer to buffer containing data.
  * @param bytes_number - Number of bytes to read.
- * @return 0 in case of success, -1 otherwise.
+ * @return Number of bytes read in case of success, -EAGAIN if no data was
+ * received yet, negative error code otherwise.
  */
 static int32_t linux_uart_read(struct no_os_uart_desc *desc, uint8_t *data,
 			       uint32_t bytes_number)
@@ -300,17 +518,75 @@ static int32_t linux_uart_read(struct no_os_uart_desc *desc, uint8_t *data,
 	uint32_t count = 0;
 	int ret;
 
+	if (desc->rx_ring)
+		return linux_uart_ring_read(desc, data, bytes_number);
+
 	linux_desc = desc->extra;
 
 	while (count < bytes_number) {
 		ret = read(linux_desc->fd, &data[count], bytes_number - count);
-		if (ret > 0)
+		if (ret > 0) {
 			count += ret;
+			continue;
+		}
+		if (ret < 0 && errno != EAGAIN && errno != EINTR)
+			return -errno;
+
+		ret = linux_uart_wait(linux_desc->fd, POLLIN);
+		if (ret)
+			return ret;
 	}
 
-	return 0;
+	return count;
 };
 
+/**
+ * @brief Read the data already received, without waiting.
+ * @param desc - Instance of UART.
+ * @param data - Pointer to buffer containing data.
+ * @param bytes_number - Maximum number of bytes to read.
+ * @return Number of bytes read in case of success, -EAGAIN if no data was
+ * received yet, negative error code otherwise.
+ */
+static int32_t linux_uart_read_nonblocking(struct no_os_uart_desc *desc,
+		uint8_t *data,
+		uint32_t bytes_number)
+{
+	struct linux_uart_desc *linux_desc = desc->extra;
+	int ret;
+
+	if (desc->rx_ring)
+		return linux_uart_ring_read(desc, data, bytes_number);
+
+	ret = read(linux_desc->fd, data, bytes_number);
+	if (ret < 0)
+		return -errno;
+
+	return ret ? ret : -EAGAIN;
+}
+
+/**
+ * @brief Write as much data as the tty buffer can take, without waiting.
+ * @param desc - Instance of UART.
+ * @param data - Pointer to buffer containing data.
+ * @param bytes_number - Number of bytes to write.
+ * @return Number of bytes written in case of success, -EAGAIN if the tty
+ * buffer is full, negative error code otherwise.
+ */
+static int32_t linux_uart_write_nonblocking(struct no_os_uart_desc *desc,
+		const uint8_t *data,
+		uint32_t bytes_number)
+{
+	struct linux_uart_desc *linux_desc = desc->extra;
+	int ret;
+
+	ret = write(linux_desc->fd, data, bytes_number);
+	if (ret < 0)
+		return -errno;
+
+	return ret;
+}
+
 /**
  * @brief Linux platform specific UART platform ops structure
  */
@@ -318,5 +594,7 @@ const struct no_os_uart_platform_ops linux_uart_ops = {
 	.init = &linux_uart_init,
 	.read = &linux_uart_read,
 	.write = &linux_uart_write,
+	.read_nonblocking = &linux_uart_read_nonblocking,
+	.write_nonblocking = &linux_uart_write_nonblocking,
 	.remove = &linux_uart_remove
 };
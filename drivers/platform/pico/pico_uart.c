@@ -87,7 +87,8 @@ static int32_t pico_uart_init(struct no_os_uart_desc **desc,
 	if (!desc || !param || !param->extra)
 		return -EINVAL;
 
-	descriptor = (struct no_os_uart_desc *) no_os_malloc(sizeof(*descriptor));
+	descriptor = (struct no_os_uart_desc *) no_os_calloc(1,
+		     sizeof(*descriptor));
 	if (!descriptor)
 		return -ENOMEM;
 
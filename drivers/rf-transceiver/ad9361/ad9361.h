@@ -43,6 +43,7 @@
 /******************************************************************************/
 #include <stdint.h>
 #include "no_os_gpio.h"
+#include "no_os_spi.h"
 #include "common.h"
 
 /******************************************************************************/
@@ -3297,6 +3298,8 @@ struct ad9361_debugfs_entry {
 	uint8_t cmd;
 };
 
+#define AD9361_FASTLOCK_PROFILES	8
+
 struct ad9361_fastlock_entry {
 #define FASTLOOK_INIT	1
 	uint8_t flags;
@@ -3307,7 +3310,63 @@ struct ad9361_fastlock_entry {
 struct ad9361_fastlock {
 	uint8_t save_profile;
 	uint8_t current_profile[2];
-	struct ad9361_fastlock_entry entry[2][8];
+	struct ad9361_fastlock_entry entry[2][AD9361_FASTLOCK_PROFILES];
+};
+
+struct ad9361_hop_entry {
+	uint64_t freq;
+	uint8_t image[RX_FAST_LOCK_CONFIG_WORD_NUM];
+};
+
+struct ad9361_hop_table {
+	bool tx;
+	uint32_t num;
+	struct ad9361_hop_entry *entries;
+	/* Table entry held by each fastlock profile, -1 if none */
+	int32_t profile_entry[AD9361_FASTLOCK_PROFILES];
+	/* Profiles stored by the user before the table was created */
+	uint8_t reserved_profiles;
+	/* Last use of each profile, the least recently used one is replaced */
+	uint32_t profile_used[AD9361_FASTLOCK_PROFILES];
+	uint32_t use_count;
+	uint32_t current;
+	uint32_t hops;
+	uint32_t hits;
+	uint32_t misses;
+	/* Optional time source [ns], enables the hop latency statistics */
+	uint64_t (*get_time_ns)(void);
+	uint64_t last_latency_ns;
+	uint64_t max_latency_ns;
+	uint64_t total_latency_ns;
+};
+
+#define AD9361_NUM_REGS		0x400
+
+enum ad9361_regcache_mode {
+	AD9361_REGCACHE_NONE,
+	/* Writes go to the device, reads of non-volatile registers do not */
+	AD9361_REGCACHE_WRITE_THROUGH,
+	/* Writes to non-volatile registers are held until the next sync or
+	 * until a volatile register is accessed */
+	AD9361_REGCACHE_WRITE_BACK,
+};
+
+struct ad9361_regcache {
+	enum ad9361_regcache_mode mode;
+	bool bypass;
+	uint8_t val[AD9361_NUM_REGS];
+	uint8_t valid[AD9361_NUM_REGS / 8];
+	uint8_t dirty[AD9361_NUM_REGS / 8];
+};
+
+#ifndef AD9361_SPI_QUEUE_LEN
+#define AD9361_SPI_QUEUE_LEN	32
+#endif
+
+struct ad9361_spi_queue {
+	struct no_os_spi_msg msgs[AD9361_SPI_QUEUE_LEN];
+	uint8_t buf[AD9361_SPI_QUEUE_LEN][MAX_MBYTE_SPI + 2];
+	uint32_t len;
 };
 
 enum dig_tune_flags {
@@ -3415,6 +3474,8 @@ struct ad9361_rf_phy {
 	uint32_t				bist_tone_level_dB;
 	uint32_t				bist_tone_mask;
 	bool			bbpll_initialized;
+	struct ad9361_regcache	*regcache;
+	struct ad9361_spi_queue	spi_queue;
 };
 
 struct refclk_scale {
@@ -3440,15 +3501,28 @@ enum debugfs_cmd {
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
-int32_t ad9361_spi_readm(struct no_os_spi_desc *spi, uint32_t reg,
+int32_t ad9361_spi_readm(struct ad9361_rf_phy *phy, uint32_t reg,
 			 uint8_t *rbuf, uint32_t num);
-int32_t ad9361_spi_read(struct no_os_spi_desc *spi, uint32_t reg);
+int32_t ad9361_spi_read(struct ad9361_rf_phy *phy, uint32_t reg);
 int32_t ad9361_reg_read(struct ad9361_rf_phy *phy,
 			uint32_t reg, uint32_t *val);
-int32_t ad9361_spi_write(struct no_os_spi_desc *spi,
+int32_t ad9361_spi_write(struct ad9361_rf_phy *phy,
 			 uint32_t reg, uint32_t val);
 int32_t ad9361_reg_write(struct ad9361_rf_phy *phy,
 			 uint32_t reg, uint32_t val);
+int32_t ad9361_spi_queue_writem(struct ad9361_rf_phy *phy, uint32_t reg,
+				const uint8_t *tbuf, uint32_t num);
+int32_t ad9361_spi_queue_write(struct ad9361_rf_phy *phy,
+			       uint32_t reg, uint32_t val);
+int32_t ad9361_spi_queue_submit(struct ad9361_rf_phy *phy);
+int32_t ad9361_regcache_init(struct ad9361_rf_phy *phy,
+			     enum ad9361_regcache_mode mode);
+int32_t ad9361_regcache_remove(struct ad9361_rf_phy *phy);
+int32_t ad9361_regcache_set_mode(struct ad9361_rf_phy *phy,
+				 enum ad9361_regcache_mode mode);
+int32_t ad9361_regcache_sync(struct ad9361_rf_phy *phy);
+int32_t ad9361_regcache_bypass(struct ad9361_rf_phy *phy, bool enable);
+void ad9361_regcache_invalidate(struct ad9361_rf_phy *phy);
 int32_t ad9361_reset(struct ad9361_rf_phy *phy);
 int32_t ad9361_register_clocks(struct ad9361_rf_phy *phy);
 int32_t ad9361_unregister_clocks(struct ad9361_rf_phy *phy);
@@ -3541,6 +3615,19 @@ int32_t ad9361_fastlock_load(struct ad9361_rf_phy *phy, bool tx,
 			     uint32_t profile, uint8_t *values);
 int32_t ad9361_fastlock_save(struct ad9361_rf_phy *phy, bool tx,
 			     uint32_t profile, uint8_t *values);
+int32_t ad9361_fastlock_capture(struct ad9361_rf_phy *phy, bool tx,
+				uint8_t *values);
+int32_t ad9361_hop_table_init(struct ad9361_rf_phy *phy,
+			      struct ad9361_hop_table **table, bool tx,
+			      const uint64_t *freqs, uint32_t num);
+int32_t ad9361_hop_table_remove(struct ad9361_rf_phy *phy,
+				struct ad9361_hop_table *table);
+int32_t ad9361_hop_table_set_time_source(struct ad9361_hop_table *table,
+		uint64_t (*get_time_ns)(void));
+int32_t ad9361_hop_prefetch(struct ad9361_rf_phy *phy,
+			    struct ad9361_hop_table *table, uint32_t index);
+int32_t ad9361_hop(struct ad9361_rf_phy *phy, struct ad9361_hop_table *table,
+		   uint32_t index);
 void ad9361_ensm_force_state(struct ad9361_rf_phy *phy, uint8_t ensm_state);
 uint8_t ad9361_ensm_get_state(struct ad9361_rf_phy *phy);
 void ad9361_ensm_restore_state(struct ad9361_rf_phy *phy, uint8_t ensm_state);
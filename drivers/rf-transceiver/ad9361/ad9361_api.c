@@ -506,6 +506,9 @@ int32_t ad9361_init (struct ad9361_rf_phy **ad9361_phy,
 	no_os_gpio_direction_output(phy->gpio_desc_sync, 0);
 
 	no_os_spi_init(&phy->spi, &init_param->spi_param);
+	ret = ad9361_regcache_init(phy, init_param->regcache_mode);
+	if (ret < 0)
+		goto out;
 
 	phy->pdata->port_ctrl.digital_io_ctrl = 0;
 	phy->pdata->port_ctrl.lvds_invert[0] = init_param->lvds_invert1_control;
@@ -544,7 +547,7 @@ int32_t ad9361_init (struct ad9361_rf_phy **ad9361_phy,
 
 	ad9361_reset(phy);
 
-	ret = ad9361_spi_read(phy->spi, REG_PRODUCT_ID);
+	ret = ad9361_spi_read(phy, REG_PRODUCT_ID);
 	if ((ret & PRODUCT_ID_MASK) != PRODUCT_ID_9361) {
 		printf("%s : Unsupported PRODUCT_ID 0x%X", __func__, (unsigned int)ret);
 		ret = -ENODEV;
@@ -582,6 +585,7 @@ int32_t ad9361_init (struct ad9361_rf_phy **ad9361_phy,
 out_clk:
 	ad9361_unregister_clocks(phy);
 out:
+	ad9361_regcache_remove(phy);
 #ifndef AXI_ADC_NOT_PRESENT
 	no_os_free(phy->adc_conv);
 	no_os_free(phy->adc_state);
@@ -602,6 +606,7 @@ out:
 int32_t ad9361_remove(struct ad9361_rf_phy *phy)
 {
 	ad9361_unregister_clocks(phy);
+	ad9361_regcache_remove(phy);
 	no_os_spi_remove(phy->spi);
 	no_os_gpio_remove(phy->gpio_desc_resetb);
 	no_os_gpio_remove(phy->gpio_desc_sync);
@@ -694,9 +699,9 @@ int32_t ad9361_get_en_state_machine_mode (struct ad9361_rf_phy *phy,
 	bool pinctrl = false;
 	int32_t ret;
 
-	ensm_state = ad9361_spi_read(phy->spi, REG_STATE);
+	ensm_state = ad9361_spi_read(phy, REG_STATE);
 	ensm_state &= ENSM_STATE(~0);
-	ret = ad9361_spi_read(phy->spi, REG_ENSM_CONFIG_1);
+	ret = ad9361_spi_read(phy, REG_ENSM_CONFIG_1);
 	if ((ret & ENABLE_ENSM_PIN_CTRL) == ENABLE_ENSM_PIN_CTRL)
 		pinctrl = true;
 
@@ -1039,14 +1044,14 @@ int32_t ad9361_get_rx_fir_config(struct ad9361_rf_phy *phy, uint8_t rx_ch,
 
 	rx_ch += 1;
 
-	ret = ad9361_spi_read(phy->spi, REG_RX_FILTER_CONFIG);
+	ret = ad9361_spi_read(phy, REG_RX_FILTER_CONFIG);
 	if(ret < 0)
 		return ret;
 	fir_conf = ret;
 
 	fir_cfg->rx_coef_size = (((fir_conf & FIR_NUM_TAPS(7)) >> 5) + 1) * 16;
 
-	ret = ad9361_spi_read(phy->spi, REG_RX_FILTER_GAIN);
+	ret = ad9361_spi_read(phy, REG_RX_FILTER_GAIN);
 	if(ret < 0)
 		return ret;
 	fir_cfg->rx_gain = -6 * (ret & FILTER_GAIN(3)) + 6;
@@ -1054,22 +1059,22 @@ int32_t ad9361_get_rx_fir_config(struct ad9361_rf_phy *phy, uint8_t rx_ch,
 
 	fir_conf &= ~FIR_SELECT(3);
 	fir_conf |= FIR_SELECT(rx_ch) | FIR_START_CLK;
-	ad9361_spi_write(phy->spi, REG_RX_FILTER_CONFIG, fir_conf);
+	ad9361_spi_write(phy, REG_RX_FILTER_CONFIG, fir_conf);
 
 	for(index = 0; index < 128; index++) {
-		ad9361_spi_write(phy->spi, REG_RX_FILTER_COEF_ADDR, index);
-		ret = ad9361_spi_read(phy->spi, REG_RX_FILTER_COEF_READ_DATA_1);
+		ad9361_spi_write(phy, REG_RX_FILTER_COEF_ADDR, index);
+		ret = ad9361_spi_read(phy, REG_RX_FILTER_COEF_READ_DATA_1);
 		if(ret < 0)
 			return ret;
 		fir_cfg->rx_coef[index] = ret;
-		ret = ad9361_spi_read(phy->spi, REG_RX_FILTER_COEF_READ_DATA_2);
+		ret = ad9361_spi_read(phy, REG_RX_FILTER_COEF_READ_DATA_2);
 		if(ret < 0)
 			return ret;
 		fir_cfg->rx_coef[index] |= (ret << 8);
 	}
 
 	fir_conf &= ~FIR_START_CLK;
-	ad9361_spi_write(phy->spi, REG_RX_FILTER_CONFIG, fir_conf);
+	ad9361_spi_write(phy, REG_RX_FILTER_CONFIG, fir_conf);
 
 	fir_cfg->rx_dec = phy->rx_fir_dec;
 
@@ -1606,7 +1611,7 @@ int32_t ad9361_get_tx_fir_config(struct ad9361_rf_phy *phy, uint8_t tx_ch,
 
 	tx_ch += 1;
 
-	ret = ad9361_spi_read(phy->spi, REG_TX_FILTER_CONF);
+	ret = ad9361_spi_read(phy, REG_TX_FILTER_CONF);
 	if(ret < 0)
 		return ret;
 	fir_conf = ret;
@@ -1616,22 +1621,22 @@ int32_t ad9361_get_tx_fir_config(struct ad9361_rf_phy *phy, uint8_t tx_ch,
 
 	fir_conf &= ~FIR_SELECT(3);
 	fir_conf |= FIR_SELECT(tx_ch) | FIR_START_CLK;
-	ad9361_spi_write(phy->spi, REG_TX_FILTER_CONF, fir_conf);
+	ad9361_spi_write(phy, REG_TX_FILTER_CONF, fir_conf);
 
 	for(index = 0; index < 128; index++) {
-		ad9361_spi_write(phy->spi, REG_TX_FILTER_COEF_ADDR, index);
-		ret = ad9361_spi_read(phy->spi, REG_TX_FILTER_COEF_READ_DATA_1);
+		ad9361_spi_write(phy, REG_TX_FILTER_COEF_ADDR, index);
+		ret = ad9361_spi_read(phy, REG_TX_FILTER_COEF_READ_DATA_1);
 		if(ret < 0)
 			return ret;
 		fir_cfg->tx_coef[index] = ret;
-		ret = ad9361_spi_read(phy->spi, REG_TX_FILTER_COEF_READ_DATA_2);
+		ret = ad9361_spi_read(phy, REG_TX_FILTER_COEF_READ_DATA_2);
 		if(ret < 0)
 			return ret;
 		fir_cfg->tx_coef[index] |= (ret << 8);
 	}
 
 	fir_conf &= ~FIR_START_CLK;
-	ad9361_spi_write(phy->spi, REG_TX_FILTER_CONF, fir_conf);
+	ad9361_spi_write(phy, REG_TX_FILTER_CONF, fir_conf);
 
 	fir_cfg->tx_int = phy->tx_fir_int;
 
@@ -1698,7 +1703,7 @@ int32_t ad9361_get_tx_rssi (struct ad9361_rf_phy *phy,
 	uint32_t val;
 	int32_t ret;
 
-	ret = ad9361_spi_readm(phy->spi, REG_TX_RSSI_LSB,
+	ret = ad9361_spi_readm(phy, REG_TX_RSSI_LSB,
 			       reg_val_buf, NO_OS_ARRAY_SIZE(reg_val_buf));
 	if (ret < 0) {
 		return ret;
@@ -1953,8 +1958,8 @@ int32_t ad9361_set_no_ch_mode(struct ad9361_rf_phy *phy, uint8_t no_ch_mode)
 						      ID_AD9361 : ID_AD9364];
 #endif
 	ad9361_reset(phy);
-	ad9361_spi_write(phy->spi, REG_SPI_CONF, SOFT_RESET | _SOFT_RESET);
-	ad9361_spi_write(phy->spi, REG_SPI_CONF, 0x0);
+	ad9361_spi_write(phy, REG_SPI_CONF, SOFT_RESET | _SOFT_RESET);
+	ad9361_spi_write(phy, REG_SPI_CONF, 0x0);
 
 	ad9361_clear_state(phy);
 
@@ -2031,10 +2036,10 @@ int32_t ad9361_do_mcs(struct ad9361_rf_phy *phy_master,
 		return -1;
 	}
 
-	reg = ad9361_spi_read(phy_master->spi, REG_RX_CLOCK_DATA_DELAY);
-	ad9361_spi_write(phy_slave->spi, REG_RX_CLOCK_DATA_DELAY, reg);
-	reg = ad9361_spi_read(phy_master->spi, REG_TX_CLOCK_DATA_DELAY);
-	ad9361_spi_write(phy_slave->spi, REG_TX_CLOCK_DATA_DELAY, reg);
+	reg = ad9361_spi_read(phy_master, REG_RX_CLOCK_DATA_DELAY);
+	ad9361_spi_write(phy_slave, REG_RX_CLOCK_DATA_DELAY, reg);
+	reg = ad9361_spi_read(phy_master, REG_TX_CLOCK_DATA_DELAY);
+	ad9361_spi_write(phy_slave, REG_TX_CLOCK_DATA_DELAY, reg);
 
 	ad9361_get_en_state_machine_mode(phy_master, &ensm_mode);
 
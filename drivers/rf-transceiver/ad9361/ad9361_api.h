@@ -295,6 +295,8 @@ typedef struct {
 	struct axi_adc_init	*rx_adc_init;
 	struct axi_dac_init	*tx_dac_init;
 #endif
+	/* Register cache */
+	enum ad9361_regcache_mode	regcache_mode;
 } AD9361_InitParam;
 
 typedef struct {
@@ -270,7 +270,7 @@ static void ad9361_set_intf_delay(struct ad9361_rf_phy *phy, bool tx,
 {
 	if (clock_changed)
 		ad9361_ensm_force_state(phy, ENSM_STATE_ALERT);
-	ad9361_spi_write(phy->spi,
+	ad9361_spi_write(phy,
 			 REG_RX_CLOCK_DATA_DELAY + (tx ? 1 : 0),
 			 RX_DATA_DELAY(data_delay) |
 			 DATA_CLK_DELAY(clock_delay));
@@ -298,7 +298,7 @@ int32_t ad9361_dig_interface_timing_analysis(struct ad9361_rf_phy *phy,
 	loopback = phy->bist_loopback_mode;
 	bist = phy->bist_config;
 	ensm_state = ad9361_ensm_get_state(phy);
-	rx = ad9361_spi_read(phy->spi, REG_RX_CLOCK_DATA_DELAY);
+	rx = ad9361_spi_read(phy, REG_RX_CLOCK_DATA_DELAY);
 
 	/* Mute TX, we don't want to transmit the PRBS */
 	ad9361_tx_mute(phy, 1);
@@ -317,9 +317,9 @@ int32_t ad9361_dig_interface_timing_analysis(struct ad9361_rf_phy *phy,
 	}
 
 	ad9361_ensm_force_state(phy, ENSM_STATE_ALERT);
-	ad9361_spi_write(phy->spi, REG_RX_CLOCK_DATA_DELAY, rx);
+	ad9361_spi_write(phy, REG_RX_CLOCK_DATA_DELAY, rx);
 	ad9361_bist_loopback(phy, loopback);
-	ad9361_spi_write(phy->spi, REG_BIST_CONFIG, bist);
+	ad9361_spi_write(phy, REG_BIST_CONFIG, bist);
 
 	if (!phy->pdata->fdd)
 		ad9361_set_ensm_mode(phy, phy->pdata->fdd, phy->pdata->ensm_pin_ctrl);
@@ -564,7 +564,7 @@ int32_t ad9361_dig_tune(struct ad9361_rf_phy *phy, uint32_t max_freq,
 			ret = ad9361_dig_tune_tx(phy, max_freq, flags);
 
 		ad9361_bist_loopback(phy, loopback);
-		ad9361_spi_write(phy->spi, REG_BIST_CONFIG, bist);
+		ad9361_spi_write(phy, REG_BIST_CONFIG, bist);
 
 		if (ret == -EIO)
 			restore = true;
@@ -574,15 +574,15 @@ int32_t ad9361_dig_tune(struct ad9361_rf_phy *phy, uint32_t max_freq,
 
 	if (restore) {
 		ad9361_ensm_force_state(phy, ENSM_STATE_ALERT);
-		ad9361_spi_write(phy->spi, REG_RX_CLOCK_DATA_DELAY,
+		ad9361_spi_write(phy, REG_RX_CLOCK_DATA_DELAY,
 				 phy->pdata->port_ctrl.rx_clk_data_delay);
-		ad9361_spi_write(phy->spi, REG_TX_CLOCK_DATA_DELAY,
+		ad9361_spi_write(phy, REG_TX_CLOCK_DATA_DELAY,
 				 phy->pdata->port_ctrl.tx_clk_data_delay);
 	} else if (!(flags & SKIP_STORE_RESULT)) {
 		phy->pdata->port_ctrl.rx_clk_data_delay =
-			ad9361_spi_read(phy->spi, REG_RX_CLOCK_DATA_DELAY);
+			ad9361_spi_read(phy, REG_RX_CLOCK_DATA_DELAY);
 		phy->pdata->port_ctrl.tx_clk_data_delay =
-			ad9361_spi_read(phy->spi, REG_TX_CLOCK_DATA_DELAY);
+			ad9361_spi_read(phy, REG_TX_CLOCK_DATA_DELAY);
 	}
 
 	if (!phy->pdata->fdd)
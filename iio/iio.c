@@ -53,6 +53,9 @@
 #include "no_os_error.h"
 #include "no_os_alloc.h"
 #include "no_os_circular_buffer.h"
+#ifdef IIO_ZSTD
+#include "no_os_zstd.h"
+#endif
 #include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
@@ -68,6 +71,22 @@
 #include "lwip_socket.h"
 #endif
 
+/* On Linux the sockets are file descriptors and can be watched with epoll */
+#if defined(NO_OS_NETWORKING) && defined(LINUX_PLATFORM)
+#define IIO_USE_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#ifdef IIO_THREADED
+#ifndef IIO_USE_EPOLL
+#error "IIO_THREADED is supported only on Linux with NO_OS_NETWORKING"
+#endif
+#include <pthread.h>
+#include "no_os_atomic.h"
+#endif
+
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
 /******************************************************************************/
@@ -77,6 +96,28 @@
 #define REG_ACCESS_ATTRIBUTE	"direct_reg_access"
 #define IIOD_CONN_BUFFER_SIZE	0x1000
 #define NO_TRIGGER				(uint32_t)-1
+#define IIO_DEV_ID_PREFIX	"iio:device"
+
+#ifdef IIO_USE_EPOLL
+/* Longest time iio_step waits for events, so the application still gets
+ * control back periodically (e.g. iio_app post_step_callback) */
+#ifndef IIO_STEP_TIMEOUT_MS
+#define IIO_STEP_TIMEOUT_MS	10
+#endif
+/* Steps a connection can run in one iio_step before the others get a turn */
+#ifndef IIO_CONN_STEP_BUDGET
+#define IIO_CONN_STEP_BUDGET	16
+#endif
+/* Period at which a connection waiting for its device is stepped again */
+#ifndef IIO_DEVICE_POLL_MS
+#define IIO_DEVICE_POLL_MS	1
+#endif
+/* Socket operation that made a connection step return -EAGAIN */
+#define IIO_WAIT_RECV		NO_OS_BIT(0)
+#define IIO_WAIT_SEND		NO_OS_BIT(1)
+/* Operation queued to the worker of a device */
+#define IIO_WAIT_JOB		NO_OS_BIT(2)
+#endif
 
 #define NO_OS_STRINGIFY(x) #x
 #define NO_OS_TOSTRING(x) NO_OS_STRINGIFY(x)
@@ -163,6 +204,28 @@ struct iio_buffer_priv {
 	bool			initalized;
 	/* Set when no_os_calloc was used to initalize cb.buf */
 	bool			allocated;
+	/* Number of blocks to allocate when raw_buf is not provided */
+	uint32_t		buffers_count;
+};
+
+/* Entry of the channel lookup table of a device */
+struct iio_ch_lookup {
+	/* Hash of the channel id and direction */
+	uint32_t		hash;
+	/* Index in iio_device.channels. Set to -1 for empty entries */
+	int32_t			idx;
+};
+
+/* Entry of the attribute lookup table of a device */
+struct iio_attr_lookup {
+	/* Hash of the attribute name, type and channel index */
+	uint32_t		hash;
+	/* Channel index for channel attributes, 0 otherwise */
+	uint16_t		ch_idx;
+	/* Attribute type (enum iio_attr_type) */
+	uint8_t			type;
+	/* Referenced attribute. NULL for empty entries */
+	struct iio_attribute	*attr;
 };
 
 /**
@@ -170,6 +233,62 @@ struct iio_buffer_priv {
  * @brief Links a physical device instance "void *dev_instance"
  * with a "iio_device *iio" that describes capabilities of the device.
  */
+#ifdef IIO_THREADED
+enum iio_job_op {
+	IIO_JOB_READ_ATTR,
+	IIO_JOB_WRITE_ATTR,
+	IIO_JOB_REFILL_BUFFER,
+	IIO_JOB_PUSH_BUFFER,
+};
+
+enum iio_job_state {
+	IIO_JOB_FREE,
+	IIO_JOB_QUEUED,
+	IIO_JOB_RUNNING,
+	IIO_JOB_DONE,
+};
+
+/**
+ * @struct iio_job
+ * @brief Device callback requested by a connection and executed by the
+ * worker of the device.
+ */
+struct iio_job {
+	enum iio_job_state	state;
+	/* Set if the connection was closed while the job was running */
+	bool			cancel;
+	enum iio_job_op		op;
+	struct iiod_ctx		ctx;
+	const char		*device;
+	struct iiod_attr	attr;
+	/*
+	 * Copy of the attribute value, name and channel owned by the job, so
+	 * the connection can be closed while the job runs
+	 */
+	char			*buf;
+	uint32_t		len;
+	int			ret;
+};
+
+/**
+ * @struct iio_dev_worker
+ * @brief Thread executing the buffer and attribute callbacks of a device.
+ */
+struct iio_dev_worker {
+	pthread_t		thread;
+	bool			started;
+	bool			stop;
+	/* Held while a callback of the device is executed */
+	pthread_mutex_t		lock;
+	/* Protects jobs and stop */
+	pthread_mutex_t		job_lock;
+	/* Signaled when a job is queued or the worker is stopped */
+	pthread_cond_t		cond;
+	/* Jobs, indexed by connection id */
+	struct iio_job		jobs[IIOD_MAX_CONNECTIONS];
+};
+#endif
+
 struct iio_dev_priv {
 	/** Will be: iio:device[0...n] n beeing the count of registerd devices*/
 	char			dev_id[MAX_DEV_ID];
@@ -187,6 +306,22 @@ struct iio_dev_priv {
 	struct iio_buffer_priv buffer;
 	/* Set to -1 when no trigger is set*/
 	uint32_t		trig_idx;
+	/** Channel ids, computed once at init. Indexed like channels */
+	char			**ch_ids;
+	/** Open addressing hash table used to find channels by id */
+	struct iio_ch_lookup	*ch_table;
+	/** Number of entries in ch_table - 1. Size is a power of 2 */
+	uint32_t		ch_table_mask;
+	/** Open addressing hash table used to find attributes by name */
+	struct iio_attr_lookup	*attr_table;
+	/** Number of entries in attr_table - 1. Size is a power of 2 */
+	uint32_t		attr_table_mask;
+	/** Xml invalidated while it was being sent. Freed when no longer used */
+	bool			xml_stale;
+#ifdef IIO_THREADED
+	/** Worker thread of the device */
+	struct iio_dev_worker	worker;
+#endif
 };
 
 /**
@@ -203,22 +338,40 @@ struct iio_trig_priv {
 	void	*instance;
 	/** Trigger descriptor(describes type of trigger and its attributes) */
 	struct iio_trigger *descriptor;
-	/** Set to true when the triggering condition is met */
-	bool	triggered;
+	/**
+	 * Set when an asynchronous trigger fired. The trigger handlers of its
+	 * devices are then called from iio_step.
+	 */
+	volatile bool	triggered;
+	/** Bitmask of the devices using the trigger. Indexed like devs */
+	uint32_t	*dev_mask;
 };
 
 struct iio_desc {
 	struct iiod_desc	*iiod;
 	struct iiod_ops		iiod_ops;
 	void			*phy_desc;
-	char			*xml_desc;
-	uint32_t		xml_size;
+	/* Fragments of the context xml. Generated when first requested */
+	struct iiod_xml_fragment	*xml_frags;
+	uint32_t		nb_xml_frags;
+	/* Zstandard compressed xml (IIO_ZSTD). Generated when first requested */
+	struct iiod_xml_fragment	zxml;
+	/* Connections sending xml_frags or zxml. They are not freed meanwhile */
+	uint32_t		xml_users;
+	/* Set when a device of devs has xml_stale set */
+	bool			xml_stale;
 	struct iio_ctx_attr	*ctx_attrs;
 	uint32_t		nb_ctx_attr;
 	struct iio_dev_priv	*devs;
 	uint32_t		nb_devs;
 	struct iio_trig_priv	*trigs;
 	uint32_t		nb_trigs;
+	/* Storage for the device masks of the triggers */
+	uint32_t		*trig_dev_masks;
+	/* Number of words of a device mask */
+	uint32_t		dev_mask_words;
+	/* Set when an asynchronous trigger fired. Cleared by iio_step */
+	volatile bool		trigs_pending;
 	struct no_os_uart_desc	*uart_desc;
 	int (*recv)(void *conn, uint8_t *buf, uint32_t len);
 	int (*send)(void *conn, uint8_t *buf, uint32_t len);
@@ -229,6 +382,26 @@ struct iio_desc {
 	/* Instance of server socket */
 	struct tcp_socket_desc	*server;
 #endif
+#ifdef IIO_USE_EPOLL
+	/* Watches the server socket, the wake_fd and the client sockets */
+	int			epoll_fd;
+	/* Signaled to wake iio_step when an asynchronous trigger occurs */
+	int			wake_fd;
+	/* Client socket and events watched for each connection */
+	struct tcp_socket_desc	*conn_socks[IIOD_MAX_CONNECTIONS];
+	uint32_t		conn_events[IIOD_MAX_CONNECTIONS];
+	/* Connections to step without waiting for a socket event */
+	uint32_t		ready_conns;
+	/* Connections waiting for their device, stepped every
+	 * IIO_DEVICE_POLL_MS */
+	uint32_t		wait_conns;
+	/* IIO_WAIT_* flags set by the connection being stepped */
+	uint32_t		io_wait;
+#endif
+#ifdef IIO_THREADED
+	/* Connections whose job is done. Set by the device workers */
+	uint32_t		done_conns;
+#endif
 };
 
 /******************************************************************************/
@@ -264,15 +437,44 @@ static inline int32_t _nb_active_conns(struct iio_desc *desc)
 static int iio_recv(struct iiod_ctx *ctx, uint8_t *buf, uint32_t len)
 {
 	struct iio_desc *desc = ctx->instance;
+	int ret;
 
-	return desc->recv(ctx->conn, buf, len);
+	ret = desc->recv(ctx->conn, buf, len);
+#ifdef IIO_USE_EPOLL
+	if (ret == -EAGAIN)
+		desc->io_wait |= IIO_WAIT_RECV;
+#endif
+
+	return ret;
 }
 
 static int iio_send(struct iiod_ctx *ctx, uint8_t *buf, uint32_t len)
 {
 	struct iio_desc *desc = ctx->instance;
+	int ret;
+
+	ret = desc->send(ctx->conn, buf, len);
+#ifdef IIO_USE_EPOLL
+	if (ret == -EAGAIN)
+		desc->io_wait |= IIO_WAIT_SEND;
+#endif
+
+	return ret;
+}
+
+/*
+ * UARTs with a receive ring (filled by interrupts, DMA or a reader thread)
+ * return the bytes received so far. The others block until all requested
+ * bytes are received, so they are read one byte at a time.
+ */
+static int iio_uart_recv(void *conn, uint8_t *buf, uint32_t len)
+{
+	struct no_os_uart_desc *uart = conn;
+
+	if (!uart->rx_ring && !uart->rx_fifo)
+		len = 1;
 
-	return desc->send(ctx->conn, buf, len);
+	return no_os_uart_read(uart, buf, len);
 }
 
 static inline void _print_ch_id(char *buff, struct iio_channel *ch)
@@ -295,25 +497,97 @@ static inline void _print_ch_id(char *buff, struct iio_channel *ch)
 	}
 }
 
+/* FNV-1a hash of a string */
+static uint32_t iio_hash_str(const char *str, uint32_t hash)
+{
+	while (*str) {
+		hash ^= (uint8_t)*str++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static inline uint32_t iio_ch_hash(const char *ch_id, bool ch_out)
+{
+	return iio_hash_str(ch_id, ch_out ? 0x050c5d1fu : 2166136261u);
+}
+
+static inline uint32_t iio_attr_hash(const char *name, enum iio_attr_type type,
+				     uint16_t ch_idx)
+{
+	return iio_hash_str(name, 2166136261u ^ (type << 16 | ch_idx));
+}
+
+/* Smallest power of 2 table size having at least twice n entries */
+static uint32_t iio_lookup_table_size(uint32_t n)
+{
+	uint32_t size = 2;
+
+	while (size < 2 * n)
+		size <<= 1;
+
+	return size;
+}
+
 /**
- * @brief Get channel ID from a list of channels.
- * @param channel - Channel name.
- * @param desc - Device descriptor
+ * @brief Get channel from the channel lookup table of a device.
+ * @param channel - Channel id.
+ * @param dev - Device
  * @param ch_out - If "true" is output channel, if "false" is input channel.
- * @return Channel ID, or negative value if attribute is not found.
+ * @return Channel index, or negative value if channel is not found.
  */
-static inline struct iio_channel *iio_get_channel(const char *channel,
-		struct iio_device *desc, bool ch_out)
+static int32_t iio_get_channel(const char *channel, struct iio_dev_priv *dev,
+			       bool ch_out)
 {
-	int16_t i = 0;
-	char	ch_id[MAX_CHN_ID];
+	struct iio_channel *channels = dev->dev_descriptor->channels;
+	struct iio_ch_lookup *entry;
+	uint32_t hash, i;
 
-	while (i < desc->num_ch) {
-		_print_ch_id(ch_id, &desc->channels[i]);
-		if (!strcmp(channel, ch_id) &&
-		    (desc->channels[i].ch_out == ch_out))
-			return &desc->channels[i];
-		i++;
+	if (!dev->ch_table)
+		return -ENOENT;
+
+	hash = iio_ch_hash(channel, ch_out);
+	i = hash & dev->ch_table_mask;
+	for (entry = &dev->ch_table[i]; entry->idx >= 0;
+	     entry = &dev->ch_table[i]) {
+		if (entry->hash == hash &&
+		    channels[entry->idx].ch_out == ch_out &&
+		    !strcmp(dev->ch_ids[entry->idx], channel))
+			return entry->idx;
+		i = (i + 1) & dev->ch_table_mask;
+	}
+
+	return -ENOENT;
+}
+
+/**
+ * @brief Get attribute from the attribute lookup table of a device.
+ * @param dev - Device
+ * @param type - Attribute type
+ * @param ch_idx - Channel index for channel attributes, 0 otherwise.
+ * @param name - Attribute name
+ * @return Attribute pointer if found, NULL otherwise.
+ */
+static struct iio_attribute *iio_get_attribute(struct iio_dev_priv *dev,
+		enum iio_attr_type type,
+		uint16_t ch_idx,
+		const char *name)
+{
+	struct iio_attr_lookup *entry;
+	uint32_t hash, i;
+
+	if (!dev->attr_table)
+		return NULL;
+
+	hash = iio_attr_hash(name, type, ch_idx);
+	i = hash & dev->attr_table_mask;
+	for (entry = &dev->attr_table[i]; entry->attr;
+	     entry = &dev->attr_table[i]) {
+		if (entry->hash == hash && entry->type == type &&
+		    entry->ch_idx == ch_idx && !strcmp(entry->attr->name, name))
+			return entry->attr;
+		i = (i + 1) & dev->attr_table_mask;
 	}
 
 	return NULL;
@@ -328,14 +602,23 @@ static inline struct iio_channel *iio_get_channel(const char *channel,
 static struct iio_dev_priv *get_iio_device(struct iio_desc *desc,
 		const char *device_name)
 {
+	const char *p;
 	uint32_t i;
 
-	for (i = 0; i < desc->nb_devs; i++) {
-		if (strcmp(desc->devs[i].dev_id, device_name) == 0)
-			return &desc->devs[i];
-	}
+	/* Device ids are IIO_DEV_ID_PREFIX followed by the device index */
+	if (strncmp(device_name, IIO_DEV_ID_PREFIX,
+		    sizeof(IIO_DEV_ID_PREFIX) - 1))
+		return NULL;
 
-	return NULL;
+	p = device_name + sizeof(IIO_DEV_ID_PREFIX) - 1;
+	if (!isdigit((unsigned char)*p))
+		return NULL;
+
+	i = strtoul(p, NULL, 10);
+	if (i >= desc->nb_devs || strcmp(desc->devs[i].dev_id, device_name))
+		return NULL;
+
+	return &desc->devs[i];
 }
 
 /**
@@ -368,16 +651,21 @@ static int iio_set_buffers_count(struct iiod_ctx *ctx, const char *device,
 				 uint32_t buffers_count)
 {
 	struct iio_desc *desc = ctx->instance;
+	struct iio_dev_priv *dev;
 
-	if(!get_iio_device(desc, device))
+	dev = get_iio_device(desc, device);
+	if (!dev)
 		return -ENODEV;
 
-	/* Our implementation uses a circular buffer to send/receive data so
-	 * only 1 is a valid value.
-	 */
-	if (buffers_count != 1)
+	if (!buffers_count)
 		return -EINVAL;
 
+	/*
+	 * Blocks are allocated on the next open. If a raw_buf is provided,
+	 * the number of blocks is given by how many fit in it.
+	 */
+	dev->buffer.buffers_count = buffers_count;
+
 	return 0;
 }
 
@@ -472,6 +760,35 @@ static int iio_write_all_attr(struct attr_fun_params *params,
 #endif
 }
 
+/**
+ * @brief Call show or store function of an attribute.
+ * @param params - Structure describing parameters for store and show functions
+ * @param attr - Attribute to be read or written.
+ * @param is_write -If it has value "1", writes attribute, otherwise reads
+ * 		attribute.
+ * @return Length of chars written/read or negative value in case of error.
+ */
+static int iio_call_attribute(struct attr_fun_params *params,
+			      struct iio_attribute *attr,
+			      bool is_write)
+{
+	if (!attr)
+		return -ENOENT;
+
+	if (is_write) {
+		if (!attr->store)
+			return -ENOENT;
+
+		return attr->store(params->dev_instance, params->buf,
+				   params->len, params->ch_info, attr->priv);
+	} else {
+		if (!attr->show)
+			return -ENOENT;
+		return attr->show(params->dev_instance, params->buf,
+				  params->len, params->ch_info, attr->priv);
+	}
+}
+
 /**
  * @brief Read/write attribute.
  * @param params - Structure describing parameters for store and show functions
@@ -488,6 +805,9 @@ static int iio_rd_wr_attribute(struct attr_fun_params *params,
 {
 	int16_t i = 0;
 
+	if (!attributes)
+		return -ENOENT;
+
 	/* Search attribute */
 	while (attributes[i].name) {
 		if (!strcmp(attr_name, attributes[i].name))
@@ -498,20 +818,7 @@ static int iio_rd_wr_attribute(struct attr_fun_params *params,
 	if (!attributes[i].name)
 		return -ENOENT;
 
-	if (is_write) {
-		if (!attributes[i].store)
-			return -ENOENT;
-
-		return attributes[i].store(params->dev_instance, params->buf,
-					   params->len, params->ch_info,
-					   attributes[i].priv);
-	} else {
-		if (!attributes[i].show)
-			return -ENOENT;
-		return attributes[i].show(params->dev_instance, params->buf,
-					  params->len, params->ch_info,
-					  attributes[i].priv);
-	}
+	return iio_call_attribute(params, &attributes[i], is_write);
 }
 
 /* Read a device register. The register address to read is set on
@@ -781,6 +1088,7 @@ static int iio_read_attr(struct iiod_ctx *ctx, const char *device,
 	struct iio_channel *ch = NULL;
 	struct attr_fun_params params;
 	struct iio_attribute *attributes;
+	int32_t ch_idx = 0;
 	int8_t ch_out;
 
 	dev = get_iio_device(ctx->instance, device);
@@ -796,10 +1104,10 @@ static int iio_read_attr(struct iiod_ctx *ctx, const char *device,
 
 		if (attr->channel[0] != '\0') {
 			ch_out = attr->type == IIO_ATTR_TYPE_CH_OUT ? 1 : 0;
-			ch = iio_get_channel(attr->channel, dev->dev_descriptor,
-					     ch_out);
-			if (!ch)
+			ch_idx = iio_get_channel(attr->channel, dev, ch_out);
+			if (ch_idx < 0)
 				return -ENOENT;
+			ch = &dev->dev_descriptor->channels[ch_idx];
 			ch_info.ch_out = ch_out;
 			ch_info.ch_num = ch->channel;
 			ch_info.type = ch->ch_type;
@@ -813,10 +1121,14 @@ static int iio_read_attr(struct iiod_ctx *ctx, const char *device,
 		params.buf = buf;
 		params.len = len;
 		params.dev_instance = dev->dev_instance;
-		attributes = get_attributes(attr->type, dev, ch);
-		if (!strcmp(attr->name, ""))
+		if (!strcmp(attr->name, "")) {
+			attributes = get_attributes(attr->type, dev, ch);
 			return iio_read_all_attr(&params, attributes);
-		return iio_rd_wr_attribute(&params, attributes, attr->name, 0);
+		}
+		return iio_call_attribute(&params,
+					  iio_get_attribute(dev, attr->type,
+							    ch_idx, attr->name),
+					  0);
 	}
 
 	/* IIO device with given name is not found, verify if it corresponds to a trigger */
@@ -856,6 +1168,7 @@ static int iio_write_attr(struct iiod_ctx *ctx, const char *device,
 	struct iio_attribute	*attributes;
 	struct iio_ch_info ch_info;
 	struct iio_channel *ch = NULL;
+	int32_t ch_idx = 0;
 	int8_t ch_out;
 
 	dev = get_iio_device(ctx->instance, device);
@@ -872,10 +1185,10 @@ static int iio_write_attr(struct iiod_ctx *ctx, const char *device,
 
 		if (attr->channel[0] != '\0') {
 			ch_out = attr->type == IIO_ATTR_TYPE_CH_OUT ? 1 : 0;
-			ch = iio_get_channel(attr->channel, dev->dev_descriptor,
-					     ch_out);
-			if (!ch)
+			ch_idx = iio_get_channel(attr->channel, dev, ch_out);
+			if (ch_idx < 0)
 				return -ENOENT;
+			ch = &dev->dev_descriptor->channels[ch_idx];
 
 			ch_info.ch_out = ch_out;
 			ch_info.ch_num = ch->channel;
@@ -890,10 +1203,14 @@ static int iio_write_attr(struct iiod_ctx *ctx, const char *device,
 		params.buf = (char *)buf;
 		params.len = len;
 		params.dev_instance = dev->dev_instance;
-		attributes = get_attributes(attr->type, dev, ch);
-		if (!strcmp(attr->name, ""))
+		if (!strcmp(attr->name, "")) {
+			attributes = get_attributes(attr->type, dev, ch);
 			return iio_write_all_attr(&params, attributes);
-		return iio_rd_wr_attribute(&params, attributes, attr->name, 1);
+		}
+		return iio_call_attribute(&params,
+					  iio_get_attribute(dev, attr->type,
+							    ch_idx, attr->name),
+					  1);
 	}
 
 	/* IIO device with given name is not found, verify if it corresponds to a trigger */
@@ -915,6 +1232,27 @@ static int iio_write_attr(struct iiod_ctx *ctx, const char *device,
 	return -ENODEV;
 }
 
+/**
+ * @brief Set the trigger of a device and update the device masks of the
+ * triggers.
+ * @param desc - IIO descriptor.
+ * @param dev - Device.
+ * @param trig_idx - Trigger index or NO_TRIGGER.
+ */
+static void iio_dev_set_trig(struct iio_desc *desc, struct iio_dev_priv *dev,
+			     uint32_t trig_idx)
+{
+	uint32_t i = dev - desc->devs;
+
+	if (dev->trig_idx != NO_TRIGGER)
+		desc->trigs[dev->trig_idx].dev_mask[i / 32] &=
+			~NO_OS_BIT(i % 32);
+
+	dev->trig_idx = trig_idx;
+	if (trig_idx != NO_TRIGGER)
+		desc->trigs[trig_idx].dev_mask[i / 32] |= NO_OS_BIT(i % 32);
+}
+
 /**
  * @brief Searches for trigger id and returns trigger index.
  * @param desc - IIO descriptor.
@@ -1022,7 +1360,7 @@ static int iio_set_trigger(struct iiod_ctx *ctx, const char *device,
 		return -ENODEV;
 
 	if (trigger[0] == '\0') {
-		dev->trig_idx = NO_TRIGGER;
+		iio_dev_set_trig(desc, dev, NO_TRIGGER);
 		return 0;
 	}
 
@@ -1030,32 +1368,69 @@ static int iio_set_trigger(struct iiod_ctx *ctx, const char *device,
 	if (i == NO_TRIGGER)
 		return -EINVAL;
 
-	dev->trig_idx = i;
+	iio_dev_set_trig(desc, dev, i);
 
 	return len;
 }
 
+/**
+ * @brief Call the trigger handlers of the devices using a trigger.
+ * @param desc - IIO descriptor.
+ * @param trig - Trigger.
+ * @param async - Set if called from iio_step, not from the trigger source.
+ */
+static void iio_trig_run_handlers(struct iio_desc *desc,
+				  struct iio_trig_priv *trig, bool async)
+{
+	struct iio_dev_priv *dev;
+	uint32_t i, id, bits;
+
+	for (i = 0; i < desc->dev_mask_words; i++) {
+		bits = trig->dev_mask[i];
+		for (id = i * 32; bits; id++, bits >>= 1) {
+			if (!(bits & 1))
+				continue;
+
+			dev = desc->devs + id;
+			if (!dev->dev_descriptor->trigger_handler)
+				continue;
+#ifdef IIO_THREADED
+			if (async)
+				pthread_mutex_lock(&dev->worker.lock);
+#endif
+			dev->dev_descriptor->trigger_handler(&dev->dev_data);
+#ifdef IIO_THREADED
+			if (async)
+				pthread_mutex_unlock(&dev->worker.lock);
+#endif
+		}
+	}
+}
+
 /**
  * @brief Asynchronous trigger processing routine.
  * @param desc - IIO descriptor.
  */
 static void iio_process_async_triggers(struct iio_desc *desc)
 {
-	struct iio_dev_priv *dev;
+	struct iio_trig_priv *trig;
 	uint32_t i;
 
-	for (i = 0; i < desc->nb_devs; i++) {
-		dev = desc->devs + i;
-		if (dev->trig_idx == NO_TRIGGER)
-			continue;
+	if (!desc->trigs_pending)
+		return;
 
-		if (!desc->trigs[dev->trig_idx].triggered)
+	/*
+	 * Clear the flags before calling the handlers, so a trigger firing
+	 * meanwhile is handled in the next step.
+	 */
+	desc->trigs_pending = false;
+	for (i = 0; i < desc->nb_trigs; i++) {
+		trig = desc->trigs + i;
+		if (!trig->triggered)
 			continue;
 
-		if (dev->dev_descriptor->trigger_handler) {
-			dev->dev_descriptor->trigger_handler(&dev->dev_data);
-			desc->trigs[i].triggered = 0;
-		}
+		trig->triggered = false;
+		iio_trig_run_handlers(desc, trig, true);
 	}
 }
 
@@ -1069,34 +1444,37 @@ static void iio_process_async_triggers(struct iio_desc *desc)
  */
 int iio_process_trigger_type(struct iio_desc *desc, char *trigger_name)
 {
-	uint32_t i;
-	uint32_t trig_id;
 	struct iio_trig_priv *trig;
+	uint32_t trig_id;
 
 	trig_id = iio_get_trig_idx_by_name(desc, trigger_name);
-
 	if (trig_id == NO_TRIGGER)
 		return -EINVAL;
 
-	struct iio_dev_priv *dev;
-
-	for (i = 0; i < desc->nb_devs; i++) {
-		dev = desc->devs + i;
-		if (dev->trig_idx == trig_id) {
-			trig = &desc->trigs[trig_id];
-			if (trig->descriptor->is_synchronous) {
-				if (dev->dev_descriptor->trigger_handler)
-					dev->dev_descriptor->trigger_handler(&dev->dev_data);
-			} else {
-				trig->triggered = 1;
-			}
-		}
+	trig = &desc->trigs[trig_id];
+	if (trig->descriptor->is_synchronous) {
+		iio_trig_run_handlers(desc, trig, false);
+	} else {
+		trig->triggered = true;
+		desc->trigs_pending = true;
+#ifdef IIO_USE_EPOLL
+		eventfd_write(desc->wake_fd, 1);
+#endif
 	}
 
 	return 0;
 }
 
-static uint32_t bytes_per_scan(struct iio_channel *channels, uint32_t mask)
+/**
+ * @brief Get the layout of a scan.
+ * @param channels - Channels of the device.
+ * @param mask - Active channels.
+ * @param offsets - If not NULL, filled with the offset in bytes of each
+ *		    active channel in a scan, in channel order.
+ * @return Number of bytes per scan.
+ */
+uint32_t iio_scan_layout(struct iio_channel *channels, uint32_t mask,
+			 uint32_t *offsets)
 {
 	uint32_t cnt, i, length, largest = 1;
 
@@ -1113,6 +1491,9 @@ static uint32_t bytes_per_scan(struct iio_channel *channels, uint32_t mask)
 				cnt += 2 * length - (cnt % length);
 			else
 				cnt += length;
+
+			if (offsets)
+				*offsets++ = cnt - length;
 		}
 
 		mask >>= 1;
@@ -1161,7 +1542,7 @@ static int iio_open_dev(struct iiod_ctx *ctx, const char *device,
 
 	dev->buffer.public.active_mask = mask;
 	dev->buffer.public.bytes_per_scan =
-		bytes_per_scan(dev->dev_descriptor->channels, mask);
+		iio_scan_layout(dev->dev_descriptor->channels, mask, NULL);
 	dev->buffer.public.size = dev->buffer.public.bytes_per_scan * samples;
 	dev->buffer.public.samples = samples;
 	if (dev->buffer.raw_buf && dev->buffer.raw_buf_len) {
@@ -1177,12 +1558,14 @@ static int iio_open_dev(struct iiod_ctx *ctx, const char *device,
 			no_os_free(dev->buffer.cb.buff);
 			dev->buffer.allocated = 0;
 		}
-		buf_size = dev->buffer.public.size;
-		buf = (int8_t *)no_os_calloc(dev->buffer.public.size, sizeof(*buf));
+		buf_size = dev->buffer.public.size * dev->buffer.buffers_count;
+		buf = (int8_t *)no_os_calloc(buf_size, sizeof(*buf));
 		if (!buf)
 			return -ENOMEM;
 		dev->buffer.allocated = 1;
 	}
+	dev->buffer.public.nb_blocks = buf_size / dev->buffer.public.size;
+	dev->buffer.public.queued_blocks = 0;
 
 	ret = no_os_cb_cfg(&dev->buffer.cb, buf, buf_size);
 	if (NO_OS_IS_ERR_VALUE(ret)) {
@@ -1351,6 +1734,74 @@ static int iio_read_buffer(struct iiod_ctx *ctx, const char *device, char *buf,
 	return bytes;
 }
 
+/**
+ * @brief Get a contiguous region of the device buffer holding data to be
+ * read, without copying it. Data is consumed by iio_read_buffer_done().
+ * The region is reserved, producers don't overwrite it until it is consumed.
+ * @param ctx - IIO instance and conn instance
+ * @param device - String containing device name.
+ * @param buf - Set to the start of the region.
+ * @param bytes - Maximum number of bytes to read.
+ * @param wait_all - If set, wait until bytes of data are available.
+ * @return Length of the region or negative value in case of error.
+ */
+static int iio_read_buffer_zc(struct iiod_ctx *ctx, const char *device,
+			      char **buf, uint32_t bytes, bool wait_all)
+{
+	struct iio_dev_priv	*dev;
+	int32_t			ret;
+	uint32_t		size;
+
+	dev = get_iio_device(ctx->instance, device);
+	if (!dev || !dev->buffer.initalized)
+		return -EINVAL;
+
+	ret = no_os_cb_size(&dev->buffer.cb, &size);
+#ifdef IIO_IGNORE_BUFF_OVERRUN_ERR
+	if (ret != -NO_OS_EOVERRUN)
+#endif
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+	/* The buffer can't hold more than its size */
+	if (wait_all && size < no_os_min(bytes, dev->buffer.cb.size))
+		return -EAGAIN;
+
+	bytes = no_os_min(size, bytes);
+	if (!bytes)
+		return -EAGAIN;
+
+	ret = no_os_cb_prepare_async_read(&dev->buffer.cb, bytes, (void **)buf,
+					  &size);
+#ifdef IIO_IGNORE_BUFF_OVERRUN_ERR
+	if (ret != -NO_OS_EOVERRUN)
+#endif
+		if (NO_OS_IS_ERR_VALUE(ret)) {
+			/* Data is dropped, same as for iio_read_buffer */
+			if (ret == -NO_OS_EOVERRUN)
+				no_os_cb_end_async_read(&dev->buffer.cb);
+			return ret;
+		}
+
+	return size;
+}
+
+/**
+ * @brief Consume the region returned by iio_read_buffer_zc().
+ * @param ctx - IIO instance and conn instance
+ * @param device - String containing device name.
+ * @return 0 or negative value in case of error.
+ */
+static int iio_read_buffer_done(struct iiod_ctx *ctx, const char *device)
+{
+	struct iio_dev_priv	*dev;
+
+	dev = get_iio_device(ctx->instance, device);
+	if (!dev || !dev->buffer.initalized)
+		return -EINVAL;
+
+	return no_os_cb_end_async_read(&dev->buffer.cb);
+}
 
 /**
  * @brief Write chunk of data into RAM.
@@ -1385,37 +1836,96 @@ static int iio_write_buffer(struct iiod_ctx *ctx, const char *device,
 	return bytes;
 }
 
+/*
+ * Blocks are consecutive regions of iio_buffer.size bytes in the circular
+ * buffer, starting from the write index for input buffers and from the read
+ * index for output buffers. Since the circular buffer size is a multiple of
+ * the block size, blocks never wrap around. Queued blocks are completed in
+ * the order they were returned.
+ */
 int iio_buffer_get_block(struct iio_buffer *buffer, void **addr)
 {
+	struct no_os_circular_buffer *cb;
+	uint32_t offset;
 	uint32_t size;
+	int32_t ret;
 
-	if (!buffer)
+	if (!buffer || !addr)
 		return -EINVAL;
 
-	if (buffer->dir == IIO_DIRECTION_INPUT)
-		return no_os_cb_prepare_async_write(buffer->buf, buffer->size, addr, &size);
+	cb = buffer->buf;
+	if (buffer->queued_blocks >= no_os_max(buffer->nb_blocks, 1))
+		return -EBUSY;
+
+	offset = buffer->queued_blocks * buffer->size;
+	if (buffer->dir == IIO_DIRECTION_INPUT) {
+		/* Don't overwrite a region being sent by iio_read_buffer_zc */
+		if (cb->read.async_started) {
+			ret = no_os_cb_size(cb, &size);
+			if (NO_OS_IS_ERR_VALUE(ret) ||
+			    offset + buffer->size > cb->size - size)
+				return -EBUSY;
+		}
+		offset += cb->write.idx;
+	} else {
+		/* Block must contain data to be sent */
+		ret = no_os_cb_size(cb, &size);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+		if (size <= offset)
+			return -EAGAIN;
+		offset += cb->read.idx;
+	}
 
-	return no_os_cb_prepare_async_read(buffer->buf, buffer->size, addr, &size);
+	*addr = cb->buff + offset % cb->size;
+	buffer->queued_blocks++;
+
+	return 0;
 }
 
 int iio_buffer_block_done(struct iio_buffer *buffer)
 {
+	struct no_os_circular_buffer *cb;
+	uint32_t size;
+	void *addr;
+	int32_t ret;
+
 	if (!buffer)
 		return -EINVAL;
 
+	if (!buffer->queued_blocks)
+		return -EINVAL;
+
+	cb = buffer->buf;
+	buffer->queued_blocks--;
+
+	/* Advance the index over the oldest queued block */
 	if (buffer->dir == IIO_DIRECTION_INPUT)
-		return no_os_cb_end_async_write(buffer->buf);
+		return no_os_cb_advance_write(cb, buffer->size);
 
-	return no_os_cb_end_async_read(buffer->buf);
+	ret = no_os_cb_prepare_async_read(cb, buffer->size, &addr, &size);
+	/* On overrun the read index was already moved to the newest data */
+	if (NO_OS_IS_ERR_VALUE(ret) && ret != -NO_OS_EOVERRUN)
+		return ret;
+
+	return no_os_cb_end_async_read(cb);
 }
 
 /* Write to buffer iio_buffer.bytes_per_scan bytes from data */
 int iio_buffer_push_scan(struct iio_buffer *buffer, void *data)
+{
+	return iio_buffer_push_scans(buffer, data, 1);
+}
+
+/* Write to buffer nb_scans * iio_buffer.bytes_per_scan bytes from data */
+int iio_buffer_push_scans(struct iio_buffer *buffer, void *data,
+			  uint32_t nb_scans)
 {
 	if (!buffer)
 		return -EINVAL;
 
-	return no_os_cb_write(buffer->buf, data, buffer->bytes_per_scan);
+	return no_os_cb_write_scans(buffer->buf, data, buffer->bytes_per_scan,
+				    nb_scans);
 }
 
 /* Read from buffer iio_buffer.bytes_per_scan bytes into data */
@@ -1436,34 +1946,713 @@ int iio_buffer_pop_scan(struct iio_buffer *buffer, void *data)
 	return ret;
 }
 
-#if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING)
-
-static int32_t accept_network_clients(struct iio_desc *desc)
+#ifdef IIO_THREADED
+/**
+ * @brief Get the id of a network connection.
+ * @param desc - IIO descriptor.
+ * @param conn - Connection instance (client socket).
+ * @return Connection id or negative value if not found.
+ */
+static int iio_conn_id(struct iio_desc *desc, void *conn)
 {
-	struct tcp_socket_desc *sock;
-	struct iiod_conn_data data;
-	int32_t ret;
-	uint32_t id;
+	int i;
 
-	do {
-		ret = socket_accept(desc->server, &sock);
-		if (NO_OS_IS_ERR_VALUE(ret))
-			return ret;
+	for (i = 0; i < IIOD_MAX_CONNECTIONS; i++)
+		if (desc->conn_socks[i] == conn)
+			return i;
 
-		data.conn = sock;
-		data.buf = no_os_calloc(1, IIOD_CONN_BUFFER_SIZE);
-		data.len = IIOD_CONN_BUFFER_SIZE;
+	return -ENOENT;
+}
 
-		if (!data.buf) {
-			ret = -ENOMEM;
-			goto close_socket;
-		}
+/**
+ * @brief Execute a job.
+ * @param job - Job to execute.
+ * @return Result of the device callback.
+ */
+static int iio_job_exec(struct iio_job *job)
+{
+	switch (job->op) {
+	case IIO_JOB_READ_ATTR:
+		return iio_read_attr(&job->ctx, job->device, &job->attr,
+				     job->buf, job->len);
+	case IIO_JOB_WRITE_ATTR:
+		return iio_write_attr(&job->ctx, job->device, &job->attr,
+				      job->buf, job->len);
+	case IIO_JOB_REFILL_BUFFER:
+		return iio_refill_buffer(&job->ctx, job->device);
+	default:
+		return iio_push_buffer(&job->ctx, job->device);
+	}
+}
+
+/**
+ * @brief Release a job and its buffer. Called with job_lock held.
+ * @param job - Job to release.
+ */
+static void iio_job_free(struct iio_job *job)
+{
+	no_os_free(job->buf);
+	job->buf = NULL;
+	job->cancel = false;
+	job->state = IIO_JOB_FREE;
+}
+
+/**
+ * @brief Fill a free job, copying the arguments that belong to the
+ * connection. Called with job_lock held.
+ * @param job - Free job.
+ * @param op - Device callback to execute.
+ * @param ctx - IIO instance and conn instance.
+ * @param dev - Device.
+ * @param attr - Attribute, for IIO_JOB_READ_ATTR and IIO_JOB_WRITE_ATTR.
+ * @param buf - Attribute value.
+ * @param len - Length of buf.
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int iio_job_fill(struct iio_job *job, enum iio_job_op op,
+			struct iiod_ctx *ctx, struct iio_dev_priv *dev,
+			struct iiod_attr *attr, char *buf, uint32_t len)
+{
+	uint32_t name_len = 0, ch_len = 0;
+	char *p;
+
+	job->op = op;
+	job->ctx = *ctx;
+	job->device = dev->dev_id;
+	job->len = len;
+	if (!attr)
+		return 0;
+
+	if (attr->name)
+		name_len = strlen(attr->name) + 1;
+	if (attr->channel)
+		ch_len = strlen(attr->channel) + 1;
+
+	/* The value is null terminated, as the payload buffer of iiod */
+	job->buf = no_os_malloc(len + 1 + name_len + ch_len);
+	if (!job->buf)
+		return -ENOMEM;
+
+	if (op == IIO_JOB_WRITE_ATTR)
+		memcpy(job->buf, buf, len);
+	job->buf[len] = '\0';
+
+	job->attr = *attr;
+	p = job->buf + len + 1;
+	if (name_len)
+		job->attr.name = memcpy(p, attr->name, name_len);
+	if (ch_len)
+		job->attr.channel = memcpy(p + name_len, attr->channel, ch_len);
+
+	return 0;
+}
+
+/**
+ * @brief Worker thread of a device. Executes the queued jobs and wakes
+ * iio_step when one is done.
+ * @param arg - Device.
+ * @return NULL.
+ */
+static void *iio_dev_worker(void *arg)
+{
+	struct iio_dev_priv *dev = arg;
+	struct iio_dev_worker *w = &dev->worker;
+	struct iio_desc *desc;
+	struct iio_job *job;
+	uint32_t i, next = 0;
+	int ret;
+
+	pthread_mutex_lock(&w->job_lock);
+	while (!w->stop) {
+		/* Serve the connections in turn */
+		job = NULL;
+		for (i = 0; i < IIOD_MAX_CONNECTIONS && !job; i++) {
+			next = (next + 1) % IIOD_MAX_CONNECTIONS;
+			if (w->jobs[next].state == IIO_JOB_QUEUED)
+				job = &w->jobs[next];
+		}
+		if (!job) {
+			pthread_cond_wait(&w->cond, &w->job_lock);
+			continue;
+		}
+
+		job->state = IIO_JOB_RUNNING;
+		pthread_mutex_unlock(&w->job_lock);
+
+		pthread_mutex_lock(&w->lock);
+		ret = iio_job_exec(job);
+		pthread_mutex_unlock(&w->lock);
+
+		pthread_mutex_lock(&w->job_lock);
+		job->ret = ret;
+		if (job->cancel)
+			iio_job_free(job);
+		else
+			job->state = IIO_JOB_DONE;
+
+		desc = job->ctx.instance;
+		no_os_atomic_or_release(&desc->done_conns, NO_OS_BIT(next));
+		eventfd_write(desc->wake_fd, 1);
+	}
+	pthread_mutex_unlock(&w->job_lock);
+
+	return NULL;
+}
+
+/**
+ * @brief Queue a job to the worker of the device or get its result.
+ * The iiod state machine calls the operation again, with the same
+ * arguments, until a result is returned.
+ * @param ctx - IIO instance and conn instance.
+ * @param op - Device callback to execute.
+ * @param device - String containing device name.
+ * @param attr - Attribute, for IIO_JOB_READ_ATTR and IIO_JOB_WRITE_ATTR.
+ * @param buf - Attribute value.
+ * @param len - Length of buf.
+ * @return Result of the callback or -EINPROGRESS if it is not done yet.
+ */
+static int iio_job_run(struct iiod_ctx *ctx, enum iio_job_op op,
+		       const char *device, struct iiod_attr *attr, char *buf,
+		       uint32_t len)
+{
+	struct iio_desc *desc = ctx->instance;
+	struct iio_dev_priv *dev;
+	struct iio_job *job;
+	int conn_id, ret;
+
+	dev = get_iio_device(desc, device);
+	conn_id = iio_conn_id(desc, ctx->conn);
+	if (!dev || !dev->worker.started || conn_id < 0) {
+		/* Triggers and the context are handled in place */
+		job = &(struct iio_job) {
+			.op = op, .ctx = *ctx, .device = device,
+			.buf = buf, .len = len
+		};
+		if (attr)
+			job->attr = *attr;
+
+		return iio_job_exec(job);
+	}
+
+	job = &dev->worker.jobs[conn_id];
+	pthread_mutex_lock(&dev->worker.job_lock);
+	switch (job->state) {
+	case IIO_JOB_DONE:
+		ret = job->ret;
+		if (op == IIO_JOB_READ_ATTR && ret > 0)
+			memcpy(buf, job->buf, no_os_min((uint32_t)ret, len));
+		iio_job_free(job);
+		break;
+	case IIO_JOB_FREE:
+		ret = iio_job_fill(job, op, ctx, dev, attr, buf, len);
+		if (ret) {
+			iio_job_free(job);
+			break;
+		}
+		job->state = IIO_JOB_QUEUED;
+		pthread_cond_broadcast(&dev->worker.cond);
+	/* fallthrough */
+	default:
+		desc->io_wait |= IIO_WAIT_JOB;
+		ret = -EINPROGRESS;
+		break;
+	}
+	pthread_mutex_unlock(&dev->worker.job_lock);
+
+	return ret;
+}
+
+/**
+ * @brief Drop the jobs of a closed connection. A running job is not waited
+ * for, the worker releases it when it is done.
+ * @param desc - IIO descriptor.
+ * @param conn_id - Connection id.
+ */
+static void iio_jobs_cancel(struct iio_desc *desc, uint32_t conn_id)
+{
+	struct iio_dev_worker *w;
+	struct iio_job *job;
+	uint32_t i;
+
+	for (i = 0; i < desc->nb_devs; i++) {
+		w = &desc->devs[i].worker;
+		if (!w->started)
+			continue;
+
+		job = &w->jobs[conn_id];
+		pthread_mutex_lock(&w->job_lock);
+		if (job->state == IIO_JOB_RUNNING)
+			job->cancel = true;
+		else
+			iio_job_free(job);
+		pthread_mutex_unlock(&w->job_lock);
+	}
+	no_os_atomic_and_relaxed(&desc->done_conns, ~NO_OS_BIT(conn_id));
+}
+
+/**
+ * @brief Start a worker thread for each device.
+ * @param desc - IIO descriptor.
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int iio_workers_start(struct iio_desc *desc)
+{
+	struct iio_dev_worker *w;
+	uint32_t i;
+	int ret;
+
+	for (i = 0; i < desc->nb_devs; i++) {
+		w = &desc->devs[i].worker;
+		pthread_mutex_init(&w->lock, NULL);
+		pthread_mutex_init(&w->job_lock, NULL);
+		pthread_cond_init(&w->cond, NULL);
+		ret = pthread_create(&w->thread, NULL, iio_dev_worker,
+				     &desc->devs[i]);
+		if (ret)
+			return -ret;
+		w->started = true;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Stop the worker threads.
+ * @param desc - IIO descriptor.
+ */
+static void iio_workers_stop(struct iio_desc *desc)
+{
+	struct iio_dev_worker *w;
+	uint32_t i, j;
+
+	for (i = 0; i < desc->nb_devs; i++) {
+		w = &desc->devs[i].worker;
+		if (!w->started)
+			continue;
+
+		pthread_mutex_lock(&w->job_lock);
+		w->stop = true;
+		pthread_cond_broadcast(&w->cond);
+		pthread_mutex_unlock(&w->job_lock);
+		pthread_join(w->thread, NULL);
+		for (j = 0; j < IIOD_MAX_CONNECTIONS; j++)
+			iio_job_free(&w->jobs[j]);
+		pthread_cond_destroy(&w->cond);
+		pthread_mutex_destroy(&w->job_lock);
+		pthread_mutex_destroy(&w->lock);
+		w->started = false;
+	}
+}
+
+static int iio_thr_read_attr(struct iiod_ctx *ctx, const char *device,
+			     struct iiod_attr *attr, char *buf, uint32_t len)
+{
+	return iio_job_run(ctx, IIO_JOB_READ_ATTR, device, attr, buf, len);
+}
+
+static int iio_thr_write_attr(struct iiod_ctx *ctx, const char *device,
+			      struct iiod_attr *attr, char *buf, uint32_t len)
+{
+	return iio_job_run(ctx, IIO_JOB_WRITE_ATTR, device, attr, buf, len);
+}
+
+static int iio_thr_refill_buffer(struct iiod_ctx *ctx, const char *device)
+{
+	return iio_job_run(ctx, IIO_JOB_REFILL_BUFFER, device, NULL, NULL, 0);
+}
+
+static int iio_thr_push_buffer(struct iiod_ctx *ctx, const char *device)
+{
+	return iio_job_run(ctx, IIO_JOB_PUSH_BUFFER, device, NULL, NULL, 0);
+}
+
+/*
+ * The other device operations are short and run in the iio_step thread,
+ * holding the device lock so they don't race with its worker. While the
+ * worker runs a callback (e.g. a buffer refill waiting for the DMA) the
+ * operation returns -EINPROGRESS and iiod calls it again in a later step.
+ */
+static int iio_dev_lock(struct iiod_ctx *ctx, const char *device,
+			pthread_mutex_t **lock)
+{
+	struct iio_dev_priv *dev = get_iio_device(ctx->instance, device);
+
+	*lock = NULL;
+	if (!dev || !dev->worker.started)
+		return 0;
+
+	if (pthread_mutex_trylock(&dev->worker.lock))
+		return -EINPROGRESS;
+
+	*lock = &dev->worker.lock;
+
+	return 0;
+}
+
+static void iio_dev_unlock(pthread_mutex_t *lock)
+{
+	if (lock)
+		pthread_mutex_unlock(lock);
+}
+
+static int iio_thr_open_dev(struct iiod_ctx *ctx, const char *device,
+			    uint32_t samples, uint32_t mask, bool cyclic)
+{
+	pthread_mutex_t *lock;
+	int ret;
+
+	ret = iio_dev_lock(ctx, device, &lock);
+	if (ret)
+		return ret;
+
+	ret = iio_open_dev(ctx, device, samples, mask, cyclic);
+	iio_dev_unlock(lock);
+
+	return ret;
+}
+
+/*
+ * iiod ignores the result of close when it drops a cyclic buffer after an
+ * error, so closing waits for the worker instead of being retried.
+ */
+static int iio_thr_close_dev(struct iiod_ctx *ctx, const char *device)
+{
+	struct iio_dev_priv *dev = get_iio_device(ctx->instance, device);
+	int ret;
+
+	if (!dev || !dev->worker.started)
+		return iio_close_dev(ctx, device);
+
+	pthread_mutex_lock(&dev->worker.lock);
+	ret = iio_close_dev(ctx, device);
+	pthread_mutex_unlock(&dev->worker.lock);
+
+	return ret;
+}
+
+static int iio_thr_read_buffer(struct iiod_ctx *ctx, const char *device,
+			       char *buf, uint32_t bytes)
+{
+	pthread_mutex_t *lock;
+	int ret;
+
+	ret = iio_dev_lock(ctx, device, &lock);
+	if (ret)
+		return ret;
+
+	ret = iio_read_buffer(ctx, device, buf, bytes);
+	iio_dev_unlock(lock);
+
+	return ret;
+}
+
+static int iio_thr_read_buffer_zc(struct iiod_ctx *ctx, const char *device,
+				  char **buf, uint32_t bytes, bool wait_all)
+{
+	pthread_mutex_t *lock;
+	int ret;
+
+	ret = iio_dev_lock(ctx, device, &lock);
+	if (ret)
+		return ret;
+
+	ret = iio_read_buffer_zc(ctx, device, buf, bytes, wait_all);
+	iio_dev_unlock(lock);
+
+	return ret;
+}
+
+static int iio_thr_read_buffer_done(struct iiod_ctx *ctx, const char *device)
+{
+	pthread_mutex_t *lock;
+	int ret;
+
+	ret = iio_dev_lock(ctx, device, &lock);
+	if (ret)
+		return ret;
+
+	ret = iio_read_buffer_done(ctx, device);
+	iio_dev_unlock(lock);
+
+	return ret;
+}
+
+static int iio_thr_write_buffer(struct iiod_ctx *ctx, const char *device,
+				const char *buf, uint32_t bytes)
+{
+	pthread_mutex_t *lock;
+	int ret;
+
+	ret = iio_dev_lock(ctx, device, &lock);
+	if (ret)
+		return ret;
+
+	ret = iio_write_buffer(ctx, device, buf, bytes);
+	iio_dev_unlock(lock);
+
+	return ret;
+}
+
+static int iio_thr_set_trigger(struct iiod_ctx *ctx, const char *device,
+			       const char *trigger, uint32_t len)
+{
+	pthread_mutex_t *lock;
+	int ret;
+
+	ret = iio_dev_lock(ctx, device, &lock);
+	if (ret)
+		return ret;
+
+	ret = iio_set_trigger(ctx, device, trigger, len);
+	iio_dev_unlock(lock);
+
+	return ret;
+}
+#endif
+
+#ifdef IIO_USE_EPOLL
+static int32_t accept_network_clients(struct iio_desc *desc);
+
+/**
+ * @brief Create the epoll instance and watch the server socket.
+ * @param desc - IIO descriptor.
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int iio_epoll_init(struct iio_desc *desc)
+{
+	struct epoll_event ev = {.events = EPOLLIN};
+	int ret;
+
+	desc->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (desc->epoll_fd < 0)
+		return -errno;
+
+	desc->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (desc->wake_fd < 0) {
+		ret = -errno;
+		goto close_epoll;
+	}
+
+	/* Connection ids are below IIOD_MAX_CONNECTIONS */
+	ev.data.u32 = IIOD_MAX_CONNECTIONS;
+	if (epoll_ctl(desc->epoll_fd, EPOLL_CTL_ADD, desc->server->id, &ev)) {
+		ret = -errno;
+		goto close_wake;
+	}
+
+	ev.data.u32 = IIOD_MAX_CONNECTIONS + 1;
+	if (epoll_ctl(desc->epoll_fd, EPOLL_CTL_ADD, desc->wake_fd, &ev)) {
+		ret = -errno;
+		goto close_wake;
+	}
+
+	return 0;
+
+close_wake:
+	close(desc->wake_fd);
+close_epoll:
+	close(desc->epoll_fd);
+	desc->epoll_fd = -1;
+
+	return ret;
+}
+
+/**
+ * @brief Close the epoll instance.
+ * @param desc - IIO descriptor.
+ */
+static void iio_epoll_remove(struct iio_desc *desc)
+{
+	if (desc->epoll_fd < 0)
+		return;
+
+	close(desc->wake_fd);
+	close(desc->epoll_fd);
+}
+
+/**
+ * @brief Watch the socket of a new connection. The connection is stepped
+ * once right away, since data may have arrived with the connection.
+ * @param desc - IIO descriptor.
+ * @param conn_id - Connection id.
+ * @param sock - Client socket.
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int iio_epoll_add_conn(struct iio_desc *desc, uint32_t conn_id,
+			      struct tcp_socket_desc *sock)
+{
+	struct epoll_event ev = {.events = EPOLLIN, .data.u32 = conn_id};
+
+	if (epoll_ctl(desc->epoll_fd, EPOLL_CTL_ADD, sock->id, &ev))
+		return -errno;
+
+	desc->conn_socks[conn_id] = sock;
+	desc->conn_events[conn_id] = EPOLLIN;
+	desc->ready_conns |= NO_OS_BIT(conn_id);
+
+	return 0;
+}
+
+/**
+ * @brief Step a connection and update the events it waits for.
+ * @param desc - IIO descriptor.
+ * @param conn_id - Connection id.
+ * @return Result of iiod_conn_step.
+ */
+static int iio_epoll_step_conn(struct iio_desc *desc, uint32_t conn_id)
+{
+	struct tcp_socket_desc *sock = desc->conn_socks[conn_id];
+	struct epoll_event ev = {.data.u32 = conn_id};
+	struct iiod_conn_data data;
+	uint32_t n;
+	int ret;
+
+	/* Woken by the worker of a job canceled when the connection closed */
+	if (!sock) {
+		desc->ready_conns &= ~NO_OS_BIT(conn_id);
+		return -ENOTCONN;
+	}
+
+	/*
+	 * Run the commands already received, then wait for more. The number
+	 * of steps is bounded so that a client sending commands back to back
+	 * does not starve the others.
+	 */
+	for (n = 0; n < IIO_CONN_STEP_BUDGET; n++) {
+		desc->io_wait = 0;
+		ret = iiod_conn_step(desc->iiod, conn_id);
+		if (ret)
+			break;
+	}
+
+	desc->ready_conns &= ~NO_OS_BIT(conn_id);
+	desc->wait_conns &= ~NO_OS_BIT(conn_id);
+
+	if (ret == -ENOTCONN) {
+#ifdef IIO_THREADED
+		iio_jobs_cancel(desc, conn_id);
+#endif
+		epoll_ctl(desc->epoll_fd, EPOLL_CTL_DEL, sock->id, NULL);
+		desc->conn_socks[conn_id] = NULL;
+		iiod_conn_remove(desc->iiod, conn_id, &data);
+		socket_remove(data.conn);
+		no_os_free(data.buf);
+
+		return ret;
+	}
+
+	/*
+	 * Step again right away only a connection that used its whole budget.
+	 * Sleep on the socket if the step is blocked by it. While a job runs,
+	 * the socket is not watched; the worker wakes iio_step when it is
+	 * done. A step waiting for the device (e.g. a buffer refill) is
+	 * retried after IIO_DEVICE_POLL_MS, without spinning.
+	 */
+	if (!ret) {
+		desc->ready_conns |= NO_OS_BIT(conn_id);
+	} else if (ret == -EAGAIN && desc->io_wait) {
+		if (desc->io_wait & IIO_WAIT_JOB)
+			ev.events = 0;
+		else if (desc->io_wait & IIO_WAIT_SEND)
+			ev.events = EPOLLOUT;
+		else
+			ev.events = EPOLLIN;
+		if (ev.events != desc->conn_events[conn_id]) {
+			epoll_ctl(desc->epoll_fd, EPOLL_CTL_MOD, sock->id, &ev);
+			desc->conn_events[conn_id] = ev.events;
+		}
+	} else {
+		desc->wait_conns |= NO_OS_BIT(conn_id);
+	}
+
+	return ret;
+}
+
+/**
+ * @brief Execute an iio step with epoll. Waits until a socket is ready, a
+ * trigger is signaled or IIO_STEP_TIMEOUT_MS passed and steps the
+ * connections that can make progress.
+ * @param desc - IIO descriptor.
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int iio_epoll_step(struct iio_desc *desc)
+{
+	struct epoll_event events[IIOD_MAX_CONNECTIONS + 2];
+	uint32_t ready, id;
+	eventfd_t val;
+	int i, n, timeout, ret = -EAGAIN;
+
+	if (desc->ready_conns)
+		timeout = 0;
+	else if (desc->wait_conns)
+		timeout = IIO_DEVICE_POLL_MS;
+	else
+		timeout = IIO_STEP_TIMEOUT_MS;
+
+	n = epoll_wait(desc->epoll_fd, events, NO_OS_ARRAY_SIZE(events),
+		       timeout);
+	if (n < 0)
+		return errno == EINTR ? -EAGAIN : -errno;
+
+	for (i = 0; i < n; i++) {
+		id = events[i].data.u32;
+		if (id < IIOD_MAX_CONNECTIONS) {
+			desc->ready_conns |= NO_OS_BIT(id);
+		} else if (id == IIOD_MAX_CONNECTIONS) {
+			ret = accept_network_clients(desc);
+			if (NO_OS_IS_ERR_VALUE(ret) && ret != -EAGAIN)
+				return ret;
+		} else {
+			eventfd_read(desc->wake_fd, &val);
+		}
+	}
+
+	iio_process_async_triggers(desc);
+
+#ifdef IIO_THREADED
+	desc->ready_conns |= no_os_atomic_xchg_acquire(&desc->done_conns, 0);
+#endif
+	ready = desc->ready_conns | desc->wait_conns;
+	for (id = 0; ready; id++, ready >>= 1)
+		if (ready & 1)
+			ret = iio_epoll_step_conn(desc, id);
+
+	return ret;
+}
+#endif
+
+#if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING)
+
+static int32_t accept_network_clients(struct iio_desc *desc)
+{
+	struct tcp_socket_desc *sock;
+	struct iiod_conn_data data;
+	int32_t ret;
+	uint32_t id;
+
+	do {
+		ret = socket_accept(desc->server, &sock);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		data.conn = sock;
+		data.buf = no_os_calloc(1, IIOD_CONN_BUFFER_SIZE);
+		data.len = IIOD_CONN_BUFFER_SIZE;
+
+		if (!data.buf) {
+			ret = -ENOMEM;
+			goto close_socket;
+		}
 
 		ret = iiod_conn_add(desc->iiod, &data, &id);
 		if (NO_OS_IS_ERR_VALUE(ret))
 			goto free_buf;
 
+#ifdef IIO_USE_EPOLL
+		ret = iio_epoll_add_conn(desc, id, sock);
+#else
 		ret = _push_conn(desc, id);
+#endif
 		if (NO_OS_IS_ERR_VALUE(ret))
 			goto remove_conn;
 	} while (true);
@@ -1492,6 +2681,11 @@ int iio_step(struct iio_desc *desc)
 	uint32_t conn_id;
 	int32_t ret;
 
+#ifdef IIO_USE_EPOLL
+	if (desc->epoll_fd >= 0)
+		return iio_epoll_step(desc);
+#endif
+
 	iio_process_async_triggers(desc);
 
 #if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING)
@@ -1568,12 +2762,12 @@ static uint32_t iio_add_ctx_attr_in_xml(struct iio_desc *desc, char *buff,
 }
 
 /*
- * Generate an xml describing a device and write it to buff.
+ * Generate the xml describing the channels and attributes of a device, up to
+ * and including the closing device tag, and write it to buff.
  * Will return the size of the xml.
  * If buff_size is 0, no data will be written to buff, but size will be returned
  */
-static uint32_t iio_generate_device_xml(struct iio_device *device, char *name,
-					char *id, char *buff,
+static uint32_t iio_generate_device_xml(struct iio_device *device, char *buff,
 					uint32_t buff_size)
 {
 	struct iio_channel	*ch;
@@ -1595,9 +2789,6 @@ static uint32_t iio_generate_device_xml(struct iio_device *device, char *name,
 
 	i = 0;
 
-	i += snprintf(buff + i, no_os_max(n - i, 0),
-		      "<device id=\"%s\" name=\"%s\">", id, name);
-
 	/* Write channels */
 	if (device->channels)
 		for (j = 0; j < device->num_ch; j++) {
@@ -1739,59 +2930,478 @@ static uint32_t iio_generate_device_xml(struct iio_device *device, char *name,
 	return i;
 }
 
-static int32_t iio_init_xml(struct iio_desc *desc)
+/* Fragments before the devices: xml header and context attributes */
+#define IIO_XML_FRAGS_START	2
+/* Fragments of each device and trigger: opening tag and body */
+#define IIO_XML_FRAGS_PER_DEV	2
+
+/* Free the xml fragments of device (or trigger, after devices) idx */
+static void iio_free_dev_xml(struct iio_desc *desc, uint32_t idx)
 {
-	struct iio_dev_priv *dev;
-	struct iio_trig_priv *trig;
+	struct iiod_xml_fragment *frag;
+
+	frag = desc->xml_frags + IIO_XML_FRAGS_START +
+	       idx * IIO_XML_FRAGS_PER_DEV;
+	no_os_free((void *)frag[0].buf);
+	/* Pre-generated bodies are not allocated */
+	if (idx >= desc->nb_devs ||
+	    frag[1].buf != desc->devs[idx].dev_descriptor->xml)
+		no_os_free((void *)frag[1].buf);
+	memset(frag, 0, IIO_XML_FRAGS_PER_DEV * sizeof(*frag));
+}
+
+/* Generate the xml fragments of device (or trigger, after devices) idx */
+static int32_t iio_generate_dev_xml(struct iio_desc *desc, uint32_t idx)
+{
+	struct iiod_xml_fragment *frag;
 	struct iio_device dummy = { 0 };
-	uint32_t i, size, of;
+	struct iio_device *device;
+	struct iio_trig_priv *trig;
+	struct iio_dev_priv *dev;
+	const char *name;
+	const char *id;
+	char *buf;
+	int32_t len;
+
+	if (idx < desc->nb_devs) {
+		dev = desc->devs + idx;
+		device = dev->dev_descriptor;
+		name = dev->name;
+		id = dev->dev_id;
+	} else {
+		trig = desc->trigs + idx - desc->nb_devs;
+		dummy.attributes = trig->descriptor->attributes;
+		device = &dummy;
+		name = trig->name;
+		id = trig->id;
+	}
 
-	/* -2 because of the 0 character */
-	size = sizeof(header) + sizeof(header_end) - 2;
-	size += iio_add_ctx_attr_in_xml(desc, NULL, -1);
-	for (i = 0; i < desc->nb_devs; i++) {
-		dev = desc->devs + i;
-		size += iio_generate_device_xml(dev->dev_descriptor,
-						(char *)dev->name,
-						dev->dev_id, NULL, -1);
+	frag = desc->xml_frags + IIO_XML_FRAGS_START +
+	       idx * IIO_XML_FRAGS_PER_DEV;
+
+	len = snprintf(NULL, 0, "<device id=\"%s\" name=\"%s\">", id, name);
+	buf = (char *)no_os_calloc(len + 1, sizeof(*buf));
+	if (!buf)
+		return -ENOMEM;
+	sprintf(buf, "<device id=\"%s\" name=\"%s\">", id, name);
+	frag[0].buf = buf;
+	frag[0].len = len;
+
+	if (device->xml) {
+		frag[1].buf = device->xml;
+		frag[1].len = strlen(device->xml);
+
+		return 0;
 	}
-	for (i = 0; i < desc->nb_trigs; i++) {
-		trig = desc->trigs + i;
-		dummy.attributes = trig->descriptor->attributes;
-		size += iio_generate_device_xml(&dummy, trig->name, trig->id,
-						NULL, -1);
+
+	len = iio_generate_device_xml(device, NULL, -1);
+	if (NO_OS_IS_ERR_VALUE(len))
+		goto free_tag;
+
+	buf = (char *)no_os_calloc(len + 1, sizeof(*buf));
+	if (!buf) {
+		len = -ENOMEM;
+		goto free_tag;
 	}
+	iio_generate_device_xml(device, buf, len + 1);
+	frag[1].buf = buf;
+	frag[1].len = len;
+
+	return 0;
+
+free_tag:
+	no_os_free((void *)frag[0].buf);
+	memset(frag, 0, sizeof(*frag));
 
-	desc->xml_desc = (char *)no_os_calloc(size + 1, sizeof(*desc->xml_desc));
-	if (!desc->xml_desc)
+	return len;
+}
+
+/* Allocate the list of xml fragments. Only the constant ones are set */
+static int32_t iio_init_xml(struct iio_desc *desc)
+{
+	desc->nb_xml_frags = IIO_XML_FRAGS_START + 1 +
+			     IIO_XML_FRAGS_PER_DEV * (desc->nb_devs +
+					     desc->nb_trigs);
+	desc->xml_frags = (struct iiod_xml_fragment *)
+			  no_os_calloc(desc->nb_xml_frags,
+				       sizeof(*desc->xml_frags));
+	if (!desc->xml_frags)
 		return -ENOMEM;
 
-	desc->xml_size = size;
+	desc->xml_frags[0].buf = header;
+	desc->xml_frags[0].len = sizeof(header) - 1;
+	desc->xml_frags[desc->nb_xml_frags - 1].buf = header_end;
+	desc->xml_frags[desc->nb_xml_frags - 1].len = sizeof(header_end) - 1;
+
+	return 0;
+}
+
+static void iio_remove_xml(struct iio_desc *desc)
+{
+	uint32_t i;
+
+	no_os_free((void *)desc->zxml.buf);
+
+	for (i = 0; i < desc->nb_devs + desc->nb_trigs; i++)
+		iio_free_dev_xml(desc, i);
+	no_os_free((void *)desc->xml_frags[1].buf);
+	no_os_free(desc->xml_frags);
+}
+
+/*
+ * Free the xml of the devices invalidated while a connection was sending it.
+ * Nothing is done while the fragments are still in use.
+ */
+static void iio_free_stale_xml(struct iio_desc *desc)
+{
+	uint32_t i;
+
+	if (!desc->xml_stale || desc->xml_users)
+		return;
 
-	strcpy(desc->xml_desc, header);
-	of = sizeof(header) - 1;
-	of += iio_add_ctx_attr_in_xml(desc, desc->xml_desc + of, size - of);
 	for (i = 0; i < desc->nb_devs; i++) {
-		dev = desc->devs + i;
-		of += iio_generate_device_xml(dev->dev_descriptor,
-					      (char *)dev->name, dev->dev_id,
-					      desc->xml_desc + of, size - of);
+		if (!desc->devs[i].xml_stale)
+			continue;
+		iio_free_dev_xml(desc, i);
+		desc->devs[i].xml_stale = false;
 	}
-	for (i = 0; i < desc->nb_trigs; i++) {
-		trig = desc->trigs + i;
-		dummy.attributes = trig->descriptor->attributes;
-		of += iio_generate_device_xml(&dummy, trig->name, trig->id,
-					      desc->xml_desc + of, size - of);
+	no_os_free((void *)desc->zxml.buf);
+	memset(&desc->zxml, 0, sizeof(desc->zxml));
+	desc->xml_stale = false;
+}
+
+/* Generate the missing fragments of the context xml */
+static int iio_build_xml(struct iio_desc *desc)
+{
+	struct iiod_xml_fragment *frag;
+	char *buf;
+	int32_t ret;
+	uint32_t i;
+
+	frag = &desc->xml_frags[1];
+	if (desc->nb_ctx_attr && !frag->buf) {
+		ret = iio_add_ctx_attr_in_xml(desc, NULL, -1);
+		buf = (char *)no_os_calloc(ret + 1, sizeof(*buf));
+		if (!buf)
+			return -ENOMEM;
+		frag->len = iio_add_ctx_attr_in_xml(desc, buf, ret + 1);
+		frag->buf = buf;
+	}
+
+	for (i = 0; i < desc->nb_devs + desc->nb_trigs; i++) {
+		frag = desc->xml_frags + IIO_XML_FRAGS_START +
+		       i * IIO_XML_FRAGS_PER_DEV;
+		if (frag->buf)
+			continue;
+
+		ret = iio_generate_dev_xml(desc, i);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Get the fragments of the context xml, generating the missing ones.
+ * They are kept until put back with iio_put_xml().
+ * @param ctx - IIOD context.
+ * @param frags - Where to store the list of fragments.
+ * @param nb_frags - Where to store the number of fragments.
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int iio_get_xml(struct iiod_ctx *ctx, struct iiod_xml_fragment **frags,
+		       uint32_t *nb_frags)
+{
+	struct iio_desc *desc = ctx->instance;
+	int ret;
+
+	iio_free_stale_xml(desc);
+
+	ret = iio_build_xml(desc);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	desc->xml_users++;
+	*frags = desc->xml_frags;
+	*nb_frags = desc->nb_xml_frags;
+
+	return 0;
+}
+
+#ifdef IIO_ZSTD
+/**
+ * @brief Get the context xml compressed as a single Zstandard frame. It is
+ * compressed the first time it is requested and kept until the xml changes.
+ * @param ctx - IIOD context.
+ * @param frags - Where to store the list of fragments.
+ * @param nb_frags - Where to store the number of fragments.
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int iio_get_zxml(struct iiod_ctx *ctx, struct iiod_xml_fragment **frags,
+			uint32_t *nb_frags)
+{
+	struct iio_desc *desc = ctx->instance;
+	struct iiod_xml_fragment *xml;
+	uint32_t nb_xml, i, len, size;
+	uint8_t *src, *dst;
+	int ret;
+
+	iio_free_stale_xml(desc);
+
+	if (!desc->zxml.buf) {
+		ret = iio_build_xml(desc);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		xml = desc->xml_frags;
+		nb_xml = desc->nb_xml_frags;
+
+		len = 0;
+		for (i = 0; i < nb_xml; i++)
+			len += xml[i].len;
+
+		src = (uint8_t *)no_os_malloc(len);
+		if (!src)
+			return -ENOMEM;
+
+		len = 0;
+		for (i = 0; i < nb_xml; i++) {
+			memcpy(src + len, xml[i].buf, xml[i].len);
+			len += xml[i].len;
+		}
+
+		size = NO_OS_ZSTD_COMPRESS_BOUND(len);
+		dst = (uint8_t *)no_os_malloc(size);
+		if (!dst) {
+			no_os_free(src);
+			return -ENOMEM;
+		}
+
+		ret = no_os_zstd_compress(src, len, dst, size, &size);
+		no_os_free(src);
+		if (NO_OS_IS_ERR_VALUE(ret)) {
+			no_os_free(dst);
+			return ret;
+		}
+
+		/* Keep only the compressed size */
+		src = (uint8_t *)no_os_malloc(size);
+		if (!src) {
+			no_os_free(dst);
+			return -ENOMEM;
+		}
+		memcpy(src, dst, size);
+		no_os_free(dst);
+
+		desc->zxml.buf = (char *)src;
+		desc->zxml.len = size;
+	}
+
+	desc->xml_users++;
+	*frags = &desc->zxml;
+	*nb_frags = 1;
+
+	return 0;
+}
+#endif
+
+/**
+ * @brief Release the fragments returned by iio_get_xml() or iio_get_zxml().
+ * @param ctx - IIOD context.
+ * @param frags - Fragments no longer used.
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int iio_put_xml(struct iiod_ctx *ctx, struct iiod_xml_fragment *frags)
+{
+	struct iio_desc *desc = ctx->instance;
+
+	if (!desc->xml_users)
+		return -EINVAL;
+
+	desc->xml_users--;
+	iio_free_stale_xml(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Drop the cached xml of a device after its description changed. It
+ * is generated again the next time the context xml is requested. While a
+ * connection is still sending the old xml, it is freed once the connection
+ * is done and clients asking for the xml meanwhile get the old one.
+ * @param desc - IIO descriptor.
+ * @param dev_name - Name of the device.
+ * @return 0 in case of success or negative value otherwise.
+ */
+int iio_invalidate_device_xml(struct iio_desc *desc, const char *dev_name)
+{
+	uint32_t i;
+
+	if (!desc || !dev_name)
+		return -EINVAL;
+
+	for (i = 0; i < desc->nb_devs; i++) {
+		if (!strcmp(desc->devs[i].name, dev_name)) {
+			desc->devs[i].xml_stale = true;
+			desc->xml_stale = true;
+			iio_free_stale_xml(desc);
+
+			return 0;
+		}
+	}
+
+	return -ENODEV;
+}
+
+static uint32_t iio_attrs_count(struct iio_attribute *attributes)
+{
+	uint32_t n = 0;
+
+	if (attributes)
+		while (attributes[n].name)
+			n++;
+
+	return n;
+}
+
+/* Insert all attributes of an array in the attribute lookup table */
+static void iio_add_attrs_to_lookup(struct iio_dev_priv *dev,
+				    struct iio_attribute *attributes,
+				    enum iio_attr_type type, uint16_t ch_idx)
+{
+	struct iio_attr_lookup *entry;
+	uint32_t hash, i, j;
+
+	if (!attributes)
+		return;
+
+	for (j = 0; attributes[j].name; j++) {
+		hash = iio_attr_hash(attributes[j].name, type, ch_idx);
+		i = hash & dev->attr_table_mask;
+		while (dev->attr_table[i].attr)
+			i = (i + 1) & dev->attr_table_mask;
+
+		entry = &dev->attr_table[i];
+		entry->hash = hash;
+		entry->type = type;
+		entry->ch_idx = ch_idx;
+		entry->attr = &attributes[j];
+	}
+}
+
+static void iio_remove_dev_lookup(struct iio_dev_priv *dev)
+{
+	no_os_free(dev->ch_ids);
+	no_os_free(dev->ch_table);
+	no_os_free(dev->attr_table);
+	dev->ch_ids = NULL;
+	dev->ch_table = NULL;
+	dev->attr_table = NULL;
+}
+
+/*
+ * Precompute channel ids and build the lookup tables used to find channels
+ * and attributes of a device without string formatting or linear searches.
+ */
+static int32_t iio_init_dev_lookup(struct iio_dev_priv *dev)
+{
+	struct iio_device *desc = dev->dev_descriptor;
+	struct iio_channel *ch;
+	char ch_id[MAX_CHN_ID];
+	uint32_t nb_attrs, size, hash, i, j;
+	char *ids;
+
+	nb_attrs = iio_attrs_count(desc->attributes) +
+		   iio_attrs_count(desc->debug_attributes) +
+		   iio_attrs_count(desc->buffer_attributes);
+
+	if (desc->channels && desc->num_ch) {
+		/* Pointers to ids followed by the ids */
+		size = desc->num_ch * sizeof(*dev->ch_ids);
+		for (i = 0; i < desc->num_ch; i++) {
+			_print_ch_id(ch_id, &desc->channels[i]);
+			size += strlen(ch_id) + 1;
+			nb_attrs += iio_attrs_count(desc->channels[i].attributes);
+		}
+
+		dev->ch_ids = (char **)no_os_calloc(1, size);
+		if (!dev->ch_ids)
+			return -ENOMEM;
+
+		size = iio_lookup_table_size(desc->num_ch);
+		dev->ch_table = (struct iio_ch_lookup *)no_os_calloc(size,
+				sizeof(*dev->ch_table));
+		if (!dev->ch_table)
+			goto error;
+		dev->ch_table_mask = size - 1;
+		for (i = 0; i < size; i++)
+			dev->ch_table[i].idx = -1;
+
+		ids = (char *)(dev->ch_ids + desc->num_ch);
+		for (i = 0; i < desc->num_ch; i++) {
+			ch = &desc->channels[i];
+			_print_ch_id(ids, ch);
+			dev->ch_ids[i] = ids;
+			ids += strlen(ids) + 1;
+
+			hash = iio_ch_hash(dev->ch_ids[i], ch->ch_out);
+			j = hash & dev->ch_table_mask;
+			while (dev->ch_table[j].idx >= 0)
+				j = (j + 1) & dev->ch_table_mask;
+			dev->ch_table[j].hash = hash;
+			dev->ch_table[j].idx = i;
+		}
 	}
 
-	strcpy(desc->xml_desc + of, header_end);
+	if (!nb_attrs)
+		return 0;
+
+	size = iio_lookup_table_size(nb_attrs);
+	dev->attr_table = (struct iio_attr_lookup *)no_os_calloc(size,
+			  sizeof(*dev->attr_table));
+	if (!dev->attr_table)
+		goto error;
+	dev->attr_table_mask = size - 1;
+
+	iio_add_attrs_to_lookup(dev, desc->attributes, IIO_ATTR_TYPE_DEVICE, 0);
+	iio_add_attrs_to_lookup(dev, desc->debug_attributes,
+				IIO_ATTR_TYPE_DEBUG, 0);
+	iio_add_attrs_to_lookup(dev, desc->buffer_attributes,
+				IIO_ATTR_TYPE_BUFFER, 0);
+	if (desc->channels)
+		for (i = 0; i < desc->num_ch; i++) {
+			ch = &desc->channels[i];
+			iio_add_attrs_to_lookup(dev, ch->attributes,
+						ch->ch_out ? IIO_ATTR_TYPE_CH_OUT :
+						IIO_ATTR_TYPE_CH_IN, i);
+		}
 
 	return 0;
+error:
+	iio_remove_dev_lookup(dev);
+
+	return -ENOMEM;
+}
+
+static void iio_remove_devs(struct iio_desc *desc)
+{
+	uint32_t i;
+
+	if (!desc->devs)
+		return;
+
+	for (i = 0; i < desc->nb_devs; i++)
+		iio_remove_dev_lookup(desc->devs + i);
+
+	no_os_free(desc->devs);
+	desc->devs = NULL;
 }
 
 static int32_t iio_init_devs(struct iio_desc *desc,
 			     struct iio_device_init *devs, uint32_t n)
 {
+	int32_t ret;
 	uint32_t i;
 	struct iio_dev_priv *ldev;
 	struct iio_device_init *ndev;
@@ -1806,8 +3416,10 @@ static int32_t iio_init_devs(struct iio_desc *desc,
 		ndev = devs + i;
 		ldev = desc->devs + i;
 		ldev->dev_descriptor = ndev->dev_descriptor;
-		sprintf(ldev->dev_id, "iio:device%"PRIu32"", i);
-		ldev->trig_idx = iio_get_trig_idx_by_id(desc, ndev->trigger_id);
+		sprintf(ldev->dev_id, IIO_DEV_ID_PREFIX"%"PRIu32"", i);
+		ldev->trig_idx = NO_TRIGGER;
+		iio_dev_set_trig(desc, ldev,
+				 iio_get_trig_idx_by_id(desc, ndev->trigger_id));
 		ldev->dev_instance = ndev->dev;
 		ldev->dev_data.dev = ndev->dev;
 		ldev->dev_data.buffer = &ldev->buffer.public;
@@ -1819,10 +3431,17 @@ static int32_t iio_init_devs(struct iio_desc *desc,
 			ldev->buffer.raw_buf = ndev->raw_buf;
 			ldev->buffer.raw_buf_len = ndev->raw_buf_len;
 			ldev->buffer.public.buf = &ldev->buffer.cb;
+			ldev->buffer.buffers_count = 1;
 			ldev->buffer.initalized = 1;
 		} else {
 			ldev->buffer.initalized = 0;
 		}
+
+		ret = iio_init_dev_lookup(ldev);
+		if (NO_OS_IS_ERR_VALUE(ret)) {
+			iio_remove_devs(desc);
+			return ret;
+		}
 	}
 
 	return 0;
@@ -1833,10 +3452,12 @@ static int32_t iio_init_devs(struct iio_desc *desc,
  * @param desc  - IIO descriptor.
  * @param trigs - Triggers array.
  * @param n     - Number of triggers to be initialized.
+ * @param nb_devs - Number of devices.
  * @return 0 in case of success or negative value otherwise.
  */
 static int32_t iio_init_trigs(struct iio_desc *desc,
-			      struct iio_trigger_init *trigs, uint32_t n)
+			      struct iio_trigger_init *trigs, uint32_t n,
+			      uint32_t nb_devs)
 {
 	uint32_t i;
 	struct iio_trig_priv *trig_priv_iter;
@@ -1848,9 +3469,19 @@ static int32_t iio_init_trigs(struct iio_desc *desc,
 	if (!desc->trigs)
 		return -ENOMEM;
 
+	desc->dev_mask_words = NO_OS_DIV_ROUND_UP(nb_devs, 32);
+	desc->trig_dev_masks = no_os_calloc(n * desc->dev_mask_words + 1,
+					    sizeof(*desc->trig_dev_masks));
+	if (!desc->trig_dev_masks) {
+		no_os_free(desc->trigs);
+		return -ENOMEM;
+	}
+
 	for (i = 0; i < n; i++) {
 		trig_init_iter = trigs + i;
 		trig_priv_iter = desc->trigs + i;
+		trig_priv_iter->dev_mask = desc->trig_dev_masks +
+					   i * desc->dev_mask_words;
 		trig_priv_iter->instance = trig_init_iter->trig;
 		trig_priv_iter->name = trig_init_iter->name;
 		trig_priv_iter->descriptor = trig_init_iter->descriptor;
@@ -1883,18 +3514,22 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 
 	ldesc->ctx_attrs = init_param->ctx_attrs;
 	ldesc->nb_ctx_attr = init_param->nb_ctx_attr;
+#ifdef IIO_USE_EPOLL
+	ldesc->epoll_fd = -1;
+#endif
 
-	ret = iio_init_trigs(ldesc, init_param->trigs, init_param->nb_trigs);
+	ret = iio_init_trigs(ldesc, init_param->trigs, init_param->nb_trigs,
+			     init_param->nb_devs);
 	if (NO_OS_IS_ERR_VALUE(ret))
-		goto free_devs;
+		goto free_desc;
 
 	ret = iio_init_devs(ldesc, init_param->devs, init_param->nb_devs);
 	if (NO_OS_IS_ERR_VALUE(ret))
-		goto free_desc;
+		goto free_trigs;
 
 	ret = iio_init_xml(ldesc);
 	if (NO_OS_IS_ERR_VALUE(ret))
-		goto free_trigs;
+		goto free_devs;
 
 	/* device operations */
 	ops = &ldesc->iiod_ops;
@@ -1903,6 +3538,8 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 	ops->get_trigger = iio_get_trigger;
 	ops->set_trigger = iio_set_trigger;
 	ops->read_buffer = iio_read_buffer;
+	ops->read_buffer_zc = iio_read_buffer_zc;
+	ops->read_buffer_done = iio_read_buffer_done;
 	ops->write_buffer = iio_write_buffer;
 	ops->refill_buffer = iio_refill_buffer;
 	ops->push_buffer = iio_push_buffer;
@@ -1911,11 +3548,31 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 	ops->send = iio_send;
 	ops->recv = iio_recv;
 	ops->set_buffers_count = iio_set_buffers_count;
+	ops->get_xml = iio_get_xml;
+#ifdef IIO_ZSTD
+	ops->get_zxml = iio_get_zxml;
+#endif
+	ops->put_xml = iio_put_xml;
+#ifdef IIO_THREADED
+	if (init_param->phy_type == USE_NETWORK) {
+		ops->read_attr = iio_thr_read_attr;
+		ops->write_attr = iio_thr_write_attr;
+		ops->set_trigger = iio_thr_set_trigger;
+		ops->read_buffer = iio_thr_read_buffer;
+		ops->read_buffer_zc = iio_thr_read_buffer_zc;
+		ops->read_buffer_done = iio_thr_read_buffer_done;
+		ops->write_buffer = iio_thr_write_buffer;
+		ops->refill_buffer = iio_thr_refill_buffer;
+		ops->push_buffer = iio_thr_push_buffer;
+		ops->open = iio_thr_open_dev;
+		ops->close = iio_thr_close_dev;
+	}
+#endif
 
 	iiod_param.instance = ldesc;
 	iiod_param.ops = ops;
-	iiod_param.xml = ldesc->xml_desc;
-	iiod_param.xml_len = ldesc->xml_size;
+	iiod_param.xml = NULL;
+	iiod_param.xml_len = 0;
 	iiod_param.phy_type = init_param->phy_type;
 
 	ret = iiod_init(&ldesc->iiod, &iiod_param);
@@ -1929,7 +3586,7 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 
 	if (init_param->phy_type == USE_UART) {
 		ldesc->send = (int (*)())no_os_uart_write;
-		ldesc->recv = (int (*)())no_os_uart_read;
+		ldesc->recv = iio_uart_recv;
 		ldesc->uart_desc = init_param->uart_desc;
 
 		struct iiod_conn_data data = {
@@ -1956,6 +3613,19 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 		ret = socket_listen(ldesc->server, MAX_BACKLOG);
 		if (NO_OS_IS_ERR_VALUE(ret))
 			goto free_pylink;
+#ifdef IIO_USE_EPOLL
+		ret = iio_epoll_init(ldesc);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			goto free_pylink;
+#endif
+#ifdef IIO_THREADED
+		ret = iio_workers_start(ldesc);
+		if (NO_OS_IS_ERR_VALUE(ret)) {
+			iio_workers_stop(ldesc);
+			iio_epoll_remove(ldesc);
+			goto free_pylink;
+		}
+#endif
 	}
 #endif
 	else if (init_param->phy_type == USE_LOCAL_BACKEND) {
@@ -1989,11 +3659,12 @@ free_conns:
 free_iiod:
 	iiod_remove(ldesc->iiod);
 free_xml:
-	no_os_free(ldesc->xml_desc);
+	iio_remove_xml(ldesc);
+free_devs:
+	iio_remove_devs(ldesc);
 free_trigs:
+	no_os_free(ldesc->trig_dev_masks);
 	no_os_free(ldesc->trigs);
-free_devs:
-	no_os_free(ldesc->devs);
 free_desc:
 	no_os_free(ldesc);
 
@@ -2013,6 +3684,10 @@ int iio_remove(struct iio_desc *desc)
 	if (!desc)
 		return -EINVAL;
 
+#ifdef IIO_THREADED
+	/* The workers may use the buffers of the connections */
+	iio_workers_stop(desc);
+#endif
 #if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING)
 	for (int i = 0; i < IIOD_MAX_CONNECTIONS; i++) {
 		ret = iiod_conn_remove(desc->iiod, i, &data);
@@ -2022,12 +3697,16 @@ int iio_remove(struct iio_desc *desc)
 		}
 	}
 	socket_remove(desc->server);
+#endif
+#ifdef IIO_USE_EPOLL
+	iio_epoll_remove(desc);
 #endif
 	no_os_cb_remove(desc->conns);
 	iiod_remove(desc->iiod);
-	no_os_free(desc->devs);
+	iio_remove_xml(desc);
+	iio_remove_devs(desc);
+	no_os_free(desc->trig_dev_masks);
 	no_os_free(desc->trigs);
-	no_os_free(desc->xml_desc);
 	no_os_free(desc);
 
 	return 0;
@@ -146,15 +146,32 @@ int32_t iio_parse_value(char *buf, enum iio_val fmt,
 int iio_format_value(char *buf, uint32_t len, enum iio_val fmt,
 		     int32_t size, int32_t *vals);
 
+/* Regenerate the xml of a device the next time the context is read */
+int iio_invalidate_device_xml(struct iio_desc *desc, const char *dev_name);
+
+/* Get the bytes per scan and the offset of each active channel in a scan */
+uint32_t iio_scan_layout(struct iio_channel *channels, uint32_t mask,
+			 uint32_t *offsets);
+
 /* DMA buffer functions. */
-/* Get buffer addr where to write iio_buffer.size bytes */
+/*
+ * Get addr of the next block of iio_buffer.size bytes. Up to
+ * iio_buffer.nb_blocks blocks can be queued before marking them as done, so
+ * a new transfer can be started while previous blocks are processed.
+ */
 int iio_buffer_get_block(struct iio_buffer *buffer, void **addr);
-/* To be called to mark last iio_buffer_read as done */
+/* Mark the oldest block returned by iio_buffer_get_block as done */
 int iio_buffer_block_done(struct iio_buffer *buffer);
 
 /* Trigger buffer functions. */
 /* Write to buffer iio_buffer.bytes_per_scan bytes from data */
 int iio_buffer_push_scan(struct iio_buffer *buffer, void *data);
+/*
+ * Write to buffer nb_scans * iio_buffer.bytes_per_scan bytes from data. Same as
+ * calling iio_buffer_push_scan nb_scans times, with a single buffer update.
+ */
+int iio_buffer_push_scans(struct iio_buffer *buffer, void *data,
+			  uint32_t nb_scans);
 /* Read from buffer iio_buffer.bytes_per_scan bytes into data */
 int iio_buffer_pop_scan(struct iio_buffer *buffer, void *data);
 
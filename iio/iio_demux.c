@@ -0,0 +1,410 @@
+/***************************************************************************//**
+ *   @file   iio_demux.c
+ *   @brief  Demux and convert kernels for IIO buffers.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <string.h>
+#include "iio.h"
+#include "iio_demux.h"
+#include "no_os_error.h"
+#include "no_os_util.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct iio_demux_op
+ * @brief Conversion of a raw sample, placed in the low bits of a 32 bit
+ * word: value = (raw << lsh) >> rsh, the right shift being arithmetic for
+ * signed samples.
+ */
+struct iio_demux_op {
+	uint32_t lsh;
+	uint32_t rsh;
+	bool is_signed;
+	bool swap;
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Load a raw sample in host order.
+ * @param p - Location of the sample.
+ * @param bytes - Storage size in bytes.
+ * @param swap - Swap the bytes of the sample.
+ * @return The raw sample.
+ */
+static inline uint32_t iio_demux_load(const uint8_t *p, uint32_t bytes,
+				      bool swap)
+{
+	uint16_t v16;
+	uint32_t v32;
+
+	switch (bytes) {
+	case 1:
+		return *p;
+	case 2:
+		memcpy(&v16, p, sizeof(v16));
+		return swap ? no_os_bswap_constant_16(v16) : v16;
+	default:
+		memcpy(&v32, p, sizeof(v32));
+		return swap ? no_os_bswap_constant_32(v32) : v32;
+	}
+}
+
+/**
+ * @brief Convert a raw sample.
+ * @param raw - Raw sample.
+ * @param op - Conversion.
+ * @return The converted sample, sign extended if it is signed.
+ */
+static inline uint32_t iio_demux_conv(uint32_t raw,
+				      const struct iio_demux_op *op)
+{
+	if (op->is_signed)
+		return (uint32_t)((int32_t)(raw << op->lsh) >> op->rsh);
+
+	return (raw << op->lsh) >> op->rsh;
+}
+
+/**
+ * @brief Store a converted sample.
+ * @param out - Output array.
+ * @param i - Index of the sample.
+ * @param val - Converted sample.
+ * @param is_signed - The sample is signed.
+ * @param fmt - Type of the output array.
+ */
+static inline void iio_demux_store(void *out, uint32_t i, uint32_t val,
+				   bool is_signed, enum iio_demux_fmt fmt)
+{
+	switch (fmt) {
+	case IIO_DEMUX_INT16:
+		((int16_t *)out)[i] = (int16_t)val;
+		break;
+	case IIO_DEMUX_INT32:
+		((int32_t *)out)[i] = (int32_t)val;
+		break;
+	default:
+		/* Unsigned 32 bit samples above INT32_MAX stay positive */
+		if (is_signed)
+			((float *)out)[i] = (int32_t)val;
+		else
+			((float *)out)[i] = val;
+		break;
+	}
+}
+
+/**
+ * @brief Scalar kernel, converts the samples [start, nb_scans).
+ * @param src - First sample of the channel.
+ * @param stride - Bytes per scan.
+ * @param start - First sample to convert.
+ * @param nb_scans - Number of scans.
+ * @param bytes - Storage size in bytes.
+ * @param op - Conversion.
+ * @param fmt - Type of the output array.
+ * @param out - Output array.
+ */
+static void iio_demux_scalar(const uint8_t *src, uint32_t stride,
+			     uint32_t start, uint32_t nb_scans, uint32_t bytes,
+			     const struct iio_demux_op *op,
+			     enum iio_demux_fmt fmt, void *out)
+{
+	uint32_t i;
+
+	for (i = start; i < nb_scans; i++)
+		iio_demux_store(out, i, iio_demux_conv(iio_demux_load(src +
+				i * stride, bytes, op->swap), op),
+				op->is_signed, fmt);
+}
+
+#if defined(__SSE2__)
+/**
+ * @brief Convert and store 4 raw 16 bit samples held in 32 bit lanes.
+ * @param x - Raw samples, in the low half of each lane.
+ * @param op - Conversion.
+ * @param fmt - Type of the output array.
+ * @param out - Location of the first converted sample.
+ */
+static inline void iio_demux_sse2_store(__m128i x,
+					const struct iio_demux_op *op,
+					enum iio_demux_fmt fmt, void *out)
+{
+	x = _mm_sll_epi32(x, _mm_cvtsi32_si128(op->lsh));
+	if (op->is_signed)
+		x = _mm_sra_epi32(x, _mm_cvtsi32_si128(op->rsh));
+	else
+		x = _mm_srl_epi32(x, _mm_cvtsi32_si128(op->rsh));
+
+	switch (fmt) {
+	case IIO_DEMUX_INT16:
+		x = _mm_srai_epi32(_mm_slli_epi32(x, 16), 16);
+		_mm_storel_epi64(out, _mm_packs_epi32(x, x));
+		break;
+	case IIO_DEMUX_INT32:
+		_mm_storeu_si128(out, x);
+		break;
+	default:
+		_mm_storeu_ps(out, _mm_cvtepi32_ps(x));
+		break;
+	}
+}
+
+/**
+ * @brief SSE2 kernel for 16 bit samples.
+ * @param src - First sample of the channel.
+ * @param stride - Bytes per scan.
+ * @param nb_scans - Number of scans.
+ * @param op - Conversion.
+ * @param fmt - Type of the output array.
+ * @param out - Output array.
+ * @return Number of converted samples.
+ */
+static uint32_t iio_demux_sse2_16(const uint8_t *src, uint32_t stride,
+				  uint32_t nb_scans,
+				  const struct iio_demux_op *op,
+				  enum iio_demux_fmt fmt, void *out)
+{
+	const uint32_t size = fmt == IIO_DEMUX_INT16 ? 2 : 4;
+	__m128i x, y;
+	uint32_t i;
+
+	/* The loads can cover the samples that follow the channel in the
+	 * last scan they touch, so the last scan is left to the scalar code. */
+	for (i = 0; i + 4 < nb_scans; i += 4) {
+		const uint8_t *p = src + i * stride;
+
+		switch (stride) {
+		case 2:
+			x = _mm_loadl_epi64((const __m128i *)p);
+			x = _mm_unpacklo_epi16(x, _mm_setzero_si128());
+			break;
+		case 4:
+			x = _mm_loadu_si128((const __m128i *)p);
+			break;
+		case 8:
+			x = _mm_loadu_si128((const __m128i *)p);
+			y = _mm_loadu_si128((const __m128i *)(p + 16));
+			x = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 1, 2, 0));
+			y = _mm_shuffle_epi32(y, _MM_SHUFFLE(3, 1, 2, 0));
+			x = _mm_unpacklo_epi64(x, y);
+			break;
+		default:
+			/* The scans may leave the samples unaligned */
+			x = _mm_set_epi32(
+				    iio_demux_load(p + 3 * stride, 2, false),
+				    iio_demux_load(p + 2 * stride, 2, false),
+				    iio_demux_load(p + stride, 2, false),
+				    iio_demux_load(p, 2, false));
+			break;
+		}
+		if (op->swap)
+			x = _mm_or_si128(_mm_slli_epi16(x, 8),
+					 _mm_srli_epi16(x, 8));
+
+		iio_demux_sse2_store(x, op, fmt, (uint8_t *)out + i * size);
+	}
+
+	return i;
+}
+#endif
+
+#if defined(__AVX2__)
+/**
+ * @brief AVX2 kernel for contiguous or paired 16 bit samples. Other layouts
+ * use the SSE2 kernel.
+ * @param src - First sample of the channel.
+ * @param stride - Bytes per scan.
+ * @param nb_scans - Number of scans.
+ * @param op - Conversion.
+ * @param fmt - Type of the output array.
+ * @param out - Output array.
+ * @return Number of converted samples.
+ */
+static uint32_t iio_demux_avx2_16(const uint8_t *src, uint32_t stride,
+				  uint32_t nb_scans,
+				  const struct iio_demux_op *op,
+				  enum iio_demux_fmt fmt, void *out)
+{
+	const uint32_t size = fmt == IIO_DEMUX_INT16 ? 2 : 4;
+	const __m128i lsh = _mm_cvtsi32_si128(op->lsh);
+	const __m128i rsh = _mm_cvtsi32_si128(op->rsh);
+	uint8_t *dst = out;
+	__m256i x;
+	uint32_t i;
+
+	if (stride != 2 && stride != 4)
+		return iio_demux_sse2_16(src, stride, nb_scans, op, fmt, out);
+
+	for (i = 0; i + 8 < nb_scans; i += 8) {
+		const uint8_t *p = src + i * stride;
+
+		if (stride == 2)
+			x = _mm256_cvtepu16_epi32(
+				    _mm_loadu_si128((const __m128i *)p));
+		else
+			x = _mm256_loadu_si256((const __m256i *)p);
+		if (op->swap)
+			x = _mm256_or_si256(_mm256_slli_epi16(x, 8),
+					    _mm256_srli_epi16(x, 8));
+
+		x = _mm256_sll_epi32(x, lsh);
+		if (op->is_signed)
+			x = _mm256_sra_epi32(x, rsh);
+		else
+			x = _mm256_srl_epi32(x, rsh);
+
+		switch (fmt) {
+		case IIO_DEMUX_INT16:
+			x = _mm256_srai_epi32(_mm256_slli_epi32(x, 16), 16);
+			x = _mm256_permute4x64_epi64(_mm256_packs_epi32(x, x),
+						     _MM_SHUFFLE(3, 1, 2, 0));
+			_mm_storeu_si128((__m128i *)(dst + i * size),
+					 _mm256_castsi256_si128(x));
+			break;
+		case IIO_DEMUX_INT32:
+			_mm256_storeu_si256((__m256i *)(dst + i * size), x);
+			break;
+		default:
+			_mm256_storeu_ps((float *)(dst + i * size),
+					 _mm256_cvtepi32_ps(x));
+			break;
+		}
+	}
+
+	return i + iio_demux_sse2_16(src + i * stride, stride, nb_scans - i, op,
+				     fmt, dst + i * size);
+}
+#endif
+
+/**
+ * @brief Convert one channel of interleaved scans into a planar array.
+ * @param src - First sample of the channel.
+ * @param stride - Bytes per scan.
+ * @param nb_scans - Number of scans.
+ * @param type - Scan type of the channel.
+ * @param fmt - Type of the output array.
+ * @param out - Output array of nb_scans samples.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int iio_demux_channel(const void *src, uint32_t stride, uint32_t nb_scans,
+		      const struct scan_type *type, enum iio_demux_fmt fmt,
+		      void *out)
+{
+	struct iio_demux_op op;
+	uint32_t bytes, i = 0;
+
+	if (!src || !type || !out)
+		return -EINVAL;
+
+	bytes = type->storagebits / 8;
+	if ((bytes != 1 && bytes != 2 && bytes != 4) || !type->realbits ||
+	    type->shift + type->realbits > type->storagebits)
+		return -EINVAL;
+
+	op.lsh = 32 - type->shift - type->realbits;
+	op.rsh = 32 - type->realbits;
+	op.is_signed = type->sign == 's';
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	op.swap = !type->is_big_endian && bytes > 1;
+#else
+	op.swap = type->is_big_endian && bytes > 1;
+#endif
+
+	if (bytes == 2) {
+#if defined(__AVX2__)
+		i = iio_demux_avx2_16(src, stride, nb_scans, &op, fmt, out);
+#elif defined(__SSE2__)
+		i = iio_demux_sse2_16(src, stride, nb_scans, &op, fmt, out);
+#endif
+	}
+
+	iio_demux_scalar(src, stride, i, nb_scans, bytes, &op, fmt, out);
+
+	return 0;
+}
+
+/**
+ * @brief Deinterleave the scans of an IIO buffer into planar arrays.
+ * @param channels - Channels of the device.
+ * @param mask - Active channels.
+ * @param buf - Interleaved scans.
+ * @param nb_scans - Number of scans.
+ * @param fmt - Type of the output arrays.
+ * @param out - One output array of nb_scans samples per active channel.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int iio_demux(struct iio_channel *channels, uint32_t mask, const void *buf,
+	      uint32_t nb_scans, enum iio_demux_fmt fmt, void **out)
+{
+	const uint8_t *scans = buf;
+	uint32_t offsets[32];
+	uint32_t stride, ch, k = 0;
+	int ret;
+
+	if (!channels || !buf || !out)
+		return -EINVAL;
+
+	stride = iio_scan_layout(channels, mask, offsets);
+
+	for (ch = 0; mask; ch++, mask >>= 1) {
+		if (!(mask & 1))
+			continue;
+
+		ret = iio_demux_channel(scans + offsets[k], stride, nb_scans,
+					channels[ch].scan_type, fmt, out[k]);
+		if (ret)
+			return ret;
+		k++;
+	}
+
+	return 0;
+}
@@ -0,0 +1,87 @@
+/***************************************************************************//**
+ *   @file   iio_demux.h
+ *   @brief  Header file of the IIO buffer demux and convert kernels.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef IIO_DEMUX_H_
+#define IIO_DEMUX_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include "iio_types.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @enum iio_demux_fmt
+ * @brief Type of the converted samples.
+ */
+enum iio_demux_fmt {
+	/** int16_t, samples wider than 16 bits are truncated */
+	IIO_DEMUX_INT16,
+	/** int32_t, unsigned 32 bit samples above INT32_MAX wrap */
+	IIO_DEMUX_INT32,
+	/** float */
+	IIO_DEMUX_FLOAT,
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/*
+ * Convert one channel of nb_scans interleaved scans into a planar array.
+ * src points to the first sample of the channel and stride is the number of
+ * bytes per scan. The sample is shifted, masked to realbits, sign extended
+ * and byte swapped as described by type.
+ */
+int iio_demux_channel(const void *src, uint32_t stride, uint32_t nb_scans,
+		      const struct scan_type *type, enum iio_demux_fmt fmt,
+		      void *out);
+/*
+ * Deinterleave nb_scans scans of the channels enabled in mask (the layout
+ * of iio_buffer) into one planar array per active channel, in channel order.
+ */
+int iio_demux(struct iio_channel *channels, uint32_t mask, const void *buf,
+	      uint32_t nb_scans, enum iio_demux_fmt fmt, void **out);
+
+#endif /* IIO_DEMUX_H_ */
@@ -227,6 +227,10 @@ struct iio_buffer {
 	struct no_os_circular_buffer *buf;
 	/* Stores cyclic buffer specific information */
 	struct iio_cyclic_buffer_info cyclic_info;
+	/* Number of blocks of size bytes that fit in buf */
+	uint32_t nb_blocks;
+	/* Blocks returned by iio_buffer_get_block and not marked as done */
+	uint32_t queued_blocks;
 };
 
 struct iio_device_data {
@@ -290,6 +294,10 @@ struct iio_device {
 	/* Write device register */
 	int32_t (*debug_reg_write)(void *dev, uint32_t reg, uint32_t writeval);
 
+	/** Optional pre-generated xml of the channels and attributes, as
+	 * emitted by tools/scripts/iio_xml_blob.py. If NULL, it is generated
+	 * the first time the context xml is requested */
+	const char *xml;
 };
 
 #endif /* IIO_TYPES_H_ */
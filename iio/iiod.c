@@ -75,7 +75,9 @@ static struct iiod_str cmds[] = {
 	[IIOD_CMD_WRITEBUF]	= IIOD_STR("WRITEBUF"),
 	[IIOD_CMD_GETTRIG]	= IIOD_STR("GETTRIG"),
 	[IIOD_CMD_SETTRIG]	= IIOD_STR("SETTRIG"),
-	[IIOD_CMD_SET]		= IIOD_STR("SET")
+	[IIOD_CMD_SET]		= IIOD_STR("SET"),
+	[IIOD_CMD_BINARY]	= IIOD_STR("NOOS_BINARY"),
+	[IIOD_CMD_ZPRINT]	= IIOD_STR("ZPRINT")
 };
 static const uint32_t priority_array[] = {
 	/* Order not tested, just personal expectation. Function can
@@ -93,7 +95,9 @@ static const uint32_t priority_array[] = {
 	IIOD_CMD_GETTRIG,
 	IIOD_CMD_SETTRIG,
 	IIOD_CMD_HELP,
-	IIOD_CMD_SET
+	IIOD_CMD_SET,
+	IIOD_CMD_BINARY,
+	IIOD_CMD_ZPRINT
 };
 
 static_assert(NO_OS_ARRAY_SIZE(cmds) == NO_OS_ARRAY_SIZE(priority_array),
@@ -229,23 +233,20 @@ static int32_t iiod_parse_rw_attr(const char *token, struct comand_desc *res,
 	return 0;
 }
 
-int32_t iiod_parse_line(char *buf, struct comand_desc *res, char **ctx)
+/* Fill res with the arguments of res->cmd found in buf */
+static int32_t iiod_parse_args(char *buf, struct comand_desc *res, char **ctx)
 {
-	int32_t ret;
 	char *token;
 
 	token = strtok_r(buf, delim, ctx);
-	ret = parse_cmd(token, res);
-	if (NO_OS_IS_ERR_VALUE(ret))
-		return ret;
-
-	token = strtok_r(NULL, delim, ctx);
 	/* Commands without device */
 	switch (res->cmd) {
 	case IIOD_CMD_HELP:
 	case IIOD_CMD_EXIT:
 	case IIOD_CMD_PRINT:
+	case IIOD_CMD_ZPRINT:
 	case IIOD_CMD_VERSION:
+	case IIOD_CMD_BINARY:
 		return 0;
 	case IIOD_CMD_TIMEOUT:
 		return parse_num(token, &res->timeout, 10);
@@ -253,6 +254,9 @@ int32_t iiod_parse_line(char *buf, struct comand_desc *res, char **ctx)
 		break;
 	}
 
+	if (!token)
+		return -EINVAL;
+
 	strncpy(res->device, token, sizeof(res->device));
 	token = strtok_r(NULL, delim, ctx);
 	switch (res->cmd) {
@@ -283,6 +287,34 @@ int32_t iiod_parse_line(char *buf, struct comand_desc *res, char **ctx)
 	return -EINVAL;
 }
 
+int32_t iiod_parse_line(char *buf, struct comand_desc *res, char **ctx)
+{
+	int32_t ret;
+	char *token;
+
+	token = strtok_r(buf, delim, ctx);
+	ret = parse_cmd(token, res);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	return iiod_parse_args(NULL, res, ctx);
+}
+
+/* Parse a binary command whose header and arguments were received */
+static int32_t iiod_parse_bin_cmd(struct iiod_conn_priv *conn)
+{
+	uint8_t op = conn->bin_cmd_hdr[2];
+
+	/* Mode can't be changed once in binary mode */
+	if (op >= NO_OS_ARRAY_SIZE(cmds) || op == IIOD_CMD_BINARY)
+		return -EINVAL;
+
+	conn->cmd_data.cmd = op;
+
+	return iiod_parse_args(conn->parser_buf, &conn->cmd_data,
+			       &conn->strtok_ctx);
+}
+
 static int dummy_open(struct iiod_ctx *ctx, const char *device,
 		      uint32_t samples, uint32_t mask, bool cyclic)
 {
@@ -334,6 +366,11 @@ int32_t iiod_copy_ops(struct iiod_ops *ops, struct iiod_ops *new_ops)
 	ops->open = SET_DUMMY_IF_NULL(new_ops->open, dummy_open);
 	ops->close = SET_DUMMY_IF_NULL(new_ops->close, dummy_close);
 	ops->read_buffer = SET_DUMMY_IF_NULL(new_ops->read_buffer, dummy_rd_data);
+	/* Zero copy reads are used only when both ops are implemented */
+	if (new_ops->read_buffer_zc && new_ops->read_buffer_done) {
+		ops->read_buffer_zc = new_ops->read_buffer_zc;
+		ops->read_buffer_done = new_ops->read_buffer_done;
+	}
 	ops->write_buffer = SET_DUMMY_IF_NULL(new_ops->write_buffer, dummy_wr_data);
 	ops->read_attr = SET_DUMMY_IF_NULL(new_ops->read_attr, dummy_rw_attr);
 	ops->write_attr = SET_DUMMY_IF_NULL(new_ops->write_attr, dummy_rw_attr);
@@ -346,6 +383,9 @@ int32_t iiod_copy_ops(struct iiod_ops *ops, struct iiod_ops *new_ops)
 					       dummy_close);
 	ops->push_buffer = SET_DUMMY_IF_NULL(new_ops->push_buffer,
 					     dummy_close);
+	ops->get_xml = new_ops->get_xml;
+	ops->get_zxml = new_ops->get_zxml;
+	ops->put_xml = new_ops->put_xml;
 
 	return 0;
 }
@@ -369,8 +409,8 @@ int32_t iiod_init(struct iiod_desc **desc, struct iiod_init_param *param)
 		return ret;
 	}
 
-	ldesc->xml = param->xml;
-	ldesc->xml_len = param->xml_len;
+	ldesc->xml.buf = param->xml;
+	ldesc->xml.len = param->xml_len;
 	ldesc->app_instance = param->instance;
 	ldesc->phy_type = param->phy_type;
 
@@ -389,6 +429,7 @@ static void conn_clean_state(struct iiod_conn_priv *conn)
 	memset(&conn->cmd_data, 0, sizeof(conn->cmd_data));
 	memset(&conn->res, 0, sizeof(conn->res));
 	memset(&conn->nb_buf, 0, sizeof(conn->nb_buf));
+	memset(&conn->bin_res, 0, sizeof(conn->bin_res));
 
 	conn->res.buf.buf = NULL;
 	conn->res.buf.idx = 0;
@@ -396,6 +437,37 @@ static void conn_clean_state(struct iiod_conn_priv *conn)
 	conn->state = IIOD_READING_LINE;
 }
 
+/*
+ * Consume the region of the device buffer a READBUF was sending, if any, so
+ * it is not left reserved when the command is aborted.
+ */
+static void iiod_release_zc(struct iiod_desc *desc,
+			    struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+
+	if (conn->state != IIOD_RW_BUF ||
+	    conn->cmd_data.cmd != IIOD_CMD_READBUF ||
+	    !desc->ops.read_buffer_zc || !conn->nb_buf.len)
+		return;
+
+	desc->ops.read_buffer_done(&ctx, conn->cmd_data.device);
+	conn->nb_buf.len = 0;
+}
+
+/* Give back the xml fragments a PRINT or ZPRINT was sending, if any */
+static void iiod_put_xml(struct iiod_desc *desc, struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+
+	if (!conn->res.frags)
+		return;
+
+	if (conn->res.frags != &desc->xml && desc->ops.put_xml)
+		desc->ops.put_xml(&ctx, conn->res.frags);
+	conn->res.frags = NULL;
+}
+
 int32_t iiod_conn_add(struct iiod_desc *desc, struct iiod_conn_data *data,
 		      uint32_t *new_conn_id)
 {
@@ -434,6 +506,8 @@ int32_t iiod_conn_remove(struct iiod_desc *desc, uint32_t conn_id,
 		return -EINVAL;
 	struct iiod_conn_priv *conn;
 	conn = &desc->conns[conn_id];
+	iiod_release_zc(desc, conn);
+	iiod_put_xml(desc, conn);
 	data->conn = conn->conn;
 	data->len = conn->payload_buf_len;
 	data->buf = conn->payload_buf;
@@ -467,6 +541,58 @@ static int32_t call_op(struct iiod_ops *ops, struct comand_desc *data,
 	return -EINVAL;
 }
 
+/*
+ * Receive at most len bytes from the connection. Data already buffered in
+ * conn->rx_buf is consumed first so pipelined commands and payloads that
+ * arrived together with a command line are not lost.
+ */
+static int32_t iiod_recv(struct iiod_desc *desc, struct iiod_conn_priv *conn,
+			 uint8_t *buf, uint32_t len)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	uint32_t available;
+
+	available = conn->rx_len - conn->rx_idx;
+	if (!available)
+		return desc->ops.recv(&ctx, buf, len);
+
+	len = no_os_min(len, available);
+	memcpy(buf, conn->rx_buf + conn->rx_idx, len);
+	conn->rx_idx += len;
+
+	return len;
+}
+
+/*
+ * Refill conn->rx_buf once it was fully consumed.
+ * The network and UART backends return partial reads (a UART without a
+ * receive ring limits the length itself), the local backend may block until
+ * the requested length is received, so for it the data is still received
+ * one byte at a time.
+ */
+static int32_t iiod_fill_rx_buf(struct iiod_desc *desc,
+				struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	uint32_t len;
+	int32_t ret;
+
+	if (conn->rx_idx < conn->rx_len)
+		return conn->rx_len - conn->rx_idx;
+
+	len = desc->phy_type == USE_LOCAL_BACKEND ? 1 : IIOD_RX_BUF_SIZE;
+	ret = desc->ops.recv(&ctx, (uint8_t *)conn->rx_buf, len);
+	if (ret == -EAGAIN || ret == 0)
+		return -EAGAIN;
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	conn->rx_idx = 0;
+	conn->rx_len = ret;
+
+	return ret;
+}
+
 /*
  * Unload data from buf without blocking.
  * When done will return 0, if there is still data to be sent it will return
@@ -486,7 +612,7 @@ static int32_t rw_iiod_buff(struct iiod_desc *desc, struct iiod_conn_priv *conn,
 		if (flags & IIOD_WR)
 			ret = desc->ops.send(&ctx, tmp_buf, len);
 		else
-			ret = desc->ops.recv(&ctx, tmp_buf, len);
+			ret = iiod_recv(desc, conn, tmp_buf, len);
 		if (NO_OS_IS_ERR_VALUE(ret))
 			return ret;
 
@@ -519,6 +645,8 @@ static int32_t do_read_buff_delayed(struct iiod_desc *desc,
 	max_to_read = len - conn->nb_buf.len;
 	ret = desc->ops.read_buffer(&ctx, conn->cmd_data.device,
 				    conn->nb_buf.buf + conn->nb_buf.len, max_to_read);
+	if (ret == -EINPROGRESS)
+		return -EAGAIN;
 	if (ret < 0)
 		return ret;
 
@@ -537,11 +665,66 @@ static int32_t do_read_buff_delayed(struct iiod_desc *desc,
 	return 0;
 }
 
+/*
+ * Send data directly from the regions of the device buffer, without copying
+ * it to payload_buf. A region stays reserved in the device buffer until it
+ * was fully sent and it is consumed.
+ */
+static int32_t do_read_buff_zc(struct iiod_desc *desc,
+			       struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	bool wait_all;
+	char *buf;
+	int32_t ret;
+
+	if (conn->nb_buf.len == 0) {
+		/*
+		 * Same as do_read_buff_delayed: on the network backend wait for
+		 * all the data before sending it
+		 */
+		wait_all = desc->phy_type == USE_NETWORK;
+		ret = desc->ops.read_buffer_zc(&ctx, conn->cmd_data.device, &buf,
+					       conn->cmd_data.bytes_count,
+					       wait_all);
+		if (ret == -EINPROGRESS)
+			return -EAGAIN;
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+		if (!ret)
+			return -EAGAIN;
+
+		conn->nb_buf.buf = buf;
+		conn->nb_buf.len = ret;
+		conn->nb_buf.idx = 0;
+	}
+
+	ret = rw_iiod_buff(desc, conn, &conn->nb_buf, IIOD_WR);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	ret = desc->ops.read_buffer_done(&ctx, conn->cmd_data.device);
+	if (ret == -EINPROGRESS)
+		return -EAGAIN;
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	conn->cmd_data.bytes_count -= conn->nb_buf.len;
+	conn->nb_buf.len = 0;
+	if (conn->cmd_data.bytes_count)
+		return -EAGAIN;
+
+	return 0;
+}
+
 static int32_t do_read_buff(struct iiod_desc *desc, struct iiod_conn_priv *conn)
 {
 	struct iiod_ctx ctx;
 	int32_t ret, len;
 
+	if (desc->ops.read_buffer_zc)
+		return do_read_buff_zc(desc, conn);
+
 	/*
 	 * When using the network backend wait for a whole buffer to be filled
 	 * before sending in order to reduce the ammount of network traffic.
@@ -557,6 +740,8 @@ static int32_t do_read_buff(struct iiod_desc *desc, struct iiod_conn_priv *conn)
 		/* Read from dev */
 		ret = desc->ops.read_buffer(&ctx, conn->cmd_data.device,
 					    conn->nb_buf.buf, len);
+		if (ret == -EINPROGRESS)
+			return -EAGAIN;
 		if (NO_OS_IS_ERR_VALUE(ret))
 			return ret;
 		len = ret;
@@ -600,6 +785,8 @@ static int32_t do_write_buff(struct iiod_desc *desc,
 	/* Write to dev */
 	ret = desc->ops.write_buffer(&ctx, conn->cmd_data.device,
 				     conn->nb_buf.buf, conn->nb_buf.len);
+	if (ret == -EINPROGRESS)
+		return -EAGAIN;
 	if (NO_OS_IS_ERR_VALUE(ret))
 		return ret;
 
@@ -621,6 +808,7 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 		.name = data->attr,
 		.channel = data->channel
 	};
+	uint32_t i;
 	int32_t ret;
 
 	switch (data->cmd) {
@@ -638,7 +826,11 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 		if (data->cmd == IIOD_CMD_CLOSE)
 			/* Set is_cyclic_buffer to false every time the device is closed */
 			conn->is_cyclic_buffer = false;
-		conn->res.val = call_op(&desc->ops, data, &ctx);
+		ret = call_op(&desc->ops, data, &ctx);
+		/* Device busy, call the operation again in the next step */
+		if (ret == -EINPROGRESS)
+			return -EAGAIN;
+		conn->res.val = ret;
 		conn->res.write_val = 1;
 		break;
 	case IIOD_CMD_EXIT:
@@ -646,11 +838,40 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 		conn->res.write_val = 1;
 
 		return -ENOTCONN;
+	case IIOD_CMD_BINARY:
+#ifdef IIOD_NOOS_BINARY
+		/* Mode is switched after the response is sent */
+		conn->res.val = 0;
+#else
+		/* Not built in, answered as an unknown command */
+		conn->res.val = -EINVAL;
+#endif
+		conn->res.write_val = 1;
+		break;
 	case IIOD_CMD_PRINT:
-		conn->res.val = desc->xml_len;
+	case IIOD_CMD_ZPRINT:
 		conn->res.write_val = 1;
-		conn->res.buf.buf = desc->xml;
-		conn->res.buf.len = desc->xml_len;
+		if (data->cmd == IIOD_CMD_ZPRINT) {
+			/* Not supported without the op */
+			ret = -EINVAL;
+			if (desc->ops.get_zxml)
+				ret = desc->ops.get_zxml(&ctx, &conn->res.frags,
+							 &conn->res.nb_frags);
+		} else if (desc->ops.get_xml) {
+			ret = desc->ops.get_xml(&ctx, &conn->res.frags,
+						&conn->res.nb_frags);
+		} else {
+			conn->res.frags = &desc->xml;
+			conn->res.nb_frags = 1;
+			ret = 0;
+		}
+		if (NO_OS_IS_ERR_VALUE(ret)) {
+			conn->res.val = ret;
+			break;
+		}
+		conn->res.val = 0;
+		for (i = 0; i < conn->res.nb_frags; i++)
+			conn->res.val += conn->res.frags[i].len;
 		break;
 	case IIOD_CMD_VERSION:
 		conn->res.buf.buf = IIOD_VERSION;
@@ -666,6 +887,9 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 			ret = desc->ops.get_trigger(&ctx, data->device,
 						    conn->payload_buf,
 						    conn->payload_buf_len);
+		/* Operation still running, call it again in the next step */
+		if (ret == -EINPROGRESS)
+			return -EAGAIN;
 		conn->res.val = ret;
 		conn->res.write_val = 1;
 		if (!NO_OS_IS_ERR_VALUE(ret)) {
@@ -678,6 +902,8 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 		ret = desc->ops.write_attr(&ctx, data->device, &attr,
 					   conn->payload_buf,
 					   data->bytes_count);
+		if (ret == -EINPROGRESS)
+			return -EAGAIN;
 		conn->nb_buf.len = 0;
 		conn->res.val = ret;
 		conn->res.write_val = 1;
@@ -685,11 +911,16 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 	case IIOD_CMD_READBUF:
 		conn->res.write_val = 1;
 		ret = desc->ops.refill_buffer(&ctx, data->device);
+		if (ret == -EINPROGRESS)
+			return -EAGAIN;
 		if (NO_OS_IS_ERR_VALUE(ret)) {
 			conn->res.val = ret;
 			break;
 		}
 		conn->res.val = data->bytes_count;
+		/* In binary mode only the data follows the response header */
+		if (conn->binary)
+			break;
 		ret = snprintf(conn->buf_mask, 10, "%08"PRIx32, conn->mask);
 		conn->res.buf.buf = conn->buf_mask;
 		conn->res.buf.len = ret;
@@ -708,27 +939,23 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 static int32_t iiod_read_line(struct iiod_desc *desc,
 			      struct iiod_conn_priv *conn)
 {
-	struct iiod_ctx ctx = {
-		.instance = desc->app_instance,
-		.conn = conn->conn
-	};
 	int32_t ret;
-	char *ch;
+	char ch;
 
 	while (conn->parser_idx < IIOD_PARSER_MAX_BUF_SIZE - 1) {
-		ch = conn->parser_buf + conn->parser_idx;
-		ret = desc->ops.recv(&ctx,(uint8_t *)ch, 1);
-		if (ret == -EAGAIN || ret == 0)
+		ret = iiod_fill_rx_buf(desc, conn);
+		if (ret == -EAGAIN)
 			return -EAGAIN;
 
 		if (NO_OS_IS_ERR_VALUE(ret))
 			goto end;
 
-		if (conn->parser_idx == 0 && (*ch == '\n' || *ch == '\r'))
+		ch = conn->rx_buf[conn->rx_idx++];
+		if (conn->parser_idx == 0 && (ch == '\n' || ch == '\r'))
 			continue ;
 
-		++conn->parser_idx;
-		if (*ch == '\n') {
+		conn->parser_buf[conn->parser_idx++] = ch;
+		if (ch == '\n') {
 			conn->parser_buf[conn->parser_idx] = '\0';
 			ret = 0;
 			goto end;
@@ -741,6 +968,103 @@ end:
 	return ret;
 }
 
+/*
+ * Receive the header and the arguments of a binary command without blocking.
+ * Arguments are stored null terminated in conn->parser_buf.
+ */
+static int32_t iiod_read_bin_cmd(struct iiod_desc *desc,
+				 struct iiod_conn_priv *conn)
+{
+	uint32_t len;
+	int32_t ret;
+	uint8_t *buf;
+
+	do {
+		if (conn->parser_idx < IIOD_BIN_HDR_SIZE) {
+			buf = conn->bin_cmd_hdr + conn->parser_idx;
+			len = IIOD_BIN_HDR_SIZE - conn->parser_idx;
+		} else {
+			len = no_os_get_unaligned_le32(conn->bin_cmd_hdr + 4);
+			/* Stream can't be parsed anymore, drop the connection */
+			if (len >= IIOD_PARSER_MAX_BUF_SIZE) {
+				ret = -ENOTCONN;
+				goto end;
+			}
+			buf = (uint8_t *)conn->parser_buf +
+			      conn->parser_idx - IIOD_BIN_HDR_SIZE;
+			len -= conn->parser_idx - IIOD_BIN_HDR_SIZE;
+			if (!len)
+				break;
+		}
+
+		ret = iiod_recv(desc, conn, buf, len);
+		if (ret == -EAGAIN || ret == 0)
+			return -EAGAIN;
+
+		if (NO_OS_IS_ERR_VALUE(ret))
+			goto end;
+
+		conn->parser_idx += ret;
+	} while (true);
+
+	conn->parser_buf[conn->parser_idx - IIOD_BIN_HDR_SIZE] = '\0';
+	ret = 0;
+end:
+	conn->parser_idx = 0;
+	return ret;
+}
+
+/* Send res.buf and then each of res.frags. flags are used for the last one */
+static int32_t iiod_write_res_buf(struct iiod_desc *desc,
+				  struct iiod_conn_priv *conn, uint8_t flags)
+{
+	struct iiod_run_cmd_result *res = &conn->res;
+	bool last;
+	int32_t ret;
+
+	while (true) {
+		last = res->frag_idx >= res->nb_frags;
+		if (res->buf.buf && res->buf.idx < res->buf.len) {
+			ret = rw_iiod_buff(desc, conn, &res->buf,
+					   last ? flags : IIOD_WR);
+			if (NO_OS_IS_ERR_VALUE(ret))
+				return ret;
+		}
+		if (last)
+			return 0;
+
+		res->buf.buf = (char *)res->frags[res->frag_idx].buf;
+		res->buf.len = res->frags[res->frag_idx].len;
+		res->buf.idx = 0;
+		res->frag_idx++;
+	}
+}
+
+static int32_t iiod_write_bin_result(struct iiod_desc *desc,
+				     struct iiod_conn_priv *conn)
+{
+	int32_t code;
+	int32_t ret;
+
+	if (!conn->bin_res.len) {
+		code = conn->res.write_val ? (int32_t)conn->res.val :
+		       (int32_t)conn->res.buf.len;
+		/* Echo client_id and dev */
+		memcpy(conn->bin_res_hdr, conn->bin_cmd_hdr, IIOD_BIN_HDR_SIZE);
+		conn->bin_res_hdr[2] |= IIOD_BIN_RESPONSE;
+		no_os_put_unaligned_le32(code, conn->bin_res_hdr + 4);
+
+		conn->bin_res.buf = (char *)conn->bin_res_hdr;
+		conn->bin_res.len = IIOD_BIN_HDR_SIZE;
+		conn->bin_res.idx = 0;
+	}
+	ret = rw_iiod_buff(desc, conn, &conn->bin_res, IIOD_WR);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	return iiod_write_res_buf(desc, conn, IIOD_WR);
+}
+
 /*
  * Function will return SUCCESS when a state was processed.
  * If a state is still in processing state, it will return -EAGAIN.
@@ -754,23 +1078,35 @@ static int32_t iiod_run_state(struct iiod_desc *desc,
 		.instance = desc->app_instance,
 		.conn = conn->conn
 	};
+	bool failed;
 	int32_t ret;
 
 	switch (conn->state) {
 	case IIOD_READING_LINE:
-		/* Read input data until \n. I/O Calls */
-		ret = iiod_read_line(desc, conn);
-		if (NO_OS_IS_ERR_VALUE(ret))
-			return ret;
+		if (conn->binary) {
+			/* Read header and arguments. I/O Calls */
+			ret = iiod_read_bin_cmd(desc, conn);
+			if (NO_OS_IS_ERR_VALUE(ret))
+				return ret;
 
-		/* Fill struct comand_desc with data from line. No I/O */
-		ret = iiod_parse_line(conn->parser_buf, &conn->cmd_data,
-				      &conn->strtok_ctx);
+			/* Fill struct comand_desc from header and args. No I/O */
+			ret = iiod_parse_bin_cmd(conn);
+		} else {
+			/* Read input data until \n. I/O Calls */
+			ret = iiod_read_line(desc, conn);
+			if (NO_OS_IS_ERR_VALUE(ret))
+				return ret;
+
+			/* Fill struct comand_desc with data from line. No I/O */
+			ret = iiod_parse_line(conn->parser_buf, &conn->cmd_data,
+					      &conn->strtok_ctx);
+		}
 		if (NO_OS_IS_ERR_VALUE(ret)) {
 			/* Parsing line failed */
 			conn->res.write_val = 1;
 			conn->res.val = ret;
-			conn->state = IIOD_WRITING_CMD_RESULT;
+			conn->state = conn->binary ? IIOD_WRITING_BIN_RESULT :
+				      IIOD_WRITING_CMD_RESULT;
 		} else if (conn->cmd_data.cmd == IIOD_CMD_WRITE) {
 			/* Special case. Attribute needs to be read */
 			conn->nb_buf.buf = conn->payload_buf;
@@ -788,12 +1124,21 @@ static int32_t iiod_run_state(struct iiod_desc *desc,
 		if (NO_OS_IS_ERR_VALUE(ret))
 			return ret;
 
-		conn->state = IIOD_WRITING_CMD_RESULT;
+		if (!conn->binary) {
+			conn->state = IIOD_WRITING_CMD_RESULT;
+		} else if (conn->cmd_data.cmd == IIOD_CMD_WRITEBUF &&
+			   !NO_OS_IS_ERR_VALUE((int32_t)conn->res.val)) {
+			/* Data of a binary WRITEBUF follows without a reply */
+			memset(&conn->nb_buf, 0, sizeof(conn->nb_buf));
+			conn->state = IIOD_RW_BUF;
+		} else {
+			conn->state = IIOD_WRITING_BIN_RESULT;
+		}
 
 		return 0;
 	case IIOD_WRITING_CMD_RESULT:
-		/* Write result or the length of data to be sent*/
 		if (conn->res.write_val) {
+			/* Write result or the length of data to be sent*/
 			if (conn->nb_buf.len == 0) {
 				conn->nb_buf.buf = conn->parser_buf;
 				ret = sprintf(conn->nb_buf.buf, "%"PRIi32,
@@ -810,13 +1155,12 @@ static int32_t iiod_run_state(struct iiod_desc *desc,
 			}
 		}
 		/* Send buf from result. Non blocking */
-		if (conn->res.buf.buf &&
-		    conn->res.buf.idx < conn->res.buf.len) {
-			ret = rw_iiod_buff(desc, conn, &conn->res.buf,
-					   IIOD_WR | IIOD_ENDL);
-			if (NO_OS_IS_ERR_VALUE(ret))
-				return ret;
-		}
+		ret = iiod_write_res_buf(desc, conn, IIOD_WR | IIOD_ENDL);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		if (conn->cmd_data.cmd == IIOD_CMD_BINARY && !conn->res.val)
+			conn->binary = true;
 
 		if (conn->cmd_data.cmd != IIOD_CMD_READBUF &&
 		    conn->cmd_data.cmd != IIOD_CMD_WRITEBUF) {
@@ -830,6 +1174,27 @@ static int32_t iiod_run_state(struct iiod_desc *desc,
 			conn->state = IIOD_RW_BUF;
 		}
 
+		return 0;
+	case IIOD_WRITING_BIN_RESULT:
+		/* Response header followed by the result data. Non blocking */
+		ret = iiod_write_bin_result(desc, conn);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		failed = NO_OS_IS_ERR_VALUE((int32_t)conn->res.val);
+		if (conn->cmd_data.cmd == IIOD_CMD_READBUF && !failed) {
+			/* Buffer data follows the response header */
+			memset(&conn->nb_buf, 0, sizeof(conn->nb_buf));
+			conn->state = IIOD_RW_BUF;
+		} else if (conn->is_cyclic_buffer &&
+			   conn->cmd_data.cmd != IIOD_CMD_OPEN &&
+			   conn->cmd_data.cmd != IIOD_CMD_READBUF &&
+			   !(conn->cmd_data.cmd == IIOD_CMD_WRITEBUF && failed)) {
+			conn->state = IIOD_PUSH_CYCLIC_BUFFER;
+		} else {
+			conn->state = IIOD_LINE_DONE;
+		}
+
 		return 0;
 	case IIOD_RW_BUF:
 		/* IIOD_CMD_READBUF and IIOD_CMD_WRITEBUF special case */
@@ -837,14 +1202,26 @@ static int32_t iiod_run_state(struct iiod_desc *desc,
 		if (conn->cmd_data.cmd == IIOD_CMD_READBUF)
 			ret = do_read_buff(desc, conn);
 		else {
-			ret = do_write_buff(desc, conn);
+			/* Data is already written if push_buffer is pending */
+			ret = conn->cmd_data.bytes_count ?
+			      do_write_buff(desc, conn) : 0;
 			if (ret == 0) {
 				conn->res.write_val = 1;
 				ret = desc->ops.push_buffer(&ctx,
 							    conn->cmd_data.device);
+				if (ret == -EINPROGRESS)
+					return -EAGAIN;
 				if (NO_OS_IS_ERR_VALUE(ret)) {
 					conn->res.val = ret;
-					conn->state = IIOD_LINE_DONE;
+					conn->state = conn->binary ?
+						      IIOD_WRITING_BIN_RESULT :
+						      IIOD_LINE_DONE;
+
+					return 0;
+				}
+				if (conn->binary) {
+					/* res.val already holds the byte count */
+					conn->state = IIOD_WRITING_BIN_RESULT;
 
 					return 0;
 				}
@@ -875,6 +1252,8 @@ static int32_t iiod_run_state(struct iiod_desc *desc,
 		/* Push puffer to IIO application */
 		ret = desc->ops.push_buffer(&ctx,
 					    conn->cmd_data.device);
+		if (ret == -EINPROGRESS)
+			return -EAGAIN;
 		/* If an error was encountered, close connection */
 		if (NO_OS_IS_ERR_VALUE(ret)) {
 			conn->res.val = ret;
@@ -885,13 +1264,21 @@ static int32_t iiod_run_state(struct iiod_desc *desc,
 		}
 
 		/* Read data from the client to verify whether a close command has been sent */
-		ret = iiod_read_line(desc, conn);
-		if (NO_OS_IS_ERR_VALUE(ret))
-			return 0;
+		if (conn->binary) {
+			ret = iiod_read_bin_cmd(desc, conn);
+			if (NO_OS_IS_ERR_VALUE(ret))
+				return 0;
 
-		/* Fill struct comand_desc with data from line */
-		ret = iiod_parse_line(conn->parser_buf, &conn->cmd_data,
-				      &conn->strtok_ctx);
+			ret = iiod_parse_bin_cmd(conn);
+		} else {
+			ret = iiod_read_line(desc, conn);
+			if (NO_OS_IS_ERR_VALUE(ret))
+				return 0;
+
+			/* Fill struct comand_desc with data from line */
+			ret = iiod_parse_line(conn->parser_buf, &conn->cmd_data,
+					      &conn->strtok_ctx);
+		}
 		if (!NO_OS_IS_ERR_VALUE(ret) && conn->cmd_data.cmd == IIOD_CMD_CLOSE) {
 			/* Exit this state only if a close command is received
 			   All other commands will be ignored.
@@ -927,6 +1314,10 @@ int32_t iiod_conn_step(struct iiod_desc *desc, uint32_t conn_id)
 		//The loop will continue because the state was changed.
 	} while (true);
 
+	if (NO_OS_IS_ERR_VALUE(ret))
+		iiod_release_zc(desc, conn);
+
+	iiod_put_xml(desc, conn);
 	conn_clean_state(conn);
 
 	return ret;
@@ -90,6 +90,13 @@ struct iiod_conn_data {
 	uint32_t len;
 };
 
+/* Part of the xml description */
+struct iiod_xml_fragment {
+	const char *buf;
+	/* Size of buf in bytes */
+	uint32_t len;
+};
+
 /* Functions should return a negative error code on failure */
 struct iiod_ops {
 	/*
@@ -120,7 +127,29 @@ struct iiod_ops {
 	/* Read data from opened buffer */
 	int (*read_buffer)(struct iiod_ctx *ctx, const char *device, char *buf,
 			   uint32_t bytes);
-	/* Called to notify that buffer must be refiiled */
+	/*
+	 * Optional zero copy alternative to read_buffer.
+	 * buf must be set to a contiguous region of the opened buffer holding
+	 * at most bytes of data and the length of the region returned.
+	 * Data is sent directly from the region and it is consumed only when
+	 * read_buffer_done is called, after all of it was sent. Until then the
+	 * region must not be overwritten by new data.
+	 * If wait_all is set, -EAGAIN must be returned while less than bytes
+	 * of data are available.
+	 */
+	int (*read_buffer_zc)(struct iiod_ctx *ctx, const char *device,
+			      char **buf, uint32_t bytes, bool wait_all);
+	/* Consume the region returned by read_buffer_zc */
+	int (*read_buffer_done)(struct iiod_ctx *ctx, const char *device);
+	/*
+	 * Called to notify that buffer must be refiiled.
+	 * refill_buffer, push_buffer, read_attr and write_attr may return
+	 * -EINPROGRESS if the operation was handed to another thread. They are
+	 * then called again, with the same arguments, until a result is
+	 * returned. open, set_trigger, read_buffer, read_buffer_zc,
+	 * read_buffer_done and write_buffer may do the same while the device
+	 * is busy.
+	 */
 	int (*refill_buffer)(struct iiod_ctx *ctx, const char *device);
 
 	/* Write data to opened buffer */
@@ -154,6 +183,29 @@ struct iiod_ops {
 	/* I don't know what this should be used for :) */
 	int (*set_buffers_count)(struct iiod_ctx *ctx, const char *device,
 				 uint32_t buffers_count);
+
+	/*
+	 * Optional. Get the xml description as a list of fragments, sent one
+	 * after the other. Called for each PRINT command. When not set, the
+	 * xml from iiod_init_param is used.
+	 */
+	int (*get_xml)(struct iiod_ctx *ctx, struct iiod_xml_fragment **frags,
+		       uint32_t *nb_frags);
+
+	/*
+	 * Optional. Same as get_xml but the xml is compressed as a Zstandard
+	 * frame. Used for ZPRINT, which fails when not set so clients fall
+	 * back to PRINT.
+	 */
+	int (*get_zxml)(struct iiod_ctx *ctx, struct iiod_xml_fragment **frags,
+			uint32_t *nb_frags);
+
+	/*
+	 * Optional. Called once the connection no longer uses the fragments
+	 * returned by get_xml or get_zxml, so they can be freed if the xml
+	 * changed while they were being sent.
+	 */
+	int (*put_xml)(struct iiod_ctx *ctx, struct iiod_xml_fragment *frags);
 };
 
 /*
@@ -46,9 +46,34 @@
 #define IIOD_ENDL			0x2
 #define IIOD_RD				0x4
 #define IIOD_PARSER_MAX_BUF_SIZE	128
+#define IIOD_RX_BUF_SIZE		512
 
 #define IIOD_STR(cmd) {(cmd), sizeof(cmd) - 1}
 
+/*
+ * Binary mode framing, specific to no-OS and negotiated with NOOS_BINARY.
+ * It is only built with IIOD_NOOS_BINARY, otherwise NOOS_BINARY is answered
+ * with -EINVAL like any unknown command.
+ * This is not the libiio v1 binary protocol: BINARY is still rejected so
+ * libiio clients keep using the text protocol. Only a client implementing
+ * this framing can use it.
+ * Commands of a connection are still run one at a time, in the order they
+ * are received, and answered in that order. Pipelining saves the round trip
+ * per command, the client_id only helps the client match the responses.
+ * Each command and response starts with a header:
+ *   client_id (le16) | op (u8) | dev (u8) | code (le32)
+ * For commands, op is an enum iiod_cmd value and code is the length of the
+ * arguments string following the header (same arguments as the text
+ * command). Data for WRITE and WRITEBUF follows the arguments.
+ * For responses, op is the command op ORed with IIOD_BIN_RESPONSE, the
+ * client_id is echoed and code is the result of the command. For commands
+ * returning data (PRINT, ZPRINT, VERSION, READ, GETTRIG, READBUF) a non negative
+ * code is also the number of data bytes following the header.
+ * The op codes, ZPRINT included, are only meaningful to no-OS clients.
+ */
+#define IIOD_BIN_HDR_SIZE		8
+#define IIOD_BIN_RESPONSE		0x80
+
 #define IIOD_CTX(desc, conn) {.instance = (desc)->app_instance,\
 			      .conn = (conn)->conn}
 
@@ -62,6 +87,8 @@ struct iiod_str {
 /*
  * Commads are the ones documented int the link:
  * https://wiki.analog.com/resources/tools-software/linux-software/libiio_internals#the_network_backend_and_iio_daemon
+ * The values are used as binary mode op codes, new commands must be added at
+ * the end.
  */
 enum iiod_cmd {
 	IIOD_CMD_HELP,
@@ -77,7 +104,9 @@ enum iiod_cmd {
 	IIOD_CMD_WRITEBUF,
 	IIOD_CMD_GETTRIG,
 	IIOD_CMD_SETTRIG,
-	IIOD_CMD_SET
+	IIOD_CMD_SET,
+	IIOD_CMD_BINARY,
+	IIOD_CMD_ZPRINT
 };
 
 /*
@@ -113,6 +142,11 @@ struct iiod_run_cmd_result {
 	bool write_val;
 	/* If buf.len != 0 buf has to be sent */
 	struct iiod_buff buf;
+	/* Sent after buf, one by one through buf */
+	struct iiod_xml_fragment *frags;
+	uint32_t nb_frags;
+	/* Next fragment to be sent */
+	uint32_t frag_idx;
 };
 
 /* Internal structure to handle a connection state */
@@ -134,6 +168,8 @@ struct iiod_conn_priv {
 		IIOD_RUNNING_CMD,
 		/* Write result of executed cmd */
 		IIOD_WRITING_CMD_RESULT,
+		/* Write response header and data of a binary mode cmd */
+		IIOD_WRITING_BIN_RESULT,
 		/* I/O operations for READBUF and WRITEBUF cmds */
 		IIOD_RW_BUF,
 		/* I/O operations for WRITE cmd */
@@ -148,6 +184,17 @@ struct iiod_conn_priv {
 	char parser_buf[IIOD_PARSER_MAX_BUF_SIZE];
 	/* Index in parser_buf. For nonblocking operation */
 	uint32_t parser_idx;
+	/*
+	 * Data received from the connection and not yet consumed. Filled with
+	 * as many bytes as available in one recv call so lines can be
+	 * tokenized without a recv per character. Pipelined commands are
+	 * kept here between calls.
+	 */
+	char rx_buf[IIOD_RX_BUF_SIZE];
+	/* Index of the first unconsumed byte in rx_buf */
+	uint32_t rx_idx;
+	/* Number of valid bytes in rx_buf */
+	uint32_t rx_len;
 	/* Buffer to store raw data (attributes or buffer data).*/
 	char *payload_buf;
 	/* Length of payload_buf_len */
@@ -163,6 +210,14 @@ struct iiod_conn_priv {
 	char *strtok_ctx;
 	/* True if the device was open with cyclic buffer flag */
 	bool is_cyclic_buffer;
+	/* Set after a successful NOOS_BINARY command. Commands are then framed */
+	bool binary;
+	/* Header of the binary command being processed */
+	uint8_t bin_cmd_hdr[IIOD_BIN_HDR_SIZE];
+	/* Header of the binary response being sent */
+	uint8_t bin_res_hdr[IIOD_BIN_HDR_SIZE];
+	/* Send state of bin_res_hdr */
+	struct iiod_buff bin_res;
 };
 
 /* Private iiod information */
@@ -173,10 +228,8 @@ struct iiod_desc {
 	struct iiod_ops ops;
 	/* Application instance */
 	void *app_instance;
-	/* Address of xml */
-	char *xml;
-	/* XML length in bytes */
-	uint32_t xml_len;
+	/* Xml from iiod_init_param. Used when ops.get_xml is not set */
+	struct iiod_xml_fragment xml;
 	/* Backend used by IIOD */
 	enum physical_link_type phy_type;
 };
@@ -0,0 +1,121 @@
+/*******************************************************************************
+ *   @file   no_os_atomic.h
+ *   @brief  Atomic accesses of 32 bit variables shared with threads or
+ *           interrupts.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef _NO_OS_ATOMIC_H_
+#define _NO_OS_ATOMIC_H_
+
+#include <stdint.h>
+
+/*
+ * The variables are plain uint32_t, so this header doesn't need C11
+ * <stdatomic.h>. GCC and clang provide the __atomic builtins for all the
+ * supported targets, in any C standard mode. Loads and stores of aligned 32
+ * bit words are lock free on every core, read-modify-write operations may
+ * need libatomic on cores without exclusive accesses (Cortex-M0).
+ * Other compilers get volatile accesses with a compiler barrier, enough for
+ * an interrupt and the code it interrupts on a single core.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+
+/* Load that later accesses can't be moved before */
+static inline uint32_t no_os_atomic_load_acquire(uint32_t *ptr)
+{
+	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+/* Load with no ordering, of a variable only this context writes */
+static inline uint32_t no_os_atomic_load_relaxed(uint32_t *ptr)
+{
+	return __atomic_load_n(ptr, __ATOMIC_RELAXED);
+}
+
+/* Store that earlier accesses can't be moved after */
+static inline void no_os_atomic_store_release(uint32_t *ptr, uint32_t val)
+{
+	__atomic_store_n(ptr, val, __ATOMIC_RELEASE);
+}
+
+/* Set bits, publishing the accesses done before */
+static inline void no_os_atomic_or_release(uint32_t *ptr, uint32_t bits)
+{
+	__atomic_fetch_or(ptr, bits, __ATOMIC_RELEASE);
+}
+
+/* Clear bits, with no ordering */
+static inline void no_os_atomic_and_relaxed(uint32_t *ptr, uint32_t bits)
+{
+	__atomic_fetch_and(ptr, bits, __ATOMIC_RELAXED);
+}
+
+/* Replace the value and get the old one, acquiring what was published */
+static inline uint32_t no_os_atomic_xchg_acquire(uint32_t *ptr, uint32_t val)
+{
+	return __atomic_exchange_n(ptr, val, __ATOMIC_ACQUIRE);
+}
+
+#else
+
+#define NO_OS_ATOMIC_BARRIER()	__asm volatile("" ::: "memory")
+
+static inline uint32_t no_os_atomic_load_acquire(uint32_t *ptr)
+{
+	uint32_t val = *(volatile uint32_t *)ptr;
+
+	NO_OS_ATOMIC_BARRIER();
+
+	return val;
+}
+
+static inline uint32_t no_os_atomic_load_relaxed(uint32_t *ptr)
+{
+	return *(volatile uint32_t *)ptr;
+}
+
+static inline void no_os_atomic_store_release(uint32_t *ptr, uint32_t val)
+{
+	NO_OS_ATOMIC_BARRIER();
+	*(volatile uint32_t *)ptr = val;
+}
+
+/* Read-modify-write operations are only used with threads (GCC on Linux) */
+
+#endif
+
+#endif // _NO_OS_ATOMIC_H_
@@ -44,7 +44,73 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 
+#include <stddef.h>
 #include <stdint.h>
+#include "no_os_error.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Declare a register batch of up to _size operations on _base */
+#define NO_OS_DECLARE_AXI_IO_BATCH(_name, _base, _size) \
+	struct no_os_axi_io_op _name##_ops[_size]; \
+	struct no_os_axi_io_batch _name = { \
+		.base = _base, \
+		.ops = _name##_ops, \
+		.size = _size, \
+	}
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @enum no_os_axi_io_op_type
+ * @brief Type of a register batch operation.
+ */
+enum no_os_axi_io_op_type {
+	/** Read the register into data */
+	NO_OS_AXI_IO_OP_READ,
+	/** Write val to the register */
+	NO_OS_AXI_IO_OP_WRITE,
+	/** Read the register, replace the bits in mask with val and write it */
+	NO_OS_AXI_IO_OP_UPDATE,
+};
+
+/**
+ * @struct no_os_axi_io_op
+ * @brief Register batch operation.
+ */
+struct no_os_axi_io_op {
+	/** Operation type */
+	enum no_os_axi_io_op_type type;
+	/** Register offset */
+	uint32_t offset;
+	/** Bits changed by an update */
+	uint32_t mask;
+	/** Value written by a write or an update */
+	uint32_t val;
+	/** Where a read stores the register value (may be NULL for updates) */
+	uint32_t *data;
+};
+
+/**
+ * @struct no_os_axi_io_batch
+ * @brief Register accesses recorded to be executed by a single platform call.
+ */
+struct no_os_axi_io_batch {
+	/** Base address */
+	uint32_t base;
+	/** Operations buffer */
+	struct no_os_axi_io_op *ops;
+	/** Size of the operations buffer */
+	uint32_t size;
+	/** Number of recorded operations */
+	uint32_t nb_ops;
+	/** First error returned while flushing a full batch */
+	int32_t err;
+};
 
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
@@ -56,4 +122,90 @@ int32_t no_os_axi_io_read(uint32_t base, uint32_t offset, uint32_t *data);
 /* AXI IO Write data */
 int32_t no_os_axi_io_write(uint32_t base, uint32_t offset, uint32_t data);
 
+/* AXI IO Read consecutive registers */
+int32_t no_os_axi_io_read_multi(uint32_t base, uint32_t offset, uint32_t *data,
+				uint32_t count);
+
+/* AXI IO Write consecutive registers */
+int32_t no_os_axi_io_write_multi(uint32_t base, uint32_t offset,
+				 const uint32_t *data, uint32_t count);
+
+/* AXI IO Execute a sequence of register operations, in order */
+int32_t no_os_axi_io_exec(uint32_t base, struct no_os_axi_io_op *ops,
+			  uint32_t nb_ops);
+
+/**
+ * @brief Execute the operations recorded in a batch and empty it.
+ * @param batch - The batch.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static inline int32_t no_os_axi_io_batch_exec(struct no_os_axi_io_batch *batch)
+{
+	int32_t ret = batch->err;
+
+	if (batch->nb_ops && !ret)
+		ret = no_os_axi_io_exec(batch->base, batch->ops, batch->nb_ops);
+	batch->nb_ops = 0;
+	batch->err = 0;
+
+	return ret;
+}
+
+/**
+ * @brief Record an operation, flushing the batch first if it is full.
+ * @param batch - The batch.
+ * @param type - Operation type.
+ * @param offset - Register offset.
+ * @param mask - Bits changed by an update.
+ * @param val - Value written.
+ * @param data - Where a read stores the register value.
+ */
+static inline void no_os_axi_io_batch_add(struct no_os_axi_io_batch *batch,
+		enum no_os_axi_io_op_type type,
+		uint32_t offset, uint32_t mask,
+		uint32_t val, uint32_t *data)
+{
+	struct no_os_axi_io_op *op;
+	int32_t ret;
+
+	if (batch->nb_ops == batch->size) {
+		ret = no_os_axi_io_batch_exec(batch);
+		if (ret)
+			batch->err = ret;
+	}
+	if (batch->err || !batch->size)
+		return;
+
+	op = &batch->ops[batch->nb_ops++];
+	op->type = type;
+	op->offset = offset;
+	op->mask = mask;
+	op->val = val;
+	op->data = data;
+}
+
+/* Record a register read, data is valid after the batch is executed */
+static inline void no_os_axi_io_batch_read(struct no_os_axi_io_batch *batch,
+		uint32_t offset, uint32_t *data)
+{
+	no_os_axi_io_batch_add(batch, NO_OS_AXI_IO_OP_READ, offset, 0, 0, data);
+}
+
+/* Record a register write */
+static inline void no_os_axi_io_batch_write(struct no_os_axi_io_batch *batch,
+		uint32_t offset, uint32_t val)
+{
+	no_os_axi_io_batch_add(batch, NO_OS_AXI_IO_OP_WRITE, offset, 0, val,
+			       NULL);
+}
+
+/* Record a read-modify-write of the bits in mask */
+static inline void no_os_axi_io_batch_update(struct no_os_axi_io_batch *batch,
+		uint32_t offset, uint32_t mask,
+		uint32_t val)
+{
+	no_os_axi_io_batch_add(batch, NO_OS_AXI_IO_OP_UPDATE, offset, mask, val,
+			       NULL);
+}
+
 #endif // _NO_OS_AXI_IO_H_
@@ -46,6 +46,7 @@
 /******************************************************************************/
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -81,6 +82,26 @@ struct no_os_circular_buffer {
 	struct no_os_cb_ptr	read;
 };
 
+/**
+ * @struct no_os_cb_region
+ * @brief Contiguous region of a circular buffer. A span that wraps around the
+ * end of the buffer is described by two regions.
+ */
+struct no_os_cb_region {
+	/** Address of the region */
+	void		*buff;
+	/** Size of the region in bytes */
+	uint32_t	size;
+};
+
+/**
+ * @struct no_os_cb_spsc
+ * @brief Lock-free circular buffer for one producer and one consumer
+ * (e.g. an interrupt handler and the main loop). The layout is private to
+ * no_os_circular_buffer.c, use the no_os_cb_spsc_* functions to access it.
+ */
+struct no_os_cb_spsc;
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -109,4 +130,43 @@ int32_t no_os_cb_prepare_async_read(struct no_os_circular_buffer *desc,
 				    uint32_t *raw_size_avilable);
 int32_t no_os_cb_end_async_read(struct no_os_circular_buffer *desc);
 
+/* Copy nb_scans elements of scan_size bytes with at most two memcpy calls */
+int32_t no_os_cb_write_scans(struct no_os_circular_buffer *desc,
+			     const void *data, uint32_t scan_size,
+			     uint32_t nb_scans);
+int32_t no_os_cb_read_scans(struct no_os_circular_buffer *desc, void *data,
+			    uint32_t scan_size, uint32_t nb_scans);
+
+/* Get both halves of a span without updating the buffer */
+int32_t no_os_cb_peek_write(struct no_os_circular_buffer *desc, uint32_t size,
+			    struct no_os_cb_region regions[2]);
+int32_t no_os_cb_advance_write(struct no_os_circular_buffer *desc,
+			       uint32_t size);
+int32_t no_os_cb_peek_read(struct no_os_circular_buffer *desc, uint32_t size,
+			   struct no_os_cb_region regions[2]);
+int32_t no_os_cb_advance_read(struct no_os_circular_buffer *desc,
+			      uint32_t size);
+
+/* Single producer single consumer variant */
+int32_t no_os_cb_spsc_init(struct no_os_cb_spsc **desc, uint32_t size);
+int32_t no_os_cb_spsc_remove(struct no_os_cb_spsc *desc);
+/* Bytes available to read. To be called by the consumer */
+uint32_t no_os_cb_spsc_size(struct no_os_cb_spsc *desc);
+/* Bytes available to write. To be called by the producer */
+uint32_t no_os_cb_spsc_space(struct no_os_cb_spsc *desc);
+
+int32_t no_os_cb_spsc_write(struct no_os_cb_spsc *desc, const void *data,
+			    uint32_t size);
+int32_t no_os_cb_spsc_read(struct no_os_cb_spsc *desc, void *data,
+			   uint32_t size);
+
+int32_t no_os_cb_spsc_prepare_write(struct no_os_cb_spsc *desc,
+				    uint32_t size_to_write, void **write_buff,
+				    uint32_t *size_available);
+int32_t no_os_cb_spsc_end_write(struct no_os_cb_spsc *desc, uint32_t size);
+int32_t no_os_cb_spsc_prepare_read(struct no_os_cb_spsc *desc,
+				   uint32_t size_to_read, void **read_buff,
+				   uint32_t *size_available);
+int32_t no_os_cb_spsc_end_read(struct no_os_cb_spsc *desc, uint32_t size);
+
 #endif //_NO_OS_CIRCULAR_BUFFER_H_
@@ -41,8 +41,10 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "no_os_crc_engine.h"
 
-#define NO_OS_CRC16_TABLE_SIZE 256
+/* One 256 entry table per slice, see NO_OS_CRC_SLICES */
+#define NO_OS_CRC16_TABLE_SIZE (NO_OS_CRC_ENGINE_TABLE_SIZE * NO_OS_CRC_SLICES)
 
 #define NO_OS_DECLARE_CRC16_TABLE(_table) \
 	static uint16_t _table[NO_OS_CRC16_TABLE_SIZE]
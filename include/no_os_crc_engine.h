@@ -0,0 +1,240 @@
+/***************************************************************************//**
+ *   @file   no_os_crc_engine.h
+ *   @brief  Header file of the generic sliced CRC engine.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef _NO_OS_CRC_ENGINE_H_
+#define _NO_OS_CRC_ENGINE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * Number of bytes processed per iteration: 1, 4 or 8. Each slice is one more
+ * 256 entry table, for the engine (1KB) and for the no_os_crc8/16/24() tables
+ * (256, 512 and 1024 bytes), so the default stays 1 and projects that compute
+ * CRCs over sample frames raise it with -DNO_OS_CRC_SLICES=4 in their
+ * Makefile (e.g. ad7606x-fmc). Long buffers are processed 2 to 3 times
+ * faster with 4 slices and 3 to 5 times faster with 8.
+ */
+#ifndef NO_OS_CRC_SLICES
+#define NO_OS_CRC_SLICES 1
+#endif
+
+#if NO_OS_CRC_SLICES != 1 && NO_OS_CRC_SLICES != 4 && NO_OS_CRC_SLICES != 8
+#error "NO_OS_CRC_SLICES must be 1, 4 or 8"
+#endif
+
+#define NO_OS_CRC_ENGINE_TABLE_SIZE 256
+
+#define NO_OS_DECLARE_CRC_ENGINE(_engine) \
+	static struct no_os_crc_engine _engine
+
+/**
+ * @struct no_os_crc_engine
+ * @brief Lookup tables for a CRC of up to 32 bits.
+ */
+struct no_os_crc_engine {
+	/** Number of bits of the CRC */
+	uint8_t width;
+	/** Data is processed lsb first (e.g. CRC-32) */
+	bool reflected;
+	/** table[k][n] is the CRC of byte n followed by k zero bytes */
+	uint32_t table[NO_OS_CRC_SLICES][NO_OS_CRC_ENGINE_TABLE_SIZE];
+};
+
+int no_os_crc_engine_init(struct no_os_crc_engine *engine, uint8_t width,
+			  uint32_t polynomial, bool reflected);
+uint32_t no_os_crc_engine_compute(const struct no_os_crc_engine *engine,
+				  const uint8_t *pdata, size_t nbytes,
+				  uint32_t crc);
+
+/*
+ * Msb first table helpers shared by the engine and no_os_crc8/16/24(). The
+ * tables hold NO_OS_CRC_SLICES slices of 256 entries of entry_size bytes and
+ * the CRC is width bits wide, right aligned. They are inline so that each
+ * caller gets a copy specialized for its constant entry_size and width.
+ */
+
+static inline uint32_t no_os_crc_table_get(const void *table,
+		uint8_t entry_size, uint32_t slice,
+		uint32_t idx)
+{
+	idx += slice * NO_OS_CRC_ENGINE_TABLE_SIZE;
+
+	switch (entry_size) {
+	case 1:
+		return ((const uint8_t *)table)[idx];
+	case 2:
+		return ((const uint16_t *)table)[idx];
+	default:
+		return ((const uint32_t *)table)[idx];
+	}
+}
+
+static inline void no_os_crc_table_set(void *table, uint8_t entry_size,
+				       uint32_t slice, uint32_t idx,
+				       uint32_t val)
+{
+	idx += slice * NO_OS_CRC_ENGINE_TABLE_SIZE;
+
+	switch (entry_size) {
+	case 1:
+		((uint8_t *)table)[idx] = val;
+		break;
+	case 2:
+		((uint16_t *)table)[idx] = val;
+		break;
+	default:
+		((uint32_t *)table)[idx] = val;
+		break;
+	}
+}
+
+static inline uint32_t no_os_crc_table_be32(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+	       ((uint32_t)p[2] << 8) | p[3];
+}
+
+/***************************************************************************//**
+ * @brief Creates the lookup tables of a msb first CRC.
+ *
+ * @param table      - Tables to write, NO_OS_CRC_SLICES * 256 entries.
+ * @param entry_size - Size of a table entry in bytes: 1, 2 or 4.
+ * @param width      - Number of bits of the CRC, from 8 to 32.
+ * @param polynomial - Msb-first representation of the polynomial, without the
+ *                     x^width term.
+ *
+ * @return None.
+*******************************************************************************/
+static inline void no_os_crc_table_populate_msb(void *table, uint8_t entry_size,
+		uint8_t width,
+		uint32_t polynomial)
+{
+	uint32_t mask = 0xffffffff >> (32 - width);
+	uint32_t top = (uint32_t)1 << (width - 1);
+	uint32_t crc, n, k;
+	uint8_t bit;
+
+	for (n = 0; n < NO_OS_CRC_ENGINE_TABLE_SIZE; n++) {
+		crc = n << (width - 8);
+		for (bit = 0; bit < 8; bit++)
+			crc = (crc & top) ? (crc << 1) ^ polynomial : crc << 1;
+		no_os_crc_table_set(table, entry_size, 0, n, crc & mask);
+	}
+
+	for (k = 1; k < NO_OS_CRC_SLICES; k++) {
+		for (n = 0; n < NO_OS_CRC_ENGINE_TABLE_SIZE; n++) {
+			crc = no_os_crc_table_get(table, entry_size, k - 1, n);
+			crc = (crc << 8) ^ no_os_crc_table_get(table, entry_size,
+					0, crc >> (width - 8));
+			no_os_crc_table_set(table, entry_size, k, n, crc & mask);
+		}
+	}
+}
+
+/***************************************************************************//**
+ * @brief Computes a msb first CRC with tables from
+ * no_os_crc_table_populate_msb().
+ *
+ * @param table      - Lookup tables.
+ * @param entry_size - Size of a table entry in bytes: 1, 2 or 4.
+ * @param width      - Number of bits of the CRC, from 8 to 32.
+ * @param pdata      - Pointer to data buffer.
+ * @param nbytes     - Number of bytes to compute the CRC over.
+ * @param crc        - Initial value for the CRC computation.
+ *
+ * @return crc       - Computed CRC value.
+*******************************************************************************/
+static inline uint32_t no_os_crc_table_compute_msb(const void *table,
+		uint8_t entry_size,
+		uint8_t width,
+		const uint8_t *pdata,
+		size_t nbytes, uint32_t crc)
+{
+	uint32_t mask = 0xffffffff >> (32 - width);
+#if NO_OS_CRC_SLICES >= 4
+	uint32_t next;
+#endif
+#if NO_OS_CRC_SLICES == 8
+	uint32_t word;
+#endif
+
+	crc &= mask;
+
+#if NO_OS_CRC_SLICES == 8
+	while (nbytes >= 8) {
+		next = (crc << (32 - width)) ^ no_os_crc_table_be32(pdata);
+		word = no_os_crc_table_be32(pdata + 4);
+		crc = no_os_crc_table_get(table, entry_size, 7, next >> 24) ^
+		      no_os_crc_table_get(table, entry_size, 6,
+					  (next >> 16) & 0xff) ^
+		      no_os_crc_table_get(table, entry_size, 5,
+					  (next >> 8) & 0xff) ^
+		      no_os_crc_table_get(table, entry_size, 4, next & 0xff) ^
+		      no_os_crc_table_get(table, entry_size, 3, word >> 24) ^
+		      no_os_crc_table_get(table, entry_size, 2,
+					  (word >> 16) & 0xff) ^
+		      no_os_crc_table_get(table, entry_size, 1,
+					  (word >> 8) & 0xff) ^
+		      no_os_crc_table_get(table, entry_size, 0, word & 0xff);
+		pdata += 8;
+		nbytes -= 8;
+	}
+#endif
+#if NO_OS_CRC_SLICES >= 4
+	while (nbytes >= 4) {
+		next = (crc << (32 - width)) ^ no_os_crc_table_be32(pdata);
+		crc = no_os_crc_table_get(table, entry_size, 3, next >> 24) ^
+		      no_os_crc_table_get(table, entry_size, 2,
+					  (next >> 16) & 0xff) ^
+		      no_os_crc_table_get(table, entry_size, 1,
+					  (next >> 8) & 0xff) ^
+		      no_os_crc_table_get(table, entry_size, 0, next & 0xff);
+		pdata += 4;
+		nbytes -= 4;
+	}
+#endif
+	while (nbytes--)
+		crc = ((crc << 8) ^ no_os_crc_table_get(table, entry_size, 0,
+				((crc >> (width - 8)) ^ *pdata++) & 0xff)) & mask;
+
+	return crc;
+}
+
+#endif // _NO_OS_CRC_ENGINE_H_
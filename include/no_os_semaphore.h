@@ -39,15 +39,23 @@
 #ifndef _NO_OS_SEMAPHORE_H_
 #define _NO_OS_SEMAPHORE_H_
 
+#include <stdint.h>
+
 /* Initialize semaphore */
 void no_os_semaphore_init(void **semaphore);
 
 /* Take token from semaphore */
 void no_os_semaphore_take(void *semaphore);
 
+/* Take token from semaphore, waiting at most timeout_ms */
+int no_os_semaphore_take_timeout(void *semaphore, uint32_t timeout_ms);
+
 /* Give token to semaphore */
 void no_os_semaphore_give(void *semaphore);
 
+/* Give token to semaphore from an interrupt handler */
+void no_os_semaphore_give_from_isr(void *semaphore);
+
 /* Remove semaphore */
 void no_os_semaphore_remove(void *semaphore);
 
@@ -108,6 +108,7 @@ enum no_os_uart_stop {
  * specific function
  */
 struct no_os_uart_platform_ops ;
+struct no_os_cb_spsc;
 
 /**
  * @struct no_os_uart_init_param
@@ -146,6 +147,11 @@ struct no_os_uart_desc {
 	uint32_t	irq_id;
 	/** Software FIFO. */
 	struct lf256fifo *rx_fifo;
+	/**
+	 * Receive ring filled by interrupts, DMA or a reader thread. If set
+	 * (or if rx_fifo is set), read returns the bytes received so far.
+	 */
+	struct no_os_cb_spsc *rx_ring;
 	/** UART Baud Rate */
 	uint32_t 	baud_rate;
 	const struct no_os_uart_platform_ops *platform_ops;
@@ -137,12 +137,14 @@ static int32_t linux_socket_send(void *desc, uint32_t sock_id,
 {
 	int32_t ret;
 
-	ret = send(sock_id, data, size, 0);
+	/* Don't raise SIGPIPE if the peer closed the connection */
+	ret = send(sock_id, data, size, MSG_NOSIGNAL);
 
 	if(ret < 0)
 		return -errno;
 
-	return size;
+	/* The socket is non-blocking, only part of data may be sent */
+	return ret;
 }
 
 /** @brief See \ref network_interface.socket_recv */
@@ -254,12 +256,16 @@ static int32_t linux_socket_accept(void *desc, uint32_t sock_id,
 				   uint32_t *client_socket_id)
 {
 	int32_t ret;
+	int one = 1;
 
 	ret = accept4(sock_id, NULL, NULL, SOCK_NONBLOCK);
 
 	if(ret < 0)
 		return -errno;
 
+	/* Replies are sent in several small writes, don't delay them */
+	setsockopt(ret, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
 	*client_socket_id = ret;
 
 	return 0;
@@ -84,6 +84,7 @@ INCS += $(INCLUDE)/no_os_delay.h     \
 		$(INCLUDE)/no_os_alloc.h \
 		$(INCLUDE)/no_os_crc8.h \
 		$(INCLUDE)/no_os_crc16.h \
+		$(INCLUDE)/no_os_crc_engine.h \
 		$(INCLUDE)/no_os_init.h \
 		$(INCLUDE)/no_os_mutex.h
 
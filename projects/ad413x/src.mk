@@ -42,6 +42,7 @@ INCS += $(INCLUDE)/no_os_spi.h \
 	$(INCLUDE)/no_os_print_log.h \
 	$(INCLUDE)/no_os_list.h \
 	$(INCLUDE)/no_os_crc8.h \
+	$(INCLUDE)/no_os_crc_engine.h \
 	$(INCLUDE)/no_os_alloc.h \
 	$(INCLUDE)/no_os_mutex.h
 
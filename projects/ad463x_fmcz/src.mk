@@ -46,6 +46,7 @@ INCS +=	$(INCLUDE)/no_os_axi_io.h \
 	$(INCLUDE)/no_os_pwm.h \
 	$(INCLUDE)/no_os_timer.h \
 	$(INCLUDE)/no_os_circular_buffer.h \
+	$(INCLUDE)/no_os_atomic.h \
 	$(INCLUDE)/no_os_print_log.h \
 	$(INCLUDE)/no_os_list.h \
 	$(INCLUDE)/no_os_lf256fifo.h \
@@ -53,11 +54,13 @@ INCS +=	$(INCLUDE)/no_os_axi_io.h \
 	$(INCLUDE)/no_os_fifo.h
 
 SRCS +=	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.c \
+	$(NO-OS)/util/no_os_semaphore.c \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine.c \
 	$(DRIVERS)/axi_core/axi_pwmgen/axi_pwm.c \
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.c
 
 INCS += $(DRIVERS)/axi_core/axi_dmac/axi_dmac.h \
+	$(INCLUDE)/no_os_semaphore.h \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine.h \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine_private.h \
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.h \
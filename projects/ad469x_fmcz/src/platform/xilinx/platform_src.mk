@@ -11,6 +11,7 @@ SRCS += $(NO-OS)/util/no_os_circular_buffer.c \
 	$(PLATFORM_DRIVERS)/xilinx_timer.c
 
 INCS += $(INCLUDE)/no_os_circular_buffer.h \
+	$(INCLUDE)/no_os_atomic.h \
 	$(INCLUDE)/no_os_timer.h           \
 	$(PLATFORM_DRIVERS)/xilinx_timer.h  \
 	$(PLATFORM_DRIVERS)/rtc_extra.h
@@ -30,11 +31,13 @@ INCS += $(INCLUDE)/no_os_rtc.h          \
 	$(PLATFORM_DRIVERS)/$(PLATFORM)_gpio.h
 
 SRCS +=	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.c \
+	$(NO-OS)/util/no_os_semaphore.c \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine.c \
 	$(DRIVERS)/axi_core/axi_pwmgen/axi_pwm.c \
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.c \
 
 INCS += $(DRIVERS)/axi_core/axi_dmac/axi_dmac.h \
+	$(INCLUDE)/no_os_semaphore.h \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine.h \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine_private.h \
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.h \
@@ -15,6 +15,7 @@ SRCS += $(PROJECT)/src/ad5766_core.c \
 	$(DRIVERS)/api/no_os_spi.c \
 	$(DRIVERS)/api/no_os_gpio.c \
 	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.c \
+	$(NO-OS)/util/no_os_semaphore.c \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine.c \
 	$(NO-OS)/util/no_os_util.c \
 	$(NO-OS)/util/no_os_alloc.c \
@@ -27,6 +28,7 @@ INCS += $(PROJECT)/src/parameters.h \
 	$(PROJECT)/src/ad5766_core.h \
 	$(DRIVERS)/dac/ad5766/ad5766.h \
 	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.h \
+	$(INCLUDE)/no_os_semaphore.h \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine.h \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine_private.h
 INCS +=	$(PLATFORM_DRIVERS)/$(PLATFORM)_spi.h \
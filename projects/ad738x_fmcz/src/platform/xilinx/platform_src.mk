@@ -7,11 +7,13 @@ SRCS +=	$(PLATFORM_DRIVERS)/xilinx_axi_io.c \
 	$(PLATFORM_DRIVERS)/xilinx_gpio.c
 
 SRCS +=	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.c \
+	$(NO-OS)/util/no_os_semaphore.c \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine.c \
 	$(DRIVERS)/axi_core/axi_pwmgen/axi_pwm.c \
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.c
 
 INCS += $(DRIVERS)/axi_core/axi_dmac/axi_dmac.h \
+	$(INCLUDE)/no_os_semaphore.h \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine.h \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine_private.h \
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.h \
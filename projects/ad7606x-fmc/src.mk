@@ -45,6 +45,7 @@ INCS += $(INCLUDE)/no_os_delay.h     \
         $(INCLUDE)/no_os_crc8.h      \
         $(INCLUDE)/no_os_crc16.h     \
         $(INCLUDE)/no_os_crc24.h     \
+        $(INCLUDE)/no_os_crc_engine.h     \
         $(INCLUDE)/no_os_print_log.h
 
 INCS += $(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.h \
@@ -52,12 +53,14 @@ INCS += $(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.h \
         $(DRIVERS)/axi_core/axi_pwmgen/axi_pwm_extra.h \
         $(DRIVERS)/axi_core/spi_engine/spi_engine.h \
         $(DRIVERS)/axi_core/spi_engine/spi_engine_private.h \
-        $(DRIVERS)/axi_core/axi_dmac/axi_dmac.h
+        $(DRIVERS)/axi_core/axi_dmac/axi_dmac.h \
+	$(INCLUDE)/no_os_semaphore.h
 
 SRCS += $(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.c \
         $(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.c \
         $(DRIVERS)/axi_core/axi_pwmgen/axi_pwm.c \
         $(DRIVERS)/axi_core/axi_dmac/axi_dmac.c \
+	$(NO-OS)/util/no_os_semaphore.c \
         $(DRIVERS)/axi_core/spi_engine/spi_engine.c \
         $(DRIVERS)/api/no_os_spi.c \
         $(DRIVERS)/api/no_os_pwm.c
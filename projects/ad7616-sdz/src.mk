@@ -16,6 +16,7 @@ SRCS += $(DRIVERS)/adc/ad7616/ad7616.c \
 	$(DRIVERS)/api/no_os_pwm.c \
 	$(DRIVERS)/axi_core/axi_pwmgen/axi_pwm.c \
 	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.c \
+	$(NO-OS)/util/no_os_semaphore.c \
 	$(DRIVERS)/axi_core/axi_pwmgen/axi_pwm.c \
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.c \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine.c \
@@ -29,6 +30,7 @@ SRCS +=	$(PLATFORM_DRIVERS)/xilinx_axi_io.c \
 INCS += $(PROJECT)/src/parameters.h \
 	$(DRIVERS)/adc/ad7616/ad7616.h \
 	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.h \
+	$(INCLUDE)/no_os_semaphore.h \
 	$(DRIVERS)/axi_core/axi_pwmgen/axi_pwm_extra.h \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine.h \
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.h \
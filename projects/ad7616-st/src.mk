@@ -27,9 +27,11 @@ INCS += $(INCLUDE)/no_os_delay.h     \
 		$(INCLUDE)/no_os_units.h \
 		$(INCLUDE)/no_os_init.h \
 		$(INCLUDE)/no_os_crc8.h \
+		$(INCLUDE)/no_os_crc_engine.h \
 		$(INCLUDE)/no_os_alloc.h \
 		$(INCLUDE)/no_os_mutex.h \
-		$(INCLUDE)/no_os_circular_buffer.h
+		$(INCLUDE)/no_os_circular_buffer.h \
+		$(INCLUDE)/no_os_atomic.h
 
 SRCS += $(DRIVERS)/api/no_os_gpio.c \
 		$(DRIVERS)/api/no_os_i2c.c  \
@@ -16,6 +16,7 @@ SRCS += $(PROJECT)/src/ad77681evb.c
 SRCS += $(DRIVERS)/api/no_os_spi.c \
 	$(DRIVERS)/adc/ad7768-1/ad77681.c \
 	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.c \
+	$(NO-OS)/util/no_os_semaphore.c \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine.c \
 	$(NO-OS)/util/no_os_util.c \
 	$(NO-OS)/util/no_os_alloc.c \
@@ -27,6 +28,7 @@ SRCS +=	$(PLATFORM_DRIVERS)/xilinx_axi_io.c \
 INCS += $(PROJECT)/src/parameters.h
 INCS += $(DRIVERS)/adc/ad7768-1/ad77681.h \
 	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.h \
+	$(INCLUDE)/no_os_semaphore.h \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine.h \
 	$(DRIVERS)/axi_core/spi_engine/spi_engine_private.h
 INCS +=	$(PLATFORM_DRIVERS)/$(PLATFORM)_spi.h \
@@ -41,6 +41,8 @@ INCS += $(PROJECT)/src/parameters.h \
 SRC_DIRS += $(PLATFORM_DRIVERS)
 SRC_DIRS += $(DRIVERS)/adc/ad7768
 SRC_DIRS += $(DRIVERS)/axi_core/axi_dmac
+SRCS += $(NO-OS)/util/no_os_semaphore.c
+INCS += $(INCLUDE)/no_os_semaphore.h
 SRC_DIRS += $(DRIVERS)/axi_core/axi_adc_core
 
 # Add to LIBRARIES the libraries that need to be linked in the build
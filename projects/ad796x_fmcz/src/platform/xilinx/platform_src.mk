@@ -11,6 +11,7 @@ SRCS += $(NO-OS)/util/no_os_circular_buffer.c \
 	$(PLATFORM_DRIVERS)/xilinx_timer.c
 
 INCS += $(INCLUDE)/no_os_circular_buffer.h \
+	$(INCLUDE)/no_os_atomic.h \
 	$(INCLUDE)/no_os_timer.h           \
 	$(PLATFORM_DRIVERS)/xilinx_timer.h  \
 	$(PLATFORM_DRIVERS)/rtc_extra.h
@@ -15,6 +15,9 @@ SRC_DIRS += $(PROJECT)/src \
 		$(DRIVERS)/axi_core/axi_dmac \
 		$(DRIVERS)/axi_core/clk_axi_clkgen
 
+SRCS += $(NO-OS)/util/no_os_semaphore.c
+INCS += $(INCLUDE)/no_os_semaphore.h
+
 ifeq (y,$(strip $(IIOD)))
 SRC_DIRS += $(DRIVERS)/axi_core/iio_axi_adc \
 	    $(DRIVERS)/api/no_os_irq.c \
@@ -17,6 +17,7 @@ endif
 SRCS += $(DRIVERS)/adc/ad9265/ad9265.c \
 	$(DRIVERS)/api/no_os_spi.c \
 	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.c \
+	$(NO-OS)/util/no_os_semaphore.c \
 	$(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.c \
 	$(NO-OS)/util/no_os_util.c \
 	$(NO-OS)/util/no_os_alloc.c \
@@ -37,7 +38,8 @@ SRCS +=	$(PLATFORM_DRIVERS)/xilinx_axi_io.c \
 INCS += $(PROJECT)/src/parameters.h \
 	$(DRIVERS)/adc/ad9265/ad9265.h \
 	$(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.h \
-	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.h
+	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.h \
+	$(INCLUDE)/no_os_semaphore.h
 INCS +=	$(PLATFORM_DRIVERS)/$(PLATFORM)_spi.h
 INCS +=	$(INCLUDE)/no_os_axi_io.h \
 	$(INCLUDE)/no_os_spi.h \
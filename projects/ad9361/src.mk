@@ -27,9 +27,12 @@ SRCS +=	$(PLATFORM_DRIVERS)/$(PLATFORM)_axi_io.c
 SRCS +=	$(PLATFORM_DRIVERS)/$(PLATFORM)_spi.c \
 	$(PLATFORM_DRIVERS)/$(PLATFORM)_gpio.c
 ifeq (linux,$(strip $(PLATFORM)))
-SRCS +=	$(PLATFORM_DRIVERS)/linux_delay.c
+SRCS +=	$(PLATFORM_DRIVERS)/linux_delay.c \
+	$(PLATFORM_DRIVERS)/linux_semaphore.c
+LDFLAGS += -pthread
 else
-SRCS +=	$(PLATFORM_DRIVERS)/$(PLATFORM)_delay.c
+SRCS +=	$(PLATFORM_DRIVERS)/$(PLATFORM)_delay.c \
+	$(NO-OS)/util/no_os_semaphore.c
 endif
 ifeq (y,$(strip $(IIOD)))
 LIBRARIES += iio
@@ -64,11 +67,14 @@ INCS += $(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.h \
 	$(DRIVERS)/axi_core/axi_dac_core/axi_dac_core.h \
 	$(INCLUDE)/no_os_irq.h \
 	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.h \
+	$(INCLUDE)/no_os_semaphore.h \
 	$(DRIVERS)/axi_core/axi_sysid/axi_sysid.h
 ifeq (linux,$(strip $(PLATFORM)))
 CFLAGS += -DPLATFORM_MB
 INCS +=	$(PLATFORM_DRIVERS)/linux_spi.h \
 	$(PLATFORM_DRIVERS)/linux_gpio.h \
+	$(PLATFORM_DRIVERS)/linux_axi_io.h \
+	$(PLATFORM_DRIVERS)/linux_semaphore.h \
 	$(INCLUDE)/no_os_lf256fifo.h \
 	$(PLATFORM_DRIVERS)/linux_uart.h
 endif
@@ -98,7 +104,8 @@ INCS += $(INCLUDE)/no_os_fifo.h \
 	$(DRIVERS)/axi_core/iio_axi_adc/iio_axi_adc.h \
 	$(DRIVERS)/axi_core/iio_axi_dac/iio_axi_dac.h \
 	$(NO-OS)/iio/iio_app/iio_app.h \
-	$(INCLUDE)/no_os_circular_buffer.h
+	$(INCLUDE)/no_os_circular_buffer.h \
+	$(INCLUDE)/no_os_atomic.h
 
 SRCS += $(DRIVERS)/api/no_os_uart.c
 endif
@@ -458,6 +458,8 @@ AD9361_InitParam default_init_param = {
 	&rx_adc_init,	// *rx_adc_init
 	&tx_dac_init,   // *tx_dac_init
 #endif
+	/* Register cache */
+	AD9361_REGCACHE_NONE,		// regcache_mode
 };
 
 AD9361_RXFIRConfig rx_fir_config = {	// BPF PASSBAND 3/20 fs to 1/4 fs
@@ -937,7 +939,11 @@ int main(void)
 		.rx_dmac = rx_dmac,
 #ifndef PLATFORM_MB
 		.dcache_invalidate_range = (void (*)(uint32_t,
-						     uint32_t))Xil_DCacheInvalidateRange
+						     uint32_t))Xil_DCacheInvalidateRange,
+#endif
+#ifdef DMA_IRQ_ENABLE
+		/* Capture continuously, the DMAC ISR refills the ring */
+		.stream_blocks = 4,
 #endif
 	};
 
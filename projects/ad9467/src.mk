@@ -18,6 +18,7 @@ SRC_DIRS += $(NO-OS)/iio/iio_app
 endif
 SRCS += $(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.c \
 	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.c \
+	$(NO-OS)/util/no_os_semaphore.c \
 	$(DRIVERS)/adc/ad9467/ad9467.c \
 	$(DRIVERS)/frequency/ad9517/ad9517.c \
 	$(DRIVERS)/api/no_os_spi.c \
@@ -41,6 +42,7 @@ INCS +=	$(PROJECT)/src/app/app_config.h \
 	$(PROJECT)/src/devices/adi_hal/parameters.h
 INCS += $(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.h \
 	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.h \
+	$(INCLUDE)/no_os_semaphore.h \
 	$(DRIVERS)/adc/ad9467/ad9467.h \
 	$(DRIVERS)/frequency/ad9517/ad9517.h
 INCS +=	$(PLATFORM_DRIVERS)/$(PLATFORM)_spi.h
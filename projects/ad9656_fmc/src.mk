@@ -18,6 +18,7 @@ SRC_DIRS += $(NO-OS)/iio/iio_app
 endif
 SRCS += $(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.c \
         $(DRIVERS)/axi_core/axi_dmac/axi_dmac.c \
+	$(NO-OS)/util/no_os_semaphore.c \
         $(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.c \
         $(DRIVERS)/axi_core/jesd204/axi_adxcvr.c \
         $(DRIVERS)/axi_core/jesd204/axi_jesd204_rx.c \
@@ -51,6 +52,7 @@ INCS +=	$(PROJECT)/src/app/app_config.h \
         $(PROJECT)/src/devices/adi_hal/parameters.h
 INCS += $(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.h \
         $(DRIVERS)/axi_core/axi_dmac/axi_dmac.h \
+	$(INCLUDE)/no_os_semaphore.h \
         $(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.h \
         $(DRIVERS)/axi_core/jesd204/axi_adxcvr.h \
         $(DRIVERS)/axi_core/jesd204/axi_jesd204_rx.h \
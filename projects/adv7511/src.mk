@@ -17,6 +17,7 @@ SRCS += $(PROJECT)/src/main.c \
 	$(PROJECT)/src/transmitter.c \
 	$(PROJECT)/src/wrapper.c
 SRCS += $(DRIVERS)/axi_core/axi_dmac/axi_dmac.c \
+	$(NO-OS)/util/no_os_semaphore.c \
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.c \
 	$(DRIVERS)/api/no_os_i2c.c \
 	$(DRIVERS)/api/no_os_gpio.c \
@@ -49,6 +50,7 @@ INCS +=	$(PROJECT)/src/app_config.h \
 	$(PROJECT)/src/transmitter_defs.h \
 	$(PROJECT)/src/wrapper.h
 INCS += $(DRIVERS)/axi_core/axi_dmac/axi_dmac.h \
+	$(INCLUDE)/no_os_semaphore.h \
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.h
 INCS +=	$(PLATFORM_DRIVERS)/$(PLATFORM)_spi.h \
 	$(PLATFORM_DRIVERS)/$(PLATFORM)_gpio.h \
@@ -18,6 +18,7 @@ INCS += $(INCLUDE)/no_os_alloc.h		\
 	$(INCLUDE)/no_os_alloc.h \
 	$(INCLUDE)/no_os_crc8.h \
 	$(INCLUDE)/no_os_crc16.h \
+	$(INCLUDE)/no_os_crc_engine.h \
 	$(INCLUDE)/no_os_uart.h			\
 	$(INCLUDE)/no_os_pwm.h			\
 	$(INCLUDE)/no_os_dma.h \
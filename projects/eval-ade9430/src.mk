@@ -19,6 +19,7 @@ INCS += $(INCLUDE)/no_os_delay.h     \
 	$(INCLUDE)/no_os_alloc.h \
 	$(INCLUDE)/no_os_mutex.h \
 	$(INCLUDE)/no_os_circular_buffer.h \
+	$(INCLUDE)/no_os_atomic.h \
 	$(INCLUDE)/no_os_trng.h \
 	$(INCLUDE)/no_os_rtc.h \
 	$(DRIVERS)/rtc/pcf85263/pcf85263.h \
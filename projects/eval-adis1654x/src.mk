@@ -26,6 +26,7 @@ INCS += $(INCLUDE)/no_os_delay.h             \
 		$(INCLUDE)/no_os_util.h      \
 		$(INCLUDE)/no_os_units.h     \
 		$(INCLUDE)/no_os_crc8.h      \
+		$(INCLUDE)/no_os_crc_engine.h      \
 		$(INCLUDE)/no_os_alloc.h     \
         	$(INCLUDE)/no_os_mutex.h
 
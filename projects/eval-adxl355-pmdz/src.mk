@@ -47,6 +47,7 @@ SRCS += $(DRIVERS)/accel/adxl355/adxl355.c
 
 ifdef IIO_LWIP_EXAMPLE
 INCS += $(INCLUDE)/no_os_crc8.h
+INCS += $(INCLUDE)/no_os_crc_engine.h
 INCS += $(DRIVERS)/net/adin1110/adin1110.h
 INCS += $(NO-OS)/network/lwip_raw_socket/netdevs/adin1110/lwip_adin1110.h
 SRCS += $(NO-OS)/network/lwip_raw_socket/netdevs/adin1110/lwip_adin1110.c
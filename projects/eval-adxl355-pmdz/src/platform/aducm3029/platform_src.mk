@@ -4,6 +4,7 @@ SRC_DIRS += $(NO-OS)/network
 
 SRCS	 += $(NO-OS)/util/no_os_circular_buffer.c
 INCS	 += $(INCLUDE)/no_os_circular_buffer.h
+INCS	 += $(INCLUDE)/no_os_atomic.h
 endif
 SRC_DIRS += $(PLATFORM_DRIVERS)
 SRC_DIRS += $(INCLUDE)
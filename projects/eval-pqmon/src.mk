@@ -56,6 +56,7 @@ EXTRA_MATH_PQM = ${PQLIB_PATH}/libadi_pqlib_cm4_gcc.a
 endif
 
 INCS += $(INCLUDE)/no_os_crc8.h
+INCS += $(INCLUDE)/no_os_crc_engine.h
 SRCS += $(NO-OS)/util/no_os_crc8.c
 
 INCS += $(INCLUDE)/no_os_list.h \
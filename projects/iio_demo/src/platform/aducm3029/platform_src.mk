@@ -10,6 +10,7 @@ SRCS += $(NO-OS)/util/no_os_circular_buffer.c \
 	$(DRIVERS)/api/no_os_timer.c
 	
 INCS += $(INCLUDE)/no_os_circular_buffer.h \
+	$(INCLUDE)/no_os_atomic.h \
 	$(INCLUDE)/no_os_timer.h           \
 	$(PLATFORM_DRIVERS)/aducm3029_timer.h  \
 	$(PLATFORM_DRIVERS)/aducm3029_rtc.h
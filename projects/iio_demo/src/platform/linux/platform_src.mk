@@ -14,6 +14,7 @@ INCS += $(NO-OS)/network/linux_socket/linux_socket.h \
 
 SRCS += $(NO-OS)/util/no_os_circular_buffer.c
 INCS += $(INCLUDE)/no_os_circular_buffer.h
+INCS += $(INCLUDE)/no_os_atomic.h
 
 SRCS += $(DRIVERS)/platform/linux/linux_uart.c \
 	$(DRIVERS)/platform/linux/linux_delay.c
@@ -27,7 +27,8 @@ INCS += $(INCLUDE)/no_os_delay.h     		\
 		$(INCLUDE)/no_os_units.h        \
 		$(INCLUDE)/no_os_alloc.h        \
                 $(INCLUDE)/no_os_mutex.h	\
-		$(INCLUDE)/no_os_crc8.h	
+		$(INCLUDE)/no_os_crc8.h \
+		$(INCLUDE)/no_os_crc_engine.h
 
 SRCS += $(NO-OS)/util/no_os_lf256fifo.c 	\
 		$(DRIVERS)/api/no_os_i2c.c  	\
@@ -41,6 +41,7 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include "common_data.h"
+#include "no_os_irq.h"
 #include "no_os_pwm.h"
 #include "no_os_spi.h"
 #include "no_os_uart.h"
@@ -74,8 +75,19 @@ struct no_os_spi_init_param pulsar_adc_spi_init = {
 struct spi_engine_offload_init_param spi_engine_offload_init_param = {
 	.offload_config = OFFLOAD_RX_EN,
 	.rx_dma_baseaddr = DMA_BASEADDR,
+#ifdef DMA_IRQ_ID
+	.irq_option = IRQ_ENABLED,
+#endif
 };
 
+#ifdef DMA_IRQ_ID
+struct no_os_irq_init_param pulsar_adc_irq_ip = {
+	.irq_ctrl_id = INTC_DEVICE_ID,
+	.platform_ops = IRQ_OPS,
+	.extra = IRQ_EXTRA,
+};
+#endif
+
 struct axi_clkgen_init clkgen_init = {
 	.name = "rx_clkgen",
 	.base = RX_CLKGEN_BASEADDR,
@@ -108,6 +120,10 @@ struct pulsar_adc_init_param pulsar_adc_init_param = {
 	.reg_access_speed = 1000000,
 	.offload_init_param = &spi_engine_offload_init_param,
 	.dcache_invalidate_range = DCACHE_INVALIDATE,
+#ifdef DMA_IRQ_ID
+	/* Capture continuously, the DMAC ISR refills the ring */
+	.stream_blocks = 4,
+#endif
 #else
 	.gpio_cnv = &gpio_cnv,
 #endif
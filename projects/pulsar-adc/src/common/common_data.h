@@ -44,6 +44,7 @@
 /******************************************************************************/
 #include "platform_includes.h"
 #include "pulsar_adc.h"
+#include "no_os_irq.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -56,4 +57,7 @@ extern struct no_os_uart_init_param pulsar_adc_uart_ip;
 #ifndef USE_STANDARD_SPI
 extern struct spi_engine_offload_init_param spi_engine_offload_init_param;
 #endif
+#ifdef DMA_IRQ_ID
+extern struct no_os_irq_init_param pulsar_adc_irq_ip;
+#endif
 #endif /* __COMMON_DATA_H__ */
@@ -49,6 +49,7 @@
 #include "iio_pulsar_adc.h"
 #include "no_os_util.h"
 #include "no_os_gpio.h"
+#include "no_os_irq.h"
 #include "no_os_print_log.h"
 #include "iio_app.h"
 
@@ -83,6 +84,38 @@ int iio_example_main()
 	if (ret)
 		return ret;
 
+#ifdef DMA_IRQ_ID
+	struct no_os_irq_ctrl_desc *irq_desc;
+	struct no_os_callback_desc dma_callback = {
+		.ctx = dev->pulsar_adc_dev->spi_desc,
+		.callback = spi_engine_offload_rx_isr,
+	};
+
+	/* The continuous capture ring is refilled from the DMAC interrupt */
+	ret = no_os_irq_ctrl_init(&irq_desc, &pulsar_adc_irq_ip);
+	if (ret)
+		goto error_iio;
+
+	ret = no_os_irq_global_enable(irq_desc);
+	if (ret)
+		goto error_irq;
+
+	ret = no_os_irq_register_callback(irq_desc, DMA_IRQ_ID, &dma_callback);
+	if (ret)
+		goto error_irq;
+
+	ret = no_os_irq_trigger_level_set(irq_desc, DMA_IRQ_ID,
+					  NO_OS_IRQ_LEVEL_HIGH);
+	if (ret)
+		goto error_irq;
+
+	ret = no_os_irq_enable(irq_desc, DMA_IRQ_ID);
+	if (ret)
+		goto error_irq;
+
+	app_init_param.irq_desc = irq_desc;
+#endif
+
 	struct iio_app_device iio_devices[] = {
 		IIO_APP_DEVICE( "pulsar_adc", dev,
 				dev->iio_dev, &adc_buff, NULL, NULL)
@@ -95,8 +128,7 @@ int iio_example_main()
 	ret = iio_app_init(&app, app_init_param);
 	if (ret) {
 		pr_info("Error: iio_app_init: %d\n", ret);
-		pulsar_adc_iio_remove(dev);
-		return ret;
+		goto error_irq;
 	}
 
 	ret = iio_app_run(app);
@@ -105,6 +137,11 @@ int iio_example_main()
 
 	iio_app_remove(app);
 
+error_irq:
+#ifdef DMA_IRQ_ID
+	no_os_irq_ctrl_remove(irq_desc);
+error_iio:
+#endif
 	pulsar_adc_iio_remove(dev);
 
 	return ret;
@@ -51,6 +51,14 @@ struct xil_uart_init_param uart_extra_ip = {
 #endif
 };
 
+struct xil_irq_init_param xil_irq_init_par = {
+#ifdef _XPARAMETERS_PS_H_
+	.type = IRQ_PS,
+#else
+	.type = IRQ_PL,
+#endif
+};
+
 struct axi_pwm_init_param pulsar_adc_axi_pwm_init = {
 	.base_addr = AXI_PWMGEN_BASEADDR,
 	.ref_clock_Hz = REFCLK_RATE,
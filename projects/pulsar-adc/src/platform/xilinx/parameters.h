@@ -47,6 +47,7 @@
 #include <xparameters.h>
 #include <xil_cache.h>
 #include <xilinx_uart.h>
+#include <xilinx_irq.h>
 
 #include "axi_pwm_extra.h"
 #include "spi_engine.h"
@@ -78,6 +79,10 @@
 #define UART_BAUDRATE			115200
 
 #define DMA_BASEADDR			XPAR_AXI_PULSAR_ADC_DMA_BASEADDR
+/* Continuous capture needs the DMAC interrupt, if it is connected */
+#ifdef XPAR_FABRIC_AXI_PULSAR_ADC_DMA_IRQ_INTR
+#define DMA_IRQ_ID			XPAR_FABRIC_AXI_PULSAR_ADC_DMA_IRQ_INTR
+#endif
 #define SPI_ENGINE_BASEADDR		XPAR_SPI_PULSAR_ADC_SPI_PULSAR_ADC_AXI_REGMAP_BASEADDR
 #define RX_CLKGEN_BASEADDR		XPAR_SPI_CLKGEN_BASEADDR
 #define AXI_PWMGEN_BASEADDR		XPAR_PULSAR_ADC_TRIGGER_GEN_BASEADDR
@@ -96,6 +101,9 @@
 #define SPI_CS				0
 #define SPI_BAUDRATE			80000000
 
+#define IRQ_OPS				&xil_irq_ops
+#define IRQ_EXTRA			&xil_irq_init_par
+
 #define PWM_OPS				&axi_pwm_ops
 #define PWM_EXTRA			&pulsar_adc_axi_pwm_init
 #define PWM_PERIOD			555
@@ -104,6 +112,7 @@
 #define PULSAR_ADC_ADC_REF_VOLTAGE		5000
 
 extern struct xil_uart_init_param uart_extra_ip;
+extern struct xil_irq_init_param xil_irq_init_par;
 extern struct spi_engine_init_param spi_eng_init_param;
 extern struct axi_pwm_init_param pulsar_adc_axi_pwm_init;
 #endif /* __PARAMETERS_H__ */
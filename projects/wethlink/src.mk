@@ -75,6 +75,7 @@ INCS += $(INCLUDE)/no_os_gpio.h \
 	$(INCLUDE)/no_os_units.h \
 	$(INCLUDE)/no_os_list.h \
 	$(INCLUDE)/no_os_crc8.h \
+	$(INCLUDE)/no_os_crc_engine.h \
 	$(INCLUDE)/no_os_pid.h \
 	$(INCLUDE)/no_os_print_log.h \
 	$(INCLUDE)/no_os_delay.h \
@@ -0,0 +1,405 @@
+/***************************************************************************//**
+ *   @file   fake_axi_dmac.c
+ *   @brief  Register level model of the AXI DMAC and of the AXI bus, used by
+ *           the tests of the AXI core drivers.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/*
+ * Included by the tests, which then provide the platform functions
+ * (no_os_axi_io_*, no_os_udelay, no_os_mdelay) through this file.
+ *
+ * The DMAC is a DEV to MEM core with 64 bit addresses, 2D transfers and a
+ * hardware queue of FAKE_DMAC_QUEUE_DEPTH transfers. A transfer starts when
+ * submitted, and completes when the test calls fake_dmac_complete(), which
+ * fills the destination with a running byte counter. Interrupt sources are
+ * latched and the ISR is called synchronously while they are pending and
+ * unmasked, outside of the ISR itself, as an interrupt controller would.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "axi_dmac.h"
+#include "no_os_axi_io.h"
+
+#define FAKE_DMAC_BASE		0x7c420000
+#define FAKE_DMAC_QUEUE_DEPTH	2
+#define FAKE_DMAC_REGS		(0x500 / 4)
+
+struct fake_dmac_xfer {
+	uint32_t id;
+	uint64_t dest;
+	uint32_t x_len;
+	uint32_t y_len;
+	uint32_t stride;
+};
+
+struct fake_dmac {
+	uint32_t regs[FAKE_DMAC_REGS];
+	struct fake_dmac_xfer queue[FAKE_DMAC_QUEUE_DEPTH];
+	uint32_t nb_queued;
+	uint32_t next_id;
+	uint32_t done;
+	uint32_t source;
+	uint32_t mask;
+	/* Value of X_LENGTH for the longest transfer */
+	uint32_t max_length;
+	/* Next byte written by the DMA */
+	uint8_t seq;
+	/* Complete the transfers without writing their destination */
+	bool discard;
+	bool in_irq;
+	/* Instance passed to the ISR, no interrupt if NULL */
+	struct axi_dmac *irq_dmac;
+	/* Registered ISR and its context, axi_dmac_isr() if NULL */
+	void (*irq_handler)(void *ctx);
+	void *irq_ctx;
+	uint32_t nb_irqs;
+	uint32_t nb_submits;
+	/* Called after each transfer is submitted, with the transfer ID */
+	void (*on_submit)(uint32_t id);
+};
+
+static struct fake_dmac fake_dmac;
+
+/* Number of register accesses, of all cores */
+static uint32_t fake_axi_io_accesses;
+/* Time spent in no_os_udelay() and no_os_mdelay(), in us */
+static uint32_t fake_delay_us;
+
+/*
+ * Counting semaphore standing for the platform one, defined here instead of
+ * linking util/no_os_semaphore.c. When the caller would sleep, sem_on_wait()
+ * stands for the DMA progressing meanwhile.
+ */
+static uint32_t sem;
+static uint32_t sem_count;
+static uint32_t sem_waits;
+static bool sem_nosys;
+static void (*sem_on_wait)(void);
+
+/* Register accesses to the other cores are forwarded to these, if set */
+static int32_t (*fake_axi_io_other_read)(uint32_t base, uint32_t offset,
+		uint32_t *val);
+static int32_t (*fake_axi_io_other_write)(uint32_t base, uint32_t offset,
+		uint32_t val);
+
+static void fake_dmac_reset(void)
+{
+	memset(&fake_dmac, 0, sizeof(fake_dmac));
+	fake_dmac.max_length = 0x00ffffff;
+	/* DEV to MEM, 64 bit destination bus */
+	fake_dmac.regs[AXI_DMAC_REG_INTF_DESC / 4] =
+		no_os_field_prep(AXI_DMAC_DMA_BPB_DEST, 3);
+	fake_axi_io_accesses = 0;
+	fake_delay_us = 0;
+	fake_axi_io_other_read = NULL;
+	fake_axi_io_other_write = NULL;
+	sem_waits = 0;
+	sem_nosys = false;
+	sem_on_wait = NULL;
+}
+
+/* Call the ISR while an unmasked source is pending */
+static void fake_dmac_irq(void)
+{
+	if (fake_dmac.in_irq || !fake_dmac.irq_dmac)
+		return;
+
+	fake_dmac.in_irq = true;
+	while (fake_dmac.source & ~fake_dmac.mask) {
+		fake_dmac.nb_irqs++;
+		if (fake_dmac.irq_handler)
+			fake_dmac.irq_handler(fake_dmac.irq_ctx);
+		else
+			axi_dmac_isr(fake_dmac.irq_dmac);
+	}
+	fake_dmac.in_irq = false;
+}
+
+/* Complete the nb oldest transfers of the queue */
+static void fake_dmac_complete(uint32_t nb)
+{
+	struct fake_dmac_xfer *xfer;
+	uint8_t *dest;
+	uint32_t x, y;
+
+	while (nb-- && fake_dmac.nb_queued) {
+		xfer = &fake_dmac.queue[0];
+		for (y = 0; y < xfer->y_len && !fake_dmac.discard; y++) {
+			dest = (uint8_t *)(uintptr_t)(xfer->dest + y * xfer->stride);
+			for (x = 0; x < xfer->x_len; x++)
+				dest[x] = fake_dmac.seq++;
+		}
+		fake_dmac.done |= (uint32_t)1 << xfer->id;
+		fake_dmac.nb_queued--;
+		memmove(&fake_dmac.queue[0], &fake_dmac.queue[1],
+			fake_dmac.nb_queued * sizeof(*xfer));
+		fake_dmac.source |= AXI_DMAC_IRQ_EOT;
+		/* The next queued transfer starts */
+		if (fake_dmac.nb_queued)
+			fake_dmac.source |= AXI_DMAC_IRQ_SOT;
+		fake_dmac_irq();
+	}
+}
+
+static void fake_dmac_submit(void)
+{
+	uint32_t *regs = fake_dmac.regs;
+	struct fake_dmac_xfer *xfer;
+	uint32_t id = fake_dmac.next_id;
+
+	if (!(regs[AXI_DMAC_REG_CTRL / 4] & AXI_DMAC_CTRL_ENABLE) ||
+	    fake_dmac.nb_queued == FAKE_DMAC_QUEUE_DEPTH)
+		return;
+
+	xfer = &fake_dmac.queue[fake_dmac.nb_queued++];
+	xfer->id = id;
+	xfer->dest = regs[AXI_DMAC_REG_DEST_ADDRESS / 4] |
+		     (uint64_t)regs[AXI_DMAC_REG_DEST_ADDRESS_HIGH / 4] << 32;
+	xfer->x_len = regs[AXI_DMAC_REG_X_LENGTH / 4] + 1;
+	xfer->y_len = regs[AXI_DMAC_REG_Y_LENGTH / 4] + 1;
+	xfer->stride = regs[AXI_DMAC_REG_DEST_STRIDE / 4];
+
+	fake_dmac.done &= ~((uint32_t)1 << id);
+	fake_dmac.next_id = (id + 1) % AXI_DMAC_MAX_TRANSFER_ID;
+	fake_dmac.nb_submits++;
+	if (fake_dmac.nb_queued == 1)
+		fake_dmac.source |= AXI_DMAC_IRQ_SOT;
+
+	if (fake_dmac.on_submit)
+		fake_dmac.on_submit(id);
+
+	fake_dmac_irq();
+}
+
+static void fake_dmac_write(uint32_t offset, uint32_t val)
+{
+	switch (offset) {
+	case AXI_DMAC_REG_IRQ_PENDING:
+		fake_dmac.source &= ~val;
+		return;
+	case AXI_DMAC_REG_IRQ_MASK:
+		fake_dmac.mask = val;
+		fake_dmac_irq();
+		return;
+	case AXI_DMAC_REG_TRANSFER_SUBMIT:
+		if (val & AXI_DMAC_TRANSFER_SUBMIT)
+			fake_dmac_submit();
+		return;
+	case AXI_DMAC_REG_CTRL:
+		/* Disabling the core aborts the queued transfers */
+		if (!(val & AXI_DMAC_CTRL_ENABLE))
+			fake_dmac.nb_queued = 0;
+		break;
+	case AXI_DMAC_REG_X_LENGTH:
+	case AXI_DMAC_REG_Y_LENGTH:
+		val &= fake_dmac.max_length;
+		break;
+	case AXI_DMAC_REG_DEST_ADDRESS:
+		val &= ~0x7;
+		break;
+	case AXI_DMAC_REG_FLAGS:
+		val &= DMA_CYCLIC | DMA_LAST;
+		break;
+	case AXI_DMAC_REG_SRC_ADDRESS:
+	case AXI_DMAC_REG_SRC_ADDRESS_HIGH:
+	case AXI_DMAC_REG_SRC_STRIDE:
+	case AXI_DMAC_REG_INTF_DESC:
+		/* Not implemented by a DEV to MEM core, or read-only */
+		return;
+	default:
+		break;
+	}
+
+	if (offset / 4 < FAKE_DMAC_REGS)
+		fake_dmac.regs[offset / 4] = val;
+}
+
+static uint32_t fake_dmac_read(uint32_t offset)
+{
+	switch (offset) {
+	case AXI_DMAC_REG_IRQ_PENDING:
+		return fake_dmac.source & ~fake_dmac.mask;
+	case AXI_DMAC_REG_IRQ_MASK:
+		return fake_dmac.mask;
+	case AXI_DMAC_REG_TRANSFER_SUBMIT:
+		return fake_dmac.nb_queued == FAKE_DMAC_QUEUE_DEPTH ?
+		       AXI_DMAC_QUEUE_FULL : 0;
+	case AXI_DMAC_REG_TRANSFER_ID:
+		return fake_dmac.next_id;
+	case AXI_DMAC_REG_TRANSFER_DONE:
+		return fake_dmac.done;
+	default:
+		return offset / 4 < FAKE_DMAC_REGS ? fake_dmac.regs[offset / 4] : 0;
+	}
+}
+
+int32_t no_os_axi_io_read(uint32_t base, uint32_t offset, uint32_t *data)
+{
+	fake_axi_io_accesses++;
+	if (base != FAKE_DMAC_BASE) {
+		*data = 0;
+		return fake_axi_io_other_read ?
+		       fake_axi_io_other_read(base, offset, data) : 0;
+	}
+
+	*data = fake_dmac_read(offset);
+
+	return 0;
+}
+
+int32_t no_os_axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
+{
+	fake_axi_io_accesses++;
+	if (base != FAKE_DMAC_BASE)
+		return fake_axi_io_other_write ?
+		       fake_axi_io_other_write(base, offset, data) : 0;
+
+	fake_dmac_write(offset, data);
+
+	return 0;
+}
+
+int32_t no_os_axi_io_read_multi(uint32_t base, uint32_t offset, uint32_t *data,
+				uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		no_os_axi_io_read(base, offset + 4 * i, &data[i]);
+
+	return 0;
+}
+
+int32_t no_os_axi_io_write_multi(uint32_t base, uint32_t offset,
+				 const uint32_t *data, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		no_os_axi_io_write(base, offset + 4 * i, data[i]);
+
+	return 0;
+}
+
+int32_t no_os_axi_io_exec(uint32_t base, struct no_os_axi_io_op *ops,
+			  uint32_t nb_ops)
+{
+	uint32_t val;
+	uint32_t i;
+	int32_t ret;
+
+	for (i = 0; i < nb_ops; i++) {
+		switch (ops[i].type) {
+		case NO_OS_AXI_IO_OP_WRITE:
+			ret = no_os_axi_io_write(base, ops[i].offset, ops[i].val);
+			break;
+		case NO_OS_AXI_IO_OP_READ:
+			ret = no_os_axi_io_read(base, ops[i].offset, ops[i].data);
+			break;
+		default:
+			ret = no_os_axi_io_read(base, ops[i].offset, &val);
+			if (ret)
+				break;
+			if (ops[i].data)
+				*ops[i].data = val;
+			ret = no_os_axi_io_write(base, ops[i].offset,
+						 (val & ~ops[i].mask) |
+						 (ops[i].val & ops[i].mask));
+			break;
+		}
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+void no_os_udelay(uint32_t usecs)
+{
+	fake_delay_us += usecs;
+}
+
+void no_os_mdelay(uint32_t msecs)
+{
+	fake_delay_us += msecs * 1000;
+}
+
+void no_os_semaphore_init(void **semaphore)
+{
+	*semaphore = &sem;
+	sem_count = 1;
+}
+
+int no_os_semaphore_take_timeout(void *semaphore, uint32_t timeout_ms)
+{
+	if (sem_nosys)
+		return -ENOSYS;
+
+	if (!sem_count && timeout_ms) {
+		sem_waits++;
+		if (sem_on_wait)
+			sem_on_wait();
+	}
+	if (!sem_count)
+		return -ETIMEDOUT;
+	sem_count--;
+
+	return 0;
+}
+
+void no_os_semaphore_take(void *semaphore)
+{
+	no_os_semaphore_take_timeout(semaphore, UINT32_MAX);
+}
+
+void no_os_semaphore_give(void *semaphore)
+{
+	sem_count++;
+}
+
+void no_os_semaphore_give_from_isr(void *semaphore)
+{
+	/* The DMAC driver only gives its semaphores from the ISR */
+	TEST_ASSERT_TRUE(fake_dmac.in_irq);
+	sem_count++;
+}
+
+void no_os_semaphore_remove(void *semaphore)
+{
+}
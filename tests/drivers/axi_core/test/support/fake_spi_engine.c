@@ -0,0 +1,154 @@
+/***************************************************************************//**
+ *   @file   fake_spi_engine.c
+ *   @brief  Register level model of the SPI Engine offload memories, used by
+ *           the tests of the SPI Engine driver.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/*
+ * Included by the tests after fake_axi_dmac.c. fake_spi_engine_reset()
+ * routes the register accesses of FAKE_SPI_ENGINE_BASE to this model.
+ *
+ * Only the registers used by the offload path are modelled. The offload
+ * command and SDO memories are appended to on each write and cleared by
+ * the core reset and by the offload reset, as in the HDL.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "spi_engine.h"
+
+#define FAKE_SPI_ENGINE_BASE		0x44a00000
+#define FAKE_SPI_ENGINE_VERSION		0x00010300
+#define FAKE_SPI_ENGINE_DATA_WIDTH	32
+#define FAKE_SPI_ENGINE_MEM_LEN		128
+
+struct fake_spi_engine {
+	uint32_t cmd_mem[FAKE_SPI_ENGINE_MEM_LEN];
+	uint32_t cmd_len;
+	uint32_t sdo_mem[FAKE_SPI_ENGINE_MEM_LEN];
+	uint32_t sdo_len;
+	bool offload_enabled;
+	/* Number of register accesses, and of words written to the memories */
+	uint32_t accesses;
+	uint32_t mem_writes;
+	uint32_t resets;
+};
+
+static struct fake_spi_engine fake_spi_engine;
+
+static void fake_spi_engine_clear(void)
+{
+	fake_spi_engine.cmd_len = 0;
+	fake_spi_engine.sdo_len = 0;
+	fake_spi_engine.offload_enabled = false;
+}
+
+static void fake_spi_engine_mem_write(uint32_t *mem, uint32_t *len,
+				      uint32_t val)
+{
+	TEST_ASSERT_TRUE(*len < FAKE_SPI_ENGINE_MEM_LEN);
+	mem[(*len)++] = val;
+	fake_spi_engine.mem_writes++;
+}
+
+static int32_t fake_spi_engine_write(uint32_t base, uint32_t offset,
+				     uint32_t val)
+{
+	if (base != FAKE_SPI_ENGINE_BASE)
+		return 0;
+
+	fake_spi_engine.accesses++;
+	switch (offset) {
+	case SPI_ENGINE_REG_RESET:
+	case SPI_ENGINE_REG_OFFLOAD_RESET(0):
+		if (val) {
+			fake_spi_engine_clear();
+			fake_spi_engine.resets++;
+		}
+		break;
+	case SPI_ENGINE_REG_OFFLOAD_CTRL(0):
+		fake_spi_engine.offload_enabled = val &
+						  SPI_ENGINE_OFFLOAD_CTRL_ENABLE;
+		break;
+	case SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0):
+		fake_spi_engine_mem_write(fake_spi_engine.cmd_mem,
+					  &fake_spi_engine.cmd_len, val);
+		break;
+	case SPI_ENGINE_REG_OFFLOAD_SDO_MEM(0):
+		fake_spi_engine_mem_write(fake_spi_engine.sdo_mem,
+					  &fake_spi_engine.sdo_len, val);
+		break;
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+static int32_t fake_spi_engine_read(uint32_t base, uint32_t offset,
+				    uint32_t *val)
+{
+	if (base != FAKE_SPI_ENGINE_BASE)
+		return 0;
+
+	fake_spi_engine.accesses++;
+	switch (offset) {
+	case SPI_ENGINE_REG_VERSION:
+		*val = FAKE_SPI_ENGINE_VERSION;
+		break;
+	case SPI_ENGINE_REG_DATA_WIDTH:
+		*val = FAKE_SPI_ENGINE_DATA_WIDTH;
+		break;
+	case SPI_ENGINE_REG_OFFLOAD_STATUS(0):
+		*val = fake_spi_engine.offload_enabled ?
+		       SPI_ENGINE_OFFLOAD_STATUS_ENABLED : 0;
+		break;
+	default:
+		*val = 0;
+		break;
+	}
+
+	return 0;
+}
+
+static void fake_spi_engine_reset(void)
+{
+	memset(&fake_spi_engine, 0, sizeof(fake_spi_engine));
+	fake_axi_io_other_read = fake_spi_engine_read;
+	fake_axi_io_other_write = fake_spi_engine_write;
+}
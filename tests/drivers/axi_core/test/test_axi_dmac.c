@@ -0,0 +1,390 @@
+/***************************************************************************//**
+ *   @file   test_axi_dmac.c
+ *   @brief  Unit tests of the AXI DMAC driver, run on a register level model
+ *           of the core.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "axi_dmac.h"
+#include "no_os_alloc.h"
+#include "no_os_axi_io.h"
+#include "no_os_error.h"
+#include "no_os_util.h"
+#include "fake_axi_dmac.c"
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define DESC_SIZE	64
+#define NB_DESC		4
+#define RING_BLOCKS	4
+#define RING_BLOCK_SIZE	32
+#define RING_TIMEOUT_MS	5
+
+static struct axi_dmac *dmac;
+static struct axi_dmac_init dmac_init = {
+	.name = "rx_dmac",
+	.base = FAKE_DMAC_BASE,
+	.irq_option = IRQ_ENABLED,
+};
+
+static uint8_t buf[NB_DESC * DESC_SIZE];
+static struct axi_dma_desc desc[NB_DESC];
+
+/* Descriptors completed, in order */
+static uint32_t done_idx[32];
+static uint32_t nb_done;
+
+/* Transfers submitted before being accounted, or with the IRQ unmasked */
+static uint32_t unaccounted_submits;
+static uint32_t unmasked_submits;
+
+static struct axi_dmac_ring ring;
+static struct axi_dmac_ring_param ring_param = {
+	.nb_blocks = RING_BLOCKS,
+	.block_size = RING_BLOCK_SIZE,
+};
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	uint32_t i;
+
+	fake_dmac_reset();
+	nb_done = 0;
+	unaccounted_submits = 0;
+	unmasked_submits = 0;
+	memset(&ring, 0, sizeof(ring));
+	memset(buf, 0, sizeof(buf));
+	for (i = 0; i < NB_DESC; i++) {
+		memset(&desc[i], 0, sizeof(desc[i]));
+		desc[i].dest_addr = (uintptr_t)(buf + i * DESC_SIZE);
+		desc[i].x_len = DESC_SIZE;
+	}
+}
+
+void tearDown(void)
+{
+	axi_dmac_ring_stop(dmac, &ring);
+	axi_dmac_remove(dmac);
+	dmac = NULL;
+}
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static void complete_block(void)
+{
+	fake_dmac_complete(1);
+}
+
+static void dmac_start(void)
+{
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_init(&dmac, &dmac_init));
+	fake_dmac.irq_dmac = dmac;
+}
+
+static void desc_done(void *ctx, uint32_t desc_idx)
+{
+	(void)ctx;
+	if (nb_done < NO_OS_ARRAY_SIZE(done_idx))
+		done_idx[nb_done] = desc_idx;
+	nb_done++;
+}
+
+/* The ISR may see the transfer completed as soon as it is submitted */
+static void check_submit(uint32_t id)
+{
+	if (!(dmac->active_ids & NO_OS_BIT(id)))
+		unaccounted_submits++;
+	if (!fake_dmac.in_irq &&
+	    fake_dmac.mask != (AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT))
+		unmasked_submits++;
+}
+
+static void check_data(uint32_t size)
+{
+	uint32_t i;
+
+	for (i = 0; i < size; i++)
+		TEST_ASSERT_EQUAL_HEX8((uint8_t)i, buf[i]);
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_axi_dmac_detect_caps(void)
+{
+	dmac_start();
+
+	TEST_ASSERT_EQUAL_INT(DMA_DEV_TO_MEM, dmac->direction);
+	TEST_ASSERT_TRUE(dmac->hw_cyclic);
+	TEST_ASSERT_TRUE(dmac->hw_2d);
+	TEST_ASSERT_TRUE(dmac->hw_addr64);
+	TEST_ASSERT_EQUAL_UINT32(0x00ffffff, dmac->max_length);
+	TEST_ASSERT_EQUAL_UINT32(8, dmac->width_dst);
+	/* The probed registers are left at their reset value */
+	TEST_ASSERT_EQUAL_HEX32(0, fake_dmac.regs[AXI_DMAC_REG_Y_LENGTH / 4]);
+	TEST_ASSERT_EQUAL_HEX32(0,
+				fake_dmac.regs[AXI_DMAC_REG_DEST_ADDRESS_HIGH / 4]);
+	TEST_ASSERT_EQUAL_HEX32(0, fake_dmac.regs[AXI_DMAC_REG_FLAGS / 4]);
+}
+
+void test_axi_dmac_chain_accounted_before_submit(void)
+{
+	struct axi_dma_transfer transfer = {
+		.desc = desc,
+		.nb_desc = NB_DESC,
+		.desc_done = desc_done,
+	};
+	uint32_t i;
+
+	dmac_start();
+	fake_dmac.on_submit = check_submit;
+
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_transfer_start(dmac, &transfer));
+	TEST_ASSERT_EQUAL_UINT32(FAKE_DMAC_QUEUE_DEPTH, fake_dmac.nb_queued);
+	/* The start of the first transfer interrupted once unmasked */
+	TEST_ASSERT_EQUAL_HEX32(0, fake_dmac.mask);
+	TEST_ASSERT_EQUAL_UINT32(1, fake_dmac.nb_irqs);
+
+	/* The ISR refills the queue from the chain */
+	fake_dmac_complete(NB_DESC);
+	TEST_ASSERT_EQUAL_UINT32(0, fake_dmac.nb_queued);
+	TEST_ASSERT_EQUAL_UINT32(NB_DESC, fake_dmac.nb_submits);
+	TEST_ASSERT_EQUAL_UINT32(0, unaccounted_submits);
+	TEST_ASSERT_EQUAL_UINT32(0, unmasked_submits);
+
+	TEST_ASSERT_EQUAL_UINT32(NB_DESC, nb_done);
+	for (i = 0; i < NB_DESC; i++)
+		TEST_ASSERT_EQUAL_UINT32(i, done_idx[i]);
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_transfer_wait_completion(dmac, 10));
+	check_data(sizeof(buf));
+}
+
+void test_axi_dmac_split_1d(void)
+{
+	struct axi_dma_transfer transfer = {
+		.desc = desc,
+		.nb_desc = 1,
+		.desc_done = desc_done,
+	};
+
+	/* Bursts of at most 48 bytes */
+	fake_dmac.max_length = 47;
+	dmac_start();
+	fake_dmac.on_submit = check_submit;
+	desc[0].x_len = 3 * 48 + 16;
+
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_transfer_start(dmac, &transfer));
+	fake_dmac_complete(3);
+	/* Only the last burst completes the descriptor */
+	TEST_ASSERT_EQUAL_UINT32(0, nb_done);
+	TEST_ASSERT_FALSE(dmac->transfer.transfer_done);
+	fake_dmac_complete(1);
+	TEST_ASSERT_EQUAL_UINT32(1, nb_done);
+	TEST_ASSERT_EQUAL_UINT32(0, done_idx[0]);
+
+	TEST_ASSERT_EQUAL_UINT32(4, fake_dmac.nb_submits);
+	TEST_ASSERT_EQUAL_UINT32(0, unaccounted_submits);
+	TEST_ASSERT_EQUAL_UINT32(0, unmasked_submits);
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_transfer_wait_completion(dmac, 10));
+	check_data(desc[0].x_len);
+}
+
+void test_axi_dmac_cyclic_stall(void)
+{
+	struct axi_dma_transfer transfer = {
+		.desc = desc,
+		.nb_desc = 3,
+		.cyclic = CYCLIC,
+		.desc_done = desc_done,
+	};
+	uint32_t i;
+
+	dmac_start();
+	fake_dmac.on_submit = check_submit;
+
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_transfer_start(dmac, &transfer));
+	/* Software cyclic: the chain restarts after the last descriptor */
+	fake_dmac_complete(7);
+	TEST_ASSERT_EQUAL_UINT32(7, nb_done);
+	for (i = 0; i < 7; i++)
+		TEST_ASSERT_EQUAL_UINT32(i % 3, done_idx[i]);
+	TEST_ASSERT_EQUAL_UINT32(0, dmac->stalls);
+
+	/* The ISR is late and the queue runs dry */
+	fake_dmac.irq_dmac = NULL;
+	fake_dmac_complete(FAKE_DMAC_QUEUE_DEPTH);
+	TEST_ASSERT_EQUAL_UINT32(0, fake_dmac.nb_queued);
+	fake_dmac.irq_dmac = dmac;
+	fake_dmac_irq();
+	TEST_ASSERT_EQUAL_UINT32(1, dmac->stalls);
+	TEST_ASSERT_EQUAL_UINT32(7 + FAKE_DMAC_QUEUE_DEPTH, nb_done);
+	/* and restarts it */
+	TEST_ASSERT_EQUAL_UINT32(FAKE_DMAC_QUEUE_DEPTH, fake_dmac.nb_queued);
+	TEST_ASSERT_FALSE(dmac->transfer.transfer_done);
+	TEST_ASSERT_EQUAL_UINT32(0, unaccounted_submits);
+	TEST_ASSERT_EQUAL_UINT32(0, unmasked_submits);
+
+	axi_dmac_transfer_stop(dmac);
+	TEST_ASSERT_EQUAL_UINT32(0, fake_dmac.nb_queued);
+}
+
+void test_axi_dmac_start_errors(void)
+{
+	struct axi_dma_transfer transfer = {
+		.desc = desc,
+		.nb_desc = NB_DESC,
+	};
+
+	dmac_start();
+
+	/* The queue is still full with the previous transfer */
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_transfer_start(dmac, &transfer));
+	TEST_ASSERT_EQUAL_INT(-1, axi_dmac_transfer_start(dmac, &transfer));
+	TEST_ASSERT_EQUAL_HEX32(0, fake_dmac.mask);
+
+	/* Unsupported descriptor */
+	axi_dmac_transfer_stop(dmac);
+	desc[1].src_stride = 8;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, axi_dmac_transfer_start(dmac, &transfer));
+	TEST_ASSERT_EQUAL_HEX32(0, fake_dmac.mask);
+
+	/* Nothing to do */
+	transfer.nb_desc = 0;
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_transfer_start(dmac, &transfer));
+	TEST_ASSERT_EQUAL_UINT32(0, fake_dmac.nb_queued);
+}
+
+void test_axi_dmac_ring_read_sleeps(void)
+{
+	struct axi_dmac_block_info info;
+	uint8_t block[RING_BLOCK_SIZE];
+	uint32_t i, j;
+
+	dmac_start();
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_ring_start(dmac, &ring, &ring_param));
+	TEST_ASSERT_EQUAL_INT(-EBUSY, axi_dmac_ring_start(dmac, &ring,
+			      &ring_param));
+	TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t)ring.buf % AXI_DMAC_CACHE_LINE);
+
+	/* Each read sleeps until the ISR gives a filled block */
+	sem_on_wait = complete_block;
+	for (i = 0; i < 2 * RING_BLOCKS; i++) {
+		TEST_ASSERT_EQUAL_INT(0, axi_dmac_ring_read(dmac, &ring, block,
+				      &info, RING_TIMEOUT_MS));
+		TEST_ASSERT_EQUAL_UINT32(i, info.seq);
+		TEST_ASSERT_EQUAL_UINT32(0, info.overruns);
+		for (j = 0; j < RING_BLOCK_SIZE; j++)
+			TEST_ASSERT_EQUAL_HEX8((uint8_t)(i * RING_BLOCK_SIZE + j),
+					       block[j]);
+	}
+	TEST_ASSERT_EQUAL_UINT32(2 * RING_BLOCKS, sem_waits);
+	TEST_ASSERT_EQUAL_UINT32(0, fake_delay_us);
+}
+
+void test_axi_dmac_ring_overrun(void)
+{
+	struct axi_dmac_block_info info;
+	uint8_t block[RING_BLOCK_SIZE];
+
+	dmac_start();
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_ring_start(dmac, &ring, &ring_param));
+
+	/* Blocks 0 to 2 are overwritten, the DMA is writing block 4 */
+	fake_dmac_complete(RING_BLOCKS + 2);
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_ring_read(dmac, &ring, block, &info,
+			      RING_TIMEOUT_MS));
+	TEST_ASSERT_EQUAL_UINT32(3, info.seq);
+	TEST_ASSERT_EQUAL_UINT32(3, info.overruns);
+	TEST_ASSERT_EQUAL_HEX8(3 * RING_BLOCK_SIZE, block[0]);
+
+	/* The tokens of the dropped blocks don't make reads return early */
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_ring_read(dmac, &ring, block, &info,
+			      RING_TIMEOUT_MS));
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_ring_read(dmac, &ring, block, &info,
+			      RING_TIMEOUT_MS));
+	TEST_ASSERT_EQUAL_UINT32(5, info.seq);
+	TEST_ASSERT_EQUAL_INT(-ETIMEDOUT, axi_dmac_ring_read(dmac, &ring, block,
+			      &info, RING_TIMEOUT_MS));
+	TEST_ASSERT_EQUAL_UINT32(0, fake_delay_us);
+
+	/* A stall of the DMA is counted as an overrun */
+	fake_dmac.irq_dmac = NULL;
+	fake_dmac_complete(FAKE_DMAC_QUEUE_DEPTH);
+	fake_dmac.irq_dmac = dmac;
+	fake_dmac_irq();
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_ring_read(dmac, &ring, block, &info,
+			      RING_TIMEOUT_MS));
+	TEST_ASSERT_EQUAL_UINT32(6, info.seq);
+	TEST_ASSERT_EQUAL_UINT32(4, info.overruns);
+}
+
+void test_axi_dmac_ring_poll_without_semaphore(void)
+{
+	uint8_t block[RING_BLOCK_SIZE];
+
+	/* Streaming needs the DMAC interrupt */
+	dmac_start();
+	dmac->irq_option = IRQ_DISABLED;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, axi_dmac_ring_start(dmac, &ring,
+			      &ring_param));
+	dmac->irq_option = IRQ_ENABLED;
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_ring_start(dmac, &ring, &ring_param));
+
+	/* The platform can't sleep, the reader polls for timeout_ms */
+	sem_nosys = true;
+	TEST_ASSERT_EQUAL_INT(-ETIMEDOUT, axi_dmac_ring_read(dmac, &ring, block,
+			      NULL, RING_TIMEOUT_MS));
+	TEST_ASSERT_EQUAL_UINT32(RING_TIMEOUT_MS * 1000, fake_delay_us);
+	TEST_ASSERT_EQUAL_UINT32(0, sem_waits);
+
+	fake_dmac_complete(1);
+	TEST_ASSERT_EQUAL_INT(0, axi_dmac_ring_read(dmac, &ring, block, NULL,
+			      RING_TIMEOUT_MS));
+}
@@ -0,0 +1,620 @@
+/***************************************************************************//**
+ *   @file   test_spi_engine.c
+ *   @brief  Unit tests of the SPI Engine offload, run on register level
+ *           models of the engine and of the AXI DMAC.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <time.h>
+#include "unity.h"
+#include "spi_engine.h"
+#include "axi_dmac.h"
+#include "no_os_axi_io.h"
+#include "no_os_error.h"
+#include "no_os_util.h"
+#include "fake_axi_dmac.c"
+#include "fake_spi_engine.c"
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define SE_REF_CLK_HZ		100000000
+#define SE_SPEED_HZ		10000000
+#define SE_SAMPLES		16
+/* Destination of the RX DMA, not written by the fake DMAC */
+#define SE_RX_ADDR		0x00800000
+/* Number of distinct messages, one more than the offload cache */
+#define SE_NB_MSGS		(SPI_ENGINE_OFFLOAD_CACHE_SIZE + 1)
+#define SE_LONG_CMDS		60
+#define SE_BENCH_TRANSFERS	1000
+#define SE_STREAM_SAMPLES	4
+#define SE_STREAM_BLOCKS	4
+#define SE_BLOCK_SIZE		(SE_STREAM_SAMPLES * 4)
+#define SE_TIMEOUT_MS		5
+#define SE_TICK			100
+
+static struct spi_engine_init_param engine_init = {
+	.ref_clk_hz = SE_REF_CLK_HZ,
+	.type = SPI_ENGINE,
+	.spi_engine_baseaddr = FAKE_SPI_ENGINE_BASE,
+	.data_width = FAKE_SPI_ENGINE_DATA_WIDTH,
+};
+
+static struct spi_engine_offload_init_param offload_init = {
+	.rx_dma_baseaddr = FAKE_DMAC_BASE,
+	.offload_config = OFFLOAD_RX_EN,
+	.irq_option = IRQ_ENABLED,
+};
+
+static struct no_os_spi_desc *desc;
+static struct no_os_spi_desc *desc2;
+
+/* Message i transfers i + 1 words, so that each one compiles differently */
+static uint32_t msg_cmds[SE_NB_MSGS][3];
+static uint32_t long_cmds[SE_LONG_CMDS];
+static uint32_t msg_data[SE_LONG_CMDS];
+
+/* Allocations made by the drivers */
+static uint32_t nb_allocs;
+
+/* Time source of the stream, advanced on each block timestamp */
+static uint64_t stream_time;
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	uint32_t i;
+
+	fake_dmac_reset();
+	/* 32 bit stream from the engine */
+	fake_dmac.regs[AXI_DMAC_REG_INTF_DESC / 4] |=
+		no_os_field_prep(AXI_DMAC_DMA_BPB_SRC, 2);
+	fake_dmac.discard = true;
+	fake_spi_engine_reset();
+	nb_allocs = 0;
+	stream_time = 0;
+
+	for (i = 0; i < SE_NB_MSGS; i++) {
+		msg_cmds[i][0] = CS_LOW;
+		msg_cmds[i][1] = WRITE_READ(4 * (i + 1));
+		msg_cmds[i][2] = CS_HIGH;
+	}
+	for (i = 0; i < SE_LONG_CMDS; i += 3) {
+		long_cmds[i] = CS_LOW;
+		long_cmds[i + 1] = WRITE_READ(4);
+		long_cmds[i + 2] = CS_HIGH;
+	}
+	for (i = 0; i < SE_LONG_CMDS; i++)
+		msg_data[i] = 0xa5000000 | i;
+}
+
+void tearDown(void)
+{
+	if (desc2)
+		spi_engine_remove(desc2);
+	if (desc)
+		spi_engine_remove(desc);
+	desc = NULL;
+	desc2 = NULL;
+}
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+void *no_os_malloc(size_t size)
+{
+	nb_allocs++;
+
+	return malloc(size);
+}
+
+void *no_os_calloc(size_t nitems, size_t size)
+{
+	nb_allocs++;
+
+	return calloc(nitems, size);
+}
+
+void no_os_free(void *ptr)
+{
+	free(ptr);
+}
+
+static uint32_t cpu_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+	return ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static struct spi_engine_desc *engine(struct no_os_spi_desc *spi)
+{
+	return spi->extra;
+}
+
+static void engine_start(struct no_os_spi_desc **spi, uint8_t chip_select)
+{
+	struct no_os_spi_init_param param = {
+		.max_speed_hz = SE_SPEED_HZ,
+		.chip_select = chip_select,
+		.extra = &engine_init,
+	};
+
+	TEST_ASSERT_EQUAL_INT(0, spi_engine_init(spi, &param));
+	TEST_ASSERT_EQUAL_INT(0, spi_engine_offload_init(*spi, &offload_init));
+}
+
+/* The engine produces the samples only while the offload is enabled */
+static void complete_transfer(void)
+{
+	TEST_ASSERT_TRUE(fake_spi_engine.offload_enabled);
+	fake_dmac_complete(UINT32_MAX);
+}
+
+static struct spi_engine_offload_message msg(const uint32_t *cmds,
+		uint32_t no_commands)
+{
+	struct spi_engine_offload_message m = {
+		.commands = (uint32_t *)cmds,
+		.no_commands = no_commands,
+		.commands_data = msg_data,
+		.rx_addr = SE_RX_ADDR,
+	};
+
+	return m;
+}
+
+static void transfer(struct no_os_spi_desc *spi,
+		     struct spi_engine_offload_message m)
+{
+	fake_dmac.irq_dmac = engine(spi)->offload_rx_dma;
+	sem_on_wait = complete_transfer;
+	fake_spi_engine.accesses = 0;
+	fake_spi_engine.mem_writes = 0;
+	fake_spi_engine.resets = 0;
+
+	TEST_ASSERT_EQUAL_INT(0, spi_engine_offload_transfer(spi, m, SE_SAMPLES));
+	TEST_ASSERT_FALSE(fake_spi_engine.offload_enabled);
+	TEST_ASSERT_TRUE(engine(spi)->offload_rx_dma->transfer.transfer_done);
+}
+
+/* Check that the offload memories hold the program and data of a message */
+static void check_loaded(struct no_os_spi_desc *spi, const uint32_t *cmds,
+			 uint32_t no_commands)
+{
+	struct spi_engine_program program;
+
+	TEST_ASSERT_EQUAL_INT(0, spi_engine_compile_message(spi, cmds,
+			      no_commands, &program));
+	TEST_ASSERT_EQUAL_UINT32(program.len, fake_spi_engine.cmd_len);
+	TEST_ASSERT_EQUAL_HEX32_ARRAY(program.cmds, fake_spi_engine.cmd_mem,
+				      program.len);
+	TEST_ASSERT_EQUAL_UINT32(program.words, fake_spi_engine.sdo_len);
+	TEST_ASSERT_EQUAL_HEX32_ARRAY(msg_data, fake_spi_engine.sdo_mem,
+				      program.words);
+}
+
+/* Slot of the offload cache holding a message, -1 if none */
+static int32_t cached_slot(struct no_os_spi_desc *spi, const uint32_t *cmds,
+			   uint32_t no_commands)
+{
+	struct spi_engine_offload_program *prog;
+	uint32_t i;
+
+	for (i = 0; i < SPI_ENGINE_OFFLOAD_CACHE_SIZE; i++) {
+		prog = &engine(spi)->offload_cache[i];
+		if (prog->program.len && prog->no_commands == no_commands &&
+		    !memcmp(prog->msg_cmds, cmds, no_commands * sizeof(*cmds)))
+			return i;
+	}
+
+	return -1;
+}
+
+static uint64_t stream_timestamp(void)
+{
+	stream_time += SE_TICK;
+
+	return stream_time;
+}
+
+static void complete_block(void)
+{
+	TEST_ASSERT_TRUE(fake_spi_engine.offload_enabled);
+	fake_dmac_complete(1);
+}
+
+/* Start a stream of msg_cmds[0], whose samples are one word */
+static void stream_start(struct spi_engine_offload_message *m)
+{
+	struct spi_engine_offload_stream_param param = {
+		.msg = m,
+		.samples_per_block = SE_STREAM_SAMPLES,
+		.nb_blocks = SE_STREAM_BLOCKS,
+		.get_timestamp = stream_timestamp,
+	};
+
+	engine_start(&desc, 0);
+	/* The ring is written by the DMA */
+	fake_dmac.discard = false;
+	fake_dmac.irq_dmac = engine(desc)->offload_rx_dma;
+	fake_dmac.irq_handler = spi_engine_offload_rx_isr;
+	fake_dmac.irq_ctx = desc;
+
+	TEST_ASSERT_EQUAL_INT(0, spi_engine_offload_stream_start(desc, &param));
+	TEST_ASSERT_TRUE(fake_spi_engine.offload_enabled);
+	check_loaded(desc, msg_cmds[0], 3);
+}
+
+static void stream_read(uint32_t seq, uint32_t overruns)
+{
+	struct axi_dmac_block_info info;
+	uint8_t block[SE_BLOCK_SIZE];
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL_INT(0, spi_engine_offload_stream_read(desc, block,
+			      &info, SE_TIMEOUT_MS));
+	TEST_ASSERT_EQUAL_UINT32(seq, info.seq);
+	TEST_ASSERT_EQUAL_UINT32(overruns, info.overruns);
+	TEST_ASSERT_TRUE(info.timestamp > 0);
+	for (i = 0; i < SE_BLOCK_SIZE; i++)
+		TEST_ASSERT_EQUAL_HEX8((uint8_t)(seq * SE_BLOCK_SIZE + i),
+				       block[i]);
+}
+
+static void bench(const char *name, const struct spi_engine_offload_message *m,
+		  uint32_t nb_msgs)
+{
+	uint32_t engine_accesses = 0;
+	uint32_t accesses;
+	uint32_t cpu;
+	uint32_t i;
+	char buf[160];
+
+	nb_allocs = 0;
+	accesses = fake_axi_io_accesses;
+	cpu = cpu_ns();
+	for (i = 0; i < SE_BENCH_TRANSFERS; i++) {
+		transfer(desc, m[i % nb_msgs]);
+		engine_accesses += fake_spi_engine.accesses;
+	}
+	cpu = cpu_ns() - cpu;
+	accesses = fake_axi_io_accesses - accesses;
+
+	snprintf(buf, sizeof(buf),
+		 "%s: %u engine and %u DMAC register accesses, %u allocations, "
+		 "%u ns CPU per transfer", name,
+		 engine_accesses / SE_BENCH_TRANSFERS,
+		 (accesses - engine_accesses) / SE_BENCH_TRANSFERS,
+		 nb_allocs / SE_BENCH_TRANSFERS, cpu / SE_BENCH_TRANSFERS);
+	TEST_MESSAGE(buf);
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_spi_engine_offload_load(void)
+{
+	engine_start(&desc, 0);
+	nb_allocs = 0;
+
+	transfer(desc, msg(msg_cmds[1], 3));
+	TEST_ASSERT_EQUAL_UINT32(1, fake_spi_engine.resets);
+	check_loaded(desc, msg_cmds[1], 3);
+	/* The program is compiled in the descriptor */
+	TEST_ASSERT_EQUAL_UINT32(0, nb_allocs);
+}
+
+void test_spi_engine_offload_cache_hit(void)
+{
+	uint32_t i;
+
+	engine_start(&desc, 0);
+	transfer(desc, msg(msg_cmds[0], 3));
+
+	/* The memories already hold the message, only the offload is toggled */
+	nb_allocs = 0;
+	transfer(desc, msg(msg_cmds[0], 3));
+	TEST_ASSERT_EQUAL_UINT32(0, fake_spi_engine.mem_writes);
+	TEST_ASSERT_EQUAL_UINT32(0, fake_spi_engine.resets);
+	TEST_ASSERT_EQUAL_UINT32(2, fake_spi_engine.accesses);
+	TEST_ASSERT_EQUAL_UINT32(0, nb_allocs);
+
+	/* Fill the cache, then hit its least recently used program */
+	for (i = 1; i < SPI_ENGINE_OFFLOAD_CACHE_SIZE; i++)
+		transfer(desc, msg(msg_cmds[i], 3));
+	transfer(desc, msg(msg_cmds[0], 3));
+	check_loaded(desc, msg_cmds[0], 3);
+	for (i = 0; i < SPI_ENGINE_OFFLOAD_CACHE_SIZE; i++)
+		TEST_ASSERT_NOT_EQUAL(-1, cached_slot(desc, msg_cmds[i], 3));
+
+	/* The hit made message 1 the least recently used one */
+	transfer(desc, msg(msg_cmds[SE_NB_MSGS - 1], 3));
+	check_loaded(desc, msg_cmds[SE_NB_MSGS - 1], 3);
+	TEST_ASSERT_EQUAL_INT(-1, cached_slot(desc, msg_cmds[1], 3));
+	TEST_ASSERT_NOT_EQUAL(-1, cached_slot(desc, msg_cmds[0], 3));
+}
+
+void test_spi_engine_offload_sdo_changed(void)
+{
+	engine_start(&desc, 0);
+	transfer(desc, msg(msg_cmds[2], 3));
+
+	/* Same program, new data: both memories are reloaded */
+	msg_data[1] = 0x12345678;
+	transfer(desc, msg(msg_cmds[2], 3));
+	TEST_ASSERT_EQUAL_UINT32(1, fake_spi_engine.resets);
+	check_loaded(desc, msg_cmds[2], 3);
+
+	transfer(desc, msg(msg_cmds[2], 3));
+	TEST_ASSERT_EQUAL_UINT32(0, fake_spi_engine.mem_writes);
+}
+
+void test_spi_engine_offload_evict_loaded(void)
+{
+	struct spi_engine_desc *eng;
+	int32_t slot;
+	uint32_t i;
+
+	engine_start(&desc, 0);
+	eng = engine(desc);
+	for (i = 1; i < SE_NB_MSGS; i++)
+		transfer(desc, msg(msg_cmds[i], 3));
+
+	/*
+	 * Age the loaded program, so that the next message is compiled over
+	 * it. Its data is a prefix of the loaded one, so only the program
+	 * tells the memories apart.
+	 */
+	slot = cached_slot(desc, msg_cmds[SE_NB_MSGS - 1], 3);
+	TEST_ASSERT_NOT_EQUAL(-1, slot);
+	eng->offload_cache[slot].last_use = 0;
+
+	transfer(desc, msg(msg_cmds[0], 3));
+	TEST_ASSERT_EQUAL_INT(slot, cached_slot(desc, msg_cmds[0], 3));
+	TEST_ASSERT_EQUAL_UINT32(1, fake_spi_engine.resets);
+	check_loaded(desc, msg_cmds[0], 3);
+
+	/* The evicted message is compiled and loaded again */
+	transfer(desc, msg(msg_cmds[SE_NB_MSGS - 1], 3));
+	check_loaded(desc, msg_cmds[SE_NB_MSGS - 1], 3);
+}
+
+void test_spi_engine_offload_reset(void)
+{
+	engine_start(&desc, 0);
+	transfer(desc, msg(msg_cmds[0], 3));
+
+	/* A second chip select of the same core resets it */
+	engine_start(&desc2, 1);
+	TEST_ASSERT_EQUAL_UINT32(0, fake_spi_engine.cmd_len);
+	transfer(desc, msg(msg_cmds[0], 3));
+	TEST_ASSERT_EQUAL_UINT32(1, fake_spi_engine.resets);
+	check_loaded(desc, msg_cmds[0], 3);
+
+	/* The descriptors share the offload memories */
+	transfer(desc2, msg(msg_cmds[0], 3));
+	check_loaded(desc2, msg_cmds[0], 3);
+	transfer(desc, msg(msg_cmds[0], 3));
+	TEST_ASSERT_EQUAL_UINT32(1, fake_spi_engine.resets);
+	check_loaded(desc, msg_cmds[0], 3);
+}
+
+void test_spi_engine_offload_long_message(void)
+{
+	struct spi_engine_program program;
+	uint32_t len = SE_LONG_CMDS + SPI_ENGINE_PROGRAM_OVERHEAD;
+
+	engine_start(&desc, 0);
+	TEST_ASSERT_TRUE(len > SPI_ENGINE_MAX_PROGRAM_LEN);
+	TEST_ASSERT_EQUAL_INT(-EINVAL, spi_engine_compile_message(desc,
+			      long_cmds, SE_LONG_CMDS, &program));
+
+	transfer(desc, msg(long_cmds, SE_LONG_CMDS));
+	TEST_ASSERT_EQUAL_UINT32(len, fake_spi_engine.cmd_len);
+	TEST_ASSERT_EQUAL_HEX32(SPI_ENGINE_CMD_SYNC(0x01),
+				fake_spi_engine.cmd_mem[len - 1]);
+	TEST_ASSERT_EQUAL_UINT32(SE_LONG_CMDS / 3, fake_spi_engine.sdo_len);
+	TEST_ASSERT_EQUAL_HEX32_ARRAY(msg_data, fake_spi_engine.sdo_mem,
+				      SE_LONG_CMDS / 3);
+
+	/* Not cached: it is written on each transfer */
+	transfer(desc, msg(long_cmds, SE_LONG_CMDS));
+	TEST_ASSERT_EQUAL_UINT32(len + SE_LONG_CMDS / 3,
+				 fake_spi_engine.mem_writes);
+	TEST_ASSERT_EQUAL_INT(-1, cached_slot(desc, long_cmds, SE_LONG_CMDS));
+
+	/* and a short message loaded after it replaces it */
+	transfer(desc, msg(msg_cmds[0], 3));
+	check_loaded(desc, msg_cmds[0], 3);
+}
+
+void test_spi_engine_offload_benchmark(void)
+{
+	struct spi_engine_offload_message m[2] = {
+		msg(msg_cmds[0], 3), msg(msg_cmds[1], 3)
+	};
+	struct spi_engine_offload_message l = msg(long_cmds, SE_LONG_CMDS);
+
+	engine_start(&desc, 0);
+
+	bench("same message", m, 1);
+	bench("two messages", m, 2);
+	bench("long message", &l, 1);
+}
+
+void test_spi_engine_stream_start_errors(void)
+{
+	struct spi_engine_offload_message m = msg(msg_cmds[0], 3);
+	struct spi_engine_offload_stream_param param = {
+		.msg = &m,
+		.samples_per_block = SE_STREAM_SAMPLES,
+		.nb_blocks = 1,
+	};
+
+	/* The ring is refilled from the DMAC interrupt */
+	offload_init.irq_option = IRQ_DISABLED;
+	engine_start(&desc, 0);
+	offload_init.irq_option = IRQ_ENABLED;
+	param.nb_blocks = SE_STREAM_BLOCKS;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, spi_engine_offload_stream_start(desc,
+			      &param));
+
+	TEST_ASSERT_EQUAL_INT(0, spi_engine_offload_init(desc, &offload_init));
+	param.nb_blocks = 1;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, spi_engine_offload_stream_start(desc,
+			      &param));
+	param.nb_blocks = SE_STREAM_BLOCKS;
+	param.samples_per_block = 0;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, spi_engine_offload_stream_start(desc,
+			      &param));
+	TEST_ASSERT_FALSE(fake_spi_engine.offload_enabled);
+	TEST_ASSERT_EQUAL_UINT32(0, fake_dmac.nb_submits);
+}
+
+void test_spi_engine_stream_read(void)
+{
+	struct spi_engine_offload_message m = msg(msg_cmds[0], 3);
+	struct spi_engine_offload_stream_param param = {
+		.msg = &m,
+		.samples_per_block = SE_STREAM_SAMPLES,
+		.nb_blocks = SE_STREAM_BLOCKS,
+	};
+	struct axi_dmac_block_info info;
+	uint8_t block[SE_BLOCK_SIZE];
+	uint8_t data[4];
+	uint32_t i;
+
+	stream_start(&m);
+
+	/* The offload belongs to the stream until it is stopped */
+	TEST_ASSERT_EQUAL_INT(-EBUSY, spi_engine_offload_stream_start(desc,
+			      &param));
+	TEST_ASSERT_EQUAL_INT(-EBUSY, spi_engine_offload_transfer(desc, m, 1));
+	TEST_ASSERT_EQUAL_INT(-EBUSY, spi_engine_write_and_read(desc, data,
+			      sizeof(data)));
+	TEST_ASSERT_TRUE(fake_spi_engine.offload_enabled);
+
+	/* Each read sleeps until the ISR gives a filled block */
+	sem_on_wait = complete_block;
+	for (i = 0; i < 2 * SE_STREAM_BLOCKS; i++) {
+		TEST_ASSERT_EQUAL_INT(0, spi_engine_offload_stream_read(desc,
+				      block, &info, SE_TIMEOUT_MS));
+		TEST_ASSERT_EQUAL_UINT32(i, info.seq);
+		TEST_ASSERT_EQUAL_UINT32(0, info.overruns);
+		TEST_ASSERT_EQUAL_UINT64((i + 1) * SE_TICK, info.timestamp);
+		TEST_ASSERT_EQUAL_HEX8((uint8_t)(i * SE_BLOCK_SIZE), block[0]);
+	}
+	TEST_ASSERT_EQUAL_UINT32(2 * SE_STREAM_BLOCKS, sem_waits);
+	/* The reads sleep on the semaphore, they don't poll */
+	TEST_ASSERT_EQUAL_UINT32(0, fake_delay_us);
+	/* and the blocks are completed through the registered ISR */
+	TEST_ASSERT_EQUAL_UINT32(2 * SE_STREAM_BLOCKS + 1, fake_dmac.nb_irqs);
+}
+
+void test_spi_engine_stream_overrun(void)
+{
+	struct spi_engine_offload_message m = msg(msg_cmds[0], 3);
+	uint8_t block[SE_BLOCK_SIZE];
+
+	stream_start(&m);
+
+	/* Blocks 0 to 2 are overwritten while the reader is late */
+	fake_dmac_complete(SE_STREAM_BLOCKS + 2);
+	stream_read(3, 3);
+	stream_read(4, 3);
+	stream_read(5, 3);
+	TEST_ASSERT_EQUAL_UINT32(3, spi_engine_offload_stream_get_overruns(desc));
+
+	/* No block is filled */
+	TEST_ASSERT_EQUAL_INT(-ETIMEDOUT, spi_engine_offload_stream_read(desc,
+			      block, NULL, SE_TIMEOUT_MS));
+}
+
+void test_spi_engine_stream_stop(void)
+{
+	struct spi_engine_offload_message m = msg(msg_cmds[0], 3);
+	struct spi_engine_offload_stream_param param = {
+		.msg = &m,
+		.samples_per_block = SE_STREAM_SAMPLES,
+		.nb_blocks = SE_STREAM_BLOCKS,
+	};
+	uint8_t block[SE_BLOCK_SIZE];
+
+	stream_start(&m);
+	fake_dmac_complete(1);
+	stream_read(0, 0);
+
+	TEST_ASSERT_EQUAL_INT(0, spi_engine_offload_stream_stop(desc));
+	TEST_ASSERT_FALSE(fake_spi_engine.offload_enabled);
+	TEST_ASSERT_EQUAL_UINT32(0, fake_dmac.nb_queued);
+	TEST_ASSERT_NULL(engine(desc)->stream.buf);
+	TEST_ASSERT_EQUAL_INT(0, spi_engine_offload_stream_stop(desc));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, spi_engine_offload_stream_read(desc,
+			      block, NULL, SE_TIMEOUT_MS));
+
+	/* The offload is free again, and still holds the message */
+	fake_dmac.discard = true;
+	fake_dmac.irq_handler = NULL;
+	transfer(desc, m);
+	TEST_ASSERT_EQUAL_UINT32(0, fake_spi_engine.mem_writes);
+
+	/* A new stream starts over */
+	fake_dmac.discard = false;
+	fake_dmac.irq_handler = spi_engine_offload_rx_isr;
+	TEST_ASSERT_EQUAL_INT(0, spi_engine_offload_stream_start(desc, &param));
+	fake_dmac_complete(1);
+	TEST_ASSERT_EQUAL_INT(0, spi_engine_offload_stream_read(desc, block,
+			      NULL, SE_TIMEOUT_MS));
+
+	/* Removing the descriptor stops the stream and frees the ring */
+	spi_engine_remove(desc);
+	desc = NULL;
+	TEST_ASSERT_FALSE(fake_spi_engine.offload_enabled);
+}
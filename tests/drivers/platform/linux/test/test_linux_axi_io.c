@@ -0,0 +1,186 @@
+/***************************************************************************//**
+ *   @file   test_linux_axi_io.c
+ *   @brief  Unit tests and benchmark of the Linux AXI IO register windows,
+ *           run on the anonymous memory mock backend.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "linux_axi_io.h"
+#include <stdio.h>
+#include <time.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define AXI_IO_BASE		0x44a00000
+#define AXI_IO_OTHER_BASE	0x44a10000
+#define AXI_IO_BENCH_READS	1000000
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+	TEST_ASSERT_EQUAL_INT(0, linux_axi_io_release());
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_linux_axi_io_read_write(void)
+{
+	uint32_t data;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_write(AXI_IO_BASE, 0x10,
+			      0x12345678));
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_read(AXI_IO_BASE, 0x10, &data));
+	TEST_ASSERT_EQUAL_HEX32(0x12345678, data);
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_axi_io_read(AXI_IO_BASE, 0x10,
+			      NULL));
+}
+
+void test_linux_axi_io_multi(void)
+{
+	uint32_t wr[8], rd[8];
+	uint32_t i;
+
+	for (i = 0; i < 8; i++)
+		wr[i] = 0xa5a50000 | i;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_write_multi(AXI_IO_BASE, 0x100,
+			      wr, 8));
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_read_multi(AXI_IO_BASE, 0x100,
+			      rd, 8));
+	TEST_ASSERT_EQUAL_HEX32_ARRAY(wr, rd, 8);
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_axi_io_read_multi(AXI_IO_BASE,
+			      0x100, rd, 0));
+}
+
+void test_linux_axi_io_exec(void)
+{
+	uint32_t old = 0, data = 0;
+	NO_OS_DECLARE_AXI_IO_BATCH(batch, AXI_IO_BASE, 2);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_write(AXI_IO_BASE, 0x20,
+			      0xffff0000));
+
+	/* Three operations in a batch of two also exercise the flush */
+	no_os_axi_io_batch_add(&batch, NO_OS_AXI_IO_OP_UPDATE, 0x20, 0x00ffff00,
+			       0x00123400, &old);
+	no_os_axi_io_batch_write(&batch, 0x24, 0xcafe);
+	no_os_axi_io_batch_read(&batch, 0x20, &data);
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_batch_exec(&batch));
+
+	TEST_ASSERT_EQUAL_HEX32(0xffff0000, old);
+	TEST_ASSERT_EQUAL_HEX32(0xff123400, data);
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_read(AXI_IO_BASE, 0x24, &data));
+	TEST_ASSERT_EQUAL_HEX32(0xcafe, data);
+}
+
+void test_linux_axi_io_window_growth(void)
+{
+	uint32_t far = LINUX_AXI_IO_WINDOW_SIZE + 0x1000;
+	uint32_t data;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_write(AXI_IO_BASE, 0x4,
+			      0xdeadbeef));
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_write(AXI_IO_BASE,
+			      LINUX_AXI_IO_WINDOW_SIZE - 4, 0x5a5a5a5a));
+
+	/* Past the first mapping: the window is replaced by a larger one */
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_write(AXI_IO_BASE, far,
+			      0x600dcafe));
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_read(AXI_IO_BASE, far, &data));
+	TEST_ASSERT_EQUAL_HEX32(0x600dcafe, data);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_read(AXI_IO_BASE, 0x4, &data));
+	TEST_ASSERT_EQUAL_HEX32(0xdeadbeef, data);
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_read(AXI_IO_BASE,
+			      LINUX_AXI_IO_WINDOW_SIZE - 4, &data));
+	TEST_ASSERT_EQUAL_HEX32(0x5a5a5a5a, data);
+}
+
+void test_linux_axi_io_bases(void)
+{
+	uint32_t data;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_write(AXI_IO_BASE, 0x0, 1));
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_write(AXI_IO_OTHER_BASE, 0x0, 2));
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_read(AXI_IO_BASE, 0x0, &data));
+	TEST_ASSERT_EQUAL_UINT32(1, data);
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_read(AXI_IO_OTHER_BASE, 0x0,
+			      &data));
+	TEST_ASSERT_EQUAL_UINT32(2, data);
+}
+
+void test_linux_axi_io_bench(void)
+{
+	uint32_t acc = 0, data = 0, i;
+	clock_t start;
+	char msg[80];
+	double sec;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_axi_io_write(AXI_IO_BASE, 0x0, 1));
+
+	start = clock();
+	for (i = 0; i < AXI_IO_BENCH_READS; i++) {
+		no_os_axi_io_read(AXI_IO_BASE, 0x0, &data);
+		acc += data;
+	}
+	sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+	if (sec <= 0)
+		sec = 1.0 / CLOCKS_PER_SEC;
+
+	TEST_ASSERT_EQUAL_UINT32(AXI_IO_BENCH_READS, acc);
+	snprintf(msg, sizeof(msg), "single register reads: %.1f M/s",
+		 AXI_IO_BENCH_READS / sec / 1e6);
+	TEST_MESSAGE(msg);
+}
@@ -0,0 +1,196 @@
+/***************************************************************************//**
+ *   @file   test_linux_semaphore.c
+ *   @brief  Unit tests of the pthread based no_os_semaphore implementation.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "linux_semaphore.h"
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+/* Long enough to never expire when a token is given */
+#define SEM_WAIT_MS		5000
+#define SEM_TIMEOUT_MS		50
+/* Delay of the giving thread, so that the taker is already waiting */
+#define SEM_GIVE_DELAY_US	20000
+
+static void *sem;
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static uint32_t now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void *give_thread(void *arg)
+{
+	usleep(SEM_GIVE_DELAY_US);
+	no_os_semaphore_give(sem);
+
+	return NULL;
+}
+
+static void *give_from_isr_thread(void *arg)
+{
+	usleep(SEM_GIVE_DELAY_US);
+	no_os_semaphore_give_from_isr(sem);
+
+	return NULL;
+}
+
+static void empty_sem(void)
+{
+	TEST_ASSERT_EQUAL_INT(0, no_os_semaphore_take_timeout(sem, 0));
+	TEST_ASSERT_EQUAL_INT(-ETIMEDOUT, no_os_semaphore_take_timeout(sem, 0));
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	sem = NULL;
+	no_os_semaphore_init(&sem);
+	TEST_ASSERT_NOT_NULL(sem);
+}
+
+void tearDown(void)
+{
+	no_os_semaphore_remove(sem);
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_linux_semaphore_init_one_token(void)
+{
+	void *first = sem;
+
+	/* A second init of the same handle keeps it */
+	no_os_semaphore_init(&sem);
+	TEST_ASSERT_EQUAL_PTR(first, sem);
+
+	empty_sem();
+}
+
+void test_linux_semaphore_counts(void)
+{
+	int i;
+
+	empty_sem();
+	for (i = 0; i < 3; i++)
+		no_os_semaphore_give(sem);
+	for (i = 0; i < 3; i++)
+		TEST_ASSERT_EQUAL_INT(0, no_os_semaphore_take_timeout(sem, 0));
+	TEST_ASSERT_EQUAL_INT(-ETIMEDOUT, no_os_semaphore_take_timeout(sem, 0));
+}
+
+void test_linux_semaphore_timeout(void)
+{
+	uint32_t start;
+
+	empty_sem();
+	start = now_ms();
+	TEST_ASSERT_EQUAL_INT(-ETIMEDOUT,
+			      no_os_semaphore_take_timeout(sem, SEM_TIMEOUT_MS));
+	/* Only the lower bound, the scheduler decides when the waiter runs */
+	TEST_ASSERT_TRUE(now_ms() - start >= SEM_TIMEOUT_MS);
+}
+
+void test_linux_semaphore_give_wakes_waiter(void)
+{
+	pthread_t thread;
+
+	empty_sem();
+	TEST_ASSERT_EQUAL_INT(0, pthread_create(&thread, NULL, give_thread,
+						NULL));
+	TEST_ASSERT_EQUAL_INT(0, no_os_semaphore_take_timeout(sem, SEM_WAIT_MS));
+	pthread_join(thread, NULL);
+	TEST_ASSERT_EQUAL_INT(-ETIMEDOUT, no_os_semaphore_take_timeout(sem, 0));
+}
+
+void test_linux_semaphore_take_blocks(void)
+{
+	pthread_t thread;
+
+	empty_sem();
+	TEST_ASSERT_EQUAL_INT(0, pthread_create(&thread, NULL, give_thread,
+						NULL));
+	no_os_semaphore_take(sem);
+	pthread_join(thread, NULL);
+	TEST_ASSERT_EQUAL_INT(-ETIMEDOUT, no_os_semaphore_take_timeout(sem, 0));
+}
+
+void test_linux_semaphore_give_from_isr(void)
+{
+	pthread_t thread;
+
+	empty_sem();
+	TEST_ASSERT_EQUAL_INT(0, pthread_create(&thread, NULL,
+						give_from_isr_thread, NULL));
+	TEST_ASSERT_EQUAL_INT(0, no_os_semaphore_take_timeout(sem, SEM_WAIT_MS));
+	pthread_join(thread, NULL);
+}
+
+void test_linux_semaphore_null(void)
+{
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_semaphore_take_timeout(NULL, 0));
+	/* The other calls ignore a NULL semaphore */
+	no_os_semaphore_take(NULL);
+	no_os_semaphore_give(NULL);
+	no_os_semaphore_give_from_isr(NULL);
+	no_os_semaphore_remove(NULL);
+}
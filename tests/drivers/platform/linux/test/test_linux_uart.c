@@ -0,0 +1,261 @@
+/***************************************************************************//**
+ *   @file   test_linux_uart.c
+ *   @brief  Unit tests and benchmark of the Linux UART driver, run on a
+ *           pseudo terminal.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+#include "unity.h"
+#include "linux_uart.h"
+#include "no_os_alloc.h"
+#include "no_os_circular_buffer.h"
+#include "no_os_error.h"
+#include "no_os_util.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define UART_TIMEOUT_MS		2000
+/* Number of bytes sent through the pseudo terminal by the benchmark */
+#define UART_BENCH_BYTES	(1024 * 1024)
+#define UART_BENCH_CHUNK	4096
+
+/* Master side of the pseudo terminal, standing for the remote end */
+static int master;
+static struct no_os_uart_desc *uart;
+static struct linux_uart_init_param linux_param;
+static struct no_os_uart_init_param uart_param = {
+	.baud_rate = 115200,
+	.size = NO_OS_UART_CS_8,
+	.parity = NO_OS_UART_PAR_NO,
+	.stop = NO_OS_UART_STOP_1_BIT,
+	.extra = &linux_param,
+};
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static uint32_t now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int uart_init(bool asynchronous_rx)
+{
+	uart_param.asynchronous_rx = asynchronous_rx;
+
+	return linux_uart_ops.init(&uart, &uart_param);
+}
+
+/* Read with read_nonblocking until len bytes are received */
+static void uart_recv(uint8_t *buf, uint32_t len)
+{
+	uint32_t start = now_ms(), got = 0;
+	int32_t ret;
+
+	while (got < len) {
+		ret = linux_uart_ops.read_nonblocking(uart, buf + got,
+						      len - got);
+		if (ret > 0)
+			got += ret;
+		else
+			TEST_ASSERT_EQUAL_INT(-EAGAIN, ret);
+		TEST_ASSERT_TRUE(now_ms() - start < UART_TIMEOUT_MS);
+	}
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+	TEST_ASSERT_TRUE(master >= 0);
+	TEST_ASSERT_EQUAL_INT(0, grantpt(master));
+	TEST_ASSERT_EQUAL_INT(0, unlockpt(master));
+	/* linux_uart opens /dev/"device_id" */
+	linux_param.device_id = ptsname(master) + strlen("/dev/");
+	uart = NULL;
+}
+
+void tearDown(void)
+{
+	if (uart)
+		TEST_ASSERT_EQUAL_INT(0, linux_uart_ops.remove(uart));
+	close(master);
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_linux_uart_ring_read(void)
+{
+	uint8_t buf[16] = {0};
+
+	TEST_ASSERT_EQUAL_INT(0, uart_init(true));
+	TEST_ASSERT_NOT_NULL(uart->rx_ring);
+
+	/* Nothing received yet */
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, linux_uart_ops.read_nonblocking(uart,
+			      buf, sizeof(buf)));
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, linux_uart_ops.read(uart, buf,
+			      sizeof(buf)));
+
+	/* The bytes received so far are returned, not a full buffer */
+	TEST_ASSERT_EQUAL_INT(5, write(master, "hello", 5));
+	uart_recv(buf, 5);
+	TEST_ASSERT_EQUAL_STRING("hello", buf);
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, linux_uart_ops.read(uart, buf,
+			      sizeof(buf)));
+}
+
+void test_linux_uart_blocking_read(void)
+{
+	uint8_t buf[8] = {0};
+
+	TEST_ASSERT_EQUAL_INT(0, uart_init(false));
+	TEST_ASSERT_NULL(uart->rx_ring);
+
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, linux_uart_ops.read_nonblocking(uart,
+			      buf, sizeof(buf)));
+
+	/* read waits for the whole length and returns the byte count */
+	TEST_ASSERT_EQUAL_INT(4, write(master, "abcd", 4));
+	TEST_ASSERT_EQUAL_INT(4, linux_uart_ops.read(uart, buf, 4));
+	TEST_ASSERT_EQUAL_STRING("abcd", buf);
+}
+
+void test_linux_uart_write(void)
+{
+	uint32_t start, got = 0;
+	char buf[16] = {0};
+	int ret;
+
+	TEST_ASSERT_EQUAL_INT(0, uart_init(true));
+
+	TEST_ASSERT_EQUAL_INT(6, linux_uart_ops.write(uart,
+			      (const uint8_t *)"no-OS\n", 6));
+	TEST_ASSERT_EQUAL_INT(3, linux_uart_ops.write_nonblocking(uart,
+			      (const uint8_t *)"abc", 3));
+
+	start = now_ms();
+	while (got < 9) {
+		ret = read(master, buf + got, sizeof(buf) - got);
+		if (ret > 0)
+			got += ret;
+		TEST_ASSERT_TRUE(now_ms() - start < UART_TIMEOUT_MS);
+	}
+	TEST_ASSERT_EQUAL_STRING("no-OS\nabc", buf);
+}
+
+void test_linux_uart_bad_param(void)
+{
+	uart_param.baud_rate = 12345;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, uart_init(false));
+	uart_param.baud_rate = 115200;
+
+	linux_param.device_id = "no-such-tty";
+	TEST_ASSERT_EQUAL_INT(-ENOENT, uart_init(false));
+}
+
+void test_linux_uart_bench(void)
+{
+	uint8_t *tx, *rx;
+	uint32_t sent = 0, got = 0, i, start;
+	struct timespec t0, t1;
+	char msg[80];
+	double sec;
+	int32_t ret;
+
+	tx = no_os_malloc(UART_BENCH_BYTES);
+	rx = no_os_malloc(UART_BENCH_BYTES);
+	TEST_ASSERT_NOT_NULL(tx);
+	TEST_ASSERT_NOT_NULL(rx);
+	for (i = 0; i < UART_BENCH_BYTES; i++)
+		tx[i] = i * 7;
+
+	TEST_ASSERT_EQUAL_INT(0, uart_init(true));
+
+	/* The remote end sends as fast as the tty takes the data */
+	start = now_ms();
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	while (got < UART_BENCH_BYTES) {
+		if (sent < UART_BENCH_BYTES) {
+			ret = write(master, tx + sent,
+				    no_os_min(UART_BENCH_CHUNK,
+					      UART_BENCH_BYTES - sent));
+			if (ret > 0)
+				sent += ret;
+		}
+		ret = linux_uart_ops.read_nonblocking(uart, rx + got,
+						      UART_BENCH_BYTES - got);
+		if (ret > 0)
+			got += ret;
+		if (now_ms() - start > 10 * UART_TIMEOUT_MS)
+			break;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	sec = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+	TEST_ASSERT_EQUAL_UINT32(UART_BENCH_BYTES, got);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(tx, rx, UART_BENCH_BYTES);
+	snprintf(msg, sizeof(msg), "ring backed receive: %.1f MB/s",
+		 UART_BENCH_BYTES / sec / 1e6);
+	TEST_MESSAGE(msg);
+
+	no_os_free(tx);
+	no_os_free(rx);
+}
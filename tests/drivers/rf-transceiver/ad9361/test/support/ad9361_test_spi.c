@@ -0,0 +1,190 @@
+/***************************************************************************//**
+ *   @file   ad9361_test_spi.c
+ *   @brief  Emulated AD9361 SPI register file, used by the tests of the
+ *           AD9361 driver.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/*
+ * Included by the tests, which stub no_os_spi_write_and_read() and
+ * no_os_spi_transfer() with test_spi_write_and_read() and
+ * test_spi_transfer().
+ *
+ * Each device keeps its register file, the number of SPI transfers and a
+ * log of the register writes. The fastlock profiles of both synthesizers are
+ * emulated too: a write to the program control register with the write bit
+ * set stores the program data register in the word selected by the program
+ * address register, and the program read register returns that word.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "ad9361.h"
+#include "unity.h"
+
+/* Length of the log of register writes */
+#define TEST_MAX_WRITES		32
+
+/* Register write, as seen on the bus */
+struct test_write {
+	uint32_t reg;
+	uint8_t val;
+};
+
+struct test_dev {
+	struct no_os_spi_desc spi;
+	uint8_t regs[AD9361_NUM_REGS];
+	uint32_t transfers;
+	struct test_write writes[TEST_MAX_WRITES];
+	uint32_t nb_writes;
+	/* Fastlock profile memory of the RX and TX synthesizers */
+	uint8_t fastlock[2][AD9361_FASTLOCK_PROFILES]
+	[RX_FAST_LOCK_CONFIG_WORD_NUM];
+};
+
+static struct test_dev devs[2];
+
+static struct test_dev *test_dev_get(struct no_os_spi_desc *desc)
+{
+	return desc == &devs[0].spi ? &devs[0] : &devs[1];
+}
+
+/* Fastlock word selected by the program address register of a synthesizer */
+static uint8_t *test_fastlock_word(struct test_dev *dev, bool tx)
+{
+	uint8_t addr = dev->regs[tx ? REG_TX_FAST_LOCK_PROGRAM_ADDR :
+					REG_RX_FAST_LOCK_PROGRAM_ADDR];
+
+	return &dev->fastlock[tx][(addr >> 4) & 0x7][addr & 0xF];
+}
+
+static void test_reg_write(struct test_dev *dev, uint32_t reg, uint8_t val)
+{
+	bool tx = reg == REG_TX_FAST_LOCK_PROGRAM_CTRL;
+
+	dev->regs[reg] = val;
+	if (dev->nb_writes < TEST_MAX_WRITES) {
+		dev->writes[dev->nb_writes].reg = reg;
+		dev->writes[dev->nb_writes].val = val;
+	}
+	dev->nb_writes++;
+
+	if ((tx || reg == REG_RX_FAST_LOCK_PROGRAM_CTRL) &&
+	    (val & RX_FAST_LOCK_PROGRAM_WRITE))
+		*test_fastlock_word(dev, tx) =
+			dev->regs[tx ? REG_TX_FAST_LOCK_PROGRAM_DATA :
+					 REG_RX_FAST_LOCK_PROGRAM_DATA];
+}
+
+static uint8_t test_reg_read(struct test_dev *dev, uint32_t reg)
+{
+	if (reg == REG_RX_FAST_LOCK_PROGRAM_READ)
+		return *test_fastlock_word(dev, false);
+	if (reg == REG_TX_FAST_LOCK_PROGRAM_READ)
+		return *test_fastlock_word(dev, true);
+
+	return dev->regs[reg];
+}
+
+/* Execute an instruction: a 16 bit command followed by up to 8 bytes */
+static void test_spi_exec(struct test_dev *dev, uint8_t *data,
+			  uint32_t bytes_number)
+{
+	uint16_t cmd = (data[0] << 8) | data[1];
+	uint32_t reg = cmd & 0x3FF;
+	uint32_t num = ((cmd >> 12) & 0x7) + 1;
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL_UINT32(num + 2, bytes_number);
+	/* Multi byte transfers count the address down */
+	for (i = 0; i < num; i++) {
+		if (cmd & AD_WRITE)
+			test_reg_write(dev, reg - i, data[2 + i]);
+		else
+			data[2 + i] = test_reg_read(dev, reg - i);
+	}
+}
+
+/* Check the register writes seen on the bus, in order */
+static void test_check_writes(struct test_dev *dev,
+			      const struct test_write *writes, uint32_t nb)
+{
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL_UINT32(nb, dev->nb_writes);
+	for (i = 0; i < nb; i++) {
+		TEST_ASSERT_EQUAL_HEX32(writes[i].reg, dev->writes[i].reg);
+		TEST_ASSERT_EQUAL_HEX8(writes[i].val, dev->writes[i].val);
+	}
+}
+
+static int32_t test_spi_write_and_read(struct no_os_spi_desc *desc,
+				       uint8_t *data, uint16_t bytes_number,
+				       int cmock_num_calls)
+{
+	struct test_dev *dev = test_dev_get(desc);
+
+	dev->transfers++;
+	test_spi_exec(dev, data, bytes_number);
+
+	return 0;
+}
+
+static int32_t test_spi_transfer(struct no_os_spi_desc *desc,
+				 struct no_os_spi_msg *msgs, uint32_t len,
+				 int cmock_num_calls)
+{
+	struct test_dev *dev = test_dev_get(desc);
+	uint32_t i;
+
+	dev->transfers++;
+	for (i = 0; i < len; i++)
+		test_spi_exec(dev, msgs[i].tx_buff, msgs[i].bytes_number);
+
+	return 0;
+}
+
+/* Provided by ad9361_conv.c, which is not needed by the tests */
+int32_t ad9361_hdl_loopback(struct ad9361_rf_phy *phy, bool enable)
+{
+	return 0;
+}
+
+int32_t ad9361_dig_tune(struct ad9361_rf_phy *phy, uint32_t max_freq,
+			enum dig_tune_flags flags)
+{
+	return 0;
+}
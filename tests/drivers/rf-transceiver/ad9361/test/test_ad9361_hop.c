@@ -0,0 +1,310 @@
+/***************************************************************************//**
+ *   @file   test_ad9361_hop.c
+ *   @brief  Unit tests of the AD9361 fast hop tables.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "ad9361.h"
+#include "no_os_alloc.h"
+#include "no_os_util.h"
+#include "mock_ad9361_util.h"
+#include "mock_no_os_delay.h"
+#include "mock_no_os_gpio.h"
+#include "mock_no_os_spi.h"
+#include <string.h>
+#include "ad9361_test_spi.c"
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+/* More frequencies than fastlock profiles */
+#define HOP_NB_FREQS		20
+#define HOP_BASE_MHZ		1000
+#define HOP_STEP_MHZ		10
+/* Profile stored by the user before the table is created */
+#define HOP_USER_PROFILE	0
+/* Time between two reads of the fake time source */
+#define HOP_TIME_NS		1500
+
+static struct ad9361_phy_platform_data pdata;
+static struct ad9361_rf_phy phy;
+static struct ad9361_hop_table *table;
+static uint64_t freqs[HOP_NB_FREQS];
+static uint8_t user_image[RX_FAST_LOCK_CONFIG_WORD_NUM];
+static uint64_t time_ns;
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+/* Tune the TX synthesizer: its integer word holds the frequency in MHz */
+static int32_t hop_clk_set_rate(struct ad9361_rf_phy *p,
+				struct refclk_scale *clk_priv, uint32_t rate,
+				int cmock_num_calls)
+{
+	uint32_t mhz = ad9361_from_clk(rate) / 1000000;
+
+	devs[0].regs[REG_TX_INTEGER_BYTE_0] = mhz;
+	devs[0].regs[REG_TX_INTEGER_BYTE_0 + 1] = mhz >> 8;
+	p->current_tx_lo_freq = rate;
+
+	return 0;
+}
+
+static uint32_t hop_find_first_bit(uint32_t word, int cmock_num_calls)
+{
+	return word ? __builtin_ctz(word) : 32;
+}
+
+static uint64_t hop_get_time_ns(void)
+{
+	time_ns += HOP_TIME_NS;
+
+	return time_ns;
+}
+
+/* Table entry held by the emulated fastlock profile, -1 if none */
+static int32_t hop_profile_freq_index(uint32_t profile)
+{
+	uint8_t *word = devs[0].fastlock[true][profile];
+	uint32_t mhz = word[0] | ((word[1] & 0x7) << 8);
+
+	if (mhz < HOP_BASE_MHZ || (mhz - HOP_BASE_MHZ) % HOP_STEP_MHZ)
+		return -1;
+
+	return (mhz - HOP_BASE_MHZ) / HOP_STEP_MHZ;
+}
+
+static void hop_table_create(void)
+{
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_hop_table_init(&phy, &table, true,
+				freqs, HOP_NB_FREQS));
+}
+
+/* The profile stored by the user is left as it was */
+static void hop_check_user_profile(void)
+{
+	TEST_ASSERT_EQUAL_MEMORY(user_image,
+				 devs[0].fastlock[true][HOP_USER_PROFILE],
+				 sizeof(user_image));
+	TEST_ASSERT_EQUAL_UINT8(FASTLOOK_INIT,
+				phy.fastlock.entry[true][HOP_USER_PROFILE].flags);
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	uint32_t i;
+
+	memset(devs, 0, sizeof(devs));
+	memset(&phy, 0, sizeof(phy));
+	memset(&pdata, 0, sizeof(pdata));
+	phy.spi = &devs[0].spi;
+	phy.pdata = &pdata;
+	table = NULL;
+	time_ns = 0;
+
+	for (i = 0; i < HOP_NB_FREQS; i++)
+		freqs[i] = (HOP_BASE_MHZ + i * HOP_STEP_MHZ) * 1000000ull;
+	for (i = 0; i < RX_FAST_LOCK_CONFIG_WORD_NUM; i++)
+		user_image[i] = 0xA0 + i;
+
+	no_os_spi_write_and_read_StubWithCallback(test_spi_write_and_read);
+	no_os_spi_transfer_StubWithCallback(test_spi_transfer);
+	no_os_clk_set_rate_StubWithCallback(hop_clk_set_rate);
+	find_first_bit_StubWithCallback(hop_find_first_bit);
+
+	/* The LO the tables restore */
+	hop_clk_set_rate(&phy, NULL, ad9361_to_clk(2400000000ull), 0);
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_fastlock_load(&phy, true,
+				HOP_USER_PROFILE, user_image));
+}
+
+void tearDown(void)
+{
+	if (table)
+		TEST_ASSERT_EQUAL_INT32(0, ad9361_hop_table_remove(&phy, table));
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_ad9361_hop_table_init(void)
+{
+	uint32_t i;
+
+	hop_table_create();
+
+	/* Each entry holds the synthesizer state at its frequency */
+	for (i = 0; i < HOP_NB_FREQS; i++)
+		TEST_ASSERT_EQUAL_UINT8((HOP_BASE_MHZ + i * HOP_STEP_MHZ) & 0xFF,
+					table->entries[i].image[0]);
+	TEST_ASSERT_EQUAL_UINT64(ad9361_to_clk(2400000000ull),
+				 phy.current_tx_lo_freq);
+	TEST_ASSERT_EQUAL_HEX8(NO_OS_BIT(HOP_USER_PROFILE),
+			       table->reserved_profiles);
+}
+
+void test_ad9361_hop_table_init_busy(void)
+{
+	uint32_t i;
+
+	/* A single profile left is not enough to hop */
+	for (i = 1; i < AD9361_FASTLOCK_PROFILES - 1; i++)
+		TEST_ASSERT_EQUAL_INT32(0, ad9361_fastlock_load(&phy, true, i,
+					user_image));
+	TEST_ASSERT_EQUAL_INT32(-EBUSY, ad9361_hop_table_init(&phy, &table,
+				true, freqs, HOP_NB_FREQS));
+	TEST_ASSERT_NULL(table);
+}
+
+void test_ad9361_hop_prefetch_free_profiles(void)
+{
+	uint32_t i, transfers;
+	int32_t profile;
+
+	hop_table_create();
+
+	/* The free profiles are used in order, the user one is skipped */
+	for (i = 0; i < AD9361_FASTLOCK_PROFILES - 1; i++) {
+		profile = ad9361_hop_prefetch(&phy, table, i);
+		TEST_ASSERT_EQUAL_INT32(i + 1, profile);
+		TEST_ASSERT_EQUAL_INT32(i, hop_profile_freq_index(profile));
+	}
+
+	/* A loaded entry is not loaded again */
+	transfers = devs[0].transfers;
+	TEST_ASSERT_EQUAL_INT32(3, ad9361_hop_prefetch(&phy, table, 2));
+	TEST_ASSERT_EQUAL_UINT32(transfers, devs[0].transfers);
+
+	TEST_ASSERT_EQUAL_INT32(-EINVAL, ad9361_hop_prefetch(&phy, table,
+				HOP_NB_FREQS));
+	hop_check_user_profile();
+}
+
+void test_ad9361_hop_lru_eviction(void)
+{
+	uint32_t i;
+	int32_t profile;
+
+	hop_table_create();
+	for (i = 0; i < AD9361_FASTLOCK_PROFILES - 1; i++)
+		ad9361_hop_prefetch(&phy, table, i);
+
+	/* Entries 0 and 2 are used again, entry 1 is now the oldest */
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_hop(&phy, table, 0));
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_hop(&phy, table, 2));
+
+	profile = ad9361_hop_prefetch(&phy, table, 7);
+	TEST_ASSERT_EQUAL_INT32(2, profile);
+	TEST_ASSERT_EQUAL_INT32(7, hop_profile_freq_index(profile));
+
+	/* Then entry 3, the oldest entry left, entry 2 is running */
+	profile = ad9361_hop_prefetch(&phy, table, 8);
+	TEST_ASSERT_EQUAL_INT32(4, profile);
+	TEST_ASSERT_EQUAL_INT32(8, hop_profile_freq_index(profile));
+
+	/* Then entry 4, loaded before entry 0 was last used */
+	profile = ad9361_hop_prefetch(&phy, table, 9);
+	TEST_ASSERT_EQUAL_INT32(5, profile);
+	hop_check_user_profile();
+}
+
+void test_ad9361_hop_user_profiles(void)
+{
+	uint32_t i;
+
+	hop_table_create();
+
+	/* Hop through all the entries, several times */
+	for (i = 0; i < 3 * HOP_NB_FREQS; i++) {
+		TEST_ASSERT_EQUAL_INT32(0, ad9361_hop(&phy, table,
+						      (i * 7) % HOP_NB_FREQS));
+		TEST_ASSERT_EQUAL_INT32(-1,
+					table->profile_entry[HOP_USER_PROFILE]);
+		hop_check_user_profile();
+	}
+
+	/* Removing the table keeps the user profile and frees the others */
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_hop_table_remove(&phy, table));
+	table = NULL;
+	hop_check_user_profile();
+	for (i = 1; i < AD9361_FASTLOCK_PROFILES; i++)
+		TEST_ASSERT_EQUAL_UINT8(0, phy.fastlock.entry[true][i].flags);
+}
+
+void test_ad9361_hop_miss(void)
+{
+	int32_t profile;
+
+	hop_table_create();
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_hop_table_set_time_source(table,
+				hop_get_time_ns));
+
+	/* The entry isn't loaded, it is loaded and then recalled */
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_hop(&phy, table, 5));
+	TEST_ASSERT_EQUAL_UINT32(1, table->misses);
+	TEST_ASSERT_EQUAL_UINT32(0, table->hits);
+	profile = phy.fastlock.current_profile[true] - 1;
+	TEST_ASSERT_EQUAL_INT32(5, table->profile_entry[profile]);
+	TEST_ASSERT_EQUAL_INT32(5, hop_profile_freq_index(profile));
+	TEST_ASSERT_EQUAL_UINT64(ad9361_to_clk(freqs[5]),
+				 phy.current_tx_lo_freq);
+	TEST_ASSERT_EQUAL_UINT32(5, table->current);
+
+	/* Then it is a hit */
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_hop(&phy, table, 5));
+	TEST_ASSERT_EQUAL_UINT32(1, table->misses);
+	TEST_ASSERT_EQUAL_UINT32(1, table->hits);
+	TEST_ASSERT_EQUAL_UINT32(2, table->hops);
+
+	TEST_ASSERT_EQUAL_UINT64(HOP_TIME_NS, table->last_latency_ns);
+	TEST_ASSERT_EQUAL_UINT64(2 * HOP_TIME_NS, table->total_latency_ns);
+
+	TEST_ASSERT_EQUAL_INT32(-EINVAL, ad9361_hop(&phy, table,
+				HOP_NB_FREQS));
+	hop_check_user_profile();
+}
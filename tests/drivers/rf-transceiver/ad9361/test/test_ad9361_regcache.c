@@ -0,0 +1,286 @@
+/***************************************************************************//**
+ *   @file   test_ad9361_regcache.c
+ *   @brief  Unit tests of the AD9361 register cache.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "ad9361.h"
+#include "ad9361_util.h"
+#include "no_os_alloc.h"
+#include "no_os_util.h"
+#include "mock_no_os_delay.h"
+#include "mock_no_os_gpio.h"
+#include "mock_no_os_spi.h"
+#include <string.h>
+#include "ad9361_test_spi.c"
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+/* Non-volatile registers, consecutive */
+#define TEST_REG		REG_TX1_ATTEN_0
+#define TEST_NB_REGS		4
+/* Volatile register */
+#define TEST_VOLATILE_REG	REG_GAIN_RX1
+
+static struct ad9361_rf_phy phys[2];
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	uint32_t i;
+
+	memset(devs, 0, sizeof(devs));
+	memset(phys, 0, sizeof(phys));
+	for (i = 0; i < NO_OS_ARRAY_SIZE(phys); i++)
+		phys[i].spi = &devs[i].spi;
+
+	no_os_spi_write_and_read_StubWithCallback(test_spi_write_and_read);
+	no_os_spi_transfer_StubWithCallback(test_spi_transfer);
+}
+
+void tearDown(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < NO_OS_ARRAY_SIZE(phys); i++)
+		TEST_ASSERT_EQUAL_INT32(0, ad9361_regcache_remove(&phys[i]));
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_ad9361_regcache_none(void)
+{
+	struct ad9361_rf_phy *phy = &phys[0];
+
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_regcache_init(phy,
+				AD9361_REGCACHE_NONE));
+	TEST_ASSERT_NULL(phy->regcache);
+
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_spi_write(phy, TEST_REG, 0x5A));
+	TEST_ASSERT_EQUAL_INT32(0x5A, ad9361_spi_read(phy, TEST_REG));
+	TEST_ASSERT_EQUAL_INT32(0x5A, ad9361_spi_read(phy, TEST_REG));
+	TEST_ASSERT_EQUAL_UINT32(3, devs[0].transfers);
+}
+
+void test_ad9361_regcache_write_through(void)
+{
+	struct ad9361_rf_phy *phy = &phys[0];
+	uint8_t buf[TEST_NB_REGS];
+
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_regcache_init(phy,
+				AD9361_REGCACHE_WRITE_THROUGH));
+
+	/* Writes go to the device, reads of written registers don't */
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_spi_write(phy, TEST_REG, 0x5A));
+	TEST_ASSERT_EQUAL_UINT8(0x5A, devs[0].regs[TEST_REG]);
+	TEST_ASSERT_EQUAL_INT32(0x5A, ad9361_spi_read(phy, TEST_REG));
+	TEST_ASSERT_EQUAL_UINT32(1, devs[0].transfers);
+
+	/* A register is read from the device only the first time */
+	devs[0].regs[TEST_REG + 1] = 0xC3;
+	TEST_ASSERT_EQUAL_INT32(0xC3, ad9361_spi_read(phy, TEST_REG + 1));
+	TEST_ASSERT_EQUAL_INT32(0xC3, ad9361_spi_read(phy, TEST_REG + 1));
+	TEST_ASSERT_EQUAL_UINT32(2, devs[0].transfers);
+
+	/* Writes update the cache, multi byte reads are served from it */
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_reg_write(phy, TEST_REG + 1, 0x0F));
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_spi_readm(phy, TEST_REG + 1, buf, 2));
+	TEST_ASSERT_EQUAL_UINT8(0x0F, buf[0]);
+	TEST_ASSERT_EQUAL_UINT8(0x5A, buf[1]);
+	TEST_ASSERT_EQUAL_UINT32(3, devs[0].transfers);
+
+	/* Volatile registers are always read from the device */
+	devs[0].regs[TEST_VOLATILE_REG] = 0x11;
+	TEST_ASSERT_EQUAL_INT32(0x11, ad9361_spi_read(phy, TEST_VOLATILE_REG));
+	devs[0].regs[TEST_VOLATILE_REG] = 0x22;
+	TEST_ASSERT_EQUAL_INT32(0x22, ad9361_spi_read(phy, TEST_VOLATILE_REG));
+	TEST_ASSERT_EQUAL_UINT32(5, devs[0].transfers);
+}
+
+void test_ad9361_regcache_write_back(void)
+{
+	struct ad9361_rf_phy *phy = &phys[0];
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_regcache_init(phy,
+				AD9361_REGCACHE_WRITE_BACK));
+
+	/* Writes are held until the sync */
+	for (i = 0; i < TEST_NB_REGS; i++)
+		TEST_ASSERT_EQUAL_INT32(0, ad9361_spi_write(phy, TEST_REG + i,
+					0x10 + i));
+	TEST_ASSERT_EQUAL_INT32(0x12, ad9361_spi_read(phy, TEST_REG + 2));
+	TEST_ASSERT_EQUAL_UINT32(0, devs[0].transfers);
+	TEST_ASSERT_EQUAL_UINT8(0, devs[0].regs[TEST_REG]);
+
+	/* Consecutive registers are written in one transfer */
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_regcache_sync(phy));
+	TEST_ASSERT_EQUAL_UINT32(1, devs[0].transfers);
+	for (i = 0; i < TEST_NB_REGS; i++)
+		TEST_ASSERT_EQUAL_UINT8(0x10 + i, devs[0].regs[TEST_REG + i]);
+
+	/* A volatile access first writes back the pending registers */
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_spi_write(phy, TEST_REG, 0x77));
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_spi_read(phy, TEST_VOLATILE_REG));
+	TEST_ASSERT_EQUAL_UINT8(0x77, devs[0].regs[TEST_REG]);
+	TEST_ASSERT_EQUAL_UINT32(3, devs[0].transfers);
+
+	/* Nothing is left to write back */
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_regcache_sync(phy));
+	TEST_ASSERT_EQUAL_UINT32(3, devs[0].transfers);
+}
+
+void test_ad9361_regcache_strobes(void)
+{
+	struct ad9361_rf_phy *phy = &phys[0];
+	static const struct test_write writes[] = {
+		{ TEST_REG, 0x01 },
+		/* ENSM pulse through the alert state, as ad9361_ensm_force_state */
+		{ REG_ENSM_CONFIG_1, TO_ALERT | FORCE_ALERT_STATE },
+		{ REG_ENSM_CONFIG_1, FORCE_ALERT_STATE },
+		{ TEST_REG, 0x02 },
+		/* Sleep sequence of ad9361_set_ensm_mode */
+		{ REG_ENSM_CONFIG_1, 0 },
+		{ REG_ENSM_CONFIG_1, ENABLE_ENSM_PIN_CTRL },
+		{ REG_ENSM_CONFIG_1, 0 },
+		/* BBPLL calibration start */
+		{ REG_SDM_CTRL_1, INIT_BB_FO_CAL | BBPLL_RESET_BAR },
+		{ REG_SDM_CTRL_1, BBPLL_RESET_BAR },
+		/* Quadrature calibration soft reset */
+		{ REG_QUAD_CAL_CTRL, QUAD_CAL_SOFT_RESET },
+		{ REG_QUAD_CAL_CTRL, 0 },
+		{ REG_CALIBRATION_CTRL, RX_BB_TUNE_CAL },
+		{ REG_RESET, 1 },
+		{ REG_RESET, 0 },
+		{ REG_SPI_CONF, SOFT_RESET | _SOFT_RESET },
+		{ REG_SPI_CONF, 0 },
+	};
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_regcache_init(phy,
+				AD9361_REGCACHE_WRITE_BACK));
+
+	/*
+	 * Write-back must neither merge the writes to the state machine,
+	 * calibration and reset registers, nor move them before the writes
+	 * issued earlier.
+	 */
+	for (i = 0; i < NO_OS_ARRAY_SIZE(writes); i++)
+		TEST_ASSERT_EQUAL_INT32(0, ad9361_spi_write(phy, writes[i].reg,
+					writes[i].val));
+	/* Only the non-volatile TEST_REG could still be pending */
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_regcache_sync(phy));
+	test_check_writes(&devs[0], writes, NO_OS_ARRAY_SIZE(writes));
+}
+
+void test_ad9361_regcache_queue(void)
+{
+	struct ad9361_rf_phy *phy = &phys[0];
+
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_regcache_init(phy,
+				AD9361_REGCACHE_WRITE_BACK));
+
+	/* Pending registers are written before the queued ones */
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_spi_write(phy, TEST_REG, 0x01));
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_spi_queue_write(phy, TEST_REG, 0x02));
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_spi_queue_write(phy, TEST_REG + 1,
+				0x03));
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_spi_queue_submit(phy));
+	TEST_ASSERT_EQUAL_UINT32(2, devs[0].transfers);
+	TEST_ASSERT_EQUAL_UINT8(0x02, devs[0].regs[TEST_REG]);
+	TEST_ASSERT_EQUAL_UINT8(0x03, devs[0].regs[TEST_REG + 1]);
+
+	/* The queued writes are recorded in the cache */
+	TEST_ASSERT_EQUAL_INT32(0x03, ad9361_spi_read(phy, TEST_REG + 1));
+	TEST_ASSERT_EQUAL_UINT32(2, devs[0].transfers);
+}
+
+void test_ad9361_regcache_bypass_invalidate(void)
+{
+	struct ad9361_rf_phy *phy = &phys[0];
+
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_regcache_init(phy,
+				AD9361_REGCACHE_WRITE_BACK));
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_spi_write(phy, TEST_REG, 0x5A));
+
+	/* Bypassing writes back the pending registers */
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_regcache_bypass(phy, true));
+	TEST_ASSERT_EQUAL_UINT8(0x5A, devs[0].regs[TEST_REG]);
+	devs[0].regs[TEST_REG] = 0x33;
+	TEST_ASSERT_EQUAL_INT32(0x33, ad9361_spi_read(phy, TEST_REG));
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_regcache_bypass(phy, false));
+
+	/* The registers are read again from the device after a reset */
+	TEST_ASSERT_EQUAL_INT32(0x5A, ad9361_spi_read(phy, TEST_REG));
+	ad9361_regcache_invalidate(phy);
+	TEST_ASSERT_EQUAL_INT32(0x33, ad9361_spi_read(phy, TEST_REG));
+}
+
+void test_ad9361_regcache_per_device(void)
+{
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_regcache_init(&phys[0],
+				AD9361_REGCACHE_WRITE_THROUGH));
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_regcache_init(&phys[1],
+				AD9361_REGCACHE_WRITE_BACK));
+	TEST_ASSERT_EQUAL_INT32(-EBUSY, ad9361_regcache_init(&phys[1],
+				AD9361_REGCACHE_WRITE_BACK));
+
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_spi_write(&phys[0], TEST_REG, 0xAA));
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_spi_write(&phys[1], TEST_REG, 0xBB));
+	TEST_ASSERT_EQUAL_INT32(0xAA, ad9361_spi_read(&phys[0], TEST_REG));
+	TEST_ASSERT_EQUAL_INT32(0xBB, ad9361_spi_read(&phys[1], TEST_REG));
+	TEST_ASSERT_EQUAL_UINT32(1, devs[0].transfers);
+	TEST_ASSERT_EQUAL_UINT32(0, devs[1].transfers);
+
+	/* Removing a cache writes back its pending registers */
+	TEST_ASSERT_EQUAL_INT32(0, ad9361_regcache_remove(&phys[1]));
+	TEST_ASSERT_NULL(phys[1].regcache);
+	TEST_ASSERT_EQUAL_UINT8(0xBB, devs[1].regs[TEST_REG]);
+	TEST_ASSERT_EQUAL_UINT8(0xAA, devs[0].regs[TEST_REG]);
+}
@@ -0,0 +1,145 @@
+/***************************************************************************//**
+ *   @file   iio_test_client.c
+ *   @brief  TCP clients of the IIO server, used by the tests of the IIO
+ *           network server.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/*
+ * Included by the tests, which define iio_test_step() to run the server
+ * while a client waits for its reply. The clients connect to the server on
+ * the loopback interface, at IIO_TEST_PORT.
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "unity.h"
+
+#define IIO_TEST_PORT		30431
+/* Longest wait for a reply, only reached when the server is stuck */
+#define IIO_TEST_TIMEOUT_MS	2000
+
+static void iio_test_step(void);
+
+static uint32_t now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Run the server for ms milliseconds */
+static void step_for(uint32_t ms)
+{
+	uint32_t start = now_us();
+
+	while (now_us() - start < ms * 1000)
+		iio_test_step();
+}
+
+static int client_open(void)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(IIO_TEST_PORT),
+		.sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+	};
+	int fd;
+
+	fd = socket(AF_INET, SOCK_STREAM, 0);
+	TEST_ASSERT_TRUE(fd >= 0);
+	TEST_ASSERT_EQUAL_INT(0, connect(fd, (struct sockaddr *)&addr,
+					 sizeof(addr)));
+
+	return fd;
+}
+
+static void client_send(int fd, const char *cmd)
+{
+	TEST_ASSERT_EQUAL_INT(strlen(cmd), send(fd, cmd, strlen(cmd), 0));
+}
+
+/* Run the server until len bytes are received on fd */
+static void client_recv(int fd, char *buf, uint32_t len)
+{
+	uint32_t start = now_us(), got = 0;
+	ssize_t ret;
+
+	while (1) {
+		ret = recv(fd, buf + got, len - got, MSG_DONTWAIT);
+		if (ret > 0)
+			got += ret;
+		else
+			TEST_ASSERT_TRUE(ret < 0 && errno == EAGAIN);
+		if (got == len)
+			break;
+		TEST_ASSERT_TRUE(now_us() - start <
+				 IIO_TEST_TIMEOUT_MS * 1000);
+		iio_test_step();
+	}
+}
+
+static void client_expect(int fd, const char *res)
+{
+	char buf[64] = {0};
+
+	client_recv(fd, buf, strlen(res));
+	TEST_ASSERT_EQUAL_STRING(res, buf);
+}
+
+/* Nothing was received on fd yet */
+static void client_expect_none(int fd)
+{
+	char c;
+
+	TEST_ASSERT_EQUAL_INT(-1, recv(fd, &c, 1, MSG_DONTWAIT));
+	TEST_ASSERT_EQUAL_INT(EAGAIN, errno);
+}
+
+static void client_close(int fd)
+{
+	/* The client closes first, so the server port is left reusable */
+	close(fd);
+	step_for(20);
+}
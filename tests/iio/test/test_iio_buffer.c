@@ -0,0 +1,220 @@
+/***************************************************************************//**
+ *   @file   test_iio_buffer.c
+ *   @brief  Tests of the IIO buffer blocks used by DMA capable devices.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "iio.h"
+#include "iiod.h"
+#include "no_os_alloc.h"
+#include "no_os_circular_buffer.h"
+#include "no_os_error.h"
+#include "no_os_list.h"
+#include "no_os_mutex.h"
+#include "no_os_uart.h"
+#include "no_os_util.h"
+#include <string.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define BUF_BLOCK_SIZE		16
+#define BUF_NB_BLOCKS		4
+
+static int8_t buf_mem[BUF_BLOCK_SIZE * BUF_NB_BLOCKS];
+static struct no_os_circular_buffer buf_cb;
+static struct iio_buffer buf;
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+/* Fill a block as a DMA transfer would */
+static void block_fill(void *addr, uint8_t val)
+{
+	memset(addr, val, BUF_BLOCK_SIZE);
+}
+
+/* Read the oldest block of data and check its content */
+static void block_expect(uint8_t val)
+{
+	uint8_t data[BUF_BLOCK_SIZE], exp[BUF_BLOCK_SIZE];
+
+	memset(exp, val, sizeof(exp));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_read(&buf_cb, data, sizeof(data)));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(exp, data, sizeof(data));
+}
+
+static uint32_t cb_size(void)
+{
+	uint32_t size;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_size(&buf_cb, &size));
+
+	return size;
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_cfg(&buf_cb, buf_mem,
+					      sizeof(buf_mem)));
+	memset(&buf, 0, sizeof(buf));
+	buf.buf = &buf_cb;
+	buf.size = BUF_BLOCK_SIZE;
+	buf.nb_blocks = BUF_NB_BLOCKS;
+	buf.dir = IIO_DIRECTION_INPUT;
+}
+
+void tearDown(void) {}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_iio_buffer_input_rotation(void)
+{
+	void *addr[BUF_NB_BLOCKS];
+	void *next;
+	uint32_t i;
+
+	/* Consecutive blocks, all of them can be queued */
+	for (i = 0; i < BUF_NB_BLOCKS; i++) {
+		TEST_ASSERT_EQUAL_INT(0, iio_buffer_get_block(&buf, &addr[i]));
+		TEST_ASSERT_TRUE(addr[i] == buf_mem + i * BUF_BLOCK_SIZE);
+		block_fill(addr[i], i);
+	}
+
+	/* Once a block is done and read, it is the next one returned */
+	for (i = 0; i < 3 * BUF_NB_BLOCKS; i++) {
+		TEST_ASSERT_EQUAL_INT(0, iio_buffer_block_done(&buf));
+		TEST_ASSERT_EQUAL_UINT32(BUF_BLOCK_SIZE, cb_size());
+		block_expect(i);
+		TEST_ASSERT_EQUAL_INT(0, iio_buffer_get_block(&buf, &next));
+		TEST_ASSERT_TRUE(next == addr[i % BUF_NB_BLOCKS]);
+		block_fill(next, i + BUF_NB_BLOCKS);
+	}
+	TEST_ASSERT_EQUAL_UINT32(BUF_NB_BLOCKS, buf.queued_blocks);
+}
+
+void test_iio_buffer_out_of_order(void)
+{
+	void *first, *second;
+
+	TEST_ASSERT_EQUAL_INT(0, iio_buffer_get_block(&buf, &first));
+	TEST_ASSERT_EQUAL_INT(0, iio_buffer_get_block(&buf, &second));
+
+	/*
+	 * The second transfer finishes first. Its data isn't readable before
+	 * the first block's, done always completes the oldest block.
+	 */
+	block_fill(second, 2);
+	TEST_ASSERT_EQUAL_UINT32(0, cb_size());
+	block_fill(first, 1);
+	TEST_ASSERT_EQUAL_INT(0, iio_buffer_block_done(&buf));
+	TEST_ASSERT_EQUAL_UINT32(BUF_BLOCK_SIZE, cb_size());
+	block_expect(1);
+
+	/* The second block becomes readable only when it is marked done */
+	TEST_ASSERT_EQUAL_UINT32(0, cb_size());
+	TEST_ASSERT_EQUAL_INT(0, iio_buffer_block_done(&buf));
+	block_expect(2);
+}
+
+void test_iio_buffer_all_held(void)
+{
+	void *addr;
+	uint32_t i;
+
+	/* No block queued: nothing to complete */
+	TEST_ASSERT_EQUAL_INT(-EINVAL, iio_buffer_block_done(&buf));
+
+	for (i = 0; i < BUF_NB_BLOCKS; i++)
+		TEST_ASSERT_EQUAL_INT(0, iio_buffer_get_block(&buf, &addr));
+	/* Every block is held by the device */
+	TEST_ASSERT_EQUAL_INT(-EBUSY, iio_buffer_get_block(&buf, &addr));
+
+	TEST_ASSERT_EQUAL_INT(0, iio_buffer_block_done(&buf));
+	TEST_ASSERT_EQUAL_INT(0, iio_buffer_get_block(&buf, &addr));
+
+	for (i = 0; i < BUF_NB_BLOCKS; i++)
+		TEST_ASSERT_EQUAL_INT(0, iio_buffer_block_done(&buf));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, iio_buffer_block_done(&buf));
+
+	/* A single block buffer is one block, not none */
+	buf.nb_blocks = 0;
+	TEST_ASSERT_EQUAL_INT(0, iio_buffer_get_block(&buf, &addr));
+	TEST_ASSERT_EQUAL_INT(-EBUSY, iio_buffer_get_block(&buf, &addr));
+}
+
+void test_iio_buffer_output(void)
+{
+	uint8_t data[2 * BUF_BLOCK_SIZE];
+	void *addr;
+
+	buf.dir = IIO_DIRECTION_OUTPUT;
+
+	/* Underflow: no data pushed yet */
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, iio_buffer_get_block(&buf, &addr));
+
+	memset(data, 1, BUF_BLOCK_SIZE);
+	memset(data + BUF_BLOCK_SIZE, 2, BUF_BLOCK_SIZE);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(&buf_cb, data, sizeof(data)));
+
+	/* Blocks hold the data in the order it was written */
+	TEST_ASSERT_EQUAL_INT(0, iio_buffer_get_block(&buf, &addr));
+	TEST_ASSERT_EQUAL_UINT8(1, *(uint8_t *)addr);
+	TEST_ASSERT_EQUAL_INT(0, iio_buffer_get_block(&buf, &addr));
+	TEST_ASSERT_EQUAL_UINT8(2, *(uint8_t *)addr);
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, iio_buffer_get_block(&buf, &addr));
+
+	/* Done blocks are consumed from the buffer */
+	TEST_ASSERT_EQUAL_INT(0, iio_buffer_block_done(&buf));
+	TEST_ASSERT_EQUAL_UINT32(BUF_BLOCK_SIZE, cb_size());
+	TEST_ASSERT_EQUAL_INT(0, iio_buffer_block_done(&buf));
+	TEST_ASSERT_EQUAL_UINT32(0, cb_size());
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, iio_buffer_get_block(&buf, &addr));
+}
@@ -0,0 +1,325 @@
+/***************************************************************************//**
+ *   @file   test_iio_demux.c
+ *   @brief  Unit tests and throughput benchmark of the IIO demux kernels.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "iio_demux.h"
+#include "mock_iio.h"
+#include "no_os_util.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define DEMUX_MAX_CH		8
+/* Not a multiple of the vector widths, so the scalar tail is used too */
+#define DEMUX_NB_SCANS		67
+#define DEMUX_BENCH_SCANS	16384
+#define DEMUX_BENCH_ROUNDS	200
+
+static struct scan_type types[] = {
+	{ .sign = 's', .realbits = 12, .storagebits = 16 },
+	{ .sign = 's', .realbits = 12, .storagebits = 16, .shift = 4 },
+	{ .sign = 'u', .realbits = 14, .storagebits = 16, .is_big_endian = true },
+	{ .sign = 's', .realbits = 16, .storagebits = 16, .is_big_endian = true },
+	{ .sign = 'u', .realbits = 6, .storagebits = 8, .shift = 1 },
+	{ .sign = 's', .realbits = 24, .storagebits = 32, .shift = 8,
+	  .is_big_endian = true },
+	{ .sign = 's', .realbits = 32, .storagebits = 32 },
+	{ .sign = 'u', .realbits = 32, .storagebits = 32 },
+};
+
+static struct iio_channel channels[DEMUX_MAX_CH];
+static uint8_t scans[DEMUX_BENCH_SCANS * DEMUX_MAX_CH * 4];
+static int32_t out[DEMUX_MAX_CH][DEMUX_BENCH_SCANS];
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+/* Same layout as iio.c, channels aligned to their storage size */
+static uint32_t scan_layout(struct iio_channel *ch, uint32_t mask,
+			    uint32_t *offsets, int cmock_num_calls)
+{
+	uint32_t cnt = 0, largest = 1, length;
+
+	for (; mask; mask >>= 1, ch++) {
+		if (!(mask & 1))
+			continue;
+		length = ch->scan_type->storagebits / 8;
+		if (length > largest)
+			largest = length;
+		cnt = (cnt + length - 1) / length * length + length;
+		if (offsets)
+			*offsets++ = cnt - length;
+	}
+
+	return (cnt + largest - 1) / largest * largest;
+}
+
+/* Bit by bit reference of a sample conversion */
+static int32_t demux_ref(const uint8_t *p, const struct scan_type *type)
+{
+	uint32_t bytes = type->storagebits / 8;
+	uint32_t raw = 0, i;
+
+	for (i = 0; i < bytes; i++)
+		if (type->is_big_endian)
+			raw = (raw << 8) | p[i];
+		else
+			raw |= (uint32_t)p[i] << (8 * i);
+
+	raw >>= type->shift;
+	if (type->realbits < 32) {
+		raw &= (1u << type->realbits) - 1;
+		if (type->sign == 's' && (raw >> (type->realbits - 1)))
+			raw |= ~((1u << type->realbits) - 1);
+	}
+
+	return (int32_t)raw;
+}
+
+/* Demux nb_ch channels and compare each sample against the reference */
+static void demux_check(uint32_t nb_ch, enum iio_demux_fmt fmt)
+{
+	uint32_t offsets[DEMUX_MAX_CH];
+	void *outs[DEMUX_MAX_CH];
+	uint32_t mask = (1u << nb_ch) - 1;
+	uint32_t stride, ch, i;
+	int32_t ref;
+	float val;
+
+	for (ch = 0; ch < nb_ch; ch++)
+		outs[ch] = out[ch];
+	stride = scan_layout(channels, mask, offsets, 0);
+
+	TEST_ASSERT_EQUAL_INT(0, iio_demux(channels, mask, scans,
+					   DEMUX_NB_SCANS, fmt, outs));
+
+	for (ch = 0; ch < nb_ch; ch++) {
+		for (i = 0; i < DEMUX_NB_SCANS; i++) {
+			ref = demux_ref(scans + i * stride + offsets[ch],
+					channels[ch].scan_type);
+			switch (fmt) {
+			case IIO_DEMUX_INT16:
+				TEST_ASSERT_EQUAL_INT16((int16_t)ref,
+							((int16_t *)out[ch])[i]);
+				break;
+			case IIO_DEMUX_INT32:
+				TEST_ASSERT_EQUAL_INT32(ref, out[ch][i]);
+				break;
+			default:
+				if (channels[ch].scan_type->sign == 'u')
+					val = (float)(uint32_t)ref;
+				else
+					val = (float)ref;
+				TEST_ASSERT_EQUAL_FLOAT(val,
+							((float *)out[ch])[i]);
+				break;
+			}
+		}
+	}
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	uint32_t i;
+
+	srand(1);
+	for (i = 0; i < sizeof(scans); i++)
+		scans[i] = rand();
+
+	iio_scan_layout_StubWithCallback(scan_layout);
+}
+
+void tearDown(void)
+{
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_iio_demux_scan_types(void)
+{
+	uint32_t t, nb_ch, ch;
+	int fmt;
+
+	for (t = 0; t < NO_OS_ARRAY_SIZE(types); t++) {
+		for (ch = 0; ch < DEMUX_MAX_CH; ch++)
+			channels[ch].scan_type = &types[t];
+		for (nb_ch = 1; nb_ch <= DEMUX_MAX_CH; nb_ch++)
+			for (fmt = IIO_DEMUX_INT16; fmt <= IIO_DEMUX_FLOAT; fmt++)
+				demux_check(nb_ch, fmt);
+	}
+}
+
+void test_iio_demux_mixed_layout(void)
+{
+	int fmt;
+
+	/* 16 bit samples next to 8 and 32 bit ones, with padding */
+	channels[0].scan_type = &types[4];
+	channels[1].scan_type = &types[0];
+	channels[2].scan_type = &types[5];
+	channels[3].scan_type = &types[2];
+
+	for (fmt = IIO_DEMUX_INT16; fmt <= IIO_DEMUX_FLOAT; fmt++)
+		demux_check(4, fmt);
+}
+
+void test_iio_demux_channel_stride(void)
+{
+	int32_t ref;
+	uint32_t i;
+
+	/* One 16 bit channel in 10 byte scans, wider than the vector kernels */
+	TEST_ASSERT_EQUAL_INT(0, iio_demux_channel(scans + 4, 10,
+			      DEMUX_NB_SCANS, &types[1], IIO_DEMUX_INT32,
+			      out[0]));
+	for (i = 0; i < DEMUX_NB_SCANS; i++) {
+		ref = demux_ref(scans + 4 + i * 10, &types[1]);
+		TEST_ASSERT_EQUAL_INT32(ref, out[0][i]);
+	}
+}
+
+void test_iio_demux_channel_unaligned(void)
+{
+	int32_t ref;
+	uint32_t i;
+	int fmt;
+
+	/* 16 bit samples at odd addresses, loaded one by one by the kernels */
+	for (fmt = IIO_DEMUX_INT16; fmt <= IIO_DEMUX_FLOAT; fmt++) {
+		TEST_ASSERT_EQUAL_INT(0, iio_demux_channel(scans + 1, 9,
+				      DEMUX_NB_SCANS, &types[2], fmt, out[0]));
+		for (i = 0; i < DEMUX_NB_SCANS; i++) {
+			ref = demux_ref(scans + 1 + i * 9, &types[2]);
+			switch (fmt) {
+			case IIO_DEMUX_INT16:
+				TEST_ASSERT_EQUAL_INT16((int16_t)ref,
+							((int16_t *)out[0])[i]);
+				break;
+			case IIO_DEMUX_INT32:
+				TEST_ASSERT_EQUAL_INT32(ref, out[0][i]);
+				break;
+			default:
+				TEST_ASSERT_EQUAL_FLOAT((float)ref,
+							((float *)out[0])[i]);
+				break;
+			}
+		}
+	}
+}
+
+void test_iio_demux_unsigned_32(void)
+{
+	uint32_t raw = 0xfffffffe;
+	float val;
+
+	/* Above INT32_MAX, converted as unsigned */
+	TEST_ASSERT_EQUAL_INT(0, iio_demux_channel(&raw, 4, 1, &types[7],
+			      IIO_DEMUX_FLOAT, &val));
+	TEST_ASSERT_EQUAL_FLOAT(4294967294.0f, val);
+}
+
+void test_iio_demux_invalid(void)
+{
+	struct scan_type bad = { .sign = 's', .realbits = 12,
+		       .storagebits = 16, .shift = 8
+	};
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, iio_demux_channel(scans, 2, 1, &bad,
+			      IIO_DEMUX_INT32, out[0]));
+	bad.storagebits = 24;
+	bad.shift = 0;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, iio_demux_channel(scans, 3, 1, &bad,
+			      IIO_DEMUX_INT32, out[0]));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, iio_demux_channel(NULL, 2, 1, &types[0],
+			      IIO_DEMUX_INT32, out[0]));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, iio_demux(NULL, 1, scans, 1,
+			      IIO_DEMUX_INT32, NULL));
+}
+
+void test_iio_demux_bench(void)
+{
+	static const char *const names[] = { "int16", "int32", "float" };
+	void *outs[DEMUX_MAX_CH];
+	uint32_t nb_ch, ch, r, mask;
+	clock_t start;
+	char msg[80];
+	double sec;
+	int fmt;
+
+	for (ch = 0; ch < DEMUX_MAX_CH; ch++) {
+		channels[ch].scan_type = &types[0];
+		outs[ch] = out[ch];
+	}
+
+	for (nb_ch = 1; nb_ch <= DEMUX_MAX_CH; nb_ch *= 2) {
+		mask = (1u << nb_ch) - 1;
+		for (fmt = IIO_DEMUX_INT16; fmt <= IIO_DEMUX_FLOAT; fmt++) {
+			start = clock();
+			for (r = 0; r < DEMUX_BENCH_ROUNDS; r++)
+				iio_demux(channels, mask, scans,
+					  DEMUX_BENCH_SCANS, fmt, outs);
+			sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+			if (sec <= 0)
+				sec = 1.0 / CLOCKS_PER_SEC;
+			snprintf(msg, sizeof(msg),
+				 "12 bit in 16, %"PRIu32" ch to %s: %.0f MB/s",
+				 nb_ch, names[fmt], DEMUX_BENCH_ROUNDS *
+				 (double)DEMUX_BENCH_SCANS * nb_ch * 2 /
+				 sec / 1e6);
+			TEST_MESSAGE(msg);
+		}
+	}
+}
@@ -0,0 +1,652 @@
+/***************************************************************************//**
+ *   @file   test_iio_server.c
+ *   @brief  Tests and benchmarks of the IIO network server.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "iio.h"
+#include "iiod.h"
+#include "no_os_alloc.h"
+#include "no_os_circular_buffer.h"
+#include "no_os_list.h"
+#include "no_os_mutex.h"
+#include "no_os_uart.h"
+#include "no_os_util.h"
+#include "tcp_socket.h"
+#include "linux_socket.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "iio_test_client.c"
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+/* Number of commands sent at once by the pipelining benchmark */
+#define SRV_PIPELINE_CMDS	256
+/* Number of channels of each direction of the wide device */
+#define SRV_WIDE_CH		32
+/* Number of READ commands of the lookup benchmark */
+#define SRV_LOOKUP_CMDS		2000
+/* Time the server is observed for by the CPU usage benchmarks */
+#define SRV_OBSERVE_MS		200
+/* Number of READ commands of each client of the connections benchmark */
+#define SRV_CLIENT_ROUNDS	500
+#define SRV_SAMPLES		64
+/* Number of events fired by the trigger benchmark */
+#define SRV_TRIG_EVENTS		100000
+
+static char srv_value[16];
+
+static struct iio_attribute srv_attrs[] = {
+	{ .name = "value" },
+	END_ATTRIBUTES_ARRAY
+};
+
+static struct iio_attribute srv_wide_ch_attrs[] = {
+	{ .name = "raw" },
+	END_ATTRIBUTES_ARRAY
+};
+
+/* Device, debug and buffer attributes sharing the same name */
+static struct iio_attribute srv_wide_attrs[] = {
+	{ .name = "sampling_frequency", .priv = 'd' },
+	END_ATTRIBUTES_ARRAY
+};
+
+static struct iio_attribute srv_wide_debug_attrs[] = {
+	{ .name = "sampling_frequency", .priv = 'g' },
+	END_ATTRIBUTES_ARRAY
+};
+
+static struct iio_attribute srv_wide_buffer_attrs[] = {
+	{ .name = "sampling_frequency", .priv = 'b' },
+	END_ATTRIBUTES_ARRAY
+};
+
+static struct iio_channel srv_wide_channels[2 * SRV_WIDE_CH];
+
+static struct scan_type srv_scan = {
+	.sign = 'u', .realbits = 16, .storagebits = 16
+};
+
+static struct iio_channel srv_slow_channels[] = {
+	{
+		.name = "voltage0", .ch_type = IIO_VOLTAGE, .channel = 0,
+		.scan_index = 0, .scan_type = &srv_scan, .indexed = true,
+	},
+};
+
+/* Set when the slow device has data */
+static bool srv_slow_ready;
+
+/* Trigger handler calls of the sync, async and untriggered devices */
+static uint32_t srv_trig_calls[3];
+
+static struct iio_trigger srv_trig_async = { .is_synchronous = false };
+static struct iio_trigger srv_trig_sync = { .is_synchronous = true };
+
+static struct iio_device srv_device;
+static struct iio_device srv_trig_device;
+static struct iio_device srv_wide_device;
+static struct iio_device srv_slow_device;
+static struct iio_desc *iio;
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static int srv_show(void *device, char *buf, uint32_t len,
+		    const struct iio_ch_info *channel, intptr_t priv)
+{
+	return snprintf(buf, len, "%s", srv_value);
+}
+
+static int srv_store(void *device, char *buf, uint32_t len,
+		     const struct iio_ch_info *channel, intptr_t priv)
+{
+	snprintf(srv_value, sizeof(srv_value), "%.*s", (int)len, buf);
+
+	return len;
+}
+
+/* Channel attributes show the channel direction and index */
+static int srv_wide_ch_show(void *device, char *buf, uint32_t len,
+			    const struct iio_ch_info *channel, intptr_t priv)
+{
+	return snprintf(buf, len, "%c%d", channel->ch_out ? 'o' : 'i',
+			channel->ch_num);
+}
+
+/* Device attributes show their type */
+static int srv_wide_show(void *device, char *buf, uint32_t len,
+			 const struct iio_ch_info *channel, intptr_t priv)
+{
+	return snprintf(buf, len, "%c", (char)priv);
+}
+
+/* Still in progress until srv_slow_ready is set, as a DMA not done yet */
+static int32_t srv_slow_submit(struct iio_device_data *dev_data)
+{
+	uint16_t sample = 0;
+	uint32_t i, nb_scans;
+
+	if (!srv_slow_ready)
+		return -EINPROGRESS;
+
+	nb_scans = dev_data->buffer->size / dev_data->buffer->bytes_per_scan;
+	for (i = 0; i < nb_scans; i++)
+		iio_buffer_push_scan(dev_data->buffer, &sample);
+
+	return 0;
+}
+
+static int32_t srv_trig_handler(struct iio_device_data *dev_data)
+{
+	(*(uint32_t *)dev_data->dev)++;
+
+	return 0;
+}
+
+static void srv_wide_init(void)
+{
+	struct iio_channel *ch;
+	uint32_t i;
+
+	for (i = 0; i < NO_OS_ARRAY_SIZE(srv_wide_channels); i++) {
+		ch = &srv_wide_channels[i];
+		ch->ch_type = IIO_VOLTAGE;
+		ch->channel = i % SRV_WIDE_CH;
+		ch->ch_out = i >= SRV_WIDE_CH;
+		ch->indexed = true;
+		ch->attributes = srv_wide_ch_attrs;
+	}
+	srv_wide_ch_attrs[0].show = srv_wide_ch_show;
+	srv_wide_attrs[0].show = srv_wide_show;
+	srv_wide_debug_attrs[0].show = srv_wide_show;
+	srv_wide_buffer_attrs[0].show = srv_wide_show;
+	srv_wide_device.num_ch = NO_OS_ARRAY_SIZE(srv_wide_channels);
+	srv_wide_device.channels = srv_wide_channels;
+	srv_wide_device.attributes = srv_wide_attrs;
+	srv_wide_device.debug_attributes = srv_wide_debug_attrs;
+	srv_wide_device.buffer_attributes = srv_wide_buffer_attrs;
+}
+
+static uint32_t cpu_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+	return ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void iio_test_step(void)
+{
+	iio_step(iio);
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	static struct tcp_socket_init_param socket_param = {
+		.net = &linux_net,
+	};
+	struct iio_device_init devs[] = {
+		{ .name = "test", .dev = &srv_device, .dev_descriptor = &srv_device },
+		{
+			.name = "wide", .dev = &srv_wide_device,
+			.dev_descriptor = &srv_wide_device
+		},
+		{
+			.name = "slow", .dev = &srv_slow_device,
+			.dev_descriptor = &srv_slow_device
+		},
+		{
+			.name = "on_sync", .dev = &srv_trig_calls[0],
+			.dev_descriptor = &srv_trig_device,
+			.trigger_id = "trigger1"
+		},
+		{
+			.name = "on_async", .dev = &srv_trig_calls[1],
+			.dev_descriptor = &srv_trig_device,
+			.trigger_id = "trigger0"
+		},
+		{
+			.name = "untriggered", .dev = &srv_trig_calls[2],
+			.dev_descriptor = &srv_trig_device
+		},
+	};
+	struct iio_trigger_init trigs[] = {
+		{ .name = "async", .descriptor = &srv_trig_async },
+		{ .name = "sync", .descriptor = &srv_trig_sync },
+	};
+	struct iio_init_param param = {
+		.phy_type = USE_NETWORK,
+		.tcp_socket_init_param = &socket_param,
+		.devs = devs,
+		.nb_devs = NO_OS_ARRAY_SIZE(devs),
+		.trigs = trigs,
+		.nb_trigs = NO_OS_ARRAY_SIZE(trigs),
+	};
+
+	strcpy(srv_value, "42");
+	memset(srv_trig_calls, 0, sizeof(srv_trig_calls));
+	/* The server socket is kept for all the tests */
+	if (iio)
+		return;
+
+	srv_attrs[0].show = srv_show;
+	srv_attrs[0].store = srv_store;
+	srv_device.attributes = srv_attrs;
+	srv_wide_init();
+	srv_slow_device.num_ch = NO_OS_ARRAY_SIZE(srv_slow_channels);
+	srv_slow_device.channels = srv_slow_channels;
+	srv_slow_device.submit = srv_slow_submit;
+	srv_trig_device.trigger_handler = srv_trig_handler;
+	TEST_ASSERT_EQUAL_INT(0, iio_init(&iio, &param));
+}
+
+void tearDown(void) {}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_iio_server_pipelined_commands(void)
+{
+	int fd = client_open();
+
+	/* The WRITE payload and the next command come in the same segment */
+	client_send(fd, "READ iio:device0 value\r\n"
+		    "WRITE iio:device0 value 2\r\n17"
+		    "READ iio:device0 value\r\n");
+	client_expect(fd, "2\n42\n2\n2\n17\n");
+
+	client_close(fd);
+}
+
+void test_iio_server_split_command(void)
+{
+	const char *cmd = "READ iio:device0 value\r\n";
+	int fd = client_open();
+	uint32_t i;
+
+	/* A command received a byte at a time */
+	for (i = 0; cmd[i]; i++) {
+		TEST_ASSERT_EQUAL_INT(1, send(fd, cmd + i, 1, 0));
+		step_for(1);
+	}
+	client_expect(fd, "2\n42\n");
+
+	client_close(fd);
+}
+
+void test_iio_server_pipeline_benchmark(void)
+{
+	static char cmds[SRV_PIPELINE_CMDS * 25 + 1];
+	static char res[SRV_PIPELINE_CMDS * 5];
+	uint32_t i, start, us;
+	char msg[64];
+	int fd = client_open();
+
+	cmds[0] = '\0';
+	for (i = 0; i < SRV_PIPELINE_CMDS; i++)
+		strcat(cmds, "READ iio:device0 value\r\n");
+
+	start = now_us();
+	client_send(fd, cmds);
+	client_recv(fd, res, sizeof(res));
+	us = no_os_max(now_us() - start, 1u);
+
+	for (i = 0; i < SRV_PIPELINE_CMDS; i++)
+		TEST_ASSERT_EQUAL_MEMORY("2\n42\n", res + i * 5, 5);
+
+	snprintf(msg, sizeof(msg), "%u pipelined READs in %u us, %u cmds/s",
+		 SRV_PIPELINE_CMDS, us,
+		 (uint32_t)(SRV_PIPELINE_CMDS * 1000000ull / us));
+	TEST_MESSAGE(msg);
+
+	client_close(fd);
+}
+
+void test_iio_server_channel_lookup(void)
+{
+	int fd = client_open();
+
+	client_send(fd, "READ iio:device1 INPUT voltage0 raw\r\n");
+	client_expect(fd, "2\ni0\n");
+	client_send(fd, "READ iio:device1 INPUT voltage31 raw\r\n");
+	client_expect(fd, "3\ni31\n");
+	/* Same channel id, other direction */
+	client_send(fd, "READ iio:device1 OUTPUT voltage31 raw\r\n");
+	client_expect(fd, "3\no31\n");
+	client_send(fd, "READ iio:device1 OUTPUT voltage7 raw\r\n");
+	client_expect(fd, "2\no7\n");
+
+	client_close(fd);
+}
+
+void test_iio_server_attr_lookup(void)
+{
+	int fd = client_open();
+
+	/* Same name, different attribute types */
+	client_send(fd, "READ iio:device1 sampling_frequency\r\n");
+	client_expect(fd, "1\nd\n");
+	client_send(fd, "READ iio:device1 DEBUG sampling_frequency\r\n");
+	client_expect(fd, "1\ng\n");
+	client_send(fd, "READ iio:device1 BUFFER sampling_frequency\r\n");
+	client_expect(fd, "1\nb\n");
+	/* The attributes of the other device are not mixed in */
+	client_send(fd, "READ iio:device0 value\r\n");
+	client_expect(fd, "2\n42\n");
+
+	client_close(fd);
+}
+
+void test_iio_server_lookup_errors(void)
+{
+	int fd = client_open();
+
+	client_send(fd, "READ iio:device1 INPUT voltage32 raw\r\n");
+	client_expect(fd, "-2\n");
+	client_send(fd, "READ iio:device1 INPUT voltage0 scale\r\n");
+	client_expect(fd, "-2\n");
+	client_send(fd, "READ iio:device1 value\r\n");
+	client_expect(fd, "-2\n");
+	/* Device ids must match exactly */
+	client_send(fd, "READ iio:device99 value\r\n");
+	client_expect(fd, "-19\n");
+	client_send(fd, "READ iio:device00 value\r\n");
+	client_expect(fd, "-19\n");
+
+	client_close(fd);
+}
+
+void test_iio_server_lookup_benchmark(void)
+{
+	char res[6];
+	uint32_t i, start, us;
+	char msg[64];
+	int fd = client_open();
+
+	/* The last channel of the wide device, one command at a time */
+	start = now_us();
+	for (i = 0; i < SRV_LOOKUP_CMDS; i++) {
+		client_send(fd, "READ iio:device1 OUTPUT voltage31 raw\r\n");
+		client_recv(fd, res, sizeof(res));
+		TEST_ASSERT_EQUAL_MEMORY("3\no31\n", res, sizeof(res));
+	}
+	us = no_os_max(now_us() - start, 1u);
+
+	snprintf(msg, sizeof(msg), "%u channel attribute READs, %u us each",
+		 SRV_LOOKUP_CMDS, us / SRV_LOOKUP_CMDS);
+	TEST_MESSAGE(msg);
+
+	client_close(fd);
+}
+
+void test_iio_server_idle(void)
+{
+	uint32_t start = now_us(), cpu = cpu_us(), steps = 0;
+	char msg[80];
+
+	/* iio_step sleeps until a socket is ready or the step timeout */
+	while (now_us() - start < SRV_OBSERVE_MS * 1000) {
+		iio_step(iio);
+		steps++;
+	}
+
+	snprintf(msg, sizeof(msg), "idle for %u ms: %u us CPU, %u steps",
+		 SRV_OBSERVE_MS, cpu_us() - cpu, steps);
+	TEST_MESSAGE(msg);
+}
+
+void test_iio_server_wait_device(void)
+{
+	char data[SRV_SAMPLES * 2 + 13];
+	int a = client_open(), b = client_open();
+	uint32_t cpu;
+	char msg[80];
+
+	srv_slow_ready = false;
+	client_send(a, "OPEN iio:device2 64 1\r\n");
+	client_expect(a, "0\n");
+	client_send(a, "READBUF iio:device2 128\r\n");
+
+	/* CPU used while the connection waits for its device */
+	cpu = cpu_us();
+	step_for(SRV_OBSERVE_MS);
+	snprintf(msg, sizeof(msg), "waiting for a device for %u ms: %u us CPU",
+		 SRV_OBSERVE_MS, cpu_us() - cpu);
+	TEST_MESSAGE(msg);
+	/* No reply before the device is done */
+	client_expect_none(a);
+
+	/* Other connections are served meanwhile */
+	client_send(b, "READ iio:device0 value\r\n");
+	client_expect(b, "2\n42\n");
+
+	srv_slow_ready = true;
+	client_recv(a, data, sizeof(data));
+	TEST_ASSERT_EQUAL_MEMORY("128\n00000001\n", data, 13);
+	client_send(a, "CLOSE iio:device2\r\n");
+	client_expect(a, "0\n");
+
+	close(b);
+	client_close(a);
+}
+
+void test_iio_server_latency(void)
+{
+	uint32_t i, start, us;
+	char msg[64];
+	int fd = client_open();
+
+	/*
+	 * The replies are written in several parts. Nagle's algorithm and
+	 * delayed ACKs would hold the last part back for tens of ms.
+	 */
+	start = now_us();
+	for (i = 0; i < 100; i++) {
+		client_send(fd, "READ iio:device0 value\r\n");
+		client_expect(fd, "2\n42\n");
+	}
+	us = (now_us() - start) / 100;
+
+	snprintf(msg, sizeof(msg), "READ round trip: %u us", us);
+	TEST_MESSAGE(msg);
+
+	client_close(fd);
+}
+
+void test_iio_server_clients_benchmark(void)
+{
+	int fds[IIOD_MAX_CONNECTIONS];
+	uint32_t i, r, start, cpu, us, max_us = 0, total_us = 0;
+	char msg[96];
+
+	for (i = 0; i < IIOD_MAX_CONNECTIONS; i++)
+		fds[i] = client_open();
+
+	/* All the clients send a command, then wait for all the replies */
+	cpu = cpu_us();
+	for (r = 0; r < SRV_CLIENT_ROUNDS; r++) {
+		start = now_us();
+		for (i = 0; i < IIOD_MAX_CONNECTIONS; i++)
+			client_send(fds[i], "READ iio:device0 value\r\n");
+		for (i = 0; i < IIOD_MAX_CONNECTIONS; i++)
+			client_expect(fds[i], "2\n42\n");
+		us = now_us() - start;
+		max_us = no_os_max(max_us, us);
+		total_us += us;
+	}
+	cpu = cpu_us() - cpu;
+
+	snprintf(msg, sizeof(msg),
+		 "%u clients: round %u us avg, %u us max, %.2f us CPU per READ",
+		 IIOD_MAX_CONNECTIONS, total_us / SRV_CLIENT_ROUNDS, max_us,
+		 cpu / (double)(SRV_CLIENT_ROUNDS * IIOD_MAX_CONNECTIONS));
+	TEST_MESSAGE(msg);
+
+	for (i = 0; i < IIOD_MAX_CONNECTIONS - 1; i++)
+		close(fds[i]);
+	client_close(fds[i]);
+}
+
+void test_iio_server_sync_trigger(void)
+{
+	/* Only the devices using the trigger are handled, right away */
+	TEST_ASSERT_EQUAL_INT(0, iio_process_trigger_type(iio, "sync"));
+	TEST_ASSERT_EQUAL_UINT32(1, srv_trig_calls[0]);
+	TEST_ASSERT_EQUAL_UINT32(0, srv_trig_calls[1]);
+	TEST_ASSERT_EQUAL_UINT32(0, srv_trig_calls[2]);
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, iio_process_trigger_type(iio, "none"));
+}
+
+void test_iio_server_async_trigger(void)
+{
+	/* Handled in the next iio_step */
+	TEST_ASSERT_EQUAL_INT(0, iio_process_trigger_type(iio, "async"));
+	TEST_ASSERT_EQUAL_UINT32(0, srv_trig_calls[1]);
+	iio_step(iio);
+	TEST_ASSERT_EQUAL_UINT32(1, srv_trig_calls[1]);
+
+	/* Once per firing, not again in the following steps */
+	iio_step(iio);
+	TEST_ASSERT_EQUAL_UINT32(1, srv_trig_calls[1]);
+
+	/* Firings before a step are handled once */
+	iio_process_trigger_type(iio, "async");
+	iio_process_trigger_type(iio, "async");
+	iio_step(iio);
+	TEST_ASSERT_EQUAL_UINT32(2, srv_trig_calls[1]);
+	TEST_ASSERT_EQUAL_UINT32(0, srv_trig_calls[0]);
+	TEST_ASSERT_EQUAL_UINT32(0, srv_trig_calls[2]);
+}
+
+void test_iio_server_settrig(void)
+{
+	int fd = client_open();
+
+	/* Move the untriggered device to the sync trigger */
+	client_send(fd, "SETTRIG iio:device5 trigger1\r\n");
+	client_expect(fd, "8\n");
+	client_send(fd, "GETTRIG iio:device5\r\n");
+	client_expect(fd, "4\nsync\n");
+	iio_process_trigger_type(iio, "sync");
+	TEST_ASSERT_EQUAL_UINT32(1, srv_trig_calls[0]);
+	TEST_ASSERT_EQUAL_UINT32(1, srv_trig_calls[2]);
+
+	/* Move the sync device to the async trigger */
+	client_send(fd, "SETTRIG iio:device3 trigger0\r\n");
+	client_expect(fd, "8\n");
+	iio_process_trigger_type(iio, "sync");
+	TEST_ASSERT_EQUAL_UINT32(1, srv_trig_calls[0]);
+	TEST_ASSERT_EQUAL_UINT32(2, srv_trig_calls[2]);
+	iio_process_trigger_type(iio, "async");
+	iio_step(iio);
+	TEST_ASSERT_EQUAL_UINT32(2, srv_trig_calls[0]);
+	TEST_ASSERT_EQUAL_UINT32(1, srv_trig_calls[1]);
+
+	/* Restore the triggers of the devices */
+	client_send(fd, "SETTRIG iio:device3 trigger1\r\n");
+	client_expect(fd, "8\n");
+	client_send(fd, "SETTRIG iio:device5\r\n");
+	client_expect(fd, "0\n");
+	client_send(fd, "GETTRIG iio:device5\r\n");
+	client_expect(fd, "0\n");
+	iio_process_trigger_type(iio, "sync");
+	TEST_ASSERT_EQUAL_UINT32(3, srv_trig_calls[0]);
+	TEST_ASSERT_EQUAL_UINT32(2, srv_trig_calls[2]);
+
+	client_close(fd);
+}
+
+void test_iio_server_trigger_benchmark(void)
+{
+	uint32_t i, start, sync_us, async_us;
+	char msg[80];
+
+	start = now_us();
+	for (i = 0; i < SRV_TRIG_EVENTS; i++)
+		iio_process_trigger_type(iio, "sync");
+	sync_us = now_us() - start;
+	TEST_ASSERT_EQUAL_UINT32(SRV_TRIG_EVENTS, srv_trig_calls[0]);
+
+	/* An asynchronous event is handled by the iio_step it wakes up */
+	start = now_us();
+	for (i = 0; i < SRV_TRIG_EVENTS; i++) {
+		iio_process_trigger_type(iio, "async");
+		iio_step(iio);
+	}
+	async_us = now_us() - start;
+	TEST_ASSERT_EQUAL_UINT32(SRV_TRIG_EVENTS, srv_trig_calls[1]);
+
+	snprintf(msg, sizeof(msg),
+		 "trigger events: sync %.2f M/s, async %.2f M/s",
+		 SRV_TRIG_EVENTS / (double)no_os_max(sync_us, 1),
+		 SRV_TRIG_EVENTS / (double)no_os_max(async_us, 1));
+	TEST_MESSAGE(msg);
+}
+
+void test_iio_server_binary_disabled(void)
+{
+	int fd = client_open();
+
+	/* Neither framing is built in without IIOD_NOOS_BINARY */
+	client_send(fd, "BINARY\r\n");
+	client_expect(fd, "-22\n");
+	client_send(fd, "NOOS_BINARY\r\n");
+	client_expect(fd, "-22\n");
+	client_send(fd, "READ iio:device0 value\r\n");
+	client_expect(fd, "2\n42\n");
+
+	client_close(fd);
+}
@@ -0,0 +1,268 @@
+/***************************************************************************//**
+ *   @file   test_iio_threaded.c
+ *   @brief  Tests of the IIO server running device callbacks on workers.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "iio.h"
+#include "iiod.h"
+#include "no_os_alloc.h"
+#include "no_os_circular_buffer.h"
+#include "no_os_list.h"
+#include "no_os_mutex.h"
+#include "no_os_uart.h"
+#include "no_os_util.h"
+#include "tcp_socket.h"
+#include "linux_socket.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+#include "iio_test_client.c"
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+/* Time the server is run for between the steps of a test */
+#define THR_RUN_MS		30
+#define THR_SAMPLES		64
+
+static struct scan_type thr_scan = {
+	.sign = 'u', .realbits = 16, .storagebits = 16
+};
+
+static struct iio_attribute thr_attrs[] = {
+	{ .name = "value", .show = NULL },
+	END_ATTRIBUTES_ARRAY
+};
+
+static struct iio_channel thr_channels[] = {
+	{
+		.name = "voltage0", .ch_type = IIO_VOLTAGE, .channel = 0,
+		.scan_index = 0, .scan_type = &thr_scan, .indexed = true,
+	},
+};
+
+static struct iio_device thr_device;
+static struct iio_desc *iio;
+
+/* The refills wait until the test opens the gate, as for a DMA transfer */
+static pthread_mutex_t thr_gate_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t thr_gate_cond = PTHREAD_COND_INITIALIZER;
+static bool thr_gate_open;
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static int thr_show(void *device, char *buf, uint32_t len,
+		    const struct iio_ch_info *channel, intptr_t priv)
+{
+	return snprintf(buf, len, "42");
+}
+
+/*
+ * Runs on the device worker and waits for the gate, at most
+ * IIO_TEST_TIMEOUT_MS so that a stuck test still ends.
+ */
+static int32_t thr_submit(struct iio_device_data *dev_data)
+{
+	uint16_t sample = 0;
+	uint32_t i, nb_scans;
+	struct timespec deadline;
+
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += IIO_TEST_TIMEOUT_MS / 1000;
+	pthread_mutex_lock(&thr_gate_lock);
+	while (!thr_gate_open)
+		if (pthread_cond_timedwait(&thr_gate_cond, &thr_gate_lock,
+					   &deadline))
+			break;
+	pthread_mutex_unlock(&thr_gate_lock);
+
+	nb_scans = dev_data->buffer->size / dev_data->buffer->bytes_per_scan;
+	for (i = 0; i < nb_scans; i++)
+		iio_buffer_push_scan(dev_data->buffer, &sample);
+
+	return 0;
+}
+
+static void thr_gate_set(bool open)
+{
+	pthread_mutex_lock(&thr_gate_lock);
+	thr_gate_open = open;
+	pthread_cond_broadcast(&thr_gate_cond);
+	pthread_mutex_unlock(&thr_gate_lock);
+}
+
+static void iio_test_step(void)
+{
+	iio_step(iio);
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	static struct tcp_socket_init_param socket_param = {
+		.net = &linux_net,
+	};
+	struct iio_device_init devs[] = {
+		{ .name = "slow", .dev = &thr_device, .dev_descriptor = &thr_device },
+		{ .name = "fast", .dev = &thr_device, .dev_descriptor = &thr_device },
+	};
+	struct iio_init_param param = {
+		.phy_type = USE_NETWORK,
+		.tcp_socket_init_param = &socket_param,
+		.devs = devs,
+		.nb_devs = NO_OS_ARRAY_SIZE(devs),
+	};
+
+	thr_gate_set(false);
+	/* The server socket is kept for all the tests */
+	if (iio)
+		return;
+
+	thr_attrs[0].show = thr_show;
+	thr_device.num_ch = NO_OS_ARRAY_SIZE(thr_channels);
+	thr_device.channels = thr_channels;
+	thr_device.attributes = thr_attrs;
+	thr_device.submit = thr_submit;
+	TEST_ASSERT_EQUAL_INT(0, iio_init(&iio, &param));
+}
+
+void tearDown(void)
+{
+	thr_gate_set(true);
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_iio_threaded_step_during_refill(void)
+{
+	char data[THR_SAMPLES * 2 + 13];
+	int a = client_open(), b = client_open();
+
+	client_send(a, "OPEN iio:device0 64 1\r\n");
+	client_expect(a, "0\n");
+	client_send(a, "READBUF iio:device0 128\r\n");
+	step_for(THR_RUN_MS);
+
+	/* Another device is served while the refill waits */
+	client_send(b, "READ iio:device1 value\r\n");
+	client_expect(b, "2\n42\n");
+	client_expect_none(a);
+
+	/* The response header is "128\n00000001\n" */
+	thr_gate_set(true);
+	client_recv(a, data, sizeof(data));
+	TEST_ASSERT_EQUAL_MEMORY("128\n00000001\n", data, 13);
+
+	client_send(a, "CLOSE iio:device0\r\n");
+	client_expect(a, "0\n");
+
+	close(b);
+	client_close(a);
+}
+
+void test_iio_threaded_short_op_during_refill(void)
+{
+	char data[THR_SAMPLES * 2 + 13];
+	int a = client_open(), b = client_open();
+
+	client_send(a, "OPEN iio:device0 64 1\r\n");
+	client_expect(a, "0\n");
+	client_send(a, "READBUF iio:device0 128\r\n");
+	step_for(THR_RUN_MS);
+
+	/*
+	 * Setting the trigger needs the device, so it is answered after the
+	 * refill, without blocking iio_step meanwhile. No trigger is
+	 * registered, hence -ENOENT.
+	 */
+	client_send(b, "SETTRIG iio:device0\r\n");
+	step_for(THR_RUN_MS);
+	client_expect_none(b);
+	client_expect_none(a);
+
+	thr_gate_set(true);
+	client_expect(b, "-2\n");
+	client_recv(a, data, sizeof(data));
+
+	client_send(a, "CLOSE iio:device0\r\n");
+	client_expect(a, "0\n");
+
+	close(b);
+	client_close(a);
+}
+
+void test_iio_threaded_close_during_refill(void)
+{
+	int a = client_open(), b;
+
+	client_send(a, "OPEN iio:device0 64 1\r\n");
+	client_expect(a, "0\n");
+	client_send(a, "READBUF iio:device0 128\r\n");
+	step_for(THR_RUN_MS);
+
+	/* Dropping the connection during its refill doesn't block iio_step */
+	client_close(a);
+	b = client_open();
+	client_send(b, "READ iio:device1 value\r\n");
+	client_expect(b, "2\n42\n");
+
+	/* The job of the dropped connection is released after the refill */
+	thr_gate_set(true);
+	step_for(THR_RUN_MS);
+	client_send(b, "READ iio:device0 value\r\n");
+	client_expect(b, "2\n42\n");
+	client_send(b, "CLOSE iio:device0\r\n");
+	client_expect(b, "0\n");
+
+	client_close(b);
+}
@@ -0,0 +1,388 @@
+/***************************************************************************//**
+ *   @file   test_iiod.c
+ *   @brief  Tests and benchmarks of the IIOD protocol engine, run over a
+ *           local socket pair.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "iiod.h"
+#include "iiod_private.h"
+#include "no_os_error.h"
+#include "no_os_util.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define IIOD_TEST_STEPS		100000
+/* Number of commands sent at once by the receive benchmark */
+#define IIOD_BENCH_CMDS		256
+#define IIOD_BENCH_CMD		"READ dev0 value\r\n"
+#define IIOD_BENCH_RES		"2\n42\n"
+
+/* Server and client ends of the socket pair */
+static int srv_fd, cli_fd;
+/* Number of recv calls made by iiod that returned data */
+static uint32_t recv_calls;
+static char payload[256];
+static char attr_value[16];
+static struct iiod_desc *iiod;
+static uint32_t conn_id;
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+static uint32_t now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int iiod_test_send(struct iiod_ctx *ctx, uint8_t *buf, uint32_t len)
+{
+	ssize_t ret;
+
+	ret = send(srv_fd, buf, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+	if (ret < 0)
+		return errno == EAGAIN ? -EAGAIN : -errno;
+
+	return ret;
+}
+
+static int iiod_test_recv(struct iiod_ctx *ctx, uint8_t *buf, uint32_t len)
+{
+	ssize_t ret;
+
+	ret = recv(srv_fd, buf, len, MSG_DONTWAIT);
+	if (ret < 0)
+		return errno == EAGAIN ? -EAGAIN : -errno;
+	recv_calls++;
+
+	return ret;
+}
+
+static int iiod_test_read_attr(struct iiod_ctx *ctx, const char *device,
+			       struct iiod_attr *attr, char *buf, uint32_t len)
+{
+	if (strcmp(device, "dev0") || strcmp(attr->name, "value"))
+		return -ENOENT;
+
+	return snprintf(buf, len, "%s", attr_value);
+}
+
+static int iiod_test_write_attr(struct iiod_ctx *ctx, const char *device,
+				struct iiod_attr *attr, char *buf, uint32_t len)
+{
+	if (strcmp(device, "dev0") || strcmp(attr->name, "value"))
+		return -ENOENT;
+
+	snprintf(attr_value, sizeof(attr_value), "%.*s", (int)len, buf);
+
+	return len;
+}
+
+static struct iiod_ops iiod_test_ops = {
+	.send = iiod_test_send,
+	.recv = iiod_test_recv,
+	.read_attr = iiod_test_read_attr,
+	.write_attr = iiod_test_write_attr,
+};
+
+static void iiod_test_start(enum physical_link_type phy_type)
+{
+	struct iiod_init_param param = {
+		.ops = &iiod_test_ops,
+		.phy_type = phy_type,
+	};
+	struct iiod_conn_data data = {
+		.buf = payload,
+		.len = sizeof(payload),
+	};
+
+	TEST_ASSERT_EQUAL_INT(0, iiod_init(&iiod, &param));
+	TEST_ASSERT_EQUAL_INT(0, iiod_conn_add(iiod, &data, &conn_id));
+	recv_calls = 0;
+}
+
+static void client_send(const void *buf, uint32_t len)
+{
+	TEST_ASSERT_EQUAL_INT(len, send(cli_fd, buf, len, 0));
+}
+
+/* Step the connection until len bytes are received by the client */
+static void client_recv(void *buf, uint32_t len)
+{
+	uint32_t got = 0, steps = 0;
+	ssize_t ret;
+
+	while (got < len) {
+		TEST_ASSERT_TRUE(steps++ < IIOD_TEST_STEPS);
+		ret = iiod_conn_step(iiod, conn_id);
+		TEST_ASSERT_TRUE(ret == 0 || ret == -EAGAIN);
+		ret = recv(cli_fd, (char *)buf + got, len - got, MSG_DONTWAIT);
+		if (ret > 0)
+			got += ret;
+	}
+}
+
+static void client_expect(const char *res)
+{
+	char buf[64] = {0};
+
+	client_recv(buf, strlen(res));
+	TEST_ASSERT_EQUAL_STRING(res, buf);
+}
+
+/* Send a NOOS_BINARY framed command: header, arguments and data */
+static void bin_send(uint16_t client_id, uint8_t op, const char *args,
+		     const char *data)
+{
+	uint8_t hdr[IIOD_BIN_HDR_SIZE];
+
+	no_os_put_unaligned_le16(client_id, hdr);
+	hdr[2] = op;
+	hdr[3] = 0;
+	no_os_put_unaligned_le32(strlen(args), hdr + 4);
+	client_send(hdr, sizeof(hdr));
+	client_send(args, strlen(args));
+	if (data)
+		client_send(data, strlen(data));
+}
+
+/* Receive a binary response and check its header and data */
+static void bin_expect(uint16_t client_id, uint8_t op, int32_t code,
+		       const char *data)
+{
+	uint8_t hdr[IIOD_BIN_HDR_SIZE];
+	char buf[64] = {0};
+
+	client_recv(hdr, sizeof(hdr));
+	TEST_ASSERT_EQUAL_UINT16(client_id, no_os_get_unaligned_le16(hdr));
+	TEST_ASSERT_EQUAL_HEX8(op | IIOD_BIN_RESPONSE, hdr[2]);
+	TEST_ASSERT_EQUAL_INT32(code, (int32_t)no_os_get_unaligned_le32(hdr + 4));
+	if (!data)
+		return;
+
+	client_recv(buf, strlen(data));
+	TEST_ASSERT_EQUAL_STRING(data, buf);
+}
+
+static void bin_start(void)
+{
+	iiod_test_start(USE_NETWORK);
+	client_send("NOOS_BINARY\r\n", 13);
+	client_expect("0\n");
+}
+
+/* Run the receive benchmark and return the time it took in us */
+static uint32_t bench_recv(enum physical_link_type phy_type, const char *cmds,
+			   char *res, uint32_t res_len)
+{
+	uint32_t start, i;
+
+	iiod_test_start(phy_type);
+	start = now_us();
+	client_send(cmds, strlen(cmds));
+	client_recv(res, res_len);
+	start = no_os_max(now_us() - start, 1u);
+
+	for (i = 0; i < IIOD_BENCH_CMDS; i++)
+		TEST_ASSERT_EQUAL_MEMORY(IIOD_BENCH_RES, res + i * 5, 5);
+	iiod_remove(iiod);
+	iiod = NULL;
+
+	return start;
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	int sv[2];
+
+	TEST_ASSERT_EQUAL_INT(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+	srv_fd = sv[0];
+	cli_fd = sv[1];
+	strcpy(attr_value, "42");
+	iiod = NULL;
+}
+
+void tearDown(void)
+{
+	if (iiod)
+		iiod_remove(iiod);
+	close(srv_fd);
+	close(cli_fd);
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_iiod_pipelined_commands(void)
+{
+	const char *cmds = "READ dev0 value\r\nWRITE dev0 value 2\r\n17"
+			   "READ dev0 value\r\nREAD dev1 value\r\n";
+
+	iiod_test_start(USE_NETWORK);
+	/* The WRITE data and the commands around it come in one recv */
+	client_send(cmds, strlen(cmds));
+	client_expect("2\n42\n2\n2\n17\n-2\n");
+	TEST_ASSERT_EQUAL_INT(1, recv_calls);
+}
+
+void test_iiod_split_command(void)
+{
+	const char *cmd = "READ dev0 value\r\n";
+	uint32_t i;
+
+	iiod_test_start(USE_NETWORK);
+	/* A partial line is kept until the rest of it is received */
+	for (i = 0; cmd[i + 1]; i++) {
+		client_send(cmd + i, 1);
+		TEST_ASSERT_EQUAL_INT(-EAGAIN, iiod_conn_step(iiod, conn_id));
+	}
+	client_send(cmd + i, 1);
+	client_expect("2\n42\n");
+	TEST_ASSERT_EQUAL_INT(strlen(cmd), recv_calls);
+}
+
+void test_iiod_recv_benchmark(void)
+{
+	static char cmds[IIOD_BENCH_CMDS * sizeof(IIOD_BENCH_CMD)];
+	static char res[IIOD_BENCH_CMDS * 5];
+	uint32_t i, bytes, byte_us, byte_calls, buf_us, buf_calls;
+	char msg[128];
+
+	cmds[0] = '\0';
+	for (i = 0; i < IIOD_BENCH_CMDS; i++)
+		strcat(cmds, IIOD_BENCH_CMD);
+	bytes = strlen(cmds);
+
+	/* Before: the local backend still receives a byte per recv call */
+	byte_us = bench_recv(USE_LOCAL_BACKEND, cmds, res, sizeof(res));
+	byte_calls = recv_calls;
+	/* After: the network backend fills the receive buffer at once */
+	buf_us = bench_recv(USE_NETWORK, cmds, res, sizeof(res));
+	buf_calls = recv_calls;
+
+	TEST_ASSERT_EQUAL_INT(bytes, byte_calls);
+	TEST_ASSERT_EQUAL_INT(NO_OS_DIV_ROUND_UP(bytes, IIOD_RX_BUF_SIZE),
+			      buf_calls);
+
+	snprintf(msg, sizeof(msg), "%u pipelined READs: per byte recv %u calls "
+		 "%u cmds/s, buffered recv %u calls %u cmds/s",
+		 IIOD_BENCH_CMDS, byte_calls,
+		 (uint32_t)(IIOD_BENCH_CMDS * 1000000ull / byte_us),
+		 buf_calls, (uint32_t)(IIOD_BENCH_CMDS * 1000000ull / buf_us));
+	TEST_MESSAGE(msg);
+}
+
+void test_iiod_binary_commands(void)
+{
+	bin_start();
+
+	/* Pipelined, the responses come in order with their client ids */
+	bin_send(1, IIOD_CMD_READ, "dev0 value", NULL);
+	bin_send(2, IIOD_CMD_WRITE, "dev0 value 2", "17");
+	bin_send(0xbeef, IIOD_CMD_READ, "dev0 value", NULL);
+	bin_send(4, IIOD_CMD_VERSION, "", NULL);
+	bin_expect(1, IIOD_CMD_READ, 2, "42");
+	bin_expect(2, IIOD_CMD_WRITE, 2, NULL);
+	bin_expect(0xbeef, IIOD_CMD_READ, 2, "17");
+	bin_expect(4, IIOD_CMD_VERSION, IIOD_VERSION_LEN, IIOD_VERSION);
+}
+
+void test_iiod_binary_errors(void)
+{
+	bin_start();
+
+	/* Errors are returned in the code, the connection is kept */
+	bin_send(1, IIOD_CMD_READ, "dev1 value", NULL);
+	bin_expect(1, IIOD_CMD_READ, -ENOENT, NULL);
+	bin_send(2, IIOD_CMD_READ, "", NULL);
+	bin_expect(2, IIOD_CMD_READ, -EINVAL, NULL);
+	bin_send(3, 0x7f, "dev0", NULL);
+	bin_expect(3, 0x7f, -EINVAL, NULL);
+	/* The mode can't be changed again */
+	bin_send(4, IIOD_CMD_BINARY, "", NULL);
+	bin_expect(4, IIOD_CMD_BINARY, -EINVAL, NULL);
+	bin_send(5, IIOD_CMD_READ, "dev0 value", NULL);
+	bin_expect(5, IIOD_CMD_READ, 2, "42");
+}
+
+void test_iiod_binary_malformed(void)
+{
+	uint8_t hdr[IIOD_BIN_HDR_SIZE] = { 1, 0, IIOD_CMD_READ, 0 };
+	uint32_t steps = 0;
+	int32_t ret;
+
+	bin_start();
+
+	/* A partial header is kept until the rest of it is received */
+	client_send(hdr, 5);
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, iiod_conn_step(iiod, conn_id));
+	client_send(hdr + 5, 3);
+	/* Arguments of length 0 */
+	bin_expect(1, IIOD_CMD_READ, -EINVAL, NULL);
+
+	/* Arguments too long to be parsed: the connection is dropped */
+	no_os_put_unaligned_le32(IIOD_PARSER_MAX_BUF_SIZE, hdr + 4);
+	client_send(hdr, sizeof(hdr));
+	do {
+		ret = iiod_conn_step(iiod, conn_id);
+		TEST_ASSERT_TRUE(steps++ < IIOD_TEST_STEPS);
+	} while (ret == -EAGAIN);
+	TEST_ASSERT_EQUAL_INT(-ENOTCONN, ret);
+}
@@ -0,0 +1,481 @@
+/***************************************************************************//**
+ *   @file   test_no_os_circular_buffer.c
+ *   @brief  Unit tests of the circular buffer.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "no_os_circular_buffer.h"
+#include "no_os_alloc.h"
+#include "no_os_error.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define CB_SIZE			64
+/* Doesn't divide CB_SIZE, so scans get split at the end of the buffer */
+#define SCAN_SIZE		6
+#define BENCH_CB_SIZE		4096
+#define BENCH_SCAN_SIZE		8
+#define BENCH_NB_SCANS		(BENCH_CB_SIZE / BENCH_SCAN_SIZE)
+#define BENCH_ROUNDS		2000
+#define SPSC_SIZE		256
+#define SPSC_STRESS_SIZE	(64 * 1024)
+#define SPSC_STRESS_BYTES	(16 * 1024 * 1024)
+
+static struct no_os_circular_buffer *cb;
+static struct no_os_cb_spsc *spsc;
+/* Shared by the producer thread and the consumer of the stress test */
+static struct no_os_cb_spsc *stress;
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_init(&cb, CB_SIZE));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_spsc_init(&spsc, SPSC_SIZE));
+}
+
+void tearDown(void)
+{
+	no_os_cb_remove(cb);
+	no_os_cb_spsc_remove(spsc);
+}
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+/* Move both pointers of the empty buffer to idx */
+static void cb_move_to(uint32_t idx)
+{
+	uint8_t tmp[CB_SIZE];
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(cb, tmp, idx));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_read(cb, tmp, idx));
+}
+
+static double elapsed_sec(struct timespec *t0)
+{
+	struct timespec t1;
+
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	return (t1.tv_sec - t0->tv_sec) + (t1.tv_nsec - t0->tv_nsec) / 1e9;
+}
+
+/* Producer: write an incrementing byte pattern in chunks of varying size */
+static void *spsc_producer(void *arg)
+{
+	uint32_t sent = 0, len, i;
+	uint8_t chunk[61];
+	uint8_t *buf;
+	void *zc;
+
+	(void)arg;
+	while (sent < SPSC_STRESS_BYTES) {
+		len = 1 + sent % sizeof(chunk);
+		if (len > SPSC_STRESS_BYTES - sent)
+			len = SPSC_STRESS_BYTES - sent;
+
+		if (sent & 0x100) {
+			/* Zero copy path */
+			if (no_os_cb_spsc_prepare_write(stress, len, &zc, &len))
+				continue;
+			buf = zc;
+			for (i = 0; i < len; i++)
+				buf[i] = (uint8_t)(sent + i);
+			no_os_cb_spsc_end_write(stress, len);
+		} else {
+			for (i = 0; i < len; i++)
+				chunk[i] = (uint8_t)(sent + i);
+			if (no_os_cb_spsc_write(stress, chunk, len))
+				continue;
+		}
+		sent += len;
+	}
+
+	return NULL;
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_no_os_cb_read_write(void)
+{
+	uint8_t in[CB_SIZE], out[CB_SIZE];
+	uint32_t size, i;
+
+	for (i = 0; i < CB_SIZE; i++)
+		in[i] = i;
+
+	/* Wrap around the end of the buffer */
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(cb, in, CB_SIZE - 8));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_read(cb, out, CB_SIZE - 8));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(cb, in, 32));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_size(cb, &size));
+	TEST_ASSERT_EQUAL_UINT32(32, size);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_read(cb, out, 32));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(in, out, 32);
+}
+
+void test_no_os_cb_write_into_reserved_region(void)
+{
+	uint8_t data[CB_SIZE] = {0};
+	uint32_t avail;
+	void *buf;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(cb, data, CB_SIZE / 2));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_prepare_async_read(cb, CB_SIZE / 2,
+			      &buf, &avail));
+	TEST_ASSERT_EQUAL_INT(-EBUSY, no_os_cb_write(cb, data, CB_SIZE / 2 + 1));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(cb, data, CB_SIZE / 2));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_end_async_read(cb));
+}
+
+void test_no_os_cb_scans_wrap(void)
+{
+	uint8_t in[4 * SCAN_SIZE], out[4 * SCAN_SIZE];
+	struct no_os_cb_region regions[2];
+	uint32_t size, i;
+
+	for (i = 0; i < sizeof(in); i++)
+		in[i] = i + 1;
+
+	/* The first scan is split 4 bytes before the end of the buffer */
+	cb_move_to(CB_SIZE - 4);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_write_scans(cb, in, SCAN_SIZE, 4));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_size(cb, &size));
+	TEST_ASSERT_EQUAL_UINT32(sizeof(in), size);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_peek_read(cb, sizeof(in), regions));
+	TEST_ASSERT_EQUAL_UINT32(4, regions[0].size);
+	TEST_ASSERT_EQUAL_UINT32(sizeof(in) - 4, regions[1].size);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_read_scans(cb, out, SCAN_SIZE, 4));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(in, out, sizeof(in));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_size(cb, &size));
+	TEST_ASSERT_EQUAL_UINT32(0, size);
+}
+
+void test_no_os_cb_scans_partial(void)
+{
+	uint8_t in[3 * SCAN_SIZE], out[3 * SCAN_SIZE] = {0};
+	uint32_t size, i;
+
+	for (i = 0; i < sizeof(in); i++)
+		in[i] = i + 1;
+
+	/* Two scans and half of the third one */
+	cb_move_to(CB_SIZE - SCAN_SIZE);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(cb, in,
+						2 * SCAN_SIZE + SCAN_SIZE / 2));
+
+	/* Nothing is read unless all the scans are available */
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, no_os_cb_read_scans(cb, out, SCAN_SIZE,
+			      3));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_size(cb, &size));
+	TEST_ASSERT_EQUAL_UINT32(2 * SCAN_SIZE + SCAN_SIZE / 2, size);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_read_scans(cb, out, SCAN_SIZE, 2));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(in, out, 2 * SCAN_SIZE);
+
+	/* Complete the third scan */
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(cb, in + 2 * SCAN_SIZE +
+						SCAN_SIZE / 2,
+						SCAN_SIZE - SCAN_SIZE / 2));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_read_scans(cb, out + 2 * SCAN_SIZE,
+			      SCAN_SIZE, 1));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(in, out, sizeof(in));
+
+	/* Wrong parameters */
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_cb_read_scans(cb, out, 0, 1));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_cb_read_scans(cb, out, SCAN_SIZE,
+			      0));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_cb_read_scans(cb, out, CB_SIZE,
+			      2));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_cb_write_scans(cb, NULL, SCAN_SIZE,
+			      1));
+}
+
+void test_no_os_cb_scans_overwrite(void)
+{
+	uint8_t in[12 * SCAN_SIZE], out[10 * SCAN_SIZE];
+	uint32_t i;
+
+	for (i = 0; i < sizeof(in); i++)
+		in[i] = i + 1;
+
+	/* More than the buffer size: the oldest 8 bytes are overwritten */
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_write_scans(cb, in, SCAN_SIZE, 12));
+	TEST_ASSERT_EQUAL_INT(-NO_OS_EOVERRUN, no_os_cb_read_scans(cb, out,
+			      SCAN_SIZE, 10));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(in + sizeof(in) - CB_SIZE, out,
+				      sizeof(out));
+}
+
+void test_no_os_cb_peek_advance(void)
+{
+	struct no_os_cb_region regions[2];
+	uint8_t in[16];
+	uint32_t size, i;
+	void *buf;
+
+	for (i = 0; i < sizeof(in); i++)
+		in[i] = i + 1;
+
+	cb_move_to(CB_SIZE - 8);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_peek_write(cb, sizeof(in), regions));
+	TEST_ASSERT_EQUAL_UINT32(8, regions[0].size);
+	TEST_ASSERT_EQUAL_UINT32(8, regions[1].size);
+	memcpy(regions[0].buff, in, regions[0].size);
+	memcpy(regions[1].buff, in + regions[0].size, regions[1].size);
+
+	/* Nothing is published before advancing */
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_size(cb, &size));
+	TEST_ASSERT_EQUAL_UINT32(0, size);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_advance_write(cb, sizeof(in)));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_size(cb, &size));
+	TEST_ASSERT_EQUAL_UINT32(sizeof(in), size);
+
+	/* Peek more than available, twice, without consuming */
+	for (i = 0; i < 2; i++) {
+		TEST_ASSERT_EQUAL_INT(0, no_os_cb_peek_read(cb, CB_SIZE,
+				      regions));
+		TEST_ASSERT_EQUAL_UINT32(8, regions[0].size);
+		TEST_ASSERT_EQUAL_UINT32(8, regions[1].size);
+		TEST_ASSERT_EQUAL_UINT8_ARRAY(in, regions[0].buff, 8);
+		TEST_ASSERT_EQUAL_UINT8_ARRAY(in + 8, regions[1].buff, 8);
+	}
+
+	/* Consume part of the data, the rest is contiguous */
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_advance_read(cb, 10));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_peek_read(cb, CB_SIZE, regions));
+	TEST_ASSERT_EQUAL_UINT32(6, regions[0].size);
+	TEST_ASSERT_EQUAL_UINT32(0, regions[1].size);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(in + 10, regions[0].buff, 6);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_advance_read(cb, 6));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_size(cb, &size));
+	TEST_ASSERT_EQUAL_UINT32(0, size);
+
+	/* Wrong parameters and asynchronous transactions */
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_cb_peek_write(cb, CB_SIZE + 1,
+			      regions));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_cb_advance_read(cb, CB_SIZE + 1));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_prepare_async_write(cb, 4, &buf,
+			      &size));
+	TEST_ASSERT_EQUAL_INT(-EBUSY, no_os_cb_peek_write(cb, 4, regions));
+	TEST_ASSERT_EQUAL_INT(-EBUSY, no_os_cb_advance_write(cb, 4));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_end_async_write(cb));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_prepare_async_read(cb, 4, &buf,
+			      &size));
+	TEST_ASSERT_EQUAL_INT(-EBUSY, no_os_cb_peek_read(cb, 4, regions));
+	TEST_ASSERT_EQUAL_INT(-EBUSY, no_os_cb_advance_read(cb, 4));
+	/* The region of the asynchronous read can't be overwritten */
+	TEST_ASSERT_EQUAL_INT(-EBUSY, no_os_cb_peek_write(cb, CB_SIZE - 3,
+			      regions));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_end_async_read(cb));
+}
+
+/* Move BENCH_NB_SCANS scans through the buffer one by one, then in bulk */
+void test_no_os_cb_scans_benchmark(void)
+{
+	struct no_os_circular_buffer *bench;
+	uint8_t *in, *out;
+	struct timespec t0;
+	double per_scan, bulk;
+	uint32_t i, j;
+	char msg[128];
+
+	in = no_os_malloc(BENCH_CB_SIZE);
+	out = no_os_malloc(BENCH_CB_SIZE);
+	TEST_ASSERT_NOT_NULL(in);
+	TEST_ASSERT_NOT_NULL(out);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_init(&bench, BENCH_CB_SIZE));
+	for (i = 0; i < BENCH_CB_SIZE; i++)
+		in[i] = i;
+
+	/* Start off the buffer boundaries so that every round wraps */
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_write(bench, in, BENCH_SCAN_SIZE / 2));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_read(bench, out, BENCH_SCAN_SIZE / 2));
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		for (j = 0; j < BENCH_NB_SCANS; j++)
+			no_os_cb_write(bench, in + j * BENCH_SCAN_SIZE,
+				       BENCH_SCAN_SIZE);
+		for (j = 0; j < BENCH_NB_SCANS; j++)
+			no_os_cb_read(bench, out + j * BENCH_SCAN_SIZE,
+				      BENCH_SCAN_SIZE);
+	}
+	per_scan = elapsed_sec(&t0);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(in, out, BENCH_CB_SIZE);
+
+	memset(out, 0, BENCH_CB_SIZE);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		no_os_cb_write_scans(bench, in, BENCH_SCAN_SIZE, BENCH_NB_SCANS);
+		no_os_cb_read_scans(bench, out, BENCH_SCAN_SIZE, BENCH_NB_SCANS);
+	}
+	bulk = elapsed_sec(&t0);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(in, out, BENCH_CB_SIZE);
+
+	snprintf(msg, sizeof(msg),
+		 "%u byte scans: per scan %.1f M/s, bulk %.1f M/s",
+		 BENCH_SCAN_SIZE,
+		 BENCH_ROUNDS * BENCH_NB_SCANS / per_scan / 1e6,
+		 BENCH_ROUNDS * BENCH_NB_SCANS / bulk / 1e6);
+	TEST_MESSAGE(msg);
+
+	no_os_cb_remove(bench);
+	no_os_free(in);
+	no_os_free(out);
+}
+
+void test_no_os_cb_spsc_init(void)
+{
+	struct no_os_cb_spsc *desc;
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_cb_spsc_init(NULL, SPSC_SIZE));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_cb_spsc_init(&desc, 0));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_cb_spsc_init(&desc, 100));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_cb_spsc_remove(NULL));
+}
+
+void test_no_os_cb_spsc_full_empty(void)
+{
+	uint8_t in[SPSC_SIZE], out[SPSC_SIZE];
+	uint32_t avail;
+	void *buf;
+
+	memset(in, 0x5a, sizeof(in));
+	TEST_ASSERT_EQUAL_UINT32(0, no_os_cb_spsc_size(spsc));
+	TEST_ASSERT_EQUAL_UINT32(SPSC_SIZE, no_os_cb_spsc_space(spsc));
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, no_os_cb_spsc_read(spsc, out, 1));
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, no_os_cb_spsc_prepare_read(spsc, 1, &buf,
+			      &avail));
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_spsc_write(spsc, in, SPSC_SIZE));
+	TEST_ASSERT_EQUAL_UINT32(0, no_os_cb_spsc_space(spsc));
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, no_os_cb_spsc_write(spsc, in, 1));
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, no_os_cb_spsc_prepare_write(spsc, 1, &buf,
+			      &avail));
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_spsc_read(spsc, out, SPSC_SIZE));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(in, out, SPSC_SIZE);
+}
+
+void test_no_os_cb_spsc_zero_copy_wrap(void)
+{
+	uint8_t in[SPSC_SIZE], out[SPSC_SIZE];
+	uint32_t avail, i;
+	void *buf;
+
+	for (i = 0; i < SPSC_SIZE; i++)
+		in[i] = i;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_spsc_write(spsc, in, SPSC_SIZE - 16));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_spsc_read(spsc, out, SPSC_SIZE - 16));
+
+	/* Regions returned by prepare_write stop at the end of the buffer */
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_spsc_prepare_write(spsc, 32, &buf,
+			      &avail));
+	TEST_ASSERT_EQUAL_UINT32(16, avail);
+	memcpy(buf, in, avail);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_spsc_end_write(spsc, avail));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_spsc_write(spsc, in + 16, 16));
+
+	TEST_ASSERT_EQUAL_UINT32(32, no_os_cb_spsc_size(spsc));
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_spsc_read(spsc, out, 32));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(in, out, 32);
+}
+
+void test_no_os_cb_spsc_two_threads(void)
+{
+	uint32_t received = 0, errors = 0, len, i;
+	pthread_t producer;
+	uint8_t chunk[47];
+	uint8_t *buf;
+	void *zc;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_spsc_init(&stress, SPSC_STRESS_SIZE));
+	TEST_ASSERT_EQUAL_INT(0, pthread_create(&producer, NULL, spsc_producer,
+						NULL));
+
+	/* Consumer: check that bytes arrive once and in order */
+	while (received < SPSC_STRESS_BYTES) {
+		if (received & 0x80) {
+			if (no_os_cb_spsc_prepare_read(stress, sizeof(chunk),
+						       &zc, &len))
+				continue;
+			buf = zc;
+			for (i = 0; i < len; i++)
+				errors += buf[i] != (uint8_t)(received + i);
+			no_os_cb_spsc_end_read(stress, len);
+		} else {
+			len = no_os_cb_spsc_size(stress);
+			if (!len)
+				continue;
+			if (len > sizeof(chunk))
+				len = sizeof(chunk);
+			TEST_ASSERT_EQUAL_INT(0, no_os_cb_spsc_read(stress, chunk,
+					      len));
+			for (i = 0; i < len; i++)
+				errors += chunk[i] != (uint8_t)(received + i);
+		}
+		received += len;
+	}
+
+	pthread_join(producer, NULL);
+
+	no_os_cb_spsc_remove(stress);
+
+	TEST_ASSERT_EQUAL_UINT32(SPSC_STRESS_BYTES, received);
+	TEST_ASSERT_EQUAL_UINT32(0, errors);
+}
@@ -0,0 +1,218 @@
+/***************************************************************************//**
+ *   @file   test_no_os_crc.c
+ *   @brief  Unit tests and throughput benchmark of the CRC helpers.
+ *   @author Analog Devices Inc.
+ *******************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "no_os_crc8.h"
+#include "no_os_crc16.h"
+#include "no_os_crc24.h"
+#include "no_os_crc_engine.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define CRC_TEST_BUFF_SIZE	200
+#define CRC_BENCH_BUFF_SIZE	4096
+#define CRC_BENCH_ROUNDS	2000
+
+NO_OS_DECLARE_CRC8_TABLE(crc8_table);
+NO_OS_DECLARE_CRC16_TABLE(crc16_table);
+NO_OS_DECLARE_CRC24_TABLE(crc24_table);
+NO_OS_DECLARE_CRC_ENGINE(crc32_engine);
+
+static const uint8_t check_data[] = "123456789";
+static uint8_t buff[CRC_BENCH_BUFF_SIZE];
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	uint32_t i;
+
+	srand(1);
+	for (i = 0; i < CRC_BENCH_BUFF_SIZE; i++)
+		buff[i] = rand();
+}
+
+void tearDown(void)
+{
+}
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+/* Bit by bit msb first CRC, used as reference */
+static uint32_t crc_ref_msb(uint8_t width, uint32_t polynomial,
+			    const uint8_t *pdata, size_t nbytes, uint32_t crc)
+{
+	uint32_t top = (uint32_t)1 << (width - 1);
+	uint32_t mask = 0xffffffff >> (32 - width);
+	uint8_t bit;
+
+	while (nbytes--) {
+		crc ^= (uint32_t)*pdata++ << (width - 8);
+		for (bit = 0; bit < 8; bit++)
+			crc = (crc & top) ? (crc << 1) ^ polynomial : crc << 1;
+		crc &= mask;
+	}
+
+	return crc;
+}
+
+/* Print the throughput of _compute, which processes _nbytes per call */
+#define CRC_BENCH(_name, _nbytes, _compute)				\
+	do {								\
+		char msg[80];						\
+		uint32_t acc = 0, r;					\
+		clock_t start = clock();				\
+		double sec;						\
+		for (r = 0; r < CRC_BENCH_ROUNDS; r++)			\
+			acc += _compute;				\
+		sec = (double)(clock() - start) / CLOCKS_PER_SEC;	\
+		if (sec <= 0)						\
+			sec = 1.0 / CLOCKS_PER_SEC;			\
+		snprintf(msg, sizeof(msg), "%s, %d slices: %.0f MB/s (%x)", \
+			 _name, NO_OS_CRC_SLICES,			\
+			 CRC_BENCH_ROUNDS * (double)(_nbytes) / sec / 1e6, \
+			 (unsigned int)acc);				\
+		TEST_MESSAGE(msg);					\
+	} while (0)
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_no_os_crc_check_values(void)
+{
+	no_os_crc8_populate_msb(crc8_table, 0x07);
+	TEST_ASSERT_EQUAL_HEX8(0xF4, no_os_crc8(crc8_table, check_data, 9, 0));
+
+	/* CRC-16/XMODEM */
+	no_os_crc16_populate_msb(crc16_table, 0x1021);
+	TEST_ASSERT_EQUAL_HEX16(0x31C3, no_os_crc16(crc16_table, check_data, 9,
+			       0));
+
+	/* CRC-24/OPENPGP */
+	no_os_crc24_populate_msb(crc24_table, 0x864CFB);
+	TEST_ASSERT_EQUAL_HEX32(0x21CF02, no_os_crc24(crc24_table, check_data,
+				9, 0xB704CE));
+
+	/* CRC-32 */
+	TEST_ASSERT_EQUAL_INT(0, no_os_crc_engine_init(&crc32_engine, 32,
+			      0x04C11DB7, true));
+	TEST_ASSERT_EQUAL_HEX32(0xCBF43926,
+				~no_os_crc_engine_compute(&crc32_engine,
+						check_data, 9, 0xFFFFFFFF));
+
+	/* CRC-5/USB */
+	TEST_ASSERT_EQUAL_INT(0, no_os_crc_engine_init(&crc32_engine, 5, 0x05,
+			      true));
+	TEST_ASSERT_EQUAL_HEX32(0x19,
+				no_os_crc_engine_compute(&crc32_engine,
+						check_data, 9, 0x1F) ^ 0x1F);
+}
+
+void test_no_os_crc_against_reference(void)
+{
+	uint32_t len, split;
+
+	no_os_crc8_populate_msb(crc8_table, 0x07);
+	no_os_crc16_populate_msb(crc16_table, 0x755B);
+	no_os_crc24_populate_msb(crc24_table, 0x5D6DCB);
+	TEST_ASSERT_EQUAL_INT(0, no_os_crc_engine_init(&crc32_engine, 12,
+			      0x80F, false));
+
+	/* Every length and alignment the sliced loops handle */
+	for (len = 0; len < CRC_TEST_BUFF_SIZE; len++) {
+		split = len / 3;
+		TEST_ASSERT_EQUAL_HEX8(crc_ref_msb(8, 0x07, buff + 1, len, 0xA5),
+				       no_os_crc8(crc8_table, buff + 1, len,
+						       0xA5));
+		TEST_ASSERT_EQUAL_HEX16(crc_ref_msb(16, 0x755B, buff, len,
+						   0xFFFF),
+					no_os_crc16(crc16_table, buff + split,
+						    len - split,
+						    no_os_crc16(crc16_table, buff,
+								split, 0xFFFF)));
+		TEST_ASSERT_EQUAL_HEX32(crc_ref_msb(24, 0x5D6DCB, buff + 3, len,
+						   0xFFFFFF),
+					no_os_crc24(crc24_table, buff + 3, len,
+						    0xFFFFFFFF));
+		TEST_ASSERT_EQUAL_HEX32(crc_ref_msb(12, 0x80F, buff + 2, len,
+						   0x123),
+					no_os_crc_engine_compute(&crc32_engine,
+							buff + 2, len, 0x123));
+	}
+}
+
+void test_no_os_crc_throughput(void)
+{
+	uint32_t n;
+
+	no_os_crc8_populate_msb(crc8_table, 0x07);
+	no_os_crc16_populate_msb(crc16_table, 0x755B);
+	no_os_crc24_populate_msb(crc24_table, 0x5D6DCB);
+	TEST_ASSERT_EQUAL_INT(0, no_os_crc_engine_init(&crc32_engine, 32,
+			      0x04C11DB7, true));
+
+	CRC_BENCH("CRC-8 0x07", CRC_BENCH_BUFF_SIZE,
+		  no_os_crc8(crc8_table, buff, CRC_BENCH_BUFF_SIZE, r));
+	CRC_BENCH("CRC-16 0x755B", CRC_BENCH_BUFF_SIZE,
+		  no_os_crc16(crc16_table, buff, CRC_BENCH_BUFF_SIZE, r));
+	CRC_BENCH("CRC-24 0x5D6DCB", CRC_BENCH_BUFF_SIZE,
+		  no_os_crc24(crc24_table, buff, CRC_BENCH_BUFF_SIZE, r));
+	CRC_BENCH("CRC-32", CRC_BENCH_BUFF_SIZE,
+		  no_os_crc_engine_compute(&crc32_engine, buff,
+					   CRC_BENCH_BUFF_SIZE, r));
+
+	/* Bit by bit reference, for scale */
+	n = CRC_BENCH_BUFF_SIZE / 16;
+	CRC_BENCH("CRC-16 0x755B bitwise", n,
+		  crc_ref_msb(16, 0x755B, buff, n, r));
+}
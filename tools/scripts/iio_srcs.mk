@@ -7,8 +7,33 @@ INCS += $(NO-OS)/iio/iio_types.h
 INCS += $(NO-OS)/iio/iiod.h
 INCS += $(NO-OS)/iio/iiod_private.h
 INCS += $(INCLUDE)/no_os_circular_buffer.h
+INCS += $(INCLUDE)/no_os_atomic.h
 
 ifeq (y,$(strip $(NETWORKING)))
 DISABLE_SECURE_SOCKET ?= y
 SRC_DIRS += $(NO-OS)/network
 endif
+
+# Run the device callbacks on per-device threads (Linux with networking only)
+ifeq (y,$(strip $(IIO_THREADED)))
+CFLAGS += -DIIO_THREADED -pthread
+LDFLAGS += -pthread
+endif
+
+# Serve the context xml compressed with zstd on ZPRINT
+ifeq (y,$(strip $(IIO_ZSTD)))
+CFLAGS += -DIIO_ZSTD
+SRCS += $(NO-OS)/util/no_os_zstd.c
+INCS += $(INCLUDE)/no_os_zstd.h
+endif
+
+# Accept the no-OS specific binary command framing (NOOS_BINARY command)
+ifeq (y,$(strip $(IIOD_NOOS_BINARY)))
+CFLAGS += -DIIOD_NOOS_BINARY
+endif
+
+# Deinterleave and convert buffer scans on the target with iio_demux()
+ifeq (y,$(strip $(IIO_DEMUX)))
+SRCS += $(NO-OS)/iio/iio_demux.c
+INCS += $(NO-OS)/iio/iio_demux.h
+endif
@@ -0,0 +1,76 @@
+#!/bin/python
+
+import argparse
+import re
+import socket
+import sys
+
+description_help='''Generate pre-built xml for static iio device descriptors.
+The context xml is read from a running iiod (e.g. the linux build of the
+project) or from a file and, for each device, the xml of its channels and
+attributes is written as a C string to be set in iio_device.xml:
+
+	>python iio_xml_blob.py 127.0.0.1 -o iio_xml_blobs.h
+	>python iio_xml_blob.py context.xml -o iio_xml_blobs.h
+
+	struct iio_device adc_demo_iio_descriptor = {
+		...
+		.xml = adc_demo_xml,
+	};
+'''
+
+IIOD_PORT = 30431
+
+def read_from_iiod(host, port):
+	sock = socket.create_connection((host, port))
+	f = sock.makefile('rb')
+	sock.sendall(b'PRINT\n')
+	size = int(f.readline())
+	if size < 0:
+		sys.exit('PRINT failed: %d' % size)
+	xml = f.read(size)
+	sock.sendall(b'EXIT\n')
+	sock.close()
+
+	return xml.decode()
+
+def c_string(text, width=64):
+	lines = [text[i:i + width] for i in range(0, len(text), width)]
+	lines = [l.replace('\\', '\\\\').replace('"', '\\"') for l in lines]
+
+	return '\n'.join('\t"%s"' % l for l in lines)
+
+def main():
+	parser = argparse.ArgumentParser(description=description_help,
+			formatter_class=argparse.RawTextHelpFormatter)
+	parser.add_argument('source', help='iiod host or xml file')
+	parser.add_argument('-p', '--port', type=int, default=IIOD_PORT)
+	parser.add_argument('-o', '--output', help='Output header file')
+	args = parser.parse_args()
+
+	try:
+		with open(args.source) as f:
+			xml = f.read()
+	except FileNotFoundError:
+		xml = read_from_iiod(args.source, args.port)
+
+	out = ['/* Generated by tools/scripts/iio_xml_blob.py. Do not edit */', '']
+	for m in re.finditer(r'<device id="([^"]*)" name="([^"]*)">(.*?</device>)',
+			     xml, re.S):
+		dev_id, name, body = m.groups()
+		if not dev_id.startswith('iio:device'):
+			continue
+		ident = re.sub(r'\W', '_', name)
+		out.append('static const char %s_xml[] =' % ident)
+		out.append(c_string(body) + ';')
+		out.append('')
+
+	text = '\n'.join(out)
+	if args.output:
+		with open(args.output, 'w') as f:
+			f.write(text)
+	else:
+		print(text)
+
+if __name__ == '__main__':
+	main()
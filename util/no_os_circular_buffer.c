@@ -49,6 +49,28 @@
 #include "no_os_error.h"
 #include "no_os_util.h"
 #include "no_os_alloc.h"
+#include "no_os_atomic.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct no_os_cb_spsc
+ * @brief Lock-free circular buffer for one producer and one consumer.
+ */
+struct no_os_cb_spsc {
+	/** Size of the buffer in bytes. Must be a power of 2 */
+	uint32_t		size;
+	/** size - 1. Used to convert positions to buffer indexes */
+	uint32_t		mask;
+	/** Address of the buffer */
+	int8_t			*buff;
+	/** Free running write position. Updated only by the producer */
+	uint32_t		write;
+	/** Free running read position. Updated only by the consumer */
+	uint32_t		read;
+};
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
@@ -160,6 +182,26 @@ int32_t no_os_cb_size(struct no_os_circular_buffer *desc, uint32_t *size)
 	return 0;
 }
 
+/*
+ * The region of an asynchronous read is reserved until the read is ended, so
+ * it is not overwritten while it is used (e.g. sent from the buffer). Unread
+ * data is overwritten starting with the oldest, which is the reserved region,
+ * so writes are refused when size bytes don't fit in the free space.
+ */
+static int32_t no_os_cb_check_reserved(struct no_os_circular_buffer *desc,
+				       uint32_t size)
+{
+	uint32_t used;
+
+	if (!desc->read.async_started)
+		return 0;
+
+	if (no_os_cb_size(desc, &used) || size > desc->size - used)
+		return -EBUSY;
+
+	return 0;
+}
+
 /*
  * Functionality described at no_os_cb_prepare_async_write/read having the is_read
  * parameter to specifiy if it is a read or write operation.
@@ -269,6 +311,12 @@ static int32_t no_os_cb_operation(struct no_os_circular_buffer *desc,
 	if (!desc || !data || !size)
 		return -EINVAL;
 
+	if (!is_read) {
+		ret = no_os_cb_check_reserved(desc, size);
+		if (ret)
+			return ret;
+	}
+
 	sticky_overrun = 0;
 	i = 0;
 	while (i < size) {
@@ -313,13 +361,23 @@ static int32_t no_os_cb_operation(struct no_os_circular_buffer *desc,
  * @return
  *  - 0   - No errors
  *  - -EINVAL   - Wrong parameters used
- *  - -EBUSY    - Asynchronous transaction already started
+ *  - -EBUSY    - Asynchronous transaction already started or the data
+ *		  would overwrite the region of an asynchronous read
  */
 int32_t no_os_cb_prepare_async_write(struct no_os_circular_buffer *desc,
 				     uint32_t size_to_write,
 				     void **write_buff,
 				     uint32_t *size_avilable)
 {
+	int32_t ret;
+
+	if (!desc)
+		return -EINVAL;
+
+	ret = no_os_cb_check_reserved(desc, size_to_write);
+	if (ret)
+		return ret;
+
 	return no_os_cb_prepare_async_operation(desc, size_to_write, write_buff,
 						size_avilable, 0);
 }
@@ -327,7 +385,8 @@ int32_t no_os_cb_prepare_async_write(struct no_os_circular_buffer *desc,
 /**
  * @brief Prepare asynchronous read.
  *
- * Get the inside raw buffer to be used in DMA transactions.
+ * Get the inside raw buffer to be used in DMA transactions. The region is
+ * not overwritten by writes until no_os_cb_end_async_read() is called.
  *
  * @param desc - Circular buffer reference
  * @param size_to_read - Number of bytes needed to write to the buffer.
@@ -380,6 +439,7 @@ int32_t no_os_cb_end_async_read(struct no_os_circular_buffer *desc)
  * @return
  *  - 0 - No errors
  *  - -EINVAL      - Wrong parameters used
+ *  - -EBUSY       - Data would overwrite the region of an asynchronous read
  */
 int32_t no_os_cb_write(struct no_os_circular_buffer *desc, const void *data,
 		       uint32_t size)
@@ -402,3 +462,555 @@ int32_t no_os_cb_read(struct no_os_circular_buffer *desc, void *data,
 {
 	return no_os_cb_operation(desc, data, size, 1);
 }
+
+/* Move ptr size bytes forward, size being at most desc->size */
+static void no_os_cb_advance_ptr(struct no_os_circular_buffer *desc,
+				 struct no_os_cb_ptr *ptr, uint32_t size)
+{
+	uint32_t new_val = ptr->idx + size;
+
+	if (new_val >= desc->size) {
+		ptr->spin_count++;
+		new_val -= desc->size;
+	}
+	ptr->idx = new_val;
+}
+
+/* Split size bytes starting from ptr in two contiguous regions */
+static void no_os_cb_fill_regions(struct no_os_circular_buffer *desc,
+				  struct no_os_cb_ptr *ptr, uint32_t size,
+				  struct no_os_cb_region regions[2])
+{
+	regions[0].buff = desc->buff + ptr->idx;
+	regions[0].size = no_os_min(size, desc->size - ptr->idx);
+	regions[1].buff = desc->buff;
+	regions[1].size = size - regions[0].size;
+}
+
+/**
+ * @brief Get the regions where the next size bytes will be written.
+ *
+ * The data written in the regions is published by no_os_cb_advance_write().
+ * Both regions can be filled with memcpy or DMA transfers. regions[1] is empty
+ * if the span does not wrap around the end of the buffer.
+ *
+ * @param desc - Circular buffer reference
+ * @param size - Number of bytes to write. At most the size of the buffer.
+ * @param regions - Where to store the two regions
+ * @return
+ *  - 0 - No errors
+ *  - -EINVAL - Wrong parameters used
+ *  - -EBUSY - Asynchronous write already started or the span would overwrite
+ *	      the region of an asynchronous read
+ */
+int32_t no_os_cb_peek_write(struct no_os_circular_buffer *desc, uint32_t size,
+			    struct no_os_cb_region regions[2])
+{
+	if (!desc || !regions || size > desc->size)
+		return -EINVAL;
+
+	if (desc->write.async_started)
+		return -EBUSY;
+
+	if (no_os_cb_check_reserved(desc, size))
+		return -EBUSY;
+
+	no_os_cb_fill_regions(desc, &desc->write, size, regions);
+
+	return 0;
+}
+
+/**
+ * @brief Publish size bytes written in the regions returned by
+ * no_os_cb_peek_write().
+ * @param desc - Circular buffer reference
+ * @param size - Number of bytes written
+ * @return
+ *  - 0 - No errors
+ *  - -EINVAL - Wrong parameters used
+ *  - -EBUSY - Asynchronous write already started
+ */
+int32_t no_os_cb_advance_write(struct no_os_circular_buffer *desc,
+			       uint32_t size)
+{
+	if (!desc || size > desc->size)
+		return -EINVAL;
+
+	if (desc->write.async_started)
+		return -EBUSY;
+
+	no_os_cb_advance_ptr(desc, &desc->write, size);
+
+	return 0;
+}
+
+/**
+ * @brief Get the regions holding up to size bytes of data to be read.
+ *
+ * The data is not removed from the buffer until no_os_cb_advance_read() is
+ * called, so both regions can be sent or copied directly. regions[1] is empty
+ * if the data does not wrap around the end of the buffer.
+ *
+ * @param desc - Circular buffer reference
+ * @param size - Maximum number of bytes to get
+ * @param regions - Where to store the two regions. The sum of their sizes is
+ * no_os_min(size, data available)
+ * @return
+ *  - 0 - No errors
+ *  - -EINVAL - Wrong parameters used
+ *  - -EBUSY - Asynchronous read already started
+ *  - -NO_OS_EOVERRUN - An overrun occurred and some data have been overwritten
+ */
+int32_t no_os_cb_peek_read(struct no_os_circular_buffer *desc, uint32_t size,
+			   struct no_os_cb_region regions[2])
+{
+	uint32_t available_size;
+	int32_t ret;
+
+	if (!desc || !regions)
+		return -EINVAL;
+
+	if (desc->read.async_started)
+		return -EBUSY;
+
+	ret = no_os_cb_size(desc, &available_size);
+	if (ret == -NO_OS_EOVERRUN) {
+		/* Same recovery as no_os_cb_prepare_async_read() */
+		desc->read.spin_count = desc->write.spin_count - 1;
+#ifndef IIO_IGNORE_BUFF_OVERRUN_ERR
+		desc->read.idx = desc->write.idx;
+#endif
+	}
+
+	no_os_cb_fill_regions(desc, &desc->read,
+			      no_os_min(size, available_size), regions);
+
+	return ret;
+}
+
+/**
+ * @brief Remove size bytes of data returned by no_os_cb_peek_read().
+ * @param desc - Circular buffer reference
+ * @param size - Number of bytes read
+ * @return
+ *  - 0 - No errors
+ *  - -EINVAL - Wrong parameters used
+ *  - -EBUSY - Asynchronous read already started
+ */
+int32_t no_os_cb_advance_read(struct no_os_circular_buffer *desc,
+			      uint32_t size)
+{
+	if (!desc || size > desc->size)
+		return -EINVAL;
+
+	if (desc->read.async_started)
+		return -EBUSY;
+
+	no_os_cb_advance_ptr(desc, &desc->read, size);
+
+	return 0;
+}
+
+/**
+ * @brief Write nb_scans elements of scan_size bytes to the buffer.
+ *
+ * Equivalent to calling no_os_cb_write() nb_scans times, but the buffer state
+ * is updated once and data is copied with at most two memcpy calls.
+ *
+ * @param desc - Circular buffer reference
+ * @param data - Buffer holding nb_scans * scan_size bytes
+ * @param scan_size - Size of one element
+ * @param nb_scans - Number of elements to write
+ * @return
+ *  - 0 - No errors
+ *  - -EINVAL - Wrong parameters used
+ *  - -EBUSY - Asynchronous write already started or the data would
+ *	      overwrite the region of an asynchronous read
+ */
+int32_t no_os_cb_write_scans(struct no_os_circular_buffer *desc,
+			     const void *data, uint32_t scan_size,
+			     uint32_t nb_scans)
+{
+	struct no_os_cb_region regions[2];
+	const uint8_t *src = data;
+	uint64_t total;
+	uint32_t len;
+	int32_t ret;
+
+	if (!desc || !data || !scan_size || !nb_scans)
+		return -EINVAL;
+
+	total = (uint64_t)scan_size * nb_scans;
+	/* Writing more than the buffer size overwrites the oldest data */
+	while (total) {
+		len = no_os_min(total, desc->size);
+		ret = no_os_cb_peek_write(desc, len, regions);
+		if (ret)
+			return ret;
+
+		memcpy(regions[0].buff, src, regions[0].size);
+		memcpy(regions[1].buff, src + regions[0].size, regions[1].size);
+		no_os_cb_advance_ptr(desc, &desc->write, len);
+
+		src += len;
+		total -= len;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Read nb_scans elements of scan_size bytes from the buffer.
+ *
+ * Nothing is read if less than nb_scans elements are available.
+ *
+ * @param desc - Circular buffer reference
+ * @param data - Buffer where to copy nb_scans * scan_size bytes
+ * @param scan_size - Size of one element
+ * @param nb_scans - Number of elements to read
+ * @return
+ *  - 0 - No errors
+ *  - -EINVAL - Wrong parameters used
+ *  - -EAGAIN - Not enough data in the buffer
+ *  - -EBUSY - Asynchronous read already started
+ *  - -NO_OS_EOVERRUN - An overrun occurred and some data have been overwritten
+ */
+int32_t no_os_cb_read_scans(struct no_os_circular_buffer *desc, void *data,
+			    uint32_t scan_size, uint32_t nb_scans)
+{
+	struct no_os_cb_region regions[2];
+	uint64_t total;
+	int32_t ret;
+
+	if (!desc || !data || !scan_size || !nb_scans)
+		return -EINVAL;
+
+	total = (uint64_t)scan_size * nb_scans;
+	if (total > desc->size)
+		return -EINVAL;
+
+	ret = no_os_cb_peek_read(desc, total, regions);
+	if (ret && ret != -NO_OS_EOVERRUN)
+		return ret;
+
+	if (regions[0].size + regions[1].size < total)
+		return -EAGAIN;
+
+	memcpy(data, regions[0].buff, regions[0].size);
+	memcpy((uint8_t *)data + regions[0].size, regions[1].buff,
+	       regions[1].size);
+	no_os_cb_advance_ptr(desc, &desc->read, total);
+
+	return ret;
+}
+
+/*
+ * Single producer single consumer circular buffer.
+ *
+ * Read and write positions are free running counters, the number of bytes in
+ * the buffer being write - read. Each position is updated by a single side
+ * with release semantics, after the data was copied, and loaded by the other
+ * side with acquire semantics, before the data is accessed. This makes it
+ * safe to use between an interrupt handler and the main loop or between two
+ * threads without locks. Since the size is a power of 2, positions are
+ * converted to buffer indexes with a mask.
+ */
+
+/**
+ * @brief Configure SPSC circular buffer with a given memory area.
+ * @param desc - SPSC circular buffer reference
+ * @param buf - Memory used to store data
+ * @param size - Size of buf. Must be a power of 2
+ * @return
+ *  - 0 : On success
+ *  - -EINVAL : Wrong parameters used
+ */
+static int32_t no_os_cb_spsc_cfg(struct no_os_cb_spsc *desc, int8_t *buf,
+				 uint32_t size)
+{
+	if (!desc || !buf || !size || (size & (size - 1)) ||
+	    size > (UINT32_MAX >> 1) + 1)
+		return -EINVAL;
+
+	desc->size = size;
+	desc->mask = size - 1;
+	desc->buff = buf;
+	desc->write = 0;
+	desc->read = 0;
+
+	return 0;
+}
+
+/**
+ * @brief Create SPSC circular buffer structure.
+ * @param desc - Where to store the circular buffer reference
+ * @param size - Buffer size. Must be a power of 2
+ * @return
+ *  - 0 : On success
+ *  - -EINVAL : Wrong parameters used
+ *  - -ENOMEM : Allocation failure
+ */
+int32_t no_os_cb_spsc_init(struct no_os_cb_spsc **desc, uint32_t size)
+{
+	struct no_os_cb_spsc *ldesc;
+	int8_t *buf;
+	int32_t ret;
+
+	if (!desc || !size || (size & (size - 1)))
+		return -EINVAL;
+
+	ldesc = (struct no_os_cb_spsc *)no_os_calloc(1, sizeof(*ldesc));
+	if (!ldesc)
+		return -ENOMEM;
+
+	buf = (int8_t *)no_os_calloc(1, size);
+	if (!buf) {
+		no_os_free(ldesc);
+		return -ENOMEM;
+	}
+
+	ret = no_os_cb_spsc_cfg(ldesc, buf, size);
+	if (ret) {
+		no_os_free(buf);
+		no_os_free(ldesc);
+		return ret;
+	}
+
+	*desc = ldesc;
+
+	return 0;
+}
+
+/**
+ * @brief Free the resources allocated by no_os_cb_spsc_init().
+ * @param desc - SPSC circular buffer reference
+ * @return
+ *  - 0 : On success
+ *  - -EINVAL : Wrong parameters used
+ */
+int32_t no_os_cb_spsc_remove(struct no_os_cb_spsc *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	no_os_free(desc->buff);
+	no_os_free(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Get the number of bytes available to read.
+ * @param desc - SPSC circular buffer reference
+ * @return Number of bytes in the buffer.
+ */
+uint32_t no_os_cb_spsc_size(struct no_os_cb_spsc *desc)
+{
+	uint32_t write = no_os_atomic_load_acquire(&desc->write);
+	uint32_t read = no_os_atomic_load_relaxed(&desc->read);
+
+	return write - read;
+}
+
+/**
+ * @brief Get the number of bytes that can be written.
+ * @param desc - SPSC circular buffer reference
+ * @return Free space in the buffer.
+ */
+uint32_t no_os_cb_spsc_space(struct no_os_cb_spsc *desc)
+{
+	uint32_t read = no_os_atomic_load_acquire(&desc->read);
+	uint32_t write = no_os_atomic_load_relaxed(&desc->write);
+
+	return desc->size - (write - read);
+}
+
+/**
+ * @brief Prepare a zero copy write.
+ *
+ * Get a contiguous region of the buffer where the producer can write, e.g.
+ * with a DMA transfer. Data is published by no_os_cb_spsc_end_write().
+ *
+ * @param desc - SPSC circular buffer reference
+ * @param size_to_write - Number of bytes needed to write to the buffer.
+ * @param write_buff - Address where to store the buffer where to write to.
+ * @param size_available - no_os_min(size_to_write, free space, size until
+ * end of allocated buffer)
+ * @return
+ *  - 0 - No errors
+ *  - -EINVAL - Wrong parameters used
+ *  - -EAGAIN - Buffer is full
+ */
+int32_t no_os_cb_spsc_prepare_write(struct no_os_cb_spsc *desc,
+				    uint32_t size_to_write, void **write_buff,
+				    uint32_t *size_available)
+{
+	uint32_t write, idx;
+
+	if (!desc || !write_buff || !size_available)
+		return -EINVAL;
+
+	write = no_os_atomic_load_relaxed(&desc->write);
+	idx = write & desc->mask;
+	size_to_write = no_os_min(size_to_write, no_os_cb_spsc_space(desc));
+	size_to_write = no_os_min(size_to_write, desc->size - idx);
+	if (!size_to_write)
+		return -EAGAIN;
+
+	*write_buff = desc->buff + idx;
+	*size_available = size_to_write;
+
+	return 0;
+}
+
+/**
+ * @brief Publish size bytes written in the region returned by
+ * no_os_cb_spsc_prepare_write().
+ * @param desc - SPSC circular buffer reference
+ * @param size - Number of bytes written
+ * @return
+ *  - 0 - No errors
+ *  - -EINVAL - Wrong parameters used
+ */
+int32_t no_os_cb_spsc_end_write(struct no_os_cb_spsc *desc, uint32_t size)
+{
+	uint32_t write;
+
+	if (!desc)
+		return -EINVAL;
+
+	write = no_os_atomic_load_relaxed(&desc->write);
+	no_os_atomic_store_release(&desc->write, write + size);
+
+	return 0;
+}
+
+/**
+ * @brief Prepare a zero copy read.
+ *
+ * Get a contiguous region of the buffer holding data to be read. The region
+ * is released by no_os_cb_spsc_end_read().
+ *
+ * @param desc - SPSC circular buffer reference
+ * @param size_to_read - Number of bytes needed to read from the buffer.
+ * @param read_buff - Address where to store the buffer where data will be read.
+ * @param size_available - no_os_min(size_to_read, data available, size until
+ * end of allocated buffer)
+ * @return
+ *  - 0 - No errors
+ *  - -EINVAL - Wrong parameters used
+ *  - -EAGAIN - Buffer is empty
+ */
+int32_t no_os_cb_spsc_prepare_read(struct no_os_cb_spsc *desc,
+				   uint32_t size_to_read, void **read_buff,
+				   uint32_t *size_available)
+{
+	uint32_t read, idx;
+
+	if (!desc || !read_buff || !size_available)
+		return -EINVAL;
+
+	read = no_os_atomic_load_relaxed(&desc->read);
+	idx = read & desc->mask;
+	size_to_read = no_os_min(size_to_read, no_os_cb_spsc_size(desc));
+	size_to_read = no_os_min(size_to_read, desc->size - idx);
+	if (!size_to_read)
+		return -EAGAIN;
+
+	*read_buff = desc->buff + idx;
+	*size_available = size_to_read;
+
+	return 0;
+}
+
+/**
+ * @brief Release size bytes read from the region returned by
+ * no_os_cb_spsc_prepare_read().
+ * @param desc - SPSC circular buffer reference
+ * @param size - Number of bytes read
+ * @return
+ *  - 0 - No errors
+ *  - -EINVAL - Wrong parameters used
+ */
+int32_t no_os_cb_spsc_end_read(struct no_os_cb_spsc *desc, uint32_t size)
+{
+	uint32_t read;
+
+	if (!desc)
+		return -EINVAL;
+
+	read = no_os_atomic_load_relaxed(&desc->read);
+	no_os_atomic_store_release(&desc->read, read + size);
+
+	return 0;
+}
+
+/**
+ * @brief Write data to the buffer (Non blocking).
+ *
+ * Either all data is written or nothing is written.
+ *
+ * @param desc - SPSC circular buffer reference
+ * @param data - Buffer from where data is copied to the circular buffer
+ * @param size - Size to write
+ * @return
+ *  - 0 - No errors
+ *  - -EINVAL - Wrong parameters used
+ *  - -EAGAIN - Not enough space in the buffer
+ */
+int32_t no_os_cb_spsc_write(struct no_os_cb_spsc *desc, const void *data,
+			    uint32_t size)
+{
+	uint32_t write, idx, len;
+
+	if (!desc || !data)
+		return -EINVAL;
+
+	if (size > no_os_cb_spsc_space(desc))
+		return -EAGAIN;
+
+	write = no_os_atomic_load_relaxed(&desc->write);
+	idx = write & desc->mask;
+	len = no_os_min(size, desc->size - idx);
+	memcpy(desc->buff + idx, data, len);
+	memcpy(desc->buff, (const uint8_t *)data + len, size - len);
+
+	no_os_atomic_store_release(&desc->write, write + size);
+
+	return 0;
+}
+
+/**
+ * @brief Read data from the buffer (Non blocking).
+ *
+ * Either all data is read or nothing is read.
+ *
+ * @param desc - SPSC circular buffer reference
+ * @param data - Buffer where to data is copied from the circular buffer
+ * @param size - Size to read
+ * @return
+ *  - 0 - No errors
+ *  - -EINVAL - Wrong parameters used
+ *  - -EAGAIN - Not enough data in the buffer
+ */
+int32_t no_os_cb_spsc_read(struct no_os_cb_spsc *desc, void *data,
+			   uint32_t size)
+{
+	uint32_t read, idx, len;
+
+	if (!desc || !data)
+		return -EINVAL;
+
+	if (size > no_os_cb_spsc_size(desc))
+		return -EAGAIN;
+
+	read = no_os_atomic_load_relaxed(&desc->read);
+	idx = read & desc->mask;
+	len = no_os_min(size, desc->size - idx);
+	memcpy(data, desc->buff + idx, len);
+	memcpy((uint8_t *)data + len, desc->buff, size - len);
+
+	no_os_atomic_store_release(&desc->read, read + size);
+
+	return 0;
+}
@@ -54,6 +54,8 @@
  *    msb first: poly = (1)0111010101011011 = 0x755B
  *                         ^
  *
+ * The table holds NO_OS_CRC_SLICES slices, see NO_OS_DECLARE_CRC16_TABLE().
+ *
  * @return None.
 *******************************************************************************/
 void no_os_crc16_populate_msb(uint16_t * table, const uint16_t polynomial)
@@ -61,18 +63,7 @@ void no_os_crc16_populate_msb(uint16_t * table, const uint16_t polynomial)
 	if (!table)
 		return;
 
-	for (int16_t n = 0; n < NO_OS_CRC16_TABLE_SIZE; n++) {
-		uint16_t currByte = (uint16_t)(n << 8);
-		for (uint8_t bit = 0; bit < 8; bit++) {
-			if ((currByte & 0x8000) != 0) {
-				currByte <<= 1;
-				currByte ^= polynomial;
-			} else {
-				currByte <<= 1;
-			}
-		}
-		table[n] = currByte;
-	}
+	no_os_crc_table_populate_msb(table, sizeof(*table), 16, polynomial);
 }
 
 /***************************************************************************//**
@@ -91,13 +82,6 @@ uint16_t no_os_crc16(const uint16_t * table, const uint8_t *pdata,
 		     size_t nbytes,
 		     uint16_t crc)
 {
-	unsigned int idx;
-
-	while (nbytes--) {
-		idx = ((crc >> 8) ^ *pdata) & 0xff;
-		crc = (table[idx] ^ (crc << 8)) & 0xffff;
-		pdata++;
-	}
-
-	return crc;
+	return no_os_crc_table_compute_msb(table, sizeof(*table), 16, pdata,
+					   nbytes, crc);
 }
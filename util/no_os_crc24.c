@@ -54,6 +54,8 @@
  *    msb first: poly = (1)010111010110110111001011 = 5D6DCB
  *                         ^
  *
+ * The table holds NO_OS_CRC_SLICES slices, see NO_OS_DECLARE_CRC24_TABLE().
+ *
  * @return None.
 *******************************************************************************/
 void no_os_crc24_populate_msb(uint32_t * table, const uint32_t polynomial)
@@ -61,19 +63,7 @@ void no_os_crc24_populate_msb(uint32_t * table, const uint32_t polynomial)
 	if (!table)
 		return;
 
-	for (int16_t n = 0; n < NO_OS_CRC24_TABLE_SIZE; n++) {
-		uint32_t currByte = (uint32_t)(n << 16);
-		for (uint8_t bit = 0; bit < 8; bit++) {
-			if ((currByte & 0x800000) != 0) {
-				currByte &= 0x7FFFFF;
-				currByte <<= 1;
-				currByte ^= polynomial;
-			} else {
-				currByte <<= 1;
-			}
-		}
-		table[n] = currByte;
-	}
+	no_os_crc_table_populate_msb(table, sizeof(*table), 24, polynomial);
 }
 
 /***************************************************************************//**
@@ -92,13 +82,6 @@ uint32_t no_os_crc24(const uint32_t * table, const uint8_t *pdata,
 		     size_t nbytes,
 		     uint32_t crc)
 {
-	unsigned int idx;
-
-	while (nbytes--) {
-		idx = ((crc >> 16) ^ *pdata) & 0xff;
-		crc = (table[idx] ^ (crc << 8)) & 0xffffff;
-		pdata++;
-	}
-
-	return (crc & 0xffffff);
+	return no_os_crc_table_compute_msb(table, sizeof(*table), 24, pdata,
+					   nbytes, crc);
 }
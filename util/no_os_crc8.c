@@ -52,6 +52,8 @@
  *
  * 	msb first: poly = (1)00000111 = 0x07
  *
+ * The table holds NO_OS_CRC_SLICES slices, see NO_OS_DECLARE_CRC8_TABLE().
+ *
  * @return None.
 *******************************************************************************/
 void no_os_crc8_populate_msb(uint8_t * table, const uint8_t polynomial)
@@ -59,18 +61,7 @@ void no_os_crc8_populate_msb(uint8_t * table, const uint8_t polynomial)
 	if (!table)
 		return;
 
-	for (int16_t n = 0; n < NO_OS_CRC8_TABLE_SIZE; n++) {
-		uint8_t currByte = (uint8_t)n;
-		for (uint8_t bit = 0; bit < 8; bit++) {
-			if ((currByte & 0x80) != 0) {
-				currByte <<= 1;
-				currByte ^= polynomial;
-			} else {
-				currByte <<= 1;
-			}
-		}
-		table[n] = currByte;
-	}
+	no_os_crc_table_populate_msb(table, sizeof(*table), 8, polynomial);
 }
 
 /***************************************************************************//**
@@ -88,13 +79,6 @@ void no_os_crc8_populate_msb(uint8_t * table, const uint8_t polynomial)
 uint8_t no_os_crc8(const uint8_t * table, const uint8_t *pdata, size_t nbytes,
 		   uint8_t crc)
 {
-	unsigned int idx;
-
-	while (nbytes--) {
-		idx = (crc ^ *pdata);
-		crc = (table[idx]) & 0xff;
-		pdata++;
-	}
-
-	return crc;
+	return no_os_crc_table_compute_msb(table, sizeof(*table), 8, pdata,
+					   nbytes, crc);
 }
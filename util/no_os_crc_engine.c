@@ -0,0 +1,189 @@
+/***************************************************************************//**
+ *   @file   no_os_crc_engine.c
+ *   @brief  Source file of the generic sliced CRC engine.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#include <errno.h>
+#include "no_os_crc_engine.h"
+
+/*
+ * Msb first CRCs are computed left aligned in a 32-bit register with the
+ * table helpers of no_os_crc_engine.h, so the same tables and loops are used
+ * for any width. Reflected CRCs are computed right
+ * aligned using the bit reversed polynomial.
+ */
+
+static uint32_t no_os_crc_reverse(uint32_t val, uint8_t width)
+{
+	uint32_t ret = 0;
+
+	while (width--) {
+		ret = (ret << 1) | (val & 1);
+		val >>= 1;
+	}
+
+	return ret;
+}
+
+static inline uint32_t no_os_crc_get_le32(const uint8_t *p)
+{
+	return ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) |
+	       ((uint32_t)p[1] << 8) | p[0];
+}
+
+/***************************************************************************//**
+ * @brief Creates the lookup tables of a CRC engine.
+ *
+ * @param engine     - Pointer to the CRC engine to initialize.
+ * @param width      - Number of bits of the CRC, from 1 to 32.
+ * @param polynomial - Msb-first representation of the polynomial, without the
+ *                     x^width term (e.g. 0x1021 for CRC-16-CCITT, 0x04C11DB7
+ *                     for CRC-32). It is reversed internally for reflected
+ *                     CRCs.
+ * @param reflected  - Process data lsb first.
+ *
+ * @return 0 in case of success, -EINVAL otherwise.
+*******************************************************************************/
+int no_os_crc_engine_init(struct no_os_crc_engine *engine, uint8_t width,
+			  uint32_t polynomial, bool reflected)
+{
+	uint32_t crc;
+	uint32_t n;
+	uint8_t bit;
+	uint8_t k;
+
+	if (!engine || !width || width > 32)
+		return -EINVAL;
+
+	engine->width = width;
+	engine->reflected = reflected;
+
+	if (!reflected) {
+		no_os_crc_table_populate_msb(engine->table,
+					     sizeof(engine->table[0][0]), 32,
+					     polynomial << (32 - width));
+		return 0;
+	}
+
+	polynomial = no_os_crc_reverse(polynomial, width);
+
+	for (n = 0; n < NO_OS_CRC_ENGINE_TABLE_SIZE; n++) {
+		crc = n;
+		for (bit = 0; bit < 8; bit++)
+			crc = (crc & 1) ? (crc >> 1) ^ polynomial : crc >> 1;
+		engine->table[0][n] = crc;
+	}
+
+	for (k = 1; k < NO_OS_CRC_SLICES; k++) {
+		for (n = 0; n < NO_OS_CRC_ENGINE_TABLE_SIZE; n++) {
+			crc = engine->table[k - 1][n];
+			crc = (crc >> 8) ^ engine->table[0][crc & 0xff];
+			engine->table[k][n] = crc;
+		}
+	}
+
+	return 0;
+}
+
+static uint32_t no_os_crc_compute_lsb(const struct no_os_crc_engine *engine,
+				      const uint8_t *pdata, size_t nbytes,
+				      uint32_t crc)
+{
+	const uint32_t (*t)[NO_OS_CRC_ENGINE_TABLE_SIZE] = engine->table;
+#if NO_OS_CRC_SLICES >= 4
+	uint32_t next;
+#endif
+
+#if NO_OS_CRC_SLICES == 8
+	while (nbytes >= 8) {
+		crc ^= no_os_crc_get_le32(pdata);
+		next = no_os_crc_get_le32(pdata + 4);
+		crc = t[7][crc & 0xff] ^ t[6][(crc >> 8) & 0xff] ^
+		      t[5][(crc >> 16) & 0xff] ^ t[4][crc >> 24] ^
+		      t[3][next & 0xff] ^ t[2][(next >> 8) & 0xff] ^
+		      t[1][(next >> 16) & 0xff] ^ t[0][next >> 24];
+		pdata += 8;
+		nbytes -= 8;
+	}
+#endif
+#if NO_OS_CRC_SLICES >= 4
+	while (nbytes >= 4) {
+		next = crc ^ no_os_crc_get_le32(pdata);
+		crc = t[3][next & 0xff] ^ t[2][(next >> 8) & 0xff] ^
+		      t[1][(next >> 16) & 0xff] ^ t[0][next >> 24];
+		pdata += 4;
+		nbytes -= 4;
+	}
+#endif
+	while (nbytes--)
+		crc = (crc >> 8) ^ t[0][(crc ^ *pdata++) & 0xff];
+
+	return crc;
+}
+
+/***************************************************************************//**
+ * @brief Computes the CRC over a buffer of data.
+ *
+ * @param engine    - Pointer to a CRC engine initialized with
+ *                    no_os_crc_engine_init().
+ * @param pdata     - Pointer to data buffer.
+ * @param nbytes    - Number of bytes to compute the CRC over.
+ * @param crc       - Initial value for the CRC computation. Can be used to
+ *                    cascade calls to this function by providing a previous
+ *                    output of this function as the crc parameter. No final
+ *                    xor is applied to the result.
+ *
+ * @return crc      - Computed CRC value.
+*******************************************************************************/
+uint32_t no_os_crc_engine_compute(const struct no_os_crc_engine *engine,
+				  const uint8_t *pdata, size_t nbytes,
+				  uint32_t crc)
+{
+	uint32_t mask;
+	uint8_t shift;
+
+	mask = 0xffffffff >> (32 - engine->width);
+	crc &= mask;
+
+	if (engine->reflected)
+		return no_os_crc_compute_lsb(engine, pdata, nbytes, crc);
+
+	shift = 32 - engine->width;
+
+	return no_os_crc_table_compute_msb(engine->table,
+					   sizeof(engine->table[0][0]), 32,
+					   pdata, nbytes, crc << shift) >> shift;
+}
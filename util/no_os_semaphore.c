@@ -38,6 +38,7 @@
 *******************************************************************************/
 
 #include "no_os_semaphore.h"
+#include "no_os_error.h"
 
 /**
  * @brief Initialize semaphore.
@@ -53,6 +54,19 @@ __attribute__((weak)) inline void no_os_semaphore_init(void **semaphore) {}
  */
 __attribute__((weak)) inline void no_os_semaphore_take(void *semaphore) {}
 
+/**
+ * @brief Take token from semaphore, waiting at most timeout_ms.
+ * @param semaphore - Pointer toward the semaphore.
+ * @param timeout_ms - Maximum time to wait, in milliseconds.
+ * @return 0 if a token was taken, -ETIMEDOUT if none was given in time,
+ * -ENOSYS if the platform has no blocking wait.
+ */
+__attribute__((weak)) int no_os_semaphore_take_timeout(void *semaphore,
+		uint32_t timeout_ms)
+{
+	return -ENOSYS;
+}
+
 /**
  * @brief Give token to semaphore
  * @param ptr - Pointer toward the semaphore.
@@ -60,6 +74,16 @@ __attribute__((weak)) inline void no_os_semaphore_take(void *semaphore) {}
  */
 __attribute((weak)) inline void no_os_semaphore_give(void *semaphore) {}
 
+/**
+ * @brief Give token to semaphore from an interrupt handler.
+ * @param semaphore - Pointer toward the semaphore.
+ * @return None.
+ */
+__attribute__((weak)) void no_os_semaphore_give_from_isr(void *semaphore)
+{
+	no_os_semaphore_give(semaphore);
+}
+
 /**
  * @brief Remove semaphore.
  * @param ptr - Pointer toward the semaphore.
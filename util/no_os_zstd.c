@@ -0,0 +1,478 @@
+/***************************************************************************//**
+ *   @file   no_os_zstd.c
+ *   @brief  Source file of the Zstandard compressor.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#include <errno.h>
+#include <string.h>
+#include "no_os_zstd.h"
+#include "no_os_util.h"
+#include "no_os_alloc.h"
+
+/*
+ * Minimal Zstandard (RFC 8878) compressor meant for data compressed once, like
+ * the iio context xml. Matches are found with a single entry hash table over
+ * the whole input and sequences are encoded with the predefined FSE
+ * distributions, so no tables are sent. Literals are stored raw. Blocks that
+ * do not get smaller are stored raw.
+ */
+
+#define ZSTD_MAGIC		0xFD2FB528
+#define ZSTD_MIN_MATCH		4
+#define ZSTD_HASH_LOG		12
+
+#define ZSTD_BLOCK_RAW		0
+#define ZSTD_BLOCK_COMPRESSED	2
+
+#define ZSTD_LL_MAX		35
+#define ZSTD_ML_MAX		52
+#define ZSTD_OF_MAX		28
+#define ZSTD_LL_LOG		6
+#define ZSTD_ML_LOG		6
+#define ZSTD_OF_LOG		5
+
+struct zstd_seq {
+	uint16_t ll;
+	uint16_t ml;
+	uint32_t off;
+};
+
+struct zstd_bits {
+	uint8_t *ptr;
+	uint8_t *end;
+	uint64_t acc;
+	uint32_t nb;
+};
+
+struct zstd_fse_symbol {
+	int32_t delta_find_state;
+	uint32_t delta_nb_bits;
+};
+
+struct zstd_fse {
+	uint8_t log;
+	uint16_t state_table[1 << ZSTD_ML_LOG];
+	struct zstd_fse_symbol symbol[ZSTD_ML_MAX + 1];
+};
+
+struct zstd_fse_state {
+	uint32_t value;
+	const struct zstd_fse *table;
+};
+
+static const int16_t ll_default_norm[ZSTD_LL_MAX + 1] = {
+	4, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1,
+	2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 1, 1, 1, 1, 1,
+	-1, -1, -1, -1
+};
+
+static const int16_t ml_default_norm[ZSTD_ML_MAX + 1] = {
+	1, 4, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1,
+	-1, -1, -1, -1, -1
+};
+
+static const int16_t of_default_norm[ZSTD_OF_MAX + 1] = {
+	1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1
+};
+
+static const uint32_t ll_base[ZSTD_LL_MAX + 1] = {
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+	16, 18, 20, 22, 24, 28, 32, 40, 48, 64, 128, 256, 512, 1024, 2048, 4096,
+	8192, 16384, 32768, 65536
+};
+
+static const uint8_t ll_bits[ZSTD_LL_MAX + 1] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	1, 1, 1, 1, 2, 2, 3, 3, 4, 6, 7, 8, 9, 10, 11, 12,
+	13, 14, 15, 16
+};
+
+static const uint32_t ml_base[ZSTD_ML_MAX + 1] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18,
+	19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34,
+	35, 37, 39, 41, 43, 47, 51, 59, 67, 83, 99, 131, 259, 515, 1027, 2051,
+	4099, 8195, 16387, 32771, 65539
+};
+
+static const uint8_t ml_bits[ZSTD_ML_MAX + 1] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	1, 1, 1, 1, 2, 2, 3, 3, 4, 4, 5, 7, 8, 9, 10, 11,
+	12, 13, 14, 15, 16
+};
+
+/* Build the FSE encoding table of a normalized distribution */
+static void zstd_fse_build(struct zstd_fse *fse, const int16_t *norm,
+			   uint32_t max_symbol, uint8_t log)
+{
+	uint32_t table_size = 1 << log;
+	uint32_t high_threshold = table_size - 1;
+	uint32_t step = (table_size >> 1) + (table_size >> 3) + 3;
+	uint8_t table_symbol[1 << ZSTD_ML_LOG];
+	uint16_t cumul[ZSTD_ML_MAX + 2];
+	uint32_t max_bits_out;
+	uint32_t position;
+	uint32_t total;
+	uint32_t s, u;
+	int32_t i;
+
+	fse->log = log;
+
+	/* Symbols with a "less than 1" probability go to the end */
+	cumul[0] = 0;
+	for (s = 0; s <= max_symbol; s++) {
+		if (norm[s] == -1) {
+			cumul[s + 1] = cumul[s] + 1;
+			table_symbol[high_threshold--] = s;
+		} else {
+			cumul[s + 1] = cumul[s] + norm[s];
+		}
+	}
+
+	/* Spread symbols, same as the decoder */
+	position = 0;
+	for (s = 0; s <= max_symbol; s++) {
+		for (i = 0; i < norm[s]; i++) {
+			table_symbol[position] = s;
+			do {
+				position = (position + step) & (table_size - 1);
+			} while (position > high_threshold);
+		}
+	}
+
+	for (u = 0; u < table_size; u++)
+		fse->state_table[cumul[table_symbol[u]]++] = table_size + u;
+
+	total = 0;
+	for (s = 0; s <= max_symbol; s++) {
+		switch (norm[s]) {
+		case 0:
+			break;
+		case -1:
+		case 1:
+			fse->symbol[s].delta_nb_bits = (log << 16) - table_size;
+			fse->symbol[s].delta_find_state = total - 1;
+			total++;
+			break;
+		default:
+			max_bits_out = log - no_os_find_last_set_bit(norm[s] - 1);
+			fse->symbol[s].delta_nb_bits = (max_bits_out << 16) -
+						       (norm[s] << max_bits_out);
+			fse->symbol[s].delta_find_state = total - norm[s];
+			total += norm[s];
+			break;
+		}
+	}
+}
+
+static void zstd_bits_add(struct zstd_bits *bits, uint32_t val, uint32_t nb)
+{
+	bits->acc |= (uint64_t)(val & (uint32_t)(NO_OS_BIT_ULL(nb) - 1)) <<
+		     bits->nb;
+	bits->nb += nb;
+	while (bits->nb >= 8) {
+		if (bits->ptr < bits->end)
+			*bits->ptr = bits->acc;
+		bits->ptr++;
+		bits->acc >>= 8;
+		bits->nb -= 8;
+	}
+}
+
+static void zstd_fse_init_state(struct zstd_fse_state *state,
+				const struct zstd_fse *fse, uint32_t symbol)
+{
+	const struct zstd_fse_symbol *sym = &fse->symbol[symbol];
+	uint32_t nb_bits_out = (sym->delta_nb_bits + (1 << 15)) >> 16;
+	uint32_t value = (nb_bits_out << 16) - sym->delta_nb_bits;
+
+	state->table = fse;
+	state->value = fse->state_table[(value >> nb_bits_out) +
+						sym->delta_find_state];
+}
+
+static void zstd_fse_encode(struct zstd_bits *bits,
+			    struct zstd_fse_state *state, uint32_t symbol)
+{
+	const struct zstd_fse_symbol *sym = &state->table->symbol[symbol];
+	uint32_t nb_bits_out = (state->value + sym->delta_nb_bits) >> 16;
+
+	zstd_bits_add(bits, state->value, nb_bits_out);
+	state->value = state->table->state_table[(state->value >> nb_bits_out) +
+						 sym->delta_find_state];
+}
+
+static uint32_t zstd_code(uint32_t val, const uint32_t *base, uint32_t max)
+{
+	uint32_t code = max;
+
+	while (base[code] > val)
+		code--;
+
+	return code;
+}
+
+/* Get the literal length, match length and offset codes of a sequence */
+static void zstd_seq_codes(const struct zstd_seq *seq, uint32_t codes[3])
+{
+	codes[0] = zstd_code(seq->ll, ll_base, ZSTD_LL_MAX);
+	codes[1] = zstd_code(seq->ml, ml_base, ZSTD_ML_MAX);
+	/* Offset values up to 3 are repeat offsets */
+	codes[2] = no_os_find_last_set_bit(seq->off + 3);
+}
+
+static void zstd_seq_bits(struct zstd_bits *bits, const struct zstd_seq *seq,
+			  const uint32_t codes[3])
+{
+	zstd_bits_add(bits, seq->ll - ll_base[codes[0]], ll_bits[codes[0]]);
+	zstd_bits_add(bits, seq->ml - ml_base[codes[1]], ml_bits[codes[1]]);
+	zstd_bits_add(bits, seq->off + 3 - NO_OS_BIT(codes[2]), codes[2]);
+}
+
+/* Encode the sequences, last one first, as read backwards by the decoder */
+static void zstd_encode_seqs(struct zstd_bits *bits, const struct zstd_seq *seq,
+			     uint32_t nb_seq, const struct zstd_fse fse[3])
+{
+	struct zstd_fse_state ll_state, ml_state, of_state;
+	uint32_t codes[3];
+	uint32_t n = nb_seq - 1;
+
+	zstd_seq_codes(&seq[n], codes);
+	zstd_fse_init_state(&ml_state, &fse[1], codes[1]);
+	zstd_fse_init_state(&of_state, &fse[2], codes[2]);
+	zstd_fse_init_state(&ll_state, &fse[0], codes[0]);
+	zstd_seq_bits(bits, &seq[n], codes);
+
+	while (n--) {
+		zstd_seq_codes(&seq[n], codes);
+		zstd_fse_encode(bits, &of_state, codes[2]);
+		zstd_fse_encode(bits, &ml_state, codes[1]);
+		zstd_fse_encode(bits, &ll_state, codes[0]);
+		zstd_seq_bits(bits, &seq[n], codes);
+	}
+
+	zstd_bits_add(bits, ml_state.value, fse[1].log);
+	zstd_bits_add(bits, of_state.value, fse[2].log);
+	zstd_bits_add(bits, ll_state.value, fse[0].log);
+	/* End mark */
+	zstd_bits_add(bits, 1, 1);
+	if (bits->nb)
+		zstd_bits_add(bits, 0, 8 - bits->nb);
+}
+
+static uint32_t zstd_hash(const uint8_t *p)
+{
+	uint32_t val = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+
+	return (val * 2654435761u) >> (32 - ZSTD_HASH_LOG);
+}
+
+/* Find the sequences of the block [start, end). Matches may start before it */
+static uint32_t zstd_find_seqs(const uint8_t *src, uint32_t start,
+			       uint32_t end, uint32_t src_len,
+			       uint32_t *hash_table, struct zstd_seq *seq,
+			       uint32_t *nb_lits)
+{
+	uint32_t anchor = start;
+	uint32_t pos = start;
+	uint32_t nb_seq = 0;
+	uint32_t cand, ml, h;
+
+	*nb_lits = 0;
+	while (pos + ZSTD_MIN_MATCH <= end) {
+		h = zstd_hash(src + pos);
+		cand = hash_table[h];
+		hash_table[h] = pos + 1;
+		if (!cand || memcmp(src + cand - 1, src + pos, ZSTD_MIN_MATCH)) {
+			pos++;
+			continue;
+		}
+
+		cand--;
+		ml = ZSTD_MIN_MATCH;
+		while (pos + ml < end && src[cand + ml] == src[pos + ml])
+			ml++;
+
+		seq[nb_seq].ll = pos - anchor;
+		seq[nb_seq].ml = ml;
+		seq[nb_seq].off = pos - cand;
+		*nb_lits += pos - anchor;
+		nb_seq++;
+
+		/* Index the matched data too, it helps on repetitive input */
+		while (--ml) {
+			pos++;
+			if (pos + ZSTD_MIN_MATCH <= src_len)
+				hash_table[zstd_hash(src + pos)] = pos + 1;
+		}
+		pos++;
+		anchor = pos;
+	}
+	*nb_lits += end - anchor;
+
+	return nb_seq;
+}
+
+/* Write a compressed block. Returns its size or 0 if it is not smaller */
+static uint32_t zstd_write_block(const uint8_t *src, uint32_t start,
+				 uint32_t end, const struct zstd_seq *seq,
+				 uint32_t nb_seq, uint32_t nb_lits,
+				 const struct zstd_fse fse[3], uint8_t *dst)
+{
+	struct zstd_bits bits = {
+		.ptr = dst,
+		.end = dst + (end - start)
+	};
+	uint32_t pos = start;
+	uint32_t i;
+
+	if (nb_lits + 3 + 4 >= end - start)
+		return 0;
+
+	/* Raw literals section with a 3 bytes header */
+	*bits.ptr++ = 0x0C | ((nb_lits & 0xF) << 4);
+	*bits.ptr++ = nb_lits >> 4;
+	*bits.ptr++ = nb_lits >> 12;
+	for (i = 0; i < nb_seq; i++) {
+		memcpy(bits.ptr, src + pos, seq[i].ll);
+		bits.ptr += seq[i].ll;
+		pos += seq[i].ll + seq[i].ml;
+	}
+	memcpy(bits.ptr, src + pos, end - pos);
+	bits.ptr += end - pos;
+
+	/* Number of sequences. Block size keeps it below 0x7F00 */
+	if (nb_seq < 128) {
+		*bits.ptr++ = nb_seq;
+	} else {
+		*bits.ptr++ = (nb_seq >> 8) + 0x80;
+		*bits.ptr++ = nb_seq;
+	}
+	if (nb_seq) {
+		/* Predefined mode for all symbols */
+		*bits.ptr++ = 0;
+		zstd_encode_seqs(&bits, seq, nb_seq, fse);
+	}
+
+	if (bits.ptr >= bits.end)
+		return 0;
+
+	return bits.ptr - dst;
+}
+
+/**
+ * @brief Compress data into a single Zstandard frame.
+ * @param src - Data to compress.
+ * @param src_len - Size of src in bytes.
+ * @param dst - Where to write the frame.
+ * @param dst_size - Size of dst. NO_OS_ZSTD_COMPRESS_BOUND(src_len) is always
+ * enough.
+ * @param dst_len - Where to store the size of the frame.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int no_os_zstd_compress(const uint8_t *src, uint32_t src_len, uint8_t *dst,
+			uint32_t dst_size, uint32_t *dst_len)
+{
+	struct zstd_fse fse[3];
+	uint32_t *hash_table;
+	struct zstd_seq *seq;
+	uint32_t start, end;
+	uint32_t nb_seq, nb_lits;
+	uint32_t block_len;
+	uint8_t *out;
+	int ret = 0;
+
+	if (!src || !dst || !dst_len)
+		return -EINVAL;
+
+	if (dst_size < NO_OS_ZSTD_COMPRESS_BOUND(src_len))
+		return -ENOSPC;
+
+	hash_table = no_os_calloc(NO_OS_BIT(ZSTD_HASH_LOG), sizeof(*hash_table));
+	if (!hash_table)
+		return -ENOMEM;
+
+	seq = no_os_calloc(NO_OS_ZSTD_BLOCK_SIZE / ZSTD_MIN_MATCH + 1,
+			   sizeof(*seq));
+	if (!seq) {
+		ret = -ENOMEM;
+		goto free_hash;
+	}
+
+	zstd_fse_build(&fse[0], ll_default_norm, ZSTD_LL_MAX, ZSTD_LL_LOG);
+	zstd_fse_build(&fse[1], ml_default_norm, ZSTD_ML_MAX, ZSTD_ML_LOG);
+	zstd_fse_build(&fse[2], of_default_norm, ZSTD_OF_MAX, ZSTD_OF_LOG);
+
+	/* Single segment frame with a 4 bytes content size and no checksum */
+	out = dst;
+	no_os_put_unaligned_le32(ZSTD_MAGIC, out);
+	out[4] = 0xA0;
+	no_os_put_unaligned_le32(src_len, out + 5);
+	out += 9;
+
+	start = 0;
+	do {
+		end = no_os_min(start + NO_OS_ZSTD_BLOCK_SIZE, src_len);
+		nb_seq = zstd_find_seqs(src, start, end, src_len, hash_table,
+					seq, &nb_lits);
+		block_len = zstd_write_block(src, start, end, seq, nb_seq,
+					     nb_lits, fse, out + 3);
+		if (block_len) {
+			no_os_put_unaligned_le24((block_len << 3) |
+						 (ZSTD_BLOCK_COMPRESSED << 1) |
+						 (end == src_len), out);
+		} else {
+			block_len = end - start;
+			memcpy(out + 3, src + start, block_len);
+			no_os_put_unaligned_le24((block_len << 3) |
+						 (ZSTD_BLOCK_RAW << 1) |
+						 (end == src_len), out);
+		}
+		out += 3 + block_len;
+		start = end;
+	} while (start < src_len);
+
+	*dst_len = out - dst;
+
+	no_os_free(seq);
+free_hash:
+	no_os_free(hash_table);
+
+	return ret;
+}